@@ -27,6 +27,9 @@
 #include <rte_ring.h>
 #include <rte_string_fns.h>
 #include <rte_pdump.h>
+#ifdef RTE_LIBRTE_BPF
+#include <rte_bpf.h>
+#endif
 
 #define CMD_LINE_OPT_PDUMP "pdump"
 #define CMD_LINE_OPT_PDUMP_NUM 256
@@ -41,6 +44,9 @@
 #define PDUMP_RING_SIZE_ARG "ring-size"
 #define PDUMP_MSIZE_ARG "mbuf-size"
 #define PDUMP_NUM_MBUFS_ARG "total-num-mbufs"
+#define PDUMP_SNAPLEN_ARG "snaplen"
+#define PDUMP_SAMPLE_ARG "sample"
+#define PDUMP_FILTER_ARG "filter"
 
 #define VDEV_NAME_FMT "net_pcap_%s_%d"
 #define VDEV_PCAP_ARGS_FMT "tx_pcap=%s"
@@ -97,6 +103,9 @@ static const char * const valid_pdump_arguments[] = {
 	PDUMP_RING_SIZE_ARG,
 	PDUMP_MSIZE_ARG,
 	PDUMP_NUM_MBUFS_ARG,
+	PDUMP_SNAPLEN_ARG,
+	PDUMP_SAMPLE_ARG,
+	PDUMP_FILTER_ARG,
 	NULL
 };
 
@@ -119,6 +128,10 @@ struct pdump_tuples {
 
 	/* params for library API call */
 	uint32_t dir;
+	struct rte_pdump_params params;
+#ifdef RTE_LIBRTE_BPF
+	struct rte_bpf_prm prm;
+#endif
 	struct rte_mempool *mp;
 	struct rte_ring *rx_ring;
 	struct rte_ring *tx_ring;
@@ -160,7 +173,10 @@ pdump_usage(const char *prgname)
 			" tx-dev=<iface or pcap file>,"
 			"[ring-size=<ring size>default:16384],"
 			"[mbuf-size=<mbuf data size>default:2176],"
-			"[total-num-mbufs=<number of mbufs>default:65535]'\n",
+			"[total-num-mbufs=<number of mbufs>default:65535],"
+			"[snaplen=<bytes captured per packet>default:0 (all)],"
+			"[sample=<capture one in N packets>default:1],"
+			"[filter=<file of raw eBPF instructions>]'\n",
 			prgname);
 }
 
@@ -243,6 +259,50 @@ parse_uint_value(const char *key, const char *value, void *extra_args)
 	return 0;
 }
 
+#ifdef RTE_LIBRTE_BPF
+/* load a file of raw eBPF instructions, run with the mbuf as argument */
+static int
+parse_filter(const char *key __rte_unused, const char *value,
+		void *extra_args)
+{
+	struct pdump_tuples *pt = extra_args;
+	struct ebpf_insn *ins = NULL;
+	FILE *f;
+	long sz;
+
+	f = fopen(value, "rb");
+	if (f == NULL) {
+		printf("cannot open filter file \"%s\": %s\n",
+			value, strerror(errno));
+		return -EINVAL;
+	}
+	if (fseek(f, 0, SEEK_END) != 0 || (sz = ftell(f)) <= 0 ||
+			sz % sizeof(*ins) != 0 || fseek(f, 0, SEEK_SET) != 0) {
+		printf("invalid filter file \"%s\"\n", value);
+		fclose(f);
+		return -EINVAL;
+	}
+	ins = malloc(sz);
+	if (ins == NULL || fread(ins, sz, 1, f) != 1) {
+		printf("cannot read filter file \"%s\"\n", value);
+		free(ins);
+		fclose(f);
+		return -EINVAL;
+	}
+	fclose(f);
+
+	memset(&pt->prm, 0, sizeof(pt->prm));
+	pt->prm.ins = ins;
+	pt->prm.nb_ins = sz / sizeof(*ins);
+	pt->prm.prog_arg.type = RTE_BPF_ARG_PTR_MBUF;
+	pt->prm.prog_arg.size = sizeof(struct rte_mbuf);
+	pt->prm.prog_arg.buf_size = pt->mbuf_data_size;
+	pt->params.prm = &pt->prm;
+
+	return 0;
+}
+#endif
+
 static int
 parse_pdump(const char *optarg)
 {
@@ -370,6 +430,49 @@ parse_pdump(const char *optarg)
 	} else
 		pt->total_num_mbufs = MBUFS_PER_POOL;
 
+	/* snaplen parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_SNAPLEN_ARG);
+	if (cnt1 == 1) {
+		v.min = 1;
+		v.max = UINT32_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_SNAPLEN_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->params.snaplen = (uint32_t) v.val;
+	} else
+		pt->params.snaplen = 0;
+
+	/* sample rate parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_SAMPLE_ARG);
+	if (cnt1 == 1) {
+		v.min = 1;
+		v.max = UINT32_MAX;
+		ret = rte_kvargs_process(kvlist, PDUMP_SAMPLE_ARG,
+						&parse_uint_value, &v);
+		if (ret < 0)
+			goto free_kvlist;
+		pt->params.sample_rate = (uint32_t) v.val;
+	} else
+		pt->params.sample_rate = 1;
+
+	/* filter parsing, after mbuf_data_size used as the buffer size */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_FILTER_ARG);
+	if (cnt1 == 1) {
+#ifdef RTE_LIBRTE_BPF
+		ret = rte_kvargs_process(kvlist, PDUMP_FILTER_ARG,
+						&parse_filter, pt);
+		if (ret < 0)
+			goto free_kvlist;
+#else
+		printf("--pdump=\"%s\": filter requires librte_bpf\n",
+			optarg);
+		ret = -1;
+		goto free_kvlist;
+#endif
+	} else
+		pt->params.prm = NULL;
+
 	num_tuples++;
 
 free_kvlist:
@@ -504,6 +607,10 @@ cleanup_rings(void)
 
 		if (pt->device_id)
 			free(pt->device_id);
+#ifdef RTE_LIBRTE_BPF
+		if (pt->params.prm != NULL)
+			free((void *)(uintptr_t)pt->prm.ins);
+#endif
 
 		/* free the rings */
 		if (pt->rx_ring)
@@ -832,48 +939,48 @@ enable_pdump(void)
 		pt = &pdump_t[i];
 		if (pt->dir == RTE_PDUMP_FLAG_RXTX) {
 			if (pt->dump_by_type == DEVICE_ID) {
-				ret = rte_pdump_enable_by_deviceid(
+				ret = rte_pdump_enable_by_deviceid_params(
 						pt->device_id,
 						pt->queue,
 						RTE_PDUMP_FLAG_RX,
 						pt->rx_ring,
-						pt->mp, NULL);
-				ret1 = rte_pdump_enable_by_deviceid(
+						pt->mp, &pt->params);
+				ret1 = rte_pdump_enable_by_deviceid_params(
 						pt->device_id,
 						pt->queue,
 						RTE_PDUMP_FLAG_TX,
 						pt->tx_ring,
-						pt->mp, NULL);
+						pt->mp, &pt->params);
 			} else if (pt->dump_by_type == PORT_ID) {
-				ret = rte_pdump_enable(pt->port, pt->queue,
+				ret = rte_pdump_enable_params(pt->port, pt->queue,
 						RTE_PDUMP_FLAG_RX,
-						pt->rx_ring, pt->mp, NULL);
-				ret1 = rte_pdump_enable(pt->port, pt->queue,
+						pt->rx_ring, pt->mp, &pt->params);
+				ret1 = rte_pdump_enable_params(pt->port, pt->queue,
 						RTE_PDUMP_FLAG_TX,
-						pt->tx_ring, pt->mp, NULL);
+						pt->tx_ring, pt->mp, &pt->params);
 			}
 		} else if (pt->dir == RTE_PDUMP_FLAG_RX) {
 			if (pt->dump_by_type == DEVICE_ID)
-				ret = rte_pdump_enable_by_deviceid(
+				ret = rte_pdump_enable_by_deviceid_params(
 						pt->device_id,
 						pt->queue,
 						pt->dir, pt->rx_ring,
-						pt->mp, NULL);
+						pt->mp, &pt->params);
 			else if (pt->dump_by_type == PORT_ID)
-				ret = rte_pdump_enable(pt->port, pt->queue,
+				ret = rte_pdump_enable_params(pt->port, pt->queue,
 						pt->dir,
-						pt->rx_ring, pt->mp, NULL);
+						pt->rx_ring, pt->mp, &pt->params);
 		} else if (pt->dir == RTE_PDUMP_FLAG_TX) {
 			if (pt->dump_by_type == DEVICE_ID)
-				ret = rte_pdump_enable_by_deviceid(
+				ret = rte_pdump_enable_by_deviceid_params(
 						pt->device_id,
 						pt->queue,
 						pt->dir,
-						pt->tx_ring, pt->mp, NULL);
+						pt->tx_ring, pt->mp, &pt->params);
 			else if (pt->dump_by_type == PORT_ID)
-				ret = rte_pdump_enable(pt->port, pt->queue,
+				ret = rte_pdump_enable_params(pt->port, pt->queue,
 						pt->dir,
-						pt->tx_ring, pt->mp, NULL);
+						pt->tx_ring, pt->mp, &pt->params);
 		}
 		if (ret < 0 || ret1 < 0) {
 			cleanup_pdump_resources();
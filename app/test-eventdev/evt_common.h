@@ -45,6 +45,8 @@ enum evt_prod_type {
 struct evt_options {
 #define EVT_TEST_NAME_MAX_LEN     32
 	char test_name[EVT_TEST_NAME_MAX_LEN];
+#define EVT_LAT_CSV_MAX_LEN       256
+	char lat_csv[EVT_LAT_CSV_MAX_LEN];
 	bool plcores[RTE_MAX_LCORE];
 	bool wlcores[RTE_MAX_LCORE];
 	int pool_sz;
@@ -64,6 +66,7 @@ struct evt_options {
 	uint32_t deq_tmo_nsec;
 	uint32_t q_priority:1;
 	uint32_t fwd_latency:1;
+	uint32_t lat_hist:1;
 	uint64_t nb_pkts;
 	uint64_t nb_timers;
 	uint64_t expiry_nsec;
@@ -78,6 +78,25 @@ evt_parse_fwd_latency(struct evt_options *opt, const char *arg __rte_unused)
 	return 0;
 }
 
+static int
+evt_parse_lat_hist(struct evt_options *opt, const char *arg __rte_unused)
+{
+	opt->lat_hist = 1;
+	return 0;
+}
+
+static int
+evt_parse_lat_csv(struct evt_options *opt, const char *arg)
+{
+	if (strlcpy(opt->lat_csv, arg, EVT_LAT_CSV_MAX_LEN) >=
+			EVT_LAT_CSV_MAX_LEN) {
+		evt_err("lat_csv file name too long");
+		return -EINVAL;
+	}
+	opt->lat_hist = 1;
+	return 0;
+}
+
 static int
 evt_parse_queue_priority(struct evt_options *opt, const char *arg __rte_unused)
 {
@@ -285,6 +304,12 @@ usage(char *program)
 		"\t--expiry_nsec      : event timer expiry ns.\n"
 		"\t--mbuf_sz          : packet mbuf size.\n"
 		"\t--max_pkt_sz       : max packet size.\n"
+		"\t--lat_hist         : measure per stage latency histograms\n"
+		"\t                     of the pipeline tests, which then\n"
+		"\t                     stop after nb_pkts packets.\n"
+		"\t--lat_csv          : append the latency histograms\n"
+		"\t                     summary to a CSV file, implies\n"
+		"\t                     lat_hist.\n"
 		);
 	printf("available tests:\n");
 	evt_test_dump_names();
@@ -356,6 +381,8 @@ static struct option lgopts[] = {
 	{ EVT_EXPIRY_NSEC,         1, 0, 0 },
 	{ EVT_MBUF_SZ,             1, 0, 0 },
 	{ EVT_MAX_PKT_SZ,          1, 0, 0 },
+	{ EVT_LAT_HIST,            0, 0, 0 },
+	{ EVT_LAT_CSV,             1, 0, 0 },
 	{ EVT_HELP,                0, 0, 0 },
 	{ NULL,                    0, 0, 0 }
 };
@@ -390,6 +417,8 @@ evt_opts_parse_long(int opt_idx, struct evt_options *opt)
 		{ EVT_EXPIRY_NSEC, evt_parse_expiry_nsec},
 		{ EVT_MBUF_SZ, evt_parse_mbuf_sz},
 		{ EVT_MAX_PKT_SZ, evt_parse_max_pkt_sz},
+		{ EVT_LAT_HIST, evt_parse_lat_hist},
+		{ EVT_LAT_CSV, evt_parse_lat_csv},
 	};
 
 	for (i = 0; i < RTE_DIM(parsermap); i++) {
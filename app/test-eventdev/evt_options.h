@@ -42,6 +42,8 @@
 #define EVT_EXPIRY_NSEC          ("expiry_nsec")
 #define EVT_MBUF_SZ              ("mbuf_sz")
 #define EVT_MAX_PKT_SZ           ("max_pkt_sz")
+#define EVT_LAT_HIST             ("lat_hist")
+#define EVT_LAT_CSV              ("lat_csv")
 #define EVT_HELP                 ("help")
 
 void evt_options_default(struct evt_options *opt);
@@ -200,6 +202,14 @@ evt_dump_fwd_latency(struct evt_options *opt)
 	evt_dump("fwd_latency", "%s", EVT_BOOL_FMT(opt->fwd_latency));
 }
 
+static inline void
+evt_dump_lat_hist(struct evt_options *opt)
+{
+	evt_dump("lat_hist", "%s", EVT_BOOL_FMT(opt->lat_hist));
+	if (opt->lat_csv[0] != '\0')
+		evt_dump("lat_csv", "%s", opt->lat_csv);
+}
+
 static inline void
 evt_dump_queue_priority(struct evt_options *opt)
 {
@@ -5,10 +5,157 @@
 
 #include "test_pipeline_common.h"
 
+static void
+pipeline_lat_hist_merge(struct pipeline_lat_hist *dst,
+		const struct pipeline_lat_hist *src)
+{
+	unsigned int i;
+
+	if (src->count == 0)
+		return;
+	if (dst->count == 0 || src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+	dst->count += src->count;
+	dst->sum += src->sum;
+	for (i = 0; i < PIPELINE_LAT_NB_BUCKETS; i++)
+		dst->bucket[i] += src->bucket[i];
+}
+
+/* Highest value of a histogram bucket */
+static uint64_t
+pipeline_lat_bucket_max(unsigned int idx)
+{
+	unsigned int shift, mant;
+
+	if (idx < (2 << PIPELINE_LAT_SUB_BITS))
+		return idx;
+	shift = (idx >> PIPELINE_LAT_SUB_BITS) - 1;
+	mant = (idx & ((1 << PIPELINE_LAT_SUB_BITS) - 1)) |
+		(1 << PIPELINE_LAT_SUB_BITS);
+	return ((uint64_t)(mant + 1) << shift) - 1;
+}
+
+static uint64_t
+pipeline_lat_percentile(const struct pipeline_lat_hist *h, double pct)
+{
+	uint64_t target, sum = 0;
+	unsigned int i;
+
+	target = (uint64_t)(h->count * pct / 100);
+	if (target == 0)
+		target = 1;
+	for (i = 0; i < PIPELINE_LAT_NB_BUCKETS; i++) {
+		sum += h->bucket[i];
+		if (sum >= target)
+			return RTE_MIN(pipeline_lat_bucket_max(i), h->max);
+	}
+
+	return h->max;
+}
+
+static void
+pipeline_lat_report(struct test_pipeline *t, struct evt_options *opt)
+{
+	static const double pcts[] = { 50, 90, 99, 99.9 };
+	const double ns_per_cycle = 1E9 / rte_get_timer_hz();
+	const int nb_hist = PIPELINE_LAT_NB_HIST(opt);
+	struct rte_event_dev_info info;
+	struct pipeline_lat_hist *h;
+	char name[EVT_STR_FMT];
+	unsigned int i, j;
+	FILE *csv = NULL;
+	int idx, k;
+
+	h = rte_malloc(NULL, sizeof(*h), 0);
+	if (h == NULL) {
+		evt_err("failed to allocate latency histogram");
+		return;
+	}
+
+	rte_event_dev_info_get(opt->dev_id, &info);
+	if (opt->lat_csv[0] != '\0') {
+		csv = fopen(opt->lat_csv, "a");
+		if (csv == NULL)
+			evt_err("failed to open %s", opt->lat_csv);
+		else if (ftell(csv) == 0)
+			fprintf(csv, "driver,test,stlist,nb_workers,stage,"
+				"count,min_ns,mean_ns,p50_ns,p90_ns,p99_ns,"
+				"p99.9_ns,max_ns\n");
+	}
+
+	evt_info("Latency in ns (Rx to stage0, previous stage to stageN, "
+		"last stage to tx, Rx to tx):");
+	printf("%-*s %12s %10s %10s %10s %10s %10s %10s %10s\n",
+		EVT_STR_FMT, "stage", "count", "min", "mean", "p50", "p90",
+		"p99", "p99.9", "max");
+
+	/* Report the stages first, then tx and total */
+	for (k = 0; k < nb_hist; k++) {
+		if (k < nb_hist - 2)
+			idx = PIPELINE_LAT_STAGE(k);
+		else if (k == nb_hist - 2)
+			idx = PIPELINE_LAT_TX;
+		else
+			idx = PIPELINE_LAT_TOTAL;
+		memset(h, 0, sizeof(*h));
+		for (i = 0; i < t->nb_lat; i++)
+			pipeline_lat_hist_merge(h, &t->lat[i * nb_hist + idx]);
+		if (h->count == 0)
+			continue;
+
+		if (idx == PIPELINE_LAT_TOTAL)
+			snprintf(name, sizeof(name), "total");
+		else if (idx == PIPELINE_LAT_TX)
+			snprintf(name, sizeof(name), "tx");
+		else
+			snprintf(name, sizeof(name), "stage%d",
+				idx - PIPELINE_LAT_STAGE(0));
+
+		printf("%-*s %12"PRIu64" %10.0f %10.0f", EVT_STR_FMT, name,
+			h->count, h->min * ns_per_cycle,
+			(double)h->sum / h->count * ns_per_cycle);
+		for (j = 0; j < RTE_DIM(pcts); j++)
+			printf(" %10.0f", pipeline_lat_percentile(h, pcts[j]) *
+				ns_per_cycle);
+		printf(" %10.0f\n", h->max * ns_per_cycle);
+
+		if (csv != NULL) {
+			fprintf(csv, "%s,%s,", info.driver_name,
+				opt->test_name);
+			for (j = 0; j < (unsigned int)opt->nb_stages; j++)
+				fprintf(csv, "%s", evt_sched_type_2_str(
+					opt->sched_type_list[j]));
+			fprintf(csv, ",%d,%s,%"PRIu64",%.0f,%.0f",
+				t->nb_workers, name, h->count, h->min * ns_per_cycle,
+				(double)h->sum / h->count * ns_per_cycle);
+			for (j = 0; j < RTE_DIM(pcts); j++)
+				fprintf(csv, ",%.0f",
+					pipeline_lat_percentile(h, pcts[j]) *
+					ns_per_cycle);
+			fprintf(csv, ",%.0f\n", h->max * ns_per_cycle);
+		}
+
+		if (opt->verbose_level > 1) {
+			for (i = 0; i < PIPELINE_LAT_NB_BUCKETS; i++) {
+				if (h->bucket[i] == 0)
+					continue;
+				printf("\t<= %.0f ns: %"PRIu64"\n",
+					pipeline_lat_bucket_max(i) *
+					ns_per_cycle, h->bucket[i]);
+			}
+		}
+	}
+
+	if (csv != NULL)
+		fclose(csv);
+	rte_free(h);
+}
+
 int
 pipeline_test_result(struct evt_test *test, struct evt_options *opt)
 {
-	RTE_SET_USED(opt);
 	int i;
 	uint64_t total = 0;
 	struct test_pipeline *t = evt_test_priv(test);
@@ -22,6 +169,8 @@ pipeline_test_result(struct evt_test *test, struct evt_options *opt)
 				t->worker[i].processed_pkts,
 				(((double)t->worker[i].processed_pkts)/total)
 				* 100);
+	if (opt->lat_hist)
+		pipeline_lat_report(t, opt);
 	return t->result;
 }
 
@@ -36,6 +185,7 @@ pipeline_opt_dump(struct evt_options *opt, uint8_t nb_queues)
 	evt_dump_queue_priority(opt);
 	evt_dump_sched_type_list(opt);
 	evt_dump_producer_type(opt);
+	evt_dump_lat_hist(opt);
 }
 
 static inline uint64_t
@@ -96,9 +246,22 @@ pipeline_launch_lcores(struct evt_test *test, struct evt_options *opt,
 			printf(CLGRN"\r%.3f mpps avg %.3f mpps"CLNRM,
 					mpps, total_mpps/samples);
 			fflush(stdout);
+
+			/* Latency runs end after nb_pkts packets */
+			if (opt->lat_hist && opt->nb_pkts &&
+					curr_pkts >= opt->nb_pkts) {
+				t->done = true;
+				rte_smp_wmb();
+				t->result = EVT_TEST_SUCCESS;
+			}
 		}
 	}
 	printf("\n");
+
+	/* Stop the traffic before reporting the latency */
+	if (t->result == EVT_TEST_SUCCESS)
+		pipeline_ethdev_destroy(test, opt);
+
 	return 0;
 }
 
@@ -153,6 +316,48 @@ pipeline_opt_check(struct evt_options *opt, uint64_t nb_queues)
 	return 0;
 }
 
+static uint16_t
+pipeline_lat_rx_cb(uint16_t port_id __rte_unused, uint16_t queue __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		uint16_t max_pkts __rte_unused, void *arg __rte_unused)
+{
+	const uint64_t now = rte_get_timer_cycles();
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		struct pipeline_lat_priv *priv = pipeline_lat_priv(pkts[i]);
+
+		/* Keep the SW Rx adapter from overwriting the timestamp */
+		pkts[i]->timestamp = now;
+		pkts[i]->ol_flags |= PKT_RX_TIMESTAMP;
+		priv->stage_ts = now;
+		priv->tx_done = 0;
+	}
+
+	return nb_pkts;
+}
+
+static uint16_t
+pipeline_lat_tx_cb(uint16_t port_id __rte_unused, uint16_t queue __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts, void *arg)
+{
+	const uint64_t now = rte_get_timer_cycles();
+	struct pipeline_lat_hist *lat = arg;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		/* Packets retried by the Tx adapter, or already recorded by
+		 * a worker transmitting through an internal port, are only
+		 * counted once.
+		 */
+		if (pipeline_lat_priv(pkts[i])->tx_done)
+			continue;
+		pipeline_lat_tx(lat, pkts[i], now);
+	}
+
+	return nb_pkts;
+}
+
 #define NB_RX_DESC			128
 #define NB_TX_DESC			512
 int
@@ -162,6 +367,7 @@ pipeline_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 	int ret;
 	uint8_t nb_queues = 1;
 	struct test_pipeline *t = evt_test_priv(test);
+	uint32_t nb_lat = t->nb_workers;
 	struct rte_eth_rxconf rx_conf;
 	struct rte_eth_conf port_conf = {
 		.rxmode = {
@@ -247,6 +453,21 @@ pipeline_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 				i, rte_strerror(-ret));
 			return ret;
 		}
+
+		if (opt->lat_hist) {
+			t->lat_port[i] =
+				&t->lat[nb_lat * PIPELINE_LAT_NB_HIST(opt)];
+			nb_lat++;
+			if (rte_eth_add_rx_callback(i, 0, pipeline_lat_rx_cb,
+						NULL) == NULL ||
+					rte_eth_add_tx_callback(i, 0,
+						pipeline_lat_tx_cb,
+						t->lat_port[i]) == NULL) {
+				evt_err("Failed to add latency callbacks to"
+						" eth port [%d]", i);
+				return -rte_errno;
+			}
+		}
 	}
 
 	return 0;
@@ -325,6 +546,13 @@ pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
 			return ret;
 		}
 
+		if (opt->lat_hist &&
+				(cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)) {
+			evt_err("lat_hist needs the SW Rx adapter to timestamp"
+					" packets of port[%d]", prod);
+			return -ENOTSUP;
+		}
+
 		if (!(cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)) {
 			uint32_t service_id;
 
@@ -401,9 +629,14 @@ void
 pipeline_ethdev_destroy(struct evt_test *test, struct evt_options *opt)
 {
 	uint16_t i;
-	RTE_SET_USED(test);
+	struct test_pipeline *t = evt_test_priv(test);
 	RTE_SET_USED(opt);
 
+	/* Latency runs stop the ports before reporting the results */
+	if (t->ethdev_stopped)
+		return;
+	t->ethdev_stopped = 1;
+
 	RTE_ETH_FOREACH_DEV(i) {
 		rte_event_eth_rx_adapter_stop(i);
 		rte_event_eth_tx_adapter_stop(i);
@@ -452,7 +685,7 @@ pipeline_mempool_setup(struct evt_test *test, struct evt_options *opt)
 	t->pool = rte_pktmbuf_pool_create(test->name, /* mempool name */
 			opt->pool_sz, /* number of elements*/
 			512, /* cache size*/
-			0,
+			opt->lat_hist ? PIPELINE_LAT_PRIV_SIZE : 0,
 			opt->mbuf_sz,
 			opt->socket_id); /* flags */
 
@@ -498,6 +731,25 @@ pipeline_test_setup(struct evt_test *test, struct evt_options *opt)
 	opt->prod_type = EVT_PROD_TYPE_ETH_RX_ADPTR;
 	memcpy(t->sched_type_list, opt->sched_type_list,
 			sizeof(opt->sched_type_list));
+
+	if (opt->lat_hist) {
+		/* One set of histograms per worker and per Tx port */
+		const int nb_hist = PIPELINE_LAT_NB_HIST(opt);
+		int i;
+
+		t->nb_lat = t->nb_workers + rte_eth_dev_count_avail();
+		t->lat = rte_zmalloc_socket(test->name, t->nb_lat * nb_hist *
+				sizeof(struct pipeline_lat_hist),
+				RTE_CACHE_LINE_SIZE, opt->socket_id);
+		if (t->lat == NULL) {
+			evt_err("failed to allocate latency histograms");
+			rte_free(test_pipeline);
+			test->test_priv = NULL;
+			goto nomem;
+		}
+		for (i = 0; i < t->nb_workers; i++)
+			t->worker[i].lat = &t->lat[i * nb_hist];
+	}
 	return 0;
 nomem:
 	return -ENOMEM;
@@ -507,6 +759,8 @@ void
 pipeline_test_destroy(struct evt_test *test, struct evt_options *opt)
 {
 	RTE_SET_USED(opt);
+	struct test_pipeline *t = evt_test_priv(test);
 
+	rte_free(t->lat);
 	rte_free(test->test_priv);
 }
@@ -29,11 +29,42 @@
 
 struct test_pipeline;
 
+/*
+ * Latency histogram in timer cycles. Values below 16 have their own bucket,
+ * larger values are split in 8 buckets per power of two, i.e. with 12.5%
+ * precision, up to 2^40 cycles.
+ */
+#define PIPELINE_LAT_SUB_BITS 3
+#define PIPELINE_LAT_MAX_MSB 39
+#define PIPELINE_LAT_NB_BUCKETS \
+	(((PIPELINE_LAT_MAX_MSB - PIPELINE_LAT_SUB_BITS + 2) << \
+	  PIPELINE_LAT_SUB_BITS))
+
+struct pipeline_lat_hist {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint64_t bucket[PIPELINE_LAT_NB_BUCKETS];
+};
+
+/*
+ * Histograms of a worker or of a Tx port: end to end latency, latency from
+ * the last worker stage to the transmission, then latency from the Rx or
+ * from the previous stage to the dequeue of each stage.
+ */
+#define PIPELINE_LAT_TOTAL 0
+#define PIPELINE_LAT_TX 1
+#define PIPELINE_LAT_STAGE(s) (2 + (s))
+/* Stages include the Tx queue of the pipeline_queue test with internal port */
+#define PIPELINE_LAT_NB_HIST(opt) PIPELINE_LAT_STAGE((opt)->nb_stages + 1)
+
 struct worker_data {
 	uint64_t processed_pkts;
 	uint8_t dev_id;
 	uint8_t port_id;
 	struct test_pipeline *t;
+	struct pipeline_lat_hist *lat;
 } __rte_cache_aligned;
 
 struct test_pipeline {
@@ -48,6 +79,10 @@ struct test_pipeline {
 	uint32_t nb_flows;
 	uint64_t outstand_pkts;
 	struct rte_mempool *pool;
+	uint32_t nb_lat;
+	struct pipeline_lat_hist *lat;
+	struct pipeline_lat_hist *lat_port[RTE_MAX_ETHPORTS];
+	uint8_t ethdev_stopped;
 	struct worker_data worker[EVT_MAX_PORTS];
 	struct evt_options *opt;
 	uint8_t sched_type_list[EVT_MAX_STAGES] __rte_cache_aligned;
@@ -144,6 +179,74 @@ pipeline_event_enqueue_burst(const uint8_t dev, const uint8_t port,
 	}
 }
 
+/*
+ * Latency state kept in the private area of the mbufs, next to the Rx time
+ * stored in mbuf->timestamp by the Rx callback.
+ */
+struct pipeline_lat_priv {
+	uint64_t stage_ts; /* Time of the last step of the packet */
+	uint8_t tx_done; /* Tx latency of the packet already recorded */
+};
+
+#define PIPELINE_LAT_PRIV_SIZE \
+	RTE_ALIGN(sizeof(struct pipeline_lat_priv), RTE_MBUF_PRIV_ALIGN)
+
+static __rte_always_inline struct pipeline_lat_priv *
+pipeline_lat_priv(struct rte_mbuf *m)
+{
+	return RTE_PTR_ADD(m, sizeof(struct rte_mbuf));
+}
+
+static __rte_always_inline void
+pipeline_lat_hist_add(struct pipeline_lat_hist *h, uint64_t cycles)
+{
+	unsigned int idx, msb;
+
+	if ((int64_t)cycles < 0)
+		cycles = 0;
+	if (cycles < (2 << PIPELINE_LAT_SUB_BITS)) {
+		idx = cycles;
+	} else {
+		msb = 63 - __builtin_clzll(cycles);
+		if (msb > PIPELINE_LAT_MAX_MSB)
+			idx = PIPELINE_LAT_NB_BUCKETS - 1;
+		else
+			idx = ((msb - PIPELINE_LAT_SUB_BITS) <<
+				PIPELINE_LAT_SUB_BITS) +
+				(cycles >> (msb - PIPELINE_LAT_SUB_BITS));
+	}
+
+	if (h->count == 0 || cycles < h->min)
+		h->min = cycles;
+	if (cycles > h->max)
+		h->max = cycles;
+	h->count++;
+	h->sum += cycles;
+	h->bucket[idx]++;
+}
+
+static __rte_always_inline void
+pipeline_lat_stage(struct pipeline_lat_hist *lat, uint8_t stage,
+		struct rte_mbuf *m, uint64_t now)
+{
+	struct pipeline_lat_priv *priv = pipeline_lat_priv(m);
+
+	pipeline_lat_hist_add(&lat[PIPELINE_LAT_STAGE(stage)],
+			now - priv->stage_ts);
+	priv->stage_ts = now;
+}
+
+static __rte_always_inline void
+pipeline_lat_tx(struct pipeline_lat_hist *lat, struct rte_mbuf *m,
+		uint64_t now)
+{
+	struct pipeline_lat_priv *priv = pipeline_lat_priv(m);
+
+	pipeline_lat_hist_add(&lat[PIPELINE_LAT_TX], now - priv->stage_ts);
+	pipeline_lat_hist_add(&lat[PIPELINE_LAT_TOTAL], now - m->timestamp);
+	priv->tx_done = 1;
+}
+
 static inline int
 pipeline_nb_event_ports(struct evt_options *opt)
 {
@@ -268,6 +268,58 @@ pipeline_queue_worker_multi_stage_burst_fwd(void *arg)
 	return 0;
 }
 
+static __rte_noinline int
+pipeline_queue_worker_lat(void *arg)
+{
+	PIPELINE_WORKER_MULTI_STAGE_BURST_INIT;
+	const uint8_t *tx_queue = t->tx_evqueue_id;
+	const uint16_t burst = evt_has_burst_mode(dev) ? BURST_SIZE : 1;
+	const bool internal_port = t->internal_port;
+	struct pipeline_lat_hist *lat = w->lat;
+	uint64_t now;
+
+	while (t->done == false) {
+		uint16_t nb_rx = rte_event_dequeue_burst(dev, port, ev,
+				burst, 0);
+
+		if (!nb_rx) {
+			rte_pause();
+			continue;
+		}
+
+		now = rte_get_timer_cycles();
+		for (i = 0; i < nb_rx; i++) {
+			rte_prefetch0(ev[i + 1].mbuf);
+			cq_id = ev[i].queue_id % nb_stages;
+			pipeline_lat_stage(lat, cq_id, ev[i].mbuf, now);
+
+			if (internal_port &&
+				ev[i].queue_id == tx_queue[ev[i].mbuf->port]) {
+				pipeline_lat_tx(lat, ev[i].mbuf,
+						rte_get_timer_cycles());
+				pipeline_event_tx(dev, port, &ev[i]);
+				ev[i].op = RTE_EVENT_OP_RELEASE;
+				w->processed_pkts++;
+			} else if (!internal_port && cq_id == last_queue) {
+				ev[i].queue_id = tx_queue[ev[i].mbuf->port];
+				rte_event_eth_tx_adapter_txq_set(ev[i].mbuf, 0);
+				pipeline_fwd_event(&ev[i],
+						RTE_SCHED_TYPE_ATOMIC);
+				w->processed_pkts++;
+			} else {
+				ev[i].queue_id++;
+				pipeline_fwd_event(&ev[i], cq_id != last_queue ?
+						sched_type_list[cq_id] :
+						RTE_SCHED_TYPE_ATOMIC);
+			}
+		}
+
+		pipeline_event_enqueue_burst(dev, port, ev, nb_rx);
+	}
+
+	return 0;
+}
+
 static int
 worker_wrapper(void *arg)
 {
@@ -278,6 +330,9 @@ worker_wrapper(void *arg)
 	const uint8_t nb_stages = opt->nb_stages;
 	RTE_SET_USED(opt);
 
+	if (opt->lat_hist)
+		return pipeline_queue_worker_lat(arg);
+
 	if (nb_stages == 1) {
 		if (!burst && internal_port)
 			return pipeline_queue_worker_single_stage_tx(arg);
@@ -110,6 +110,30 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "RIB autotest",
+        "Command": "rib_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "RIB6 autotest",
+        "Command": "rib6_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "FIB autotest",
+        "Command": "fib_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "FIB6 autotest",
+        "Command": "fib6_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Memcpy autotest",
         "Command": "memcpy_autotest",
@@ -374,6 +398,18 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Timer wheel autotest",
+        "Command": "timer_wheel_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Trace autotest",
+        "Command": "trace_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Member autotest",
         "Command": "member_autotest",
@@ -500,6 +536,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Telemetry shared memory autotest",
+        "Command": "telemetry_shm_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Bitratestats autotest",
         "Command": "bitratestats_autotest",
@@ -591,6 +633,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Eventdev selftest dsw",
+        "Command": "eventdev_selftest_dsw",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "KNI autotest",
         "Command": "kni_autotest",
@@ -615,6 +663,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Hash large table performance autotest",
+        "Command": "hash_large_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Hash read-write concurrency autotest",
         "Command": "hash_readwrite_autotest",
@@ -688,6 +742,18 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Fib perf autotest",
+        "Command": "fib_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Fib6 perf autotest",
+        "Command": "fib6_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
          "Name":    "Efd perf autotest",
          "Command": "efd_perf_autotest",
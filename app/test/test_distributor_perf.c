@@ -17,6 +17,8 @@
 #define ITER_POWER 21 /* log 2 of how many iterations we do when timing. */
 #define BURST 64
 #define BIG_BATCH 1024
+/* number of workers of the many workers test */
+#define MANY_WORKERS RTE_MIN(64u, RTE_MAX_LCORE - 1u)
 
 /* static vars - zero initialized by default */
 static volatile int quit;
@@ -88,7 +90,7 @@ static unsigned
 total_packet_count(void)
 {
 	unsigned i, count = 0;
-	for (i = 0; i < worker_idx; i++)
+	for (i = 0; i < RTE_DIM(worker_stats); i++)
 		count += worker_stats[i].handled_packets;
 	return count;
 }
@@ -129,13 +131,47 @@ handle_work(void *arg)
 	return 0;
 }
 
+/*
+ * Worker function for the many workers test. Each worker lcore serves
+ * several worker ids, polling them in turn, so that the distributor can
+ * fan out to more workers than there are lcores.
+ */
+static int
+handle_work_many(void *arg)
+{
+	struct rte_distributor *d = arg;
+	const unsigned int nb_lcores = rte_lcore_count() - 1;
+	const unsigned int first = __atomic_fetch_add(&worker_idx, 1,
+			__ATOMIC_RELAXED);
+	struct rte_mbuf *buf[8] __rte_cache_aligned;
+	unsigned int id;
+	int num;
+
+	/*
+	 * Requests are only made after a successful poll, so that they never
+	 * wait for the distributor to take the previous returns, which would
+	 * prevent the other worker ids of this lcore from being served.
+	 */
+	while (!quit) {
+		for (id = first; id < MANY_WORKERS; id += nb_lcores) {
+			num = rte_distributor_poll_pkt(d, id, buf);
+			if (num < 0)
+				continue;
+			worker_stats[id].handled_packets += num;
+			rte_distributor_request_pkt(d, id, buf, num);
+		}
+	}
+	return 0;
+}
+
 /*
  * This basic performance test just repeatedly sends in 32 packets at a time
  * to the distributor and verifies at the end that we got them all in the worker
  * threads and finally how long per packet the processing took.
  */
 static inline int
-perf_test(struct rte_distributor *d, struct rte_mempool *p)
+perf_test(struct rte_distributor *d, struct rte_mempool *p,
+		unsigned int num_workers)
 {
 	unsigned int i;
 	uint64_t start, end;
@@ -167,7 +203,7 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 			((end - start) >> ITER_POWER)/BURST);
 	rte_mempool_put_bulk(p, (void *)bufs, BURST);
 
-	for (i = 0; i < rte_lcore_count() - 1; i++)
+	for (i = 0; i < num_workers; i++)
 		printf("Worker %u handled %u packets\n", i,
 				worker_stats[i].handled_packets);
 	printf("Total packets: %u (%x)\n", total_packet_count(),
@@ -177,6 +213,18 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 	return 0;
 }
 
+/* Terminates the worker functions of the many workers test */
+static void
+quit_workers_many(struct rte_distributor *d)
+{
+	quit = 1;
+	rte_eal_mp_wait_lcore();
+	rte_distributor_process(d, NULL, 0);
+	rte_distributor_clear_returns(d);
+	quit = 0;
+	worker_idx = 0;
+}
+
 /* Useful function which ensures that all worker functions terminate */
 static void
 quit_workers(struct rte_distributor *d, struct rte_mempool *p)
@@ -205,6 +253,7 @@ test_distributor_perf(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
+	static struct rte_distributor *dm;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -239,6 +288,18 @@ test_distributor_perf(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (dm == NULL) {
+		dm = rte_distributor_create("Test_burst_many", rte_socket_id(),
+				MANY_WORKERS, RTE_DIST_ALG_BURST);
+		if (dm == NULL) {
+			printf("Error creating burst distributor with %u workers\n",
+					MANY_WORKERS);
+			return -1;
+		}
+	} else {
+		rte_distributor_clear_returns(dm);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -252,16 +313,23 @@ test_distributor_perf(void)
 
 	printf("=== Performance test of distributor (single mode) ===\n");
 	rte_eal_mp_remote_launch(handle_work, ds, SKIP_MASTER);
-	if (perf_test(ds, p) < 0)
+	if (perf_test(ds, p, rte_lcore_count() - 1) < 0)
 		return -1;
 	quit_workers(ds, p);
 
 	printf("=== Performance test of distributor (burst mode) ===\n");
 	rte_eal_mp_remote_launch(handle_work, db, SKIP_MASTER);
-	if (perf_test(db, p) < 0)
+	if (perf_test(db, p, rte_lcore_count() - 1) < 0)
 		return -1;
 	quit_workers(db, p);
 
+	printf("=== Performance test of distributor (burst mode, %u workers) ===\n",
+			MANY_WORKERS);
+	rte_eal_mp_remote_launch(handle_work_many, dm, SKIP_MASTER);
+	if (perf_test(dm, p, MANY_WORKERS) < 0)
+		return -1;
+	quit_workers_many(dm);
+
 	return 0;
 }
 
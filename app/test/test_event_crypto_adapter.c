@@ -35,6 +35,10 @@
 #define NB_TEST_QUEUES             2
 #define NUM_CORES                  1
 #define CRYPTODEV_NAME_NULL_PMD    crypto_null
+/* Fewer ops than the SW adapter enqueues to the cryptodev at once */
+#define NUM_STAGED_OPS             4
+/* Time the SW adapter stages ops before enqueuing them to the cryptodev */
+#define STAGED_OPS_TIMEOUT_US      100
 
 #define MBUF_SIZE              (sizeof(struct rte_mbuf) + \
 				RTE_PKTMBUF_HEADROOM + PACKET_LENGTH)
@@ -153,8 +157,19 @@ test_crypto_adapter_stats(void)
 		stats.event_enq_retry_count);
 	printf(" + Event enqueue fail count       %" PRIx64 "\n",
 		stats.event_enq_fail_count);
+	printf(" + Cryptodev enqueue burst count  %" PRIx64 "\n",
+		stats.crypto_enq_burst_count);
+	printf(" + Cryptodev enqueue timeouts     %" PRIx64 "\n",
+		stats.crypto_enq_timeout_count);
+	printf(" + Cryptodev dequeue burst count  %" PRIx64 "\n",
+		stats.crypto_deq_burst_count);
 	printf(" +------------------------------------------------------+\n");
 
+	TEST_ASSERT(stats.crypto_enq_burst_count <= stats.crypto_enq_count,
+		"More cryptodev enqueue bursts than crypto ops\n");
+	TEST_ASSERT(stats.crypto_deq_burst_count <= stats.crypto_deq_count,
+		"More cryptodev dequeue bursts than crypto ops\n");
+
 	rte_event_crypto_adapter_stats_reset(TEST_ADAPTER_ID);
 	return TEST_SUCCESS;
 }
@@ -256,6 +271,142 @@ test_op_forward_mode(uint8_t session_less)
 	return TEST_SUCCESS;
 }
 
+static struct rte_crypto_op *
+alloc_sessionless_null_op(void)
+{
+	union rte_event_crypto_metadata m_data;
+	struct rte_crypto_sym_xform *xform;
+	struct rte_crypto_op *op;
+	struct rte_mbuf *m;
+	uint32_t len;
+
+	m = alloc_fill_mbuf(params.mbuf_pool, text_64B, PACKET_LENGTH, 0);
+	if (m == NULL)
+		return NULL;
+
+	op = rte_crypto_op_alloc(params.op_mpool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+	if (op == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	xform = rte_crypto_op_sym_xforms_alloc(op, NUM);
+	xform->type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	xform->next = NULL;
+	xform->cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	xform->cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	op->sess_type = RTE_CRYPTO_OP_SESSIONLESS;
+
+	len = IV_OFFSET + MAXIMUM_IV_LENGTH +
+		(sizeof(struct rte_crypto_sym_xform) * 2);
+	op->private_data_offset = len;
+	memset(&m_data, 0, sizeof(m_data));
+	rte_memcpy(&m_data.response_info, &response_info,
+		   sizeof(response_info));
+	rte_memcpy(&m_data.request_info, &request_info,
+		   sizeof(request_info));
+	rte_memcpy((uint8_t *)op + len, &m_data, sizeof(m_data));
+
+	op->sym->m_src = m;
+	op->sym->cipher.data.offset = 0;
+	op->sym->cipher.data.length = PACKET_LENGTH;
+
+	return op;
+}
+
+/* Fewer ops than a cryptodev enqueue burst stay staged in the SW adapter
+ * until the flush timeout, the adapter service is run from here to
+ * control when the ops are enqueued
+ */
+static int
+test_staged_ops_flush_timeout(void)
+{
+	struct rte_event_crypto_adapter_stats stats;
+	struct rte_event ev[NUM_STAGED_OPS];
+	uint64_t timeout_ticks, start = 0;
+	uint32_t adapter_service_id;
+	struct rte_crypto_op *op;
+	unsigned int i, n;
+	int retry, ret;
+
+	if (rte_event_crypto_adapter_service_id_get(TEST_ADAPTER_ID,
+					&adapter_service_id) != 0) {
+		printf("Crypto adapter service not used, skipped\n");
+		return TEST_SKIPPED;
+	}
+	rte_service_set_runstate_mapped_check(adapter_service_id, 0);
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_start(TEST_ADAPTER_ID),
+				"Failed to start event crypto adapter");
+	rte_event_crypto_adapter_stats_reset(TEST_ADAPTER_ID);
+	timeout_ticks = STAGED_OPS_TIMEOUT_US * rte_get_timer_hz() / 1E6;
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < NUM_STAGED_OPS; i++) {
+		op = alloc_sessionless_null_op();
+		TEST_ASSERT_NOT_NULL(op, "Failed to allocate crypto op\n");
+		ev[i].queue_id = TEST_CRYPTO_EV_QUEUE_ID;
+		ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		ev[i].flow_id = TEST_APP_EV_FLOWID;
+		ev[i].event_ptr = op;
+	}
+	ret = rte_event_enqueue_burst(evdev, TEST_APP_PORT_ID, ev,
+				      NUM_STAGED_OPS);
+	TEST_ASSERT_EQUAL(ret, NUM_STAGED_OPS,
+			  "Failed to send events to crypto adapter\n");
+
+	/* the ops are staged as the adapter dequeues them */
+	for (retry = 0; retry < 100000; retry++) {
+		uint64_t now = rte_get_timer_cycles();
+
+		rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+		rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+		if (start == 0 && stats.event_deq_count != 0)
+			start = now;
+		if (stats.event_deq_count == NUM_STAGED_OPS)
+			break;
+		rte_pause();
+	}
+	TEST_ASSERT_EQUAL(stats.event_deq_count, NUM_STAGED_OPS,
+			  "Crypto adapter dequeued %" PRIu64 " events\n",
+			  stats.event_deq_count);
+	TEST_ASSERT(stats.crypto_enq_count == 0 ||
+		    rte_get_timer_cycles() - start >= timeout_ticks,
+		    "Crypto ops enqueued before the flush timeout\n");
+
+	/* all of them are enqueued at once after the timeout */
+	rte_delay_us(2 * STAGED_OPS_TIMEOUT_US);
+	rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.crypto_enq_count, NUM_STAGED_OPS,
+			  "Crypto adapter enqueued %" PRIu64 " crypto ops\n",
+			  stats.crypto_enq_count);
+	TEST_ASSERT_EQUAL(stats.crypto_enq_burst_count, 1,
+			  "Staged crypto ops not enqueued in one burst\n");
+	TEST_ASSERT_EQUAL(stats.crypto_enq_timeout_count, 1,
+			  "Flush timeout not accounted\n");
+	TEST_ASSERT_EQUAL(stats.crypto_enq_fail, 0,
+			  "Staged crypto ops dropped\n");
+
+	/* and their completions forwarded to the application */
+	n = 0;
+	for (retry = 0; retry < 100000 && n < NUM_STAGED_OPS; retry++) {
+		rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+		ret = rte_event_dequeue_burst(evdev, TEST_APP_PORT_ID, ev,
+					      NUM_STAGED_OPS - n, 0);
+		for (i = 0; i < (unsigned int)ret; i++) {
+			op = ev[i].event_ptr;
+			rte_pktmbuf_free(op->sym->m_src);
+			rte_crypto_op_free(op);
+		}
+		n += ret;
+	}
+	TEST_ASSERT_EQUAL(n, NUM_STAGED_OPS,
+			  "Received %u crypto completions\n", n);
+
+	return TEST_SUCCESS;
+}
+
 static int
 map_adapter_service_core(void)
 {
@@ -920,6 +1071,10 @@ static struct unit_test_suite functional_testsuite = {
 				test_crypto_adapter_free,
 				test_crypto_adapter_stats),
 
+		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
+				test_crypto_adapter_stop,
+				test_staged_ops_flush_timeout),
+
 		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
 				test_crypto_adapter_stop,
 				test_session_with_op_forward_mode),
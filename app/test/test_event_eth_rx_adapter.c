@@ -6,8 +6,11 @@
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
+#include <rte_eth_ring.h>
 #include <rte_eventdev.h>
 #include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_service.h>
 
 #include <rte_event_eth_rx_adapter.h>
 
@@ -676,6 +679,432 @@ adapter_stats(void)
 	return TEST_SUCCESS;
 }
 
+static int
+adapter_queue_stats(void)
+{
+	int err;
+	int expected;
+	struct rte_event ev;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event_eth_rx_adapter_queue_stats stats;
+
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.priority = 0;
+
+	queue_config.rx_queue_flags = 0;
+	if (default_params.caps &
+		RTE_EVENT_ETH_RX_ADAPTER_CAP_OVERRIDE_FLOW_ID) {
+		ev.flow_id = 1;
+		queue_config.rx_queue_flags =
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID;
+	}
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+
+	/* queue not added yet */
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0, &stats);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+					-1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	expected = default_params.caps &
+		RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT ? -ENOTSUP : 0;
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0, &stats);
+	TEST_ASSERT(err == expected, "Expected %d got %d", expected, err);
+	if (err == 0)
+		TEST_ASSERT(stats.rx_packets == 0 && stats.rx_poll_count == 0,
+			"Expected zeroed stats of a new queue");
+
+	err = rte_event_eth_rx_adapter_queue_stats_reset(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0);
+	TEST_ASSERT(err == expected, "Expected %d got %d", expected, err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID,
+						default_params.rx_rings,
+						&stats);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(1, TEST_ETHDEV_ID, 0,
+						&stats);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_reset(1, TEST_ETHDEV_ID, 0);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+#define VECTOR_SIZE		24
+#define VECTOR_TIMEOUT_NS	1000000
+
+/* run the services of the adapter and event device, and return the number
+ * of mbufs of the event vectors dequeued
+ */
+static int
+adapter_vector_poll(uint32_t rxa_service_id, uint32_t sched_service_id,
+		int *nb_vectors, uint16_t *first_size)
+{
+	struct rte_event ev[32];
+	int nb_mbufs = 0;
+	uint16_t i, n;
+	int retry;
+
+	*nb_vectors = 0;
+	rte_service_run_iter_on_app_lcore(rxa_service_id, 1);
+	for (retry = 0; retry < 100; retry++) {
+		rte_service_run_iter_on_app_lcore(sched_service_id, 1);
+		n = rte_event_dequeue_burst(TEST_DEV_ID, 0, ev, RTE_DIM(ev), 0);
+		for (i = 0; i < n; i++) {
+			struct rte_event_vector *vec = ev[i].vec;
+
+			TEST_ASSERT(ev[i].event_type ==
+				RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR,
+				"Expected a vector event, got type %u",
+				ev[i].event_type);
+			TEST_ASSERT(vec->attr_valid && vec->queue == 0 &&
+				vec->port == TEST_ETHDEV_ID,
+				"Wrong vector attributes");
+			if (*nb_vectors == 0)
+				*first_size = vec->nb_elem;
+			(*nb_vectors)++;
+			nb_mbufs += vec->nb_elem;
+			rte_pktmbuf_free_bulk(vec->mbufs, vec->nb_elem);
+			rte_mempool_put(rte_mempool_from_obj(vec), vec);
+		}
+	}
+
+	return nb_mbufs;
+}
+
+static int
+adapter_event_vector(void)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event_eth_rx_adapter_vector_config vector_config;
+	uint32_t rxa_service_id, sched_service_id;
+	struct rte_event_dev_info dev_info;
+	struct rte_mempool *vector_mp;
+	int32_t rx_queue_id;
+	struct rte_event_eth_rx_adapter_stats stats;
+	int nb_mbufs, nb_vectors;
+	uint64_t nb_vectored;
+	uint16_t first_size = 0;
+	int err;
+
+	vector_mp = rte_event_vector_pool_create("test_vector_pool", 64, 0,
+						VECTOR_SIZE, rte_socket_id());
+	TEST_ASSERT(vector_mp != NULL, "Failed to create vector pool");
+	TEST_ASSERT(rte_event_vector_pool_nb_elem(vector_mp) == VECTOR_SIZE,
+		"Wrong number of vector elements");
+	TEST_ASSERT(rte_event_vector_pool_create("test_vector_pool_0", 64, 0,
+				0, rte_socket_id()) == NULL &&
+			rte_errno == EINVAL,
+		"Created vector pool of empty vectors");
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev.queue_id = 0;
+	queue_config.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_config.ev.priority = 0;
+	queue_config.servicing_weight = 1;
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	rx_queue_id = default_params.caps &
+		RTE_EVENT_ETH_RX_ADAPTER_CAP_MULTI_EVENTQ ? 0 : -1;
+
+	if (!(default_params.caps &
+			RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR)) {
+		err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID,
+				TEST_ETHDEV_ID, rx_queue_id, &queue_config);
+		TEST_ASSERT(err == -ENOTSUP, "Expected -ENOTSUP got %d", err);
+		rte_mempool_free(vector_mp);
+		return TEST_SUCCESS;
+	}
+
+	memset(&vector_config, 0, sizeof(vector_config));
+	vector_config.vector_mp = vector_mp;
+	vector_config.vector_sz = VECTOR_SIZE;
+	vector_config.vector_timeout_ns = VECTOR_TIMEOUT_NS;
+
+	/* queue not added with the vector flag */
+	queue_config.rx_queue_flags = 0;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+					rx_queue_id, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	err = rte_event_eth_rx_adapter_queue_vector_config(TEST_INST_ID,
+			TEST_ETHDEV_ID, rx_queue_id, &vector_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+					rx_queue_id, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* no vector pool, vectors too large, no timeout */
+	vector_config.vector_mp = NULL;
+	err = rte_event_eth_rx_adapter_queue_vector_config(TEST_INST_ID,
+			TEST_ETHDEV_ID, rx_queue_id, &vector_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+	vector_config.vector_mp = vector_mp;
+	vector_config.vector_sz = VECTOR_SIZE + 1;
+	err = rte_event_eth_rx_adapter_queue_vector_config(TEST_INST_ID,
+			TEST_ETHDEV_ID, rx_queue_id, &vector_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+	vector_config.vector_sz = VECTOR_SIZE;
+	vector_config.vector_timeout_ns = 0;
+	err = rte_event_eth_rx_adapter_queue_vector_config(TEST_INST_ID,
+			TEST_ETHDEV_ID, rx_queue_id, &vector_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	vector_config.vector_timeout_ns = VECTOR_TIMEOUT_NS;
+	err = rte_event_eth_rx_adapter_queue_vector_config(TEST_INST_ID,
+			TEST_ETHDEV_ID, rx_queue_id, &vector_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* the data path is checked with the software event device, which
+	 * schedules from a service run here
+	 */
+	err = rte_event_dev_info_get(TEST_DEV_ID, &dev_info);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	if (strcmp(dev_info.driver_name, "event_sw") != 0 ||
+			rx_queue_id != 0)
+		goto queue_del;
+
+	TEST_ASSERT(rte_event_queue_setup(TEST_DEV_ID, 0, NULL) == 0,
+		"Event queue setup failed");
+	TEST_ASSERT(rte_event_port_setup(TEST_DEV_ID, 0, NULL) == 0,
+		"Event port setup failed");
+	TEST_ASSERT(rte_event_port_link(TEST_DEV_ID, 0, NULL, NULL, 0) == 1,
+		"Event port link failed");
+
+	TEST_ASSERT(rte_event_eth_rx_adapter_service_id_get(TEST_INST_ID,
+			&rxa_service_id) == 0, "Failed to get service id");
+	TEST_ASSERT(rte_event_dev_service_id_get(TEST_DEV_ID,
+			&sched_service_id) == 0, "Failed to get service id");
+	rte_service_runstate_set(sched_service_id, 1);
+	rte_service_set_runstate_mapped_check(sched_service_id, 0);
+	rte_service_set_runstate_mapped_check(rxa_service_id, 0);
+	TEST_ASSERT(rte_event_dev_start(TEST_DEV_ID) == 0,
+		"Event device start failed");
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* full vectors only, the remainder of the poll waits in a vector */
+	nb_mbufs = adapter_vector_poll(rxa_service_id, sched_service_id,
+				&nb_vectors, &first_size);
+	TEST_ASSERT(nb_mbufs > 0 && nb_mbufs == nb_vectors * VECTOR_SIZE,
+		"Expected full vectors, got %d mbufs in %d vectors",
+		nb_mbufs, nb_vectors);
+	nb_vectored = nb_mbufs;
+
+	/* the partial vector is enqueued first once expired */
+	rte_delay_us(2 * VECTOR_TIMEOUT_NS / 1000);
+	nb_mbufs = adapter_vector_poll(rxa_service_id, sched_service_id,
+				&nb_vectors, &first_size);
+	TEST_ASSERT(nb_vectors > 1 && first_size > 0 &&
+		first_size < VECTOR_SIZE,
+		"Expected an expired partial vector first, got %u mbufs",
+		first_size);
+	TEST_ASSERT(nb_mbufs == (nb_vectors - 1) * VECTOR_SIZE + first_size,
+		"Expected full vectors after the expired one");
+	nb_vectored += nb_mbufs;
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	err = rte_event_eth_rx_adapter_stats_get(TEST_INST_ID, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* the vector being filled, holding the mbufs received but not
+	 * dequeued yet, is enqueued when the queue is deleted
+	 */
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						rx_queue_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	nb_mbufs = adapter_vector_poll(rxa_service_id, sched_service_id,
+				&nb_vectors, &first_size);
+	TEST_ASSERT(stats.rx_packets - nb_vectored < VECTOR_SIZE &&
+		nb_mbufs == (int)(stats.rx_packets - nb_vectored) &&
+		nb_vectors == (nb_mbufs != 0),
+		"Expected the partial vector of %" PRIu64 " mbufs, got %d "
+		"mbufs in %d vectors", stats.rx_packets - nb_vectored,
+		nb_mbufs, nb_vectors);
+	rte_event_dev_stop(TEST_DEV_ID);
+	TEST_ASSERT(rte_mempool_full(vector_mp), "Event vectors leaked");
+	rte_mempool_free(vector_mp);
+
+	return TEST_SUCCESS;
+
+queue_del:
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						rx_queue_id);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(rte_mempool_full(vector_mp), "Event vectors leaked");
+	rte_mempool_free(vector_mp);
+
+	return TEST_SUCCESS;
+}
+
+#define BACKOFF_RING_NAME	"rxa_backoff"
+#define BACKOFF_NB_PKTS		8
+#define BACKOFF_NB_CALLS	200
+
+/* run the scheduler and free the mbufs of the events dequeued */
+static void
+adapter_backoff_drain(uint32_t sched_service_id)
+{
+	struct rte_event ev[32];
+	uint16_t i, n;
+	int retry;
+
+	for (retry = 0; retry < 100; retry++) {
+		rte_service_run_iter_on_app_lcore(sched_service_id, 1);
+		n = rte_event_dequeue_burst(TEST_DEV_ID, 0, ev, RTE_DIM(ev), 0);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(ev[i].mbuf);
+	}
+}
+
+static int
+adapter_backoff_send(struct rte_ring *r)
+{
+	struct rte_mbuf *m[BACKOFF_NB_PKTS];
+
+	if (rte_pktmbuf_alloc_bulk(default_params.mp, m, RTE_DIM(m)) != 0)
+		return -ENOMEM;
+	if (rte_ring_enqueue_bulk(r, (void **)m, RTE_DIM(m), NULL) == 0) {
+		rte_pktmbuf_free_bulk(m, RTE_DIM(m));
+		return -ENOSPC;
+	}
+
+	return 0;
+}
+
+/* an idle queue backs off from polling, and is polled again on each call
+ * once it receives packets
+ */
+static int
+adapter_poll_backoff(void)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event_eth_rx_adapter_queue_stats stats;
+	uint32_t rxa_service_id, sched_service_id;
+	struct rte_event_dev_info dev_info;
+	struct rte_ring *r;
+	int port, i, err;
+
+	err = rte_event_dev_info_get(TEST_DEV_ID, &dev_info);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	if (strcmp(dev_info.driver_name, "event_sw") != 0) {
+		printf("Poll backoff needs the event_sw device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	r = rte_ring_create(BACKOFF_RING_NAME, 256, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT(r != NULL, "Failed to create ring");
+	port = rte_eth_from_rings(BACKOFF_RING_NAME, &r, 1, &r, 1,
+			rte_socket_id());
+	TEST_ASSERT(port >= 0, "Port creation failed");
+	TEST_ASSERT(rte_eth_dev_start(port) == 0, "Port start failed");
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev.queue_id = 0;
+	queue_config.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_config.servicing_weight = 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, port, -1,
+					&queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	TEST_ASSERT(rte_event_queue_setup(TEST_DEV_ID, 0, NULL) == 0,
+		"Event queue setup failed");
+	TEST_ASSERT(rte_event_port_setup(TEST_DEV_ID, 0, NULL) == 0,
+		"Event port setup failed");
+	TEST_ASSERT(rte_event_port_link(TEST_DEV_ID, 0, NULL, NULL, 0) == 1,
+		"Event port link failed");
+
+	TEST_ASSERT(rte_event_eth_rx_adapter_service_id_get(TEST_INST_ID,
+			&rxa_service_id) == 0, "Failed to get service id");
+	TEST_ASSERT(rte_event_dev_service_id_get(TEST_DEV_ID,
+			&sched_service_id) == 0, "Failed to get service id");
+	rte_service_runstate_set(sched_service_id, 1);
+	rte_service_set_runstate_mapped_check(sched_service_id, 0);
+	rte_service_set_runstate_mapped_check(rxa_service_id, 0);
+	TEST_ASSERT(rte_event_dev_start(TEST_DEV_ID) == 0,
+		"Event device start failed");
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* the idle queue skips most of its polls */
+	for (i = 0; i < BACKOFF_NB_CALLS; i++)
+		rte_service_run_iter_on_app_lcore(rxa_service_id, 1);
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID, port, 0,
+						&stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(stats.rx_poll_count + stats.rx_skip_count ==
+		BACKOFF_NB_CALLS, "Expected a poll or a skip per call, got "
+		"%" PRIu64 " polls %" PRIu64 " skips",
+		stats.rx_poll_count, stats.rx_skip_count);
+	TEST_ASSERT(stats.rx_empty_poll_count == stats.rx_poll_count,
+		"Expected empty polls only");
+	TEST_ASSERT(stats.rx_skip_count > 8 * stats.rx_poll_count,
+		"Expected an exponential backoff, got %" PRIu64 " polls %"
+		PRIu64 " skips", stats.rx_poll_count, stats.rx_skip_count);
+
+	/* packets are received at the end of the backoff */
+	TEST_ASSERT(adapter_backoff_send(r) == 0, "Failed to send packets");
+	for (i = 0; i < BACKOFF_NB_CALLS; i++) {
+		rte_service_run_iter_on_app_lcore(rxa_service_id, 1);
+		rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID, port, 0,
+							&stats);
+		if (stats.rx_packets == BACKOFF_NB_PKTS)
+			break;
+	}
+	TEST_ASSERT(stats.rx_packets == BACKOFF_NB_PKTS,
+		"Expected %u packets got %" PRIu64, BACKOFF_NB_PKTS,
+		stats.rx_packets);
+
+	/* the backoff is reset, the next packets are polled at once */
+	err = rte_event_eth_rx_adapter_queue_stats_reset(TEST_INST_ID, port,
+						0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(adapter_backoff_send(r) == 0, "Failed to send packets");
+	rte_service_run_iter_on_app_lcore(rxa_service_id, 1);
+	rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID, port, 0,
+						&stats);
+	TEST_ASSERT(stats.rx_skip_count == 0 && stats.rx_poll_count == 1 &&
+		stats.rx_packets == BACKOFF_NB_PKTS,
+		"Expected the queue polled at once, got %" PRIu64 " polls %"
+		PRIu64 " skips", stats.rx_poll_count, stats.rx_skip_count);
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	adapter_backoff_drain(sched_service_id);
+	rte_event_dev_stop(TEST_DEV_ID);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, port, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	rte_eth_dev_stop(port);
+	rte_vdev_uninit("net_ring_" BACKOFF_RING_NAME);
+	rte_ring_free(r);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite event_eth_rx_tests = {
 	.suite_name = "rx event eth adapter test suite",
 	.setup = testsuite_setup,
@@ -684,10 +1113,16 @@ static struct unit_test_suite event_eth_rx_tests = {
 		TEST_CASE_ST(NULL, NULL, adapter_create_free),
 		TEST_CASE_ST(adapter_create, adapter_free,
 					adapter_queue_add_del),
+		TEST_CASE_ST(adapter_create, adapter_free,
+					adapter_poll_backoff),
 		TEST_CASE_ST(adapter_create, adapter_free,
 					adapter_multi_eth_add_del),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_start_stop),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_stats),
+		TEST_CASE_ST(adapter_create, adapter_free,
+			adapter_queue_stats),
+		TEST_CASE_ST(adapter_create, adapter_free,
+			adapter_event_vector),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
@@ -1008,6 +1008,12 @@ test_eventdev_selftest_sw(void)
 	return test_eventdev_selftest_impl("event_sw", "");
 }
 
+static int
+test_eventdev_selftest_dsw(void)
+{
+	return test_eventdev_selftest_impl("event_dsw", "");
+}
+
 static int
 test_eventdev_selftest_octeontx(void)
 {
@@ -1028,6 +1034,7 @@ test_eventdev_selftest_dpaa2(void)
 
 REGISTER_TEST_COMMAND(eventdev_common_autotest, test_eventdev_common);
 REGISTER_TEST_COMMAND(eventdev_selftest_sw, test_eventdev_selftest_sw);
+REGISTER_TEST_COMMAND(eventdev_selftest_dsw, test_eventdev_selftest_dsw);
 REGISTER_TEST_COMMAND(eventdev_selftest_octeontx,
 		test_eventdev_selftest_octeontx);
 REGISTER_TEST_COMMAND(eventdev_selftest_octeontx2,
@@ -0,0 +1,635 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <rte_ip.h>
+#include <rte_random.h>
+#include <rte_malloc.h>
+#include <rte_lcore.h>
+#include <rte_rcu_qsbr.h>
+#include <rte_rib.h>
+#include <rte_fib.h>
+
+#include "test.h"
+
+typedef int32_t (*rte_fib_test)(void);
+
+static int32_t test_create_invalid(void);
+static int32_t test_multiple_create(void);
+static int32_t test_free_null(void);
+static int32_t test_add_del_invalid(void);
+static int32_t test_get_invalid(void);
+static int32_t test_lookup(void);
+static int32_t test_random_routes(void);
+static int32_t test_rcu_qsbr(void);
+
+#define MAX_ROUTES	(1 << 16)
+#define MAX_TBL8	(1 << 15)
+#define NUM_RND_ROUTES	1000
+#define NUM_RND_LOOKUPS	(NUM_RND_ROUTES * 8)
+
+static const enum rte_fib_lookup_type lookup_types[] = {
+	RTE_FIB_LOOKUP_DIR24_8_SCALAR_MACRO,
+	RTE_FIB_LOOKUP_DIR24_8_SCALAR_UNI,
+	RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512,
+};
+
+/*
+ * Check that rte_fib_create fails gracefully for incorrect user input
+ * arguments
+ */
+int32_t
+test_create_invalid(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DUMMY;
+
+	/* rte_fib_create: fib name == NULL */
+	fib = rte_fib_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_create: config == NULL */
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* socket_id < -1 is invalid */
+	fib = rte_fib_create(__func__, -2, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_create: max_routes = -1 */
+	config.max_routes = -1;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.max_routes = MAX_ROUTES;
+
+	config.type = RTE_FIB_TYPE_MAX;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_8B + 1;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_8B;
+
+	config.dir24_8.num_tbl8 = 0;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* num_tbl8 does not fit into a 1 byte next hop */
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_1B;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* default_nh does not fit into a 1 byte next hop */
+	config.dir24_8.num_tbl8 = 16;
+	config.default_nh = UINT8_MAX;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Create fib table then delete fib table 10 times
+ * Use a slightly different rules size each time
+ */
+int32_t
+test_multiple_create(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	int32_t i;
+
+	config.default_nh = 0;
+	config.type = RTE_FIB_DUMMY;
+
+	for (i = 0; i < 100; i++) {
+		config.max_routes = MAX_ROUTES - i;
+		fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+		RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+		rte_fib_free(fib);
+	}
+	/* Can not test free so return success */
+	return TEST_SUCCESS;
+}
+
+/*
+ * Call rte_fib_free for NULL pointer user input. Note: free has no return and
+ * therefore it is impossible to check for failure but this test is added to
+ * increase function coverage metrics and to validate that freeing null does
+ * not crash.
+ */
+int32_t
+test_free_null(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DUMMY;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	rte_fib_free(fib);
+	rte_fib_free(NULL);
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib_add and rte_fib_delete fails gracefully
+ * for incorrect user input arguments
+ */
+int32_t
+test_add_del_invalid(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint64_t nh = 100;
+	uint32_t ip = RTE_IPV4(0, 0, 0, 0);
+	int ret;
+	uint8_t depth = 24;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DUMMY;
+
+	/* rte_fib_add: fib == NULL */
+	ret = rte_fib_add(NULL, ip, depth, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_delete: fib == NULL */
+	ret = rte_fib_delete(NULL, ip, depth);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/*Create valid fib to use in rest of test. */
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* rte_fib_add: depth > RTE_FIB_MAXDEPTH */
+	ret = rte_fib_add(fib, ip, RTE_FIB_MAXDEPTH + 1, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_delete: depth > RTE_FIB_MAXDEPTH */
+	ret = rte_fib_delete(fib, ip, RTE_FIB_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib_delete: route does not exist */
+	ret = rte_fib_delete(fib, ip, depth);
+	RTE_TEST_ASSERT(ret == -ENOENT,
+		"Call succeeded with invalid parameters\n");
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib_get_dp and rte_fib_get_rib fails gracefully
+ * for incorrect user input arguments
+ */
+int32_t
+test_get_invalid(void)
+{
+	void *p;
+	int ret;
+
+	p = rte_fib_get_dp(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	p = rte_fib_get_rib(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	ret = rte_fib_set_lookup_fn(NULL, RTE_FIB_LOOKUP_DEFAULT);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	ret = rte_fib_rcu_qsbr_add(NULL, NULL);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Routes ip_base/d with next hop d are installed for the nb_routes
+ * longest depths. Probe ip_base itself and, for every depth, an address
+ * that diverges from it right after that depth, so that each probe
+ * matches a different set of routes.
+ */
+static int
+check_nested(struct rte_fib *fib, uint64_t def_nh, uint8_t nb_routes)
+{
+	uint32_t ip_base = RTE_IPV4(192, 0, 2, 0);
+	uint32_t ips[RTE_FIB_MAXDEPTH * 2 + 1];
+	uint64_t nhs[RTE_FIB_MAXDEPTH * 2 + 1];
+	uint64_t exp;
+	unsigned int i, j;
+
+	for (i = 0; i < RTE_FIB_MAXDEPTH; i++) {
+		ips[i * 2] = ip_base ^ (1U << (31 - i));
+		/* same prefix match, different tbl8 entry */
+		ips[i * 2 + 1] = ips[i * 2] ^ ((i < 24) ? 0xff : 0);
+	}
+	ips[RTE_FIB_MAXDEPTH * 2] = ip_base;
+	rte_fib_lookup_bulk(fib, ips, nhs, RTE_DIM(ips));
+
+	for (i = 0; i < RTE_DIM(ips); i++) {
+		exp = def_nh;
+		for (j = RTE_FIB_MAXDEPTH + 1 - nb_routes;
+				j <= RTE_FIB_MAXDEPTH; j++) {
+			if (((ips[i] ^ ip_base) &
+					rte_rib_depth_to_mask(j)) == 0)
+				exp = j;
+		}
+		if (nhs[i] != exp) {
+			printf("%08x: %"PRIu64" expected %"PRIu64"\n",
+				ips[i], nhs[i], exp);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_lookup_nh_sz(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint32_t ip_base = RTE_IPV4(192, 0, 2, 0);
+	uint64_t def_nh = 100;
+	unsigned int i, k;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = nh_sz;
+	config.dir24_8.num_tbl8 = 64;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (k = 0; k < RTE_DIM(lookup_types); k++) {
+		ret = rte_fib_set_lookup_fn(fib, lookup_types[k]);
+		if (ret != 0) {
+			/* only the vector lookup may be unavailable */
+			RTE_TEST_ASSERT(lookup_types[k] ==
+				RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512,
+				"Failed to set lookup function %u\n", k);
+			continue;
+		}
+
+		RTE_TEST_ASSERT(check_nested(fib, def_nh, 0) == 0,
+			"Lookup in empty FIB failed\n");
+
+		/* add from /32 to /0, every step covers the previous one */
+		for (i = RTE_FIB_MAXDEPTH; i > 0; i--) {
+			ret = rte_fib_add(fib, ip_base, i, i);
+			RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+			RTE_TEST_ASSERT(check_nested(fib, def_nh,
+				RTE_FIB_MAXDEPTH + 1 - i) == 0,
+				"Lookup failed after adding /%u\n", i);
+		}
+		ret = rte_fib_add(fib, 0, 0, 0);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add default route\n");
+		RTE_TEST_ASSERT(check_nested(fib, 0, RTE_FIB_MAXDEPTH) == 0,
+			"Lookup failed after adding default route\n");
+
+		/* deleting an absent route must not change anything */
+		ret = rte_fib_delete(fib, ip_base ^ 1, RTE_FIB_MAXDEPTH);
+		RTE_TEST_ASSERT(ret == -ENOENT,
+			"Deleted a route that does not exist\n");
+
+		ret = rte_fib_delete(fib, 0, 0);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete default route\n");
+
+		for (i = 1; i <= RTE_FIB_MAXDEPTH; i++) {
+			ret = rte_fib_delete(fib, ip_base, i);
+			RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+			RTE_TEST_ASSERT(check_nested(fib, def_nh,
+				RTE_FIB_MAXDEPTH - i) == 0,
+				"Lookup failed after deleting /%u\n", i);
+		}
+	}
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check lookup results for every next hop size and every lookup function
+ */
+int32_t
+test_lookup(void)
+{
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+	int ret;
+
+	for (nh_sz = RTE_FIB_DIR24_8_1B; nh_sz <= RTE_FIB_DIR24_8_8B;
+			nh_sz++) {
+		ret = test_lookup_nh_sz(nh_sz);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static uint32_t
+random_prefix(uint8_t depth)
+{
+	return (uint32_t)rte_rand() & rte_rib_depth_to_mask(depth);
+}
+
+/*
+ * Look up addresses around the edges of every prefix as well as random
+ * ones and compare the results with the reference RIB based FIB.
+ */
+static int
+compare_fibs(struct rte_fib *ref, struct rte_fib *fib, const uint32_t *pfx,
+	const uint8_t *depth, unsigned int nb_routes)
+{
+	static uint32_t ips[NUM_RND_LOOKUPS];
+	static uint64_t nh_ref[NUM_RND_LOOKUPS];
+	static uint64_t nh[NUM_RND_LOOKUPS];
+	uint32_t last;
+	unsigned int i, k, n = 0;
+
+	for (i = 0; i < nb_routes; i++) {
+		last = pfx[i] | ~rte_rib_depth_to_mask(depth[i]);
+		ips[n++] = pfx[i];
+		ips[n++] = last;
+		ips[n++] = pfx[i] - 1;
+		ips[n++] = last + 1;
+	}
+	while (n < RTE_DIM(ips))
+		ips[n++] = (uint32_t)rte_rand();
+
+	rte_fib_lookup_bulk(ref, ips, nh_ref, n);
+
+	for (k = 0; k < RTE_DIM(lookup_types); k++) {
+		if (rte_fib_set_lookup_fn(fib, lookup_types[k]) != 0)
+			continue;
+		/* use an odd number of lookups to exercise the tail path */
+		rte_fib_lookup_bulk(fib, ips, nh, n - 1);
+		for (i = 0; i < n - 1; i++) {
+			if (nh[i] != nh_ref[i]) {
+				printf("Lookup type %u: %08x: %"PRIu64
+					" expected %"PRIu64"\n",
+					k, ips[i], nh[i], nh_ref[i]);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+static int
+test_random_routes_nh_sz(enum rte_fib_dir24_8_nh_sz nh_sz,
+	unsigned int nb_routes)
+{
+	struct rte_fib *fib = NULL, *ref = NULL;
+	struct rte_fib_conf config;
+	static uint32_t pfx[NUM_RND_ROUTES];
+	static uint8_t depth[NUM_RND_ROUTES];
+	uint64_t max_nh, nh;
+	unsigned int i, n = 0;
+	int ret;
+
+	max_nh = (1ULL << ((8 << nh_sz) - 1)) - 1;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = max_nh;
+	config.type = RTE_FIB_DUMMY;
+	ref = rte_fib_create("rnd_ref", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = nh_sz;
+	config.dir24_8.num_tbl8 = RTE_MIN(max_nh, (uint64_t)MAX_TBL8);
+	fib = rte_fib_create("rnd_fib", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < nb_routes; i++) {
+		depth[n] = rte_rand() % (RTE_FIB_MAXDEPTH + 1);
+		pfx[n] = random_prefix(depth[n]);
+		nh = rte_rand() % (max_nh + 1);
+		ret = rte_fib_add(fib, pfx[n], depth[n], nh);
+		if (ret == -ENOSPC)
+			continue;
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_add(ref, pfx[n], depth[n], nh);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		n++;
+	}
+	ret = compare_fibs(ref, fib, pfx, depth, n);
+	RTE_TEST_ASSERT(ret == 0, "Lookup mismatch after adding routes\n");
+
+	/* delete every other route, duplicates are already gone */
+	for (i = 0; i < n; i += 2) {
+		ret = rte_fib_delete(ref, pfx[i], depth[i]);
+		if (ret == -ENOENT)
+			continue;
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+		ret = rte_fib_delete(fib, pfx[i], depth[i]);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+	ret = compare_fibs(ref, fib, pfx, depth, n);
+	RTE_TEST_ASSERT(ret == 0, "Lookup mismatch after deleting routes\n");
+
+	rte_fib_free(fib);
+	rte_fib_free(ref);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Add random routes with random next hops to a DIR24_8 FIB and
+ * check it against the plain RIB lookup for every next hop size
+ */
+int32_t
+test_random_routes(void)
+{
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+	int ret;
+
+	for (nh_sz = RTE_FIB_DIR24_8_1B; nh_sz <= RTE_FIB_DIR24_8_8B;
+			nh_sz++) {
+		ret = test_random_routes_nh_sz(nh_sz,
+			(nh_sz == RTE_FIB_DIR24_8_1B) ?
+			NUM_RND_ROUTES / 8 : NUM_RND_ROUTES);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that tbl8 groups released while a reader is online are not
+ * reused until the reader reports a quiescent state
+ */
+int32_t
+test_rcu_qsbr(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	struct rte_fib_rcu_config rcu_cfg;
+	struct rte_rcu_qsbr *qsv;
+	uint32_t ip_base = RTE_IPV4(192, 0, 2, 0);
+	uint32_t ip;
+	uint64_t nh;
+	const unsigned int num_tbl8 = 4;
+	unsigned int i, thr_id = 0;
+	size_t sz;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = num_tbl8;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qsv = rte_zmalloc_socket(NULL, sz, RTE_CACHE_LINE_SIZE,
+		SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate QSBR variable\n");
+	rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+
+	rcu_cfg.v = NULL;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -EINVAL,
+		"Call succeeded with invalid parameters\n");
+
+	rcu_cfg.v = qsv;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to attach QSBR variable\n");
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == -EEXIST,
+		"QSBR variable attached twice\n");
+
+	rte_rcu_qsbr_thread_register(qsv, thr_id);
+	rte_rcu_qsbr_thread_online(qsv, thr_id);
+
+	/* every add/delete cycle retires a tbl8 group */
+	for (i = 0; i < num_tbl8 * 4; i++) {
+		ip = ip_base + (i << 8) + 1;
+		ret = rte_fib_add(fib, ip, 32, i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+		RTE_TEST_ASSERT(nh == i + 1, "Lookup failed\n");
+		ret = rte_fib_delete(fib, ip, 32);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+		rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+		RTE_TEST_ASSERT(nh == 0, "Lookup failed\n");
+		/*
+		 * Report quiescent state once all the groups are retired,
+		 * otherwise the next add would wait for this thread.
+		 */
+		if ((i % num_tbl8) == num_tbl8 - 1)
+			rte_rcu_qsbr_quiescent(qsv, thr_id);
+	}
+
+	rte_rcu_qsbr_thread_offline(qsv, thr_id);
+	rte_rcu_qsbr_thread_unregister(qsv, thr_id);
+
+	rte_fib_free(fib);
+
+	/* the same with synchronous reclamation and no readers online */
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_SYNC;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Failed to attach QSBR variable\n");
+
+	for (i = 0; i < num_tbl8 * 4; i++) {
+		ip = ip_base + (i << 8) + 1;
+		ret = rte_fib_add(fib, ip, 32, i + 1);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib_delete(fib, ip, 32);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite fib_tests = {
+	.suite_name = "fib autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_free_null),
+	TEST_CASE(test_add_del_invalid),
+	TEST_CASE(test_get_invalid),
+	TEST_CASE(test_lookup),
+	TEST_CASE(test_random_routes),
+	TEST_CASE(test_rcu_qsbr),
+	TEST_CASES_END()
+	}
+};
+
+static struct unit_test_suite fib_slow_tests = {
+	.suite_name = "fib slow autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_multiple_create),
+	TEST_CASES_END()
+	}
+};
+
+/*
+ * Do all unit tests.
+ */
+static int
+test_fib(void)
+{
+	return unit_test_suite_runner(&fib_tests);
+}
+
+static int
+test_slow_fib(void)
+{
+	return unit_test_suite_runner(&fib_slow_tests);
+}
+
+REGISTER_TEST_COMMAND(fib_autotest, test_fib);
+REGISTER_TEST_COMMAND(fib_slow_autotest, test_slow_fib);
@@ -0,0 +1,654 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+
+#include <rte_memory.h>
+#include <rte_random.h>
+#include <rte_rib6.h>
+#include <rte_fib6.h>
+
+#include "test.h"
+
+typedef int32_t (*rte_fib6_test)(void);
+
+static int32_t test_create_invalid(void);
+static int32_t test_multiple_create(void);
+static int32_t test_free_null(void);
+static int32_t test_add_del_invalid(void);
+static int32_t test_get_invalid(void);
+static int32_t test_lookup(void);
+static int32_t test_random_routes(void);
+static int32_t test_tbl8_exhaustion(void);
+
+#define MAX_ROUTES	(1 << 16)
+#define MAX_TBL8	(1 << 15)
+#define NUM_RND_ROUTES	1000
+#define NUM_RND_LOOKUPS	(NUM_RND_ROUTES * 8)
+
+static const enum rte_fib6_lookup_type lookup_types[] = {
+	RTE_FIB6_LOOKUP_TRIE_SCALAR,
+	RTE_FIB6_LOOKUP_TRIE_BATCH,
+};
+
+/*
+ * Check that rte_fib6_create fails gracefully for incorrect user input
+ * arguments
+ */
+int32_t
+test_create_invalid(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_DUMMY;
+
+	/* rte_fib6_create: fib name == NULL */
+	fib = rte_fib6_create(NULL, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_create: config == NULL */
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, NULL);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* socket_id < -1 is invalid */
+	fib = rte_fib6_create(__func__, -2, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_create: max_routes = -1 */
+	config.max_routes = -1;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.max_routes = MAX_ROUTES;
+
+	config.type = RTE_FIB6_TYPE_MAX;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.num_tbl8 = MAX_TBL8;
+
+	config.trie.nh_sz = RTE_FIB6_TRIE_8B + 1;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+	config.trie.nh_sz = RTE_FIB6_TRIE_8B;
+
+	config.trie.num_tbl8 = 0;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* num_tbl8 does not fit into a 2 byte next hop */
+	config.trie.nh_sz = RTE_FIB6_TRIE_2B;
+	config.trie.num_tbl8 = UINT16_MAX;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	/* default_nh does not fit into a 2 byte next hop */
+	config.trie.num_tbl8 = 16;
+	config.default_nh = UINT16_MAX;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Create fib table then delete fib table 10 times
+ * Use a slightly different rules size each time
+ */
+int32_t
+test_multiple_create(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	int32_t i;
+
+	config.default_nh = 0;
+	config.type = RTE_FIB6_DUMMY;
+
+	for (i = 0; i < 100; i++) {
+		config.max_routes = MAX_ROUTES - i;
+		fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+		RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+		rte_fib6_free(fib);
+	}
+	/* Can not test free so return success */
+	return TEST_SUCCESS;
+}
+
+/*
+ * Call rte_fib6_free for NULL pointer user input. Note: free has no return and
+ * therefore it is impossible to check for failure but this test is added to
+ * increase function coverage metrics and to validate that freeing null does
+ * not crash.
+ */
+int32_t
+test_free_null(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_DUMMY;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	rte_fib6_free(fib);
+	rte_fib6_free(NULL);
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib6_add and rte_fib6_delete fails gracefully
+ * for incorrect user input arguments
+ */
+int32_t
+test_add_del_invalid(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	uint64_t nh = 100;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	int ret;
+	uint8_t depth = 24;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_DUMMY;
+
+	/* rte_fib6_add: fib == NULL */
+	ret = rte_fib6_add(NULL, ip, depth, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_delete: fib == NULL */
+	ret = rte_fib6_delete(NULL, ip, depth);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/*Create valid fib to use in rest of test. */
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* rte_fib6_add: ip == NULL */
+	ret = rte_fib6_add(fib, NULL, depth, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_add: depth > RTE_FIB6_MAXDEPTH */
+	ret = rte_fib6_add(fib, ip, RTE_FIB6_MAXDEPTH + 1, nh);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_delete: depth > RTE_FIB6_MAXDEPTH */
+	ret = rte_fib6_delete(fib, ip, RTE_FIB6_MAXDEPTH + 1);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	/* rte_fib6_delete: route does not exist */
+	ret = rte_fib6_delete(fib, ip, depth);
+	RTE_TEST_ASSERT(ret == -ENOENT,
+		"Call succeeded with invalid parameters\n");
+
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that rte_fib6_get_dp and rte_fib6_get_rib fails gracefully
+ * for incorrect user input arguments
+ */
+int32_t
+test_get_invalid(void)
+{
+	void *p;
+	int ret;
+
+	p = rte_fib6_get_dp(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	p = rte_fib6_get_rib(NULL);
+	RTE_TEST_ASSERT(p == NULL,
+		"Call succeeded with invalid parameters\n");
+
+	ret = rte_fib6_set_lookup_fn(NULL, RTE_FIB6_LOOKUP_DEFAULT);
+	RTE_TEST_ASSERT(ret < 0,
+		"Call succeeded with invalid parameters\n");
+
+	return TEST_SUCCESS;
+}
+
+static void
+flip_bit(uint8_t *ip, unsigned int bit)
+{
+	ip[bit / CHAR_BIT] ^= 1 << (CHAR_BIT - 1 - bit % CHAR_BIT);
+}
+
+/* Whether the first depth bits of both addresses are equal */
+static int
+same_prefix(const uint8_t *ip1, const uint8_t *ip2, unsigned int depth)
+{
+	unsigned int i;
+
+	for (i = 0; i < depth; i++) {
+		if (((ip1[i / CHAR_BIT] ^ ip2[i / CHAR_BIT]) &
+				(1 << (CHAR_BIT - 1 - i % CHAR_BIT))) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * Routes ip_base/d with next hop d are installed for the nb_routes
+ * longest depths. Probe ip_base itself and, for every depth, an address
+ * that diverges from it right after that depth, so that each probe
+ * matches a different set of routes.
+ */
+static int
+check_nested(struct rte_fib6 *fib, const uint8_t *ip_base, uint64_t def_nh,
+	uint8_t nb_routes)
+{
+	static uint8_t ips[RTE_FIB6_MAXDEPTH * 2 + 1][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t nhs[RTE_FIB6_MAXDEPTH * 2 + 1];
+	uint64_t exp;
+	unsigned int i, j;
+
+	for (i = 0; i < RTE_FIB6_MAXDEPTH; i++) {
+		memcpy(ips[i * 2], ip_base, RTE_FIB6_IPV6_ADDR_SIZE);
+		flip_bit(ips[i * 2], i);
+		/* same prefix match, different entry of the last level */
+		memcpy(ips[i * 2 + 1], ips[i * 2], RTE_FIB6_IPV6_ADDR_SIZE);
+		if (i < RTE_FIB6_MAXDEPTH - CHAR_BIT)
+			ips[i * 2 + 1][RTE_FIB6_IPV6_ADDR_SIZE - 1] ^= 0xff;
+	}
+	memcpy(ips[RTE_FIB6_MAXDEPTH * 2], ip_base, RTE_FIB6_IPV6_ADDR_SIZE);
+	rte_fib6_lookup_bulk(fib, ips, nhs, RTE_DIM(ips));
+
+	for (i = 0; i < RTE_DIM(ips); i++) {
+		exp = def_nh;
+		for (j = RTE_FIB6_MAXDEPTH + 1 - nb_routes;
+				j <= RTE_FIB6_MAXDEPTH; j++) {
+			if (same_prefix(ips[i], ip_base, j))
+				exp = j;
+		}
+		if (nhs[i] != exp) {
+			printf("probe %u: %"PRIu64" expected %"PRIu64"\n",
+				i, nhs[i], exp);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_lookup_nh_sz(enum rte_fib_trie_nh_sz nh_sz)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	uint8_t ip_base[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8,
+		0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0,
+		0x0f, 0xed, 0xcb, 0xa9};
+	uint8_t ip_any[RTE_FIB6_IPV6_ADDR_SIZE] = {0};
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t def_nh = 200;
+	unsigned int i, k;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = nh_sz;
+	config.trie.num_tbl8 = 64;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (k = 0; k < RTE_DIM(lookup_types); k++) {
+		ret = rte_fib6_set_lookup_fn(fib, lookup_types[k]);
+		RTE_TEST_ASSERT(ret == 0,
+			"Failed to set lookup function %u\n", k);
+
+		RTE_TEST_ASSERT(check_nested(fib, ip_base, def_nh, 0) == 0,
+			"Lookup in empty FIB failed\n");
+
+		/* add from /128 to /1, every step covers the previous one */
+		for (i = RTE_FIB6_MAXDEPTH; i > 0; i--) {
+			ret = rte_fib6_add(fib, ip_base, i, i);
+			RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+			RTE_TEST_ASSERT(check_nested(fib, ip_base, def_nh,
+				RTE_FIB6_MAXDEPTH + 1 - i) == 0,
+				"Lookup failed after adding /%u\n", i);
+		}
+		ret = rte_fib6_add(fib, ip_any, 0, 0);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add default route\n");
+		RTE_TEST_ASSERT(check_nested(fib, ip_base, 0,
+			RTE_FIB6_MAXDEPTH) == 0,
+			"Lookup failed after adding default route\n");
+
+		/* deleting an absent route must not change anything */
+		memcpy(ip, ip_base, sizeof(ip));
+		flip_bit(ip, RTE_FIB6_MAXDEPTH - 1);
+		ret = rte_fib6_delete(fib, ip, RTE_FIB6_MAXDEPTH);
+		RTE_TEST_ASSERT(ret == -ENOENT,
+			"Deleted a route that does not exist\n");
+
+		ret = rte_fib6_delete(fib, ip_any, 0);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete default route\n");
+
+		for (i = 1; i <= RTE_FIB6_MAXDEPTH; i++) {
+			ret = rte_fib6_delete(fib, ip_base, i);
+			RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+			RTE_TEST_ASSERT(check_nested(fib, ip_base, def_nh,
+				RTE_FIB6_MAXDEPTH - i) == 0,
+				"Lookup failed after deleting /%u\n", i);
+		}
+	}
+
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check lookup results for every next hop size and every lookup function
+ */
+int32_t
+test_lookup(void)
+{
+	enum rte_fib_trie_nh_sz nh_sz;
+	int ret;
+
+	for (nh_sz = RTE_FIB6_TRIE_2B; nh_sz <= RTE_FIB6_TRIE_8B; nh_sz++) {
+		ret = test_lookup_nh_sz(nh_sz);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static void
+random_addr(uint8_t *ip)
+{
+	uint64_t r;
+	unsigned int i;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i += sizeof(r)) {
+		r = rte_rand();
+		memcpy(&ip[i], &r, sizeof(r));
+	}
+}
+
+/*
+ * Random prefix, most of them short enough to share the tbl8 groups
+ * with the others so that the routes overlap.
+ */
+static void
+random_prefix(uint8_t *ip, uint8_t depth)
+{
+	unsigned int i;
+
+	random_addr(ip);
+	/* keep a common /16 so that the routes overlap */
+	ip[0] = 0x20;
+	ip[1] = 0x01;
+	for (i = depth; i < RTE_FIB6_MAXDEPTH; i++)
+		ip[i / CHAR_BIT] &= ~(1 << (CHAR_BIT - 1 - i % CHAR_BIT));
+}
+
+/* Add or subtract one to an address, wrapping around */
+static void
+addr_step(uint8_t *ip, int inc)
+{
+	int i;
+
+	for (i = RTE_FIB6_IPV6_ADDR_SIZE - 1; i >= 0; i--) {
+		ip[i] += inc ? 1 : -1;
+		if (ip[i] != (inc ? 0 : UINT8_MAX))
+			break;
+	}
+}
+
+/*
+ * Look up addresses around the edges of every prefix as well as random
+ * ones and compare the results with the reference RIB based FIB.
+ */
+static int
+compare_fibs(struct rte_fib6 *ref, struct rte_fib6 *fib,
+	uint8_t pfx[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depth,
+	unsigned int nb_routes)
+{
+	static uint8_t ips[NUM_RND_LOOKUPS][RTE_FIB6_IPV6_ADDR_SIZE];
+	static uint64_t nh_ref[NUM_RND_LOOKUPS];
+	static uint64_t nh[NUM_RND_LOOKUPS];
+	unsigned int i, j, k, n = 0;
+
+	for (i = 0; i < nb_routes; i++) {
+		memcpy(ips[n], pfx[i], RTE_FIB6_IPV6_ADDR_SIZE);
+		memcpy(ips[n + 1], pfx[i], RTE_FIB6_IPV6_ADDR_SIZE);
+		for (j = depth[i]; j < RTE_FIB6_MAXDEPTH; j++)
+			flip_bit(ips[n + 1], j);
+		memcpy(ips[n + 2], ips[n], RTE_FIB6_IPV6_ADDR_SIZE);
+		addr_step(ips[n + 2], 0);
+		memcpy(ips[n + 3], ips[n + 1], RTE_FIB6_IPV6_ADDR_SIZE);
+		addr_step(ips[n + 3], 1);
+		n += 4;
+	}
+	while (n < RTE_DIM(ips)) {
+		random_addr(ips[n]);
+		/* half of them in the routed /16 */
+		if (n & 1) {
+			ips[n][0] = 0x20;
+			ips[n][1] = 0x01;
+		}
+		n++;
+	}
+
+	rte_fib6_lookup_bulk(ref, ips, nh_ref, n);
+
+	for (k = 0; k < RTE_DIM(lookup_types); k++) {
+		if (rte_fib6_set_lookup_fn(fib, lookup_types[k]) != 0)
+			return -1;
+		/* use an odd number of lookups to exercise the tail path */
+		rte_fib6_lookup_bulk(fib, ips, nh, n - 1);
+		for (i = 0; i < n - 1; i++) {
+			if (nh[i] != nh_ref[i]) {
+				printf("Lookup type %u: ip %u: %"PRIu64
+					" expected %"PRIu64"\n",
+					k, i, nh[i], nh_ref[i]);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+static int
+test_random_routes_nh_sz(enum rte_fib_trie_nh_sz nh_sz)
+{
+	struct rte_fib6 *fib = NULL, *ref = NULL;
+	struct rte_fib6_conf config;
+	static uint8_t pfx[NUM_RND_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE];
+	static uint8_t depth[NUM_RND_ROUTES];
+	uint64_t max_nh, nh;
+	unsigned int i, n = 0;
+	int ret;
+
+	max_nh = (1ULL << ((8 << nh_sz) - 1)) - 1;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = max_nh;
+	config.type = RTE_FIB6_DUMMY;
+	ref = rte_fib6_create("rnd_ref6", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = nh_sz;
+	config.trie.num_tbl8 = RTE_MIN(max_nh, (uint64_t)MAX_TBL8);
+	fib = rte_fib6_create("rnd_fib6", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	for (i = 0; i < NUM_RND_ROUTES; i++) {
+		depth[n] = rte_rand() % (RTE_FIB6_MAXDEPTH + 1);
+		random_prefix(pfx[n], depth[n]);
+		nh = rte_rand() % (max_nh + 1);
+		ret = rte_fib6_add(fib, pfx[n], depth[n], nh);
+		if (ret == -ENOSPC)
+			continue;
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		ret = rte_fib6_add(ref, pfx[n], depth[n], nh);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		n++;
+	}
+	ret = compare_fibs(ref, fib, pfx, depth, n);
+	RTE_TEST_ASSERT(ret == 0, "Lookup mismatch after adding routes\n");
+
+	/* delete every other route, duplicates are already gone */
+	for (i = 0; i < n; i += 2) {
+		ret = rte_fib6_delete(ref, pfx[i], depth[i]);
+		if (ret == -ENOENT)
+			continue;
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+		ret = rte_fib6_delete(fib, pfx[i], depth[i]);
+		RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	}
+	ret = compare_fibs(ref, fib, pfx, depth, n);
+	RTE_TEST_ASSERT(ret == 0, "Lookup mismatch after deleting routes\n");
+
+	rte_fib6_free(fib);
+	rte_fib6_free(ref);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Add random routes with random next hops to a TRIE FIB and
+ * check it against the plain RIB lookup for every next hop size
+ */
+int32_t
+test_random_routes(void)
+{
+	enum rte_fib_trie_nh_sz nh_sz;
+	int ret;
+
+	for (nh_sz = RTE_FIB6_TRIE_2B; nh_sz <= RTE_FIB6_TRIE_8B; nh_sz++) {
+		ret = test_random_routes_nh_sz(nh_sz);
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check that an update which does not fit into the free tbl8 groups
+ * fails without changing the lookup results and that the groups are
+ * returned to the pool on delete
+ */
+int32_t
+test_tbl8_exhaustion(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8};
+	uint8_t ips[1][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t nh;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	/* a /128 needs 13 groups, one for every byte after the first 3 */
+	config.trie.num_tbl8 = 13;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib6_add(fib, ip, 128, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+
+	/* shares the first 14 bytes, needs one more group */
+	memcpy(ips[0], ip, sizeof(ip));
+	ips[0][14] = 1;
+	ret = rte_fib6_add(fib, ips[0], 128, 2);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Route added without free tbl8\n");
+	rte_fib6_lookup_bulk(fib, ips, &nh, 1);
+	RTE_TEST_ASSERT(nh == 0, "Failed update changed the lookup result\n");
+
+	ret = rte_fib6_delete(fib, ip, 128);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete a route\n");
+	ret = rte_fib6_add(fib, ips[0], 128, 2);
+	RTE_TEST_ASSERT(ret == 0, "tbl8 groups were not released\n");
+	rte_fib6_lookup_bulk(fib, ips, &nh, 1);
+	RTE_TEST_ASSERT(nh == 2, "Lookup failed\n");
+
+	rte_fib6_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite fib6_tests = {
+	.suite_name = "fib6 autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_create_invalid),
+	TEST_CASE(test_free_null),
+	TEST_CASE(test_add_del_invalid),
+	TEST_CASE(test_get_invalid),
+	TEST_CASE(test_lookup),
+	TEST_CASE(test_random_routes),
+	TEST_CASE(test_tbl8_exhaustion),
+	TEST_CASES_END()
+	}
+};
+
+static struct unit_test_suite fib6_slow_tests = {
+	.suite_name = "fib6 slow autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+	TEST_CASE(test_multiple_create),
+	TEST_CASES_END()
+	}
+};
+
+/*
+ * Do all unit tests.
+ */
+static int
+test_fib6(void)
+{
+	return unit_test_suite_runner(&fib6_tests);
+}
+
+static int
+test_slow_fib6(void)
+{
+	return unit_test_suite_runner(&fib6_slow_tests);
+}
+
+REGISTER_TEST_COMMAND(fib6_autotest, test_fib6);
+REGISTER_TEST_COMMAND(fib6_slow_autotest, test_slow_fib6);
@@ -0,0 +1,163 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2014 Intel Corporation
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_random.h>
+#include <rte_branch_prediction.h>
+#include <rte_memory.h>
+#include <rte_fib6.h>
+
+#include "test.h"
+
+#include "test_lpm6_data.h"
+
+#define TEST_FIB_ASSERT(cond) do {				\
+	if (!(cond)) {						\
+		printf("Error at line %d:\n", __LINE__);	\
+		return -1;					\
+	}							\
+} while (0)
+
+#define ITERATIONS (1 << 10)
+#define BULK_SIZE 32
+#define NUMBER_TBL8S (1 << 16)
+
+static void
+print_route_distribution(const struct rules_tbl_entry *table, uint32_t n)
+{
+	unsigned int i, j;
+
+	printf("Route distribution per prefix width:\n");
+	printf("DEPTH    QUANTITY (PERCENT)\n");
+	printf("---------------------------\n");
+
+	/* Count depths. */
+	for (i = 1; i <= 128; i++) {
+		unsigned int depth_counter = 0;
+		double percent_hits;
+
+		for (j = 0; j < n; j++)
+			if (table[j].depth == (uint8_t) i)
+				depth_counter++;
+
+		percent_hits = ((double)depth_counter)/((double)n) * 100;
+		printf("%.2u%15u (%.2f)\n", i, depth_counter, percent_hits);
+	}
+	printf("\n");
+}
+
+static const char * const lookup_names[] = {
+	[RTE_FIB6_LOOKUP_TRIE_SCALAR] = "scalar",
+	[RTE_FIB6_LOOKUP_TRIE_BATCH] = "batch",
+};
+
+static int
+test_fib6_perf(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf conf;
+	uint64_t begin, total_time;
+	unsigned int i, j, type;
+	uint64_t next_hop_add;
+	int status = 0;
+	int64_t count = 0;
+	static uint8_t ip_batch[NUM_IPS_ENTRIES][16];
+	uint64_t next_hops[BULK_SIZE];
+
+	conf.type = RTE_FIB6_TRIE;
+	conf.default_nh = 0;
+	conf.max_routes = 1000000;
+	conf.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	conf.trie.num_tbl8 = NUMBER_TBL8S;
+
+	rte_srand(rte_rdtsc());
+
+	printf("No. routes = %u\n", (unsigned int) NUM_ROUTE_ENTRIES);
+
+	print_route_distribution(large_route_table,
+		(uint32_t) NUM_ROUTE_ENTRIES);
+
+	/* Only generate IPv6 address of each item in large IPS table,
+	 * here next_hop is not needed.
+	 */
+	generate_large_ips_table(0);
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &conf);
+	TEST_FIB_ASSERT(fib != NULL);
+
+	/* Measure add. */
+	begin = rte_rdtsc();
+
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		next_hop_add = (i & ((1 << 14) - 1)) + 1;
+		if (rte_fib6_add(fib, large_route_table[i].ip,
+				large_route_table[i].depth, next_hop_add) == 0)
+			status++;
+	}
+	/* End Timer. */
+	total_time = rte_rdtsc() - begin;
+
+	printf("Unique added entries = %d\n", status);
+	printf("Average FIB Add: %g cycles\n",
+			(double)total_time / NUM_ROUTE_ENTRIES);
+
+	for (i = 0; i < NUM_IPS_ENTRIES; i++)
+		memcpy(ip_batch[i], large_ips_table[i].ip, 16);
+
+	/* Measure bulk Lookup for every lookup function */
+	for (type = RTE_FIB6_LOOKUP_TRIE_SCALAR;
+			type <= RTE_FIB6_LOOKUP_TRIE_BATCH; type++) {
+		TEST_FIB_ASSERT(rte_fib6_set_lookup_fn(fib, type) == 0);
+
+		total_time = 0;
+		count = 0;
+		for (i = 0; i < ITERATIONS; i++) {
+			/* Lookup per batch */
+			begin = rte_rdtsc();
+			for (j = 0; j + BULK_SIZE <= NUM_IPS_ENTRIES;
+					j += BULK_SIZE) {
+				uint32_t k;
+				rte_fib6_lookup_bulk(fib, &ip_batch[j],
+					next_hops, BULK_SIZE);
+				for (k = 0; k < BULK_SIZE; k++)
+					if (unlikely(next_hops[k] == 0))
+						count++;
+			}
+			total_time += rte_rdtsc() - begin;
+		}
+		printf("BULK FIB Lookup (%s): %.1f cycles (fails = %.1f%%)\n",
+			lookup_names[type],
+			(double)total_time / ((double)ITERATIONS *
+			(NUM_IPS_ENTRIES / BULK_SIZE * BULK_SIZE)),
+			(count * 100.0) / (double)(ITERATIONS *
+			(NUM_IPS_ENTRIES / BULK_SIZE * BULK_SIZE)));
+	}
+
+	/* Delete */
+	status = 0;
+	begin = rte_rdtsc();
+
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++) {
+		/* rte_fib6_delete(fib, ip, depth) */
+		status += rte_fib6_delete(fib, large_route_table[i].ip,
+				large_route_table[i].depth);
+	}
+
+	total_time = rte_rdtsc() - begin;
+
+	printf("Average FIB Delete: %g cycles\n",
+			(double)total_time / NUM_ROUTE_ENTRIES);
+
+	rte_fib6_free(fib);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(fib6_perf_autotest, test_fib6_perf);
@@ -1809,6 +1809,152 @@ test_hash_add_delete_jhash_3word(void)
 	return ret;
 }
 
+#define RESIZABLE_TEST_KEYS 4096
+
+/*
+ * Add keys to a resizable table far beyond its initial size and check that
+ * all keys keep being found at the same position while it grows, with and
+ * without lock free read-write concurrency.
+ */
+static int test_resizable_table(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_resizable",
+		.entries = 64,
+		.key_len = sizeof(struct flow_key), /* 13 */
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+	};
+	const uint8_t extra_flags[] = {
+		RTE_HASH_EXTRA_FLAGS_RESIZABLE,
+		RTE_HASH_EXTRA_FLAGS_RESIZABLE |
+			RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	static struct flow_key keys[RESIZABLE_TEST_KEYS];
+	static int32_t pos[RESIZABLE_TEST_KEYS];
+	const void *keys_burst[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t pos_burst[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash *handle = NULL;
+	const void *next_key;
+	void *next_data;
+	uint32_t iter;
+	unsigned int f, i, j;
+	int32_t ret;
+
+	for (i = 0; i < RESIZABLE_TEST_KEYS; i++) {
+		keys[i].ip_src = i;
+		keys[i].ip_dst = i * 7;
+		keys[i].port_src = i & 0xffff;
+		keys[i].port_dst = (i >> 3) & 0xffff;
+		keys[i].proto = i & 0xff;
+	}
+
+	/* Resizable table does not support extendable buckets */
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE |
+				RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle != NULL,
+			"resizable table with ext buckets should have failed");
+
+	for (f = 0; f < RTE_DIM(extra_flags); f++) {
+		params.extra_flag = extra_flags[f];
+		handle = rte_hash_create(&params);
+		RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+		for (i = 0; i < RESIZABLE_TEST_KEYS; i++) {
+			pos[i] = rte_hash_add_key(handle, &keys[i]);
+			RETURN_IF_ERROR(pos[i] < 0,
+				"failed to add key (pos[%u]=%d)", i, pos[i]);
+
+			/* Check all keys regularly, also mid-migration */
+			if (i % 61 != 0)
+				continue;
+			for (j = 0; j <= i; j++) {
+				ret = rte_hash_lookup(handle, &keys[j]);
+				RETURN_IF_ERROR(ret != pos[j],
+					"failed to find key %u after adding "
+					"%u keys (ret=%d)", j, i + 1, ret);
+			}
+		}
+
+		RETURN_IF_ERROR(rte_hash_count(handle) != RESIZABLE_TEST_KEYS,
+				"wrong key count after growing");
+
+		/* Bulk lookup */
+		for (i = 0; i < RESIZABLE_TEST_KEYS;
+				i += RTE_HASH_LOOKUP_BULK_MAX) {
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+				keys_burst[j] = &keys[i + j];
+			rte_hash_lookup_bulk(handle, keys_burst,
+					RTE_HASH_LOOKUP_BULK_MAX, pos_burst);
+			for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+				RETURN_IF_ERROR(pos_burst[j] != pos[i + j],
+					"bulk lookup failed for key %u "
+					"(ret=%d)", i + j, pos_burst[j]);
+		}
+
+		/* Every key is iterated exactly once */
+		iter = 0;
+		for (i = 0; rte_hash_iterate(handle, &next_key, &next_data,
+						&iter) >= 0; i++)
+			;
+		RETURN_IF_ERROR(i != RESIZABLE_TEST_KEYS,
+				"iterated %u keys instead of %u",
+				i, RESIZABLE_TEST_KEYS);
+
+		/* Delete half of the keys */
+		for (i = 0; i < RESIZABLE_TEST_KEYS; i += 2) {
+			ret = rte_hash_del_key(handle, &keys[i]);
+			RETURN_IF_ERROR(ret != pos[i],
+				"failed to delete key %u (ret=%d)", i, ret);
+			if (params.extra_flag &
+					RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
+				rte_hash_free_key_with_position(handle, ret);
+		}
+		for (i = 0; i < RESIZABLE_TEST_KEYS; i++) {
+			ret = rte_hash_lookup(handle, &keys[i]);
+			RETURN_IF_ERROR(ret != ((i & 1) ? pos[i] : -ENOENT),
+				"wrong lookup of key %u after deletes "
+				"(ret=%d)", i, ret);
+		}
+		RETURN_IF_ERROR(
+			rte_hash_count(handle) != RESIZABLE_TEST_KEYS / 2,
+			"wrong key count after deletes");
+
+		rte_hash_free(handle);
+		handle = NULL;
+	}
+
+	/* Keys added with their own hash are migrated with that hash */
+	params.extra_flag = RTE_HASH_EXTRA_FLAGS_RESIZABLE;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	for (i = 0; i < RESIZABLE_TEST_KEYS; i++) {
+		pos[i] = rte_hash_add_key_with_hash(handle, &keys[i],
+				i * 2654435761U);
+		RETURN_IF_ERROR(pos[i] < 0,
+			"failed to add key with hash (pos[%u]=%d)", i, pos[i]);
+	}
+	for (i = 0; i < RESIZABLE_TEST_KEYS; i++) {
+		ret = rte_hash_lookup_with_hash(handle, &keys[i],
+				i * 2654435761U);
+		RETURN_IF_ERROR(ret != pos[i],
+			"failed to find key %u added with hash (ret=%d)",
+			i, ret);
+	}
+	rte_hash_free(handle);
+	handle = NULL;
+
+	/* The names of the grown free slots rings must not be truncated */
+	params.name = "test_resizable_too_long_name";
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle != NULL,
+			"resizable table with a too long name should have failed");
+
+	return 0;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -1843,6 +1989,8 @@ test_hash(void)
 		return -1;
 	if (test_extendable_bucket() < 0)
 		return -1;
+	if (test_resizable_table() < 0)
+		return -1;
 
 	if (test_fbk_hash_find_existing() < 0)
 		return -1;
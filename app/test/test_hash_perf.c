@@ -668,6 +668,114 @@ fbk_hash_perf_test(void)
 	return 0;
 }
 
+/* Control operation of the large table lookup performance test. */
+#define LARGE_ENTRIES 10000000	/* Entries in the large table. */
+#define LARGE_KEY_LEN 16	/* IPv4 5-tuple, padded to 16 bytes. */
+#define LARGE_LOOKUPS (1 << 24)	/* How many lookups to time. */
+
+/*
+ * Lookups in a table that is far bigger than the last level cache, so
+ * almost every bucket and key-store access misses. This is the case bulk
+ * lookup prefetching is designed for.
+ */
+static int
+test_hash_large_perf(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_hash_large",
+		.entries = LARGE_ENTRIES,
+		.key_len = LARGE_KEY_LEN,
+		.socket_id = rte_socket_id(),
+	};
+	struct rte_hash *handle;
+	uint32_t (*large_keys)[LARGE_KEY_LEN / sizeof(uint32_t)] = NULL;
+	uint32_t *lookup_idx = NULL;
+	const void *keys_burst[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions_burst[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t begin, lookup_cycles, bulk_cycles;
+	unsigned int keys_to_add = LARGE_ENTRIES * ADD_PERCENT;
+	unsigned int i, j, added = 0;
+	int ret = -1;
+
+	handle = rte_hash_find_existing(params.name);
+	if (handle != NULL)
+		rte_hash_free(handle);
+	handle = rte_hash_create(&params);
+	if (handle == NULL) {
+		printf("Error creating large table\n");
+		return -1;
+	}
+
+	large_keys = rte_zmalloc(NULL, sizeof(*large_keys) * keys_to_add, 0);
+	if (large_keys == NULL) {
+		printf("Memory allocation for large key store failed\n");
+		goto exit;
+	}
+
+	/* Keys are unique by construction, so no duplicate check is needed */
+	for (i = 0; i < keys_to_add; i++) {
+		large_keys[i][0] = i;
+		large_keys[i][1] = (uint32_t)rte_rand();
+		large_keys[i][2] = (uint32_t)rte_rand();
+		large_keys[i][3] = (uint32_t)rte_rand();
+		if (rte_hash_add_key(handle, large_keys[i]) < 0)
+			break;
+		added++;
+	}
+	if (added == 0) {
+		printf("Could not add any key to large table\n");
+		goto exit;
+	}
+
+	/* Pick the keys to look up before timing, rte_rand() is not free */
+	lookup_idx = rte_malloc(NULL, sizeof(*lookup_idx) * LARGE_LOOKUPS, 0);
+	if (lookup_idx == NULL) {
+		printf("Memory allocation for lookup indexes failed\n");
+		goto exit;
+	}
+	for (i = 0; i < LARGE_LOOKUPS; i++)
+		lookup_idx[i] = rte_rand() % added;
+
+	begin = rte_rdtsc();
+	for (i = 0; i < LARGE_LOOKUPS; i++) {
+		if (rte_hash_lookup(handle, large_keys[lookup_idx[i]]) < 0) {
+			printf("Key not found in large table\n");
+			goto exit;
+		}
+	}
+	lookup_cycles = rte_rdtsc() - begin;
+
+	begin = rte_rdtsc();
+	for (i = 0; i < LARGE_LOOKUPS / RTE_HASH_LOOKUP_BULK_MAX; i++) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++)
+			keys_burst[j] = large_keys[lookup_idx[
+				i * RTE_HASH_LOOKUP_BULK_MAX + j]];
+		rte_hash_lookup_bulk(handle, keys_burst,
+				RTE_HASH_LOOKUP_BULK_MAX, positions_burst);
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			if (positions_burst[j] < 0) {
+				printf("Key not found in large table\n");
+				goto exit;
+			}
+		}
+	}
+	bulk_cycles = rte_rdtsc() - begin;
+
+	printf("\n\n *** Large table (%u keys of %u bytes) ***\n",
+		added, LARGE_KEY_LEN);
+	printf("Lookup: %"PRIu64" cycles/key\n",
+		lookup_cycles / LARGE_LOOKUPS);
+	printf("Lookup_bulk: %"PRIu64" cycles/key\n",
+		bulk_cycles / LARGE_LOOKUPS);
+	ret = 0;
+
+exit:
+	rte_free(lookup_idx);
+	rte_free(large_keys);
+	rte_hash_free(handle);
+	return ret;
+}
+
 static int
 test_hash_perf(void)
 {
@@ -699,3 +807,4 @@ test_hash_perf(void)
 }
 
 REGISTER_TEST_COMMAND(hash_perf_autotest, test_hash_perf);
+REGISTER_TEST_COMMAND(hash_large_perf_autotest, test_hash_large_perf);
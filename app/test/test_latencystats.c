@@ -7,13 +7,14 @@
 #include <string.h>
 
 #include <rte_latencystats.h>
+#include <rte_ethdev.h>
 #include "rte_lcore.h"
 #include "rte_metrics.h"
 
 #include "sample_packet_forward.h"
 #include "test.h"
 
-#define NUM_STATS 4
+#define NUM_STATS 7
 #define LATENCY_NUM_PACKETS 10
 #define QUEUE_ID 0
 
@@ -25,6 +26,9 @@ static struct rte_metric_name lat_stats_strings[] = {
 	{"avg_latency_ns"},
 	{"max_latency_ns"},
 	{"jitter_ns"},
+	{"p50_latency_ns"},
+	{"p99_latency_ns"},
+	{"p999_latency_ns"},
 };
 
 /* Test case for latency init with metrics init */
@@ -77,7 +81,7 @@ static int test_latencystats_get_names(void)
 	/* Success Test: Valid names and size */
 	size = NUM_STATS;
 	ret = rte_latencystats_get_names(names, size);
-	for (i = 0; i <= NUM_STATS; i++) {
+	for (i = 0; i < NUM_STATS; i++) {
 		if (strcmp(lat_stats_strings[i].name, names[i].name) == 0)
 			printf(" %s\n", names[i].name);
 		else
@@ -130,6 +134,44 @@ static int test_latencystats_get(void)
 	return TEST_SUCCESS;
 }
 
+/* Test case to get the latency stats values of a queue */
+static int test_latencystats_get_queue(void)
+{
+	struct rte_metric_value values[NUM_STATS];
+	int ret, i;
+
+	memset(values, 0, sizeof(values));
+
+	ret = rte_latencystats_get_queue(portid, QUEUE_ID, values, NUM_STATS);
+	TEST_ASSERT((ret == NUM_STATS), "Test Failed to get queue latency"
+		    " metrics values, ret %d", ret);
+	for (i = 0; i < NUM_STATS; i++)
+		TEST_ASSERT((values[i].key == (uint16_t)i),
+			    "Test Failed: wrong key %u", values[i].key);
+
+	/* min <= p50 <= p99 <= p99.9 <= max */
+	TEST_ASSERT(values[0].value <= values[4].value &&
+		    values[4].value <= values[5].value &&
+		    values[5].value <= values[6].value &&
+		    values[6].value <= values[2].value,
+		    "Test Failed: percentiles not ordered");
+
+	/* Failure Test: Valid values and invalid size */
+	ret = rte_latencystats_get_queue(portid, QUEUE_ID, values, 0);
+	TEST_ASSERT((ret == NUM_STATS), "Test Failed to get the stats count,"
+		    "Actual: %d Expected: %d", ret, NUM_STATS);
+
+	/* Failure Test: Invalid port and queue */
+	ret = rte_latencystats_get_queue(RTE_MAX_ETHPORTS, QUEUE_ID, values,
+					 NUM_STATS);
+	TEST_ASSERT((ret == -EINVAL), "Test Failed: invalid port accepted");
+	ret = rte_latencystats_get_queue(portid, QUEUE_ID + 1, values,
+					 NUM_STATS);
+	TEST_ASSERT((ret == -ENOENT), "Test Failed: unused queue accepted");
+
+	return TEST_SUCCESS;
+}
+
 static int test_latency_ring_setup(void)
 {
 	test_ring_setup(&ring, &portid);
@@ -155,7 +197,10 @@ static int test_latency_packet_forward(void)
 		printf("allocate mbuf pool Failed\n");
 		return TEST_FAILED;
 	}
+	/* packets are time stamped on Rx and measured on the second Tx */
 	ret = test_packet_forward(pbuf, portid, QUEUE_ID);
+	if (ret == 0)
+		ret = test_packet_forward(pbuf, portid, QUEUE_ID);
 	if (ret < 0)
 		printf("send pkts Failed\n");
 	test_put_mbuf_to_pool(mp, pbuf);
@@ -191,7 +236,12 @@ unit_test_suite latencystats_testsuite = {
 		 */
 		TEST_CASE_ST(NULL, NULL, test_latencystats_get),
 
-		/* Test Case 5: To check uninit of latency test */
+		/* Test Case 5: To check whether the latency stats
+		 * of a queue are retrieved
+		 */
+		TEST_CASE_ST(NULL, NULL, test_latencystats_get_queue),
+
+		/* Test Case 6: To check uninit of latency test */
 		TEST_CASE_ST(NULL, NULL, test_latency_uninit),
 
 		TEST_CASES_END()
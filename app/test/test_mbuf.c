@@ -886,6 +886,107 @@ test_pktmbuf_pool_bulk(void)
 	return ret;
 }
 
+/*
+ * Test bulk free of mbufs interleaved from more pools than gathered at once,
+ * and the reset of the fields by bulk allocation.
+ */
+#define NB_BULK_POOLS 6
+#define NB_BULK_POOL_MBUF 32
+
+static int
+test_pktmbuf_bulk_multi_pool(void)
+{
+	struct rte_mempool *pools[NB_BULK_POOLS] = { NULL };
+	struct rte_mbuf *mbufs[NB_BULK_POOLS * NB_BULK_POOL_MBUF];
+	char name[RTE_MEMPOOL_NAMESIZE];
+	unsigned int i, p;
+	struct rte_mbuf *m;
+	int ret = -1;
+
+	for (p = 0; p < NB_BULK_POOLS; p++) {
+		snprintf(name, sizeof(name), "test_bulk_multi%u", p);
+		pools[p] = rte_pktmbuf_pool_create(name, NB_BULK_POOL_MBUF, 0,
+				0, MBUF_DATA_SIZE, SOCKET_ID_ANY);
+		if (pools[p] == NULL) {
+			printf("rte_pktmbuf_pool_create() failed. rte_errno %d\n",
+			       rte_errno);
+			goto err;
+		}
+	}
+
+	/* Interleave the mbufs of all pools, some of them chained. */
+	for (i = 0; i < RTE_DIM(mbufs); i++) {
+		mbufs[i] = rte_pktmbuf_alloc(pools[i % NB_BULK_POOLS]);
+		if (mbufs[i] == NULL) {
+			printf("rte_pktmbuf_alloc() failed (%u)\n", i);
+			goto err;
+		}
+		if (i % 5 == 4) {
+			rte_pktmbuf_chain(mbufs[i - 1], mbufs[i]);
+			mbufs[i] = NULL;
+		}
+	}
+	for (p = 0; p < NB_BULK_POOLS; p++) {
+		if (!rte_mempool_empty(pools[p])) {
+			printf("mempool %u not empty\n", p);
+			goto err;
+		}
+	}
+	rte_pktmbuf_free_bulk(mbufs, RTE_DIM(mbufs));
+	for (p = 0; p < NB_BULK_POOLS; p++) {
+		if (!rte_mempool_full(pools[p])) {
+			printf("mempool %u not full after bulk free\n", p);
+			goto err;
+		}
+	}
+
+	/* Dirty the mbufs, then check bulk allocation resets them. */
+	if (rte_pktmbuf_alloc_bulk(pools[0], mbufs, NB_BULK_POOL_MBUF) != 0) {
+		printf("rte_pktmbuf_alloc_bulk() failed\n");
+		goto err;
+	}
+	for (i = 0; i < NB_BULK_POOL_MBUF; i++) {
+		m = mbufs[i];
+		m->data_off = 0;
+		m->port = 3;
+		m->ol_flags = PKT_RX_RSS_HASH;
+		m->packet_type = RTE_PTYPE_L2_ETHER;
+		m->pkt_len = 100;
+		m->data_len = 100;
+		m->vlan_tci = 1;
+		m->vlan_tci_outer = 2;
+		m->tx_offload = 42;
+	}
+	rte_pktmbuf_free_bulk(mbufs, NB_BULK_POOL_MBUF);
+	if (rte_pktmbuf_alloc_bulk(pools[0], mbufs, NB_BULK_POOL_MBUF) != 0) {
+		printf("rte_pktmbuf_alloc_bulk() failed\n");
+		goto err;
+	}
+	for (i = 0; i < NB_BULK_POOL_MBUF; i++) {
+		m = mbufs[i];
+		if (m->data_off != RTE_MIN(RTE_PKTMBUF_HEADROOM, m->buf_len) ||
+				rte_mbuf_refcnt_read(m) != 1 ||
+				m->nb_segs != 1 ||
+				m->port != MBUF_INVALID_PORT ||
+				m->ol_flags != 0 || m->packet_type != 0 ||
+				m->pkt_len != 0 || m->data_len != 0 ||
+				m->vlan_tci != 0 || m->vlan_tci_outer != 0 ||
+				m->next != NULL || m->tx_offload != 0) {
+			printf("mbuf %u not reset by bulk allocation\n", i);
+			rte_pktmbuf_free_bulk(mbufs, NB_BULK_POOL_MBUF);
+			goto err;
+		}
+	}
+	rte_pktmbuf_free_bulk(mbufs, NB_BULK_POOL_MBUF);
+
+	ret = 0;
+
+err:
+	for (p = 0; p < NB_BULK_POOLS; p++)
+		rte_mempool_free(pools[p]);
+	return ret;
+}
+
 /*
  * test that the pointer to the data on a packet mbuf is set properly
  */
@@ -2412,6 +2513,132 @@ test_pktmbuf_ext_shinfo_init_helper(struct rte_mempool *pktmbuf_pool)
 	return -1;
 }
 
+/*
+ * Test the mbufs of a pool with pinned external buffers
+ *  - Create the pool with buffers in two zones of external memory.
+ *  - Check the mbufs are attached to buffers of the zones.
+ *  - Clone a mbuf into a regular pool, free the original mbuf first and
+ *    check it is only returned to its pool when the clone is freed.
+ */
+#define EXT_PINNED_NB_MBUF 30
+#define EXT_PINNED_ELT_SIZE 2048
+
+static int
+test_pktmbuf_ext_pinned_buffer(struct rte_mempool *pktmbuf_pool)
+{
+	struct rte_pktmbuf_extmem ext_mem[2];
+	struct rte_mempool *pinned_pool = NULL;
+	struct rte_mbuf *mbufs[EXT_PINNED_NB_MBUF];
+	struct rte_mbuf *m = NULL, *clone = NULL;
+	size_t zone_len = EXT_PINNED_NB_MBUF / 2 * EXT_PINNED_ELT_SIZE;
+	unsigned int i, z;
+	char *data;
+
+	memset(ext_mem, 0, sizeof(ext_mem));
+	for (z = 0; z < RTE_DIM(ext_mem); z++) {
+		ext_mem[z].buf_ptr = rte_malloc("test_ext_pinned", zone_len,
+				RTE_CACHE_LINE_SIZE);
+		if (ext_mem[z].buf_ptr == NULL)
+			GOTO_FAIL("%s: zone allocation failed\n", __func__);
+		ext_mem[z].buf_iova = rte_malloc_virt2iova(ext_mem[z].buf_ptr);
+		ext_mem[z].buf_len = zone_len;
+		ext_mem[z].elt_size = EXT_PINNED_ELT_SIZE;
+	}
+
+	/* more mbufs than buffers in the zones */
+	pinned_pool = rte_pktmbuf_pool_create_extbuf("test_ext_pinned_big",
+			EXT_PINNED_NB_MBUF + 1, 0, 0, EXT_PINNED_ELT_SIZE,
+			SOCKET_ID_ANY, ext_mem, RTE_DIM(ext_mem));
+	if (pinned_pool != NULL || rte_errno != EINVAL)
+		GOTO_FAIL("%s: too small zones accepted\n", __func__);
+
+	pinned_pool = rte_pktmbuf_pool_create_extbuf("test_ext_pinned",
+			EXT_PINNED_NB_MBUF, 0, 0, EXT_PINNED_ELT_SIZE,
+			SOCKET_ID_ANY, ext_mem, RTE_DIM(ext_mem));
+	if (pinned_pool == NULL)
+		GOTO_FAIL("%s: pool creation failed\n", __func__);
+
+	if (rte_pktmbuf_alloc_bulk(pinned_pool, mbufs, EXT_PINNED_NB_MBUF))
+		GOTO_FAIL("%s: bulk allocation failed\n", __func__);
+	for (i = 0; i < EXT_PINNED_NB_MBUF; i++) {
+		m = mbufs[i];
+		for (z = 0; z < RTE_DIM(ext_mem); z++)
+			if ((char *)m->buf_addr >= (char *)ext_mem[z].buf_ptr &&
+					(char *)m->buf_addr + m->buf_len <=
+					(char *)ext_mem[z].buf_ptr + zone_len)
+				break;
+		if (z == RTE_DIM(ext_mem))
+			GOTO_FAIL("%s: buffer not in the zones\n", __func__);
+		if (m->ol_flags != EXT_ATTACHED_MBUF ||
+				!RTE_MBUF_HAS_PINNED_EXTBUF(m) ||
+				m->buf_len != EXT_PINNED_ELT_SIZE ||
+				m->data_off != RTE_PKTMBUF_HEADROOM)
+			GOTO_FAIL("%s: bad mbuf fields\n", __func__);
+	}
+	m = NULL;
+	rte_pktmbuf_free_bulk(mbufs, EXT_PINNED_NB_MBUF);
+	if (!rte_mempool_full(pinned_pool))
+		GOTO_FAIL("%s: mbufs not returned to the pool\n", __func__);
+
+	m = rte_pktmbuf_alloc(pinned_pool);
+	if (m == NULL || m->ol_flags != EXT_ATTACHED_MBUF)
+		GOTO_FAIL("%s: allocation failed\n", __func__);
+	data = rte_pktmbuf_append(m, MBUF_TEST_DATA_LEN);
+	if (data == NULL)
+		GOTO_FAIL("%s: cannot append data\n", __func__);
+	memset(data, 0xcc, MBUF_TEST_DATA_LEN);
+
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("%s: cannot clone mbuf\n", __func__);
+	if (rte_pktmbuf_mtod(clone, char *) != data ||
+			rte_mbuf_ext_refcnt_read(m->shinfo) != 2)
+		GOTO_FAIL("%s: clone not attached to the buffer\n", __func__);
+
+	/* the mbuf waits for the clone before going back to its pool */
+	rte_pktmbuf_free(m);
+	if (rte_mempool_avail_count(pinned_pool) != EXT_PINNED_NB_MBUF - 1)
+		GOTO_FAIL("%s: mbuf freed with its buffer in use\n", __func__);
+	if (memcmp(rte_pktmbuf_mtod(clone, char *), data,
+			MBUF_TEST_DATA_LEN) != 0 || data[0] != (char)0xcc)
+		GOTO_FAIL("%s: bad clone data\n", __func__);
+	m = NULL;
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	if (!rte_mempool_full(pinned_pool))
+		GOTO_FAIL("%s: mbuf not returned with its clone\n", __func__);
+
+	/* freeing the clone first returns the mbuf when it is freed */
+	m = rte_pktmbuf_alloc(pinned_pool);
+	if (m == NULL)
+		GOTO_FAIL("%s: allocation failed\n", __func__);
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("%s: cannot clone mbuf\n", __func__);
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	if (rte_mbuf_ext_refcnt_read(m->shinfo) != 1 ||
+			m->ol_flags != EXT_ATTACHED_MBUF)
+		GOTO_FAIL("%s: buffer not released by the clone\n", __func__);
+	rte_pktmbuf_free(m);
+	m = NULL;
+	if (!rte_mempool_full(pinned_pool))
+		GOTO_FAIL("%s: mbuf not returned to the pool\n", __func__);
+
+	rte_mempool_free(pinned_pool);
+	for (z = 0; z < RTE_DIM(ext_mem); z++)
+		rte_free(ext_mem[z].buf_ptr);
+	return 0;
+
+fail:
+	rte_pktmbuf_free(clone);
+	rte_pktmbuf_free(m);
+	rte_mempool_free(pinned_pool);
+	for (z = 0; z < RTE_DIM(ext_mem); z++)
+		rte_free(ext_mem[z].buf_ptr);
+	return -1;
+}
+
 static int
 test_mbuf_dyn(struct rte_mempool *pktmbuf_pool)
 {
@@ -2598,6 +2825,11 @@ test_mbuf(void)
 	}
 
 	/* test bulk mbuf alloc and free */
+	if (test_pktmbuf_bulk_multi_pool() < 0) {
+		printf("test_pktmbuf_bulk_multi_pool() failed\n");
+		goto err;
+	}
+
 	if (test_pktmbuf_pool_bulk() < 0) {
 		printf("test_pktmbuf_pool_bulk() failed\n");
 		goto err;
@@ -2732,6 +2964,12 @@ test_mbuf(void)
 		goto err;
 	}
 
+	/* test the mbufs of a pool with pinned external buffers */
+	if (test_pktmbuf_ext_pinned_buffer(pktmbuf_pool) < 0) {
+		printf("test_pktmbuf_ext_pinned_buffer() failed\n");
+		goto err;
+	}
+
 	ret = 0;
 err:
 	rte_mempool_free(pktmbuf_pool);
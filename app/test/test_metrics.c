@@ -7,6 +7,8 @@
 #include <stdint.h>
 #include <errno.h>
 
+#include <rte_common.h>
+#include <rte_launch.h>
 #include <rte_lcore.h>
 #include <rte_metrics.h>
 
@@ -16,6 +18,7 @@
 #define	METRIC_LESSER_COUNT	3
 #define	KEY	1
 #define	VALUE	1
+#define	RTE_METRICS_MAX_METRICS_TEST	256
 
 /* Initializes metric module. This function must be called
  * from a primary process before metrics are used
@@ -271,6 +274,91 @@ test_metrics_get_values(void)
 	return TEST_SUCCESS;
 }
 
+static int
+test_metrics_update_shard(void *arg)
+{
+	const uint64_t value[2] = {1, 2};
+	int key = *(int *)arg;
+
+	if (rte_metrics_update_shard_values(RTE_METRICS_GLOBAL, key,
+			value, 2) < 0)
+		return -1;
+	return rte_metrics_update_shard_values(0, key + 1, &value[1], 1);
+}
+
+/* Test to validate the sharded metric sets */
+static int
+test_metrics_sharded(void)
+{
+	const char * const mnames[] = {"shard_pkts", "shard_bytes"};
+	struct rte_metric_value getvalues[RTE_METRICS_MAX_METRICS_TEST];
+	const uint64_t value[2] = {10, 20};
+	unsigned int lcore_id, nb_lcores = 1;
+	int err, key, plain_key;
+
+	key = rte_metrics_reg_names_sharded(&mnames[0], RTE_DIM(mnames));
+	TEST_ASSERT(key >= 0, "%s, %d", __func__, __LINE__);
+
+	/* Failure Test: invalid names */
+	err = rte_metrics_reg_names_sharded(NULL, RTE_DIM(mnames));
+	TEST_ASSERT(err == -EINVAL, "%s, %d", __func__, __LINE__);
+
+	/* Successful Test: global and port values of the local shard */
+	err = rte_metrics_update_shard_values(RTE_METRICS_GLOBAL, key,
+			value, 2);
+	TEST_ASSERT(err == 0, "%s, %d", __func__, __LINE__);
+	err = rte_metrics_update_shard_values(0, key + 1, &value[1], 1);
+	TEST_ASSERT(err == 0, "%s, %d", __func__, __LINE__);
+	/* stores replace the previous values of the shard */
+	err = rte_metrics_update_shard_values(0, key + 1, &value[1], 1);
+	TEST_ASSERT(err == 0, "%s, %d", __func__, __LINE__);
+
+	/* Failure Test: update across the set border */
+	err = rte_metrics_update_shard_values(0, key + 1, value, 2);
+	TEST_ASSERT(err == -ERANGE, "%s, %d", __func__, __LINE__);
+
+	/* Failure Test: invalid port_id */
+	err = rte_metrics_update_shard_values(-2, key, value, 1);
+	TEST_ASSERT(err == -EINVAL, "%s, %d", __func__, __LINE__);
+
+	/* Failure Test: metric which is not sharded */
+	plain_key = rte_metrics_reg_name("plain_pkts");
+	TEST_ASSERT(plain_key >= 0, "%s, %d", __func__, __LINE__);
+	err = rte_metrics_update_shard_values(0, plain_key, value, 1);
+	TEST_ASSERT(err == -EINVAL, "%s, %d", __func__, __LINE__);
+
+	/* the shards of the other lcores are summed */
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		rte_eal_remote_launch(test_metrics_update_shard, &key,
+				lcore_id);
+		TEST_ASSERT(rte_eal_wait_lcore(lcore_id) == 0, "%s, %d",
+			    __func__, __LINE__);
+		nb_lcores++;
+	}
+
+	err = rte_metrics_get_values(RTE_METRICS_GLOBAL, getvalues,
+			RTE_DIM(getvalues));
+	TEST_ASSERT(err > key + 1, "%s, %d", __func__, __LINE__);
+	TEST_ASSERT(getvalues[key].value == 10 + (nb_lcores - 1) * 1 &&
+		    getvalues[key + 1].value == 20 + (nb_lcores - 1) * 2,
+		    "%s, %d", __func__, __LINE__);
+
+	err = rte_metrics_get_values(0, getvalues, RTE_DIM(getvalues));
+	TEST_ASSERT(err > key + 1, "%s, %d", __func__, __LINE__);
+	TEST_ASSERT(getvalues[key].value == 0 &&
+		    getvalues[key + 1].value == 20 + (nb_lcores - 1) * 2,
+		    "%s, %d", __func__, __LINE__);
+
+	/* the value set by rte_metrics_update_values is added */
+	err = rte_metrics_update_value(0, key, 5);
+	TEST_ASSERT(err == 0, "%s, %d", __func__, __LINE__);
+	err = rte_metrics_get_values(0, getvalues, RTE_DIM(getvalues));
+	TEST_ASSERT(err > key && getvalues[key].value == 5,
+		    "%s, %d", __func__, __LINE__);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite metrics_testsuite  = {
 	.suite_name = "Metrics Unit Test Suite",
 	.setup = NULL,
@@ -313,7 +401,12 @@ static struct unit_test_suite metrics_testsuite  = {
 		 */
 		TEST_CASE(test_metrics_get_values),
 
-		/* TEST CASE 8: Test to unregister metrics*/
+		/* TEST CASE 8: Test to update sharded metrics from several
+		 * lcores and get their sum
+		 */
+		TEST_CASE(test_metrics_sharded),
+
+		/* TEST CASE 9: Test to unregister metrics*/
 		TEST_CASE(test_metrics_deinitialize),
 
 		TEST_CASES_END()
@@ -8,6 +8,9 @@
 
 #include <rte_ethdev_driver.h>
 #include <rte_pdump.h>
+#ifdef RTE_LIBRTE_BPF
+#include <rte_bpf.h>
+#endif
 #include "rte_eal.h"
 #include "rte_lcore.h"
 #include "rte_mempool.h"
@@ -44,6 +47,118 @@ test_pdump_init(void)
 	return ret;
 }
 
+#ifdef RTE_LIBRTE_BPF
+static uint32_t test_pdump_accept = 1;
+
+/*
+ * BPF filter returning the value of a variable, so that the primary has
+ * to relocate the variable address to its own copy.
+ */
+static void
+test_pdump_filter_prm(struct rte_bpf_prm *prm, struct ebpf_insn *ins,
+		      struct rte_bpf_xsym *xsym, enum rte_bpf_arg_type arg_type)
+{
+	uint64_t addr = (uintptr_t)&test_pdump_accept;
+
+	memset(ins, 0, 4 * sizeof(*ins));
+	ins[0].code = (BPF_LD | BPF_IMM | EBPF_DW);
+	ins[0].dst_reg = EBPF_REG_2;
+	ins[0].imm = (uint32_t)addr;
+	ins[1].imm = (uint32_t)(addr >> 32);
+	ins[2].code = (BPF_LDX | BPF_MEM | BPF_W);
+	ins[2].dst_reg = EBPF_REG_0;
+	ins[2].src_reg = EBPF_REG_2;
+	ins[3].code = (BPF_JMP | EBPF_EXIT);
+
+	memset(xsym, 0, sizeof(*xsym));
+	xsym->name = "accept";
+	xsym->type = RTE_BPF_XTYPE_VAR;
+	xsym->var.val = &test_pdump_accept;
+	xsym->var.desc.type = RTE_BPF_ARG_PTR;
+	xsym->var.desc.size = sizeof(test_pdump_accept);
+
+	memset(prm, 0, sizeof(*prm));
+	prm->ins = ins;
+	prm->nb_ins = 4;
+	prm->xsym = xsym;
+	prm->nb_xsym = 1;
+	prm->prog_arg.type = arg_type;
+	prm->prog_arg.size = sizeof(struct rte_mbuf);
+	prm->prog_arg.buf_size = RTE_MBUF_DEFAULT_BUF_SIZE;
+}
+#endif
+
+static int
+run_pdump_params_tests(char *deviceid, struct rte_ring *ring_client,
+		       struct rte_mempool *mp)
+{
+	struct rte_pdump_params params = {
+		.snaplen = 64,
+		.sample_rate = 4,
+	};
+	int flags = RTE_PDUMP_FLAG_RXTX, ret;
+
+	printf("\n***** snaplen = 64, sample_rate = 4 *****\n");
+	ret = rte_pdump_enable_params(portid, QUEUE_ID, flags, ring_client,
+				      mp, &params);
+	if (ret < 0) {
+		printf("rte_pdump_enable_params failed\n");
+		return -1;
+	}
+	ret = rte_pdump_disable(portid, QUEUE_ID, flags);
+	if (ret < 0) {
+		printf("rte_pdump_disable failed\n");
+		return -1;
+	}
+	printf("pdump_enable_params success\n");
+
+#ifdef RTE_LIBRTE_BPF
+	struct rte_bpf_prm prm;
+	struct ebpf_insn ins[4];
+	struct rte_bpf_xsym xsym;
+	int i;
+
+	printf("\n***** BPF filter *****\n");
+	params.prm = &prm;
+	test_pdump_filter_prm(&prm, ins, &xsym, RTE_BPF_ARG_RAW);
+	ret = rte_pdump_enable_by_deviceid_params(deviceid, QUEUE_ID, flags,
+						  ring_client, mp, &params);
+	if (ret == 0) {
+		printf("filter with non mbuf argument was accepted\n");
+		return -1;
+	}
+
+	test_pdump_filter_prm(&prm, ins, &xsym, RTE_BPF_ARG_PTR_MBUF);
+	xsym.type = RTE_BPF_XTYPE_FUNC;
+	ret = rte_pdump_enable_by_deviceid_params(deviceid, QUEUE_ID, flags,
+						  ring_client, mp, &params);
+	if (ret == 0) {
+		printf("filter with function symbol was accepted\n");
+		return -1;
+	}
+
+	/* enable twice to replace the filter of a disabled capture */
+	test_pdump_filter_prm(&prm, ins, &xsym, RTE_BPF_ARG_PTR_MBUF);
+	for (i = 0; i < 2; i++) {
+		ret = rte_pdump_enable_by_deviceid_params(deviceid, QUEUE_ID,
+						flags, ring_client, mp, &params);
+		if (ret < 0) {
+			printf("rte_pdump_enable_by_deviceid_params failed\n");
+			return -1;
+		}
+		ret = rte_pdump_disable_by_deviceid(deviceid, QUEUE_ID, flags);
+		if (ret < 0) {
+			printf("rte_pdump_disable_by_deviceid failed\n");
+			return -1;
+		}
+	}
+	printf("pdump_enable_by_deviceid_params with filter success\n");
+#else
+	RTE_SET_USED(deviceid);
+#endif
+	return 0;
+}
+
 int
 run_pdump_client_tests(void)
 {
@@ -116,6 +231,7 @@ run_pdump_client_tests(void)
 			printf("\n***** flags = RTE_PDUMP_FLAG_RXTX *****\n");
 		}
 	}
+	ret = run_pdump_params_tests(deviceid, ring_client, mp);
 	if (ring_client != NULL)
 		test_ring_free(ring_client);
 	if (mp != NULL)
@@ -9,6 +9,8 @@
 #include <rte_eth_ring.h>
 #include <rte_ethdev.h>
 #include <rte_bus_vdev.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 
 #define SOCKET0 0
 #define RING_SIZE 256
@@ -554,6 +556,300 @@ test_stats_reset_for_port(void)
 	return TEST_SUCCESS;
 }
 
+#ifdef RTE_ETHDEV_RXTX_CALLBACKS
+static unsigned int rx_calls;
+
+/* record the order of the calls in rx_calls, drop the last packet */
+static uint16_t
+test_rx_callback(uint16_t port_id __rte_unused, uint16_t queue __rte_unused,
+		struct rte_mbuf *pkts[] __rte_unused, uint16_t nb_pkts,
+		uint16_t max_pkts __rte_unused, void *user_param)
+{
+	rx_calls = rx_calls * 10 + (uintptr_t)user_param;
+	return nb_pkts - 1;
+}
+
+static uint16_t
+test_tx_callback(uint16_t port_id __rte_unused, uint16_t queue __rte_unused,
+		struct rte_mbuf *pkts[] __rte_unused, uint16_t nb_pkts,
+		void *user_param)
+{
+	unsigned int *calls = user_param;
+
+	(*calls)++;
+	return nb_pkts;
+}
+
+static int
+test_rxtx_callbacks(void)
+{
+	struct rte_mbuf  bufs[RING_SIZE];
+	struct rte_mbuf *pbufs[RING_SIZE];
+	const struct rte_eth_rxtx_callback *rx_cb[2], *tx_cb;
+	struct rte_eth_queue_cb_stats stats;
+	unsigned int tx_calls = 0;
+	struct rte_rcu_qsbr *v;
+	uint64_t tsc;
+	int i;
+
+	printf("Testing RX/TX callbacks and inline operations\n");
+
+	memset(bufs, 0, sizeof(bufs));
+	for (i = 0; i < RING_SIZE/2; i++)
+		pbufs[i] = &bufs[i];
+	pbufs[1]->ol_flags = PKT_RX_TIMESTAMP;
+	pbufs[1]->timestamp = 1;
+
+	/* removing a disabled operation fails */
+	TEST_ASSERT(rte_eth_remove_rx_inline(rx_portb, 0,
+			RTE_ETH_CB_INLINE_COUNT) == -EINVAL,
+			"removed a disabled operation");
+	TEST_ASSERT(rte_eth_add_tx_inline(tx_porta, 0,
+			RTE_ETH_CB_INLINE_TIMESTAMP) == -EINVAL,
+			"enabled timestamps on TX");
+
+	tx_cb = rte_eth_add_tx_callback(tx_porta, 0, test_tx_callback,
+			&tx_calls);
+	TEST_ASSERT_NOT_NULL(tx_cb, "cannot add TX callback");
+	TEST_ASSERT_SUCCESS(rte_eth_add_tx_inline(tx_porta, 0,
+			RTE_ETH_CB_INLINE_COUNT), "cannot enable TX count");
+
+	/* second callback added first, the order of the calls is 2, 1 */
+	rx_calls = 0;
+	rx_cb[0] = rte_eth_add_rx_callback(rx_portb, 0, test_rx_callback,
+			(void *)1);
+	rx_cb[1] = rte_eth_add_first_rx_callback(rx_portb, 0,
+			test_rx_callback, (void *)2);
+	TEST_ASSERT(rx_cb[0] != NULL && rx_cb[1] != NULL,
+			"cannot add RX callbacks");
+	TEST_ASSERT_SUCCESS(rte_eth_add_rx_inline(rx_portb, 0,
+			RTE_ETH_CB_INLINE_COUNT | RTE_ETH_CB_INLINE_TIMESTAMP),
+			"cannot enable RX operations");
+	TEST_ASSERT_SUCCESS(rte_eth_add_rx_inline(rx_portb, 0,
+			RTE_ETH_CB_INLINE_COUNT), "cannot enable RX count");
+
+	tsc = rte_rdtsc();
+	TEST_ASSERT(rte_eth_tx_burst(tx_porta, 0, pbufs, RING_SIZE/2) ==
+			RING_SIZE/2, "failed to transmit packet burst");
+	TEST_ASSERT(rte_eth_rx_burst(rx_portb, 0, pbufs, RING_SIZE) ==
+			RING_SIZE/2 - 2, "RX callbacks did not drop packets");
+	TEST_ASSERT(tx_calls == 1, "TX callback not called");
+	TEST_ASSERT(rx_calls == 21, "RX callbacks not called in order");
+	TEST_ASSERT(bufs[0].timestamp >= tsc &&
+			(bufs[0].ol_flags & PKT_RX_TIMESTAMP) != 0,
+			"packet not timestamped");
+	TEST_ASSERT(bufs[1].timestamp == 1, "timestamp overwritten");
+
+	TEST_ASSERT_SUCCESS(rte_eth_tx_inline_stats_get(tx_porta, 0, &stats),
+			"cannot get TX stats");
+	TEST_ASSERT(stats.pkts == RING_SIZE/2 && stats.bursts == 1,
+			"wrong TX stats");
+	TEST_ASSERT_SUCCESS(rte_eth_rx_inline_stats_get(rx_portb, 0, &stats),
+			"cannot get RX stats");
+	TEST_ASSERT(stats.pkts == RING_SIZE/2 && stats.bursts == 1,
+			"wrong RX stats");
+
+	/* free the replaced arrays immediately, no reader is registered */
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(1), RTE_CACHE_LINE_SIZE);
+	TEST_ASSERT_NOT_NULL(v, "cannot allocate QSBR variable");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_init(v, 1), "cannot init QSBR");
+	TEST_ASSERT_SUCCESS(rte_eth_rxtx_callbacks_rcu_set(rx_portb, v),
+			"cannot set QSBR variable");
+
+	/* count stays enabled once, timestamps are disabled */
+	TEST_ASSERT_SUCCESS(rte_eth_remove_rx_inline(rx_portb, 0,
+			RTE_ETH_CB_INLINE_COUNT | RTE_ETH_CB_INLINE_TIMESTAMP),
+			"cannot disable RX operations");
+	TEST_ASSERT_SUCCESS(rte_eth_remove_rx_callback(rx_portb, 0, rx_cb[1]),
+			"cannot remove RX callback");
+	TEST_ASSERT_SUCCESS(rte_eth_remove_tx_callback(tx_porta, 0, tx_cb),
+			"cannot remove TX callback");
+
+	bufs[0].ol_flags = 0;
+	bufs[0].timestamp = 0;
+	for (i = 0; i < RING_SIZE/2; i++)
+		pbufs[i] = &bufs[i];
+	TEST_ASSERT(rte_eth_tx_burst(tx_porta, 0, pbufs, RING_SIZE/2) ==
+			RING_SIZE/2, "failed to transmit packet burst");
+	TEST_ASSERT(rte_eth_rx_burst(rx_portb, 0, pbufs, RING_SIZE) ==
+			RING_SIZE/2 - 1, "RX callback did not drop a packet");
+	TEST_ASSERT(tx_calls == 1, "removed TX callback called");
+	TEST_ASSERT(rx_calls == 211, "removed RX callback called");
+	TEST_ASSERT(bufs[0].timestamp == 0, "packet timestamped");
+	TEST_ASSERT_SUCCESS(rte_eth_rx_inline_stats_get(rx_portb, 0, &stats),
+			"cannot get RX stats");
+	TEST_ASSERT(stats.pkts == RING_SIZE && stats.bursts == 2,
+			"wrong RX stats");
+
+	TEST_ASSERT_SUCCESS(rte_eth_remove_rx_callback(rx_portb, 0, rx_cb[0]),
+			"cannot remove RX callback");
+	TEST_ASSERT(rte_eth_rx_burst(rx_portb, 0, pbufs, RING_SIZE) == 0,
+			"packets left in the ring");
+
+	TEST_ASSERT_SUCCESS(rte_eth_remove_rx_inline(rx_portb, 0,
+			RTE_ETH_CB_INLINE_COUNT), "cannot disable RX count");
+	TEST_ASSERT_SUCCESS(rte_eth_remove_tx_inline(tx_porta, 0,
+			RTE_ETH_CB_INLINE_COUNT), "cannot disable TX count");
+	TEST_ASSERT_SUCCESS(rte_eth_rxtx_callbacks_rcu_set(rx_portb, NULL),
+			"cannot reset QSBR variable");
+	rte_free(v);
+	rte_free((void *)(uintptr_t)rx_cb[0]);
+	rte_free((void *)(uintptr_t)rx_cb[1]);
+	rte_free((void *)(uintptr_t)tx_cb);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_rxtx_callbacks_retired(void)
+{
+	const struct rte_eth_rxtx_callback *cb;
+	struct rte_rcu_qsbr *v;
+	int i;
+
+	printf("Testing the limit of the retired callback arrays\n");
+
+	/* without QSBR variable, the replaced arrays are kept */
+	for (i = 0; i <= RTE_ETH_CB_RETIRED_MAX; i++) {
+		cb = rte_eth_add_rx_callback(rx_portb, 0, test_rx_callback,
+				(void *)1);
+		if (cb == NULL)
+			break;
+		TEST_ASSERT_SUCCESS(rte_eth_remove_rx_callback(rx_portb, 0, cb),
+				"cannot remove RX callback");
+		rte_free((void *)(uintptr_t)cb);
+	}
+	TEST_ASSERT(i <= RTE_ETH_CB_RETIRED_MAX && rte_errno == ENOSPC,
+			"retired arrays not limited");
+	TEST_ASSERT(rte_eth_add_rx_inline(rx_portb, 0,
+			RTE_ETH_CB_INLINE_COUNT) == -ENOSPC,
+			"enabled RX count over the limit");
+
+	/* the kept arrays are freed once a QSBR variable is set */
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(1), RTE_CACHE_LINE_SIZE);
+	TEST_ASSERT_NOT_NULL(v, "cannot allocate QSBR variable");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_init(v, 1), "cannot init QSBR");
+	TEST_ASSERT_SUCCESS(rte_eth_rxtx_callbacks_rcu_set(rx_portb, v),
+			"cannot set QSBR variable");
+	for (i = 0; i < 2 * RTE_ETH_CB_RETIRED_MAX; i++) {
+		cb = rte_eth_add_rx_callback(rx_portb, 0, test_rx_callback,
+				(void *)1);
+		TEST_ASSERT_NOT_NULL(cb, "cannot add RX callback");
+		TEST_ASSERT_SUCCESS(rte_eth_remove_rx_callback(rx_portb, 0, cb),
+				"cannot remove RX callback");
+		rte_free((void *)(uintptr_t)cb);
+	}
+
+	TEST_ASSERT_SUCCESS(rte_eth_rxtx_callbacks_rcu_set(rx_portb, NULL),
+			"cannot reset QSBR variable");
+	rte_free(v);
+
+	return TEST_SUCCESS;
+}
+#else
+static int
+test_rxtx_callbacks(void)
+{
+	printf("RX/TX callbacks not supported, skipping test\n");
+	return TEST_SKIPPED;
+}
+
+static int
+test_rxtx_callbacks_retired(void)
+{
+	printf("RX/TX callbacks not supported, skipping test\n");
+	return TEST_SKIPPED;
+}
+#endif
+
+static uint64_t
+test_tsc_to_ns(uint64_t tsc)
+{
+	return (uint64_t)((double)tsc * NS_PER_S / rte_get_tsc_hz());
+}
+
+static int
+test_rx_timestamp(void)
+{
+	struct rte_mbuf  bufs[RING_SIZE];
+	struct rte_mbuf *pbufs[RING_SIZE];
+	struct rte_eth_clock_corr corr;
+	uint64_t ns[RING_SIZE];
+	uint64_t start, end, ticks;
+	int i, mode;
+
+	printf("Testing RX timestamps conversion\n");
+
+	memset(bufs, 0, sizeof(bufs));
+	for (i = 0; i < RING_SIZE/2; i++)
+		pbufs[i] = &bufs[i];
+
+	TEST_ASSERT(rte_eth_clock_corr_get(rx_portb, &corr) == -EINVAL,
+			"got correlation of a disabled port");
+	mode = rte_eth_rx_timestamp_enable(rx_portb);
+	if (mode == -ENOTSUP) {
+		printf("RX timestamps not supported, skipping test\n");
+		return TEST_SKIPPED;
+	}
+	/* the ring PMD has no clock, packets are timestamped by software */
+	TEST_ASSERT(mode == RTE_ETH_RX_TIMESTAMP_SW,
+			"wrong timestamp mode %d", mode);
+	TEST_ASSERT(rte_eth_rx_timestamp_enable(rx_portb) == -EBUSY,
+			"timestamps enabled twice");
+	TEST_ASSERT_SUCCESS(rte_eth_clock_sync(rx_portb), "cannot sync clock");
+	TEST_ASSERT_SUCCESS(rte_eth_clock_corr_get(rx_portb, &corr),
+			"cannot get correlation");
+	TEST_ASSERT(corr.mode == RTE_ETH_RX_TIMESTAMP_SW &&
+			corr.clock == corr.tsc &&
+			corr.clock_hz == rte_get_tsc_hz(),
+			"wrong correlation");
+
+	TEST_ASSERT(rte_eth_tx_burst(tx_porta, 0, pbufs, RING_SIZE/2) ==
+			RING_SIZE/2, "failed to transmit packet burst");
+	/* the last packet has no timestamp */
+	bufs[RING_SIZE/2 - 1].ol_flags = 0;
+	start = rte_rdtsc();
+	TEST_ASSERT(rte_eth_rx_burst(rx_portb, 0, pbufs, RING_SIZE) ==
+			RING_SIZE/2, "failed to receive packet burst");
+	end = rte_rdtsc();
+	bufs[RING_SIZE/2 - 1].ol_flags = 0;
+
+	TEST_ASSERT(rte_eth_rx_timestamp_to_ns(&corr, pbufs, RING_SIZE/2, ns) ==
+			RING_SIZE/2 - 1, "wrong number of timestamps");
+	for (i = 0; i < RING_SIZE/2 - 1; i++)
+		TEST_ASSERT(ns[i] + 1 >= test_tsc_to_ns(start) &&
+				ns[i] <= test_tsc_to_ns(end) + 1,
+				"wrong timestamp %d", i);
+	TEST_ASSERT(ns[RING_SIZE/2 - 1] == 0, "timestamp without flag");
+
+	/* conversions before the correlation and far from it */
+	ticks = (uint64_t)rte_get_tsc_hz() * 10;
+	TEST_ASSERT(rte_eth_clock_to_ns(&corr, corr.clock + ticks) ==
+			corr.ns + UINT64_C(10) * NS_PER_S, "wrong conversion of 10 s");
+	TEST_ASSERT(rte_eth_clock_to_ns(&corr, corr.clock - ticks) ==
+			corr.ns - UINT64_C(10) * NS_PER_S, "wrong conversion of -10 s");
+	ticks = rte_get_tsc_hz() / 1000;
+	i = rte_eth_clock_to_ns(&corr, corr.clock + ticks) - corr.ns;
+	TEST_ASSERT(i >= 999999 && i <= 1000001, "wrong conversion of 1 ms");
+
+	TEST_ASSERT_SUCCESS(rte_eth_rx_timestamp_disable(rx_portb),
+			"cannot disable timestamps");
+	TEST_ASSERT(rte_eth_rx_timestamp_disable(rx_portb) == -EINVAL,
+			"timestamps disabled twice");
+
+	memset(bufs, 0, sizeof(bufs));
+	for (i = 0; i < RING_SIZE/2; i++)
+		pbufs[i] = &bufs[i];
+	TEST_ASSERT(rte_eth_tx_burst(tx_porta, 0, pbufs, RING_SIZE/2) ==
+			RING_SIZE/2, "failed to transmit packet burst");
+	TEST_ASSERT(rte_eth_rx_burst(rx_portb, 0, pbufs, RING_SIZE) ==
+			RING_SIZE/2, "failed to receive packet burst");
+	TEST_ASSERT((bufs[0].ol_flags & PKT_RX_TIMESTAMP) == 0,
+			"packet timestamped after disable");
+
+	return TEST_SUCCESS;
+}
+
 static struct
 unit_test_suite test_pmd_ring_suite  = {
 	.setup = test_pmd_ringcreate_setup,
@@ -564,6 +860,9 @@ unit_test_suite test_pmd_ring_suite  = {
 		TEST_CASE(test_send_basic_packets),
 		TEST_CASE(test_get_stats_for_port),
 		TEST_CASE(test_stats_reset_for_port),
+		TEST_CASE(test_rxtx_callbacks),
+		TEST_CASE(test_rxtx_callbacks_retired),
+		TEST_CASE(test_rx_timestamp),
 		TEST_CASE(test_pmd_ring_pair_create_attach),
 		TEST_CASE(test_command_line_ring_port),
 		TEST_CASES_END()
@@ -11,7 +11,9 @@
 #include <rte_mbuf.h>
 #include <rte_reorder.h>
 #include <rte_lcore.h>
+#include <rte_launch.h>
 #include <rte_malloc.h>
+#include <rte_pause.h>
 
 #include "test.h"
 
@@ -330,6 +332,268 @@ test_reorder_drain(void)
 	return ret;
 }
 
+static int
+test_reorder_mp_insert_drain(void)
+{
+	struct rte_reorder_mp_params params = {
+		.size = 8,
+		.first_seqn = 10,
+		.gap_timeout_ns = RTE_REORDER_MP_NO_TIMEOUT,
+	};
+	struct rte_reorder_buffer *b;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int num_bufs = 8;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	unsigned int i, cnt;
+	int ret = -1;
+
+	params.size = 6;
+	b = rte_reorder_mp_create("test_mp", rte_socket_id(), &params);
+	TEST_ASSERT((b == NULL) && (rte_errno == EINVAL),
+			"No error on create with invalid size");
+	params.size = 8;
+
+	b = rte_reorder_mp_create("test_mp", rte_socket_id(), &params);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+	}
+
+	if (rte_reorder_insert(b, bufs[0]) != -1 || rte_errno != EINVAL) {
+		printf("%s:%d: legacy insert accepted\n", __func__, __LINE__);
+		goto exit;
+	}
+
+	/* 11 and 13 wait for 10 */
+	if (rte_reorder_mp_insert(b, bufs[1], 11) != 0 ||
+			rte_reorder_mp_insert(b, bufs[3], 13) != 0) {
+		printf("%s:%d: insert failed\n", __func__, __LINE__);
+		goto exit;
+	}
+	cnt = rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d: drained %u packets before 10\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+
+	/* 18 is out of the window [10, 18) */
+	if (rte_reorder_mp_insert(b, bufs[7], 18) != -1 ||
+			rte_errno != ENOSPC) {
+		printf("%s:%d: no error on early insert\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+	if (rte_reorder_mp_insert(b, bufs[7], 11) != -1 ||
+			rte_errno != EEXIST) {
+		printf("%s:%d: no error on duplicate insert\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+
+	/* 10 releases 11, 13 still waits for 12 */
+	if (rte_reorder_mp_insert(b, bufs[0], 10) != 0) {
+		printf("%s:%d: insert failed\n", __func__, __LINE__);
+		goto exit;
+	}
+	cnt = rte_reorder_mp_drain_burst(b, robufs, 1);
+	cnt += rte_reorder_mp_drain_burst(b, robufs + 1, num_bufs - 1);
+	if (cnt != 2 || robufs[0] != bufs[0] || robufs[1] != bufs[1]) {
+		printf("%s:%d: drained %u packets, expected 10 and 11\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	bufs[0] = bufs[1] = NULL;
+
+	/* 11 was already drained */
+	if (rte_reorder_mp_insert(b, bufs[7], 11) != -1 ||
+			rte_errno != ERANGE) {
+		printf("%s:%d: no error on late insert\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+
+	/* the window moved to [12, 20) */
+	if (rte_reorder_mp_insert(b, bufs[2], 12) != 0 ||
+			rte_reorder_mp_insert(b, bufs[7], 19) != 0) {
+		printf("%s:%d: insert failed\n", __func__, __LINE__);
+		goto exit;
+	}
+	cnt = rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	if (cnt != 2 || robufs[0] != bufs[2] || robufs[1] != bufs[3]) {
+		printf("%s:%d: drained %u packets, expected 12 and 13\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	bufs[2] = bufs[3] = bufs[7] = NULL;
+
+	/* 19 is freed with the buffer */
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++)
+		rte_pktmbuf_free(bufs[i]);
+	return ret;
+}
+
+static int
+test_reorder_mp_gap_timeout(void)
+{
+	struct rte_reorder_mp_params params = {
+		.size = 8,
+		.first_seqn = 0,
+		.gap_timeout_ns = 1000 * 1000,
+	};
+	struct rte_reorder_buffer *b;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int num_bufs = 4;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	unsigned int i, cnt;
+	int ret = -1;
+
+	b = rte_reorder_mp_create("test_mp_gap", rte_socket_id(), &params);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+	}
+
+	/* 1 waits for 0 until the timeout expires */
+	if (rte_reorder_mp_insert(b, bufs[1], 1) != 0) {
+		printf("%s:%d: insert failed\n", __func__, __LINE__);
+		goto exit;
+	}
+	cnt = rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	if (cnt != 0) {
+		printf("%s:%d: drained %u packets before the timeout\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	rte_delay_ms(2);
+	cnt = rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	if (cnt != 1 || robufs[0] != bufs[1]) {
+		printf("%s:%d: drained %u packets, expected 1\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	bufs[1] = NULL;
+
+	/* 0 was skipped */
+	if (rte_reorder_mp_insert(b, bufs[0], 0) != -1 ||
+			rte_errno != ERANGE) {
+		printf("%s:%d: no error on skipped insert\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+
+	/* a gap is not skipped while no packet waits behind it */
+	cnt = rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	rte_delay_ms(2);
+	cnt += rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	if (cnt != 0 || rte_reorder_mp_insert(b, bufs[2], 2) != 0) {
+		printf("%s:%d: skipped a gap with nothing behind\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+	cnt = rte_reorder_mp_drain_burst(b, robufs, num_bufs);
+	if (cnt != 1 || robufs[0] != bufs[2]) {
+		printf("%s:%d: drained %u packets, expected 2\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	bufs[2] = NULL;
+
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++)
+		rte_pktmbuf_free(bufs[i]);
+	return ret;
+}
+
+#define MP_NUM_PKTS 4096
+
+static struct rte_mbuf *mp_bufs[MP_NUM_PKTS];
+static unsigned int mp_num_workers;
+static unsigned int mp_worker_idx;
+
+/* inserts the packets whose sequence number maps to this worker */
+static int
+reorder_mp_worker(void *arg)
+{
+	struct rte_reorder_buffer *b = arg;
+	const unsigned int id = __atomic_fetch_add(&mp_worker_idx, 1,
+			__ATOMIC_RELAXED);
+	unsigned int seqn;
+
+	for (seqn = id; seqn < MP_NUM_PKTS; seqn += mp_num_workers) {
+		while (rte_reorder_mp_insert(b, mp_bufs[seqn], seqn) != 0) {
+			if (rte_errno != ENOSPC)
+				return -1;
+			rte_pause();
+		}
+	}
+	return 0;
+}
+
+static int
+test_reorder_mp_concurrent(void)
+{
+	struct rte_reorder_mp_params params = {
+		.size = 64,
+		.first_seqn = 0,
+		.gap_timeout_ns = RTE_REORDER_MP_NO_TIMEOUT,
+	};
+	struct rte_reorder_buffer *b;
+	struct rte_mbuf *robufs[BURST];
+	unsigned int i, cnt, next = 0;
+	unsigned int lcore_id;
+	int ret = 0;
+	int done;
+
+	if (rte_lcore_count() < 2) {
+		printf("%s: not enough lcores, skipping\n", __func__);
+		return 0;
+	}
+	mp_num_workers = rte_lcore_count() - 1;
+	mp_worker_idx = 0;
+
+	b = rte_reorder_mp_create("test_mp_mt", rte_socket_id(), &params);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	TEST_ASSERT_SUCCESS(rte_pktmbuf_alloc_bulk(test_params->p, mp_bufs,
+			MP_NUM_PKTS), "Packet allocation failed");
+
+	rte_eal_mp_remote_launch(reorder_mp_worker, b, SKIP_MASTER);
+	while (next < MP_NUM_PKTS && ret == 0) {
+		done = 1;
+		RTE_LCORE_FOREACH_SLAVE(lcore_id)
+			if (rte_eal_get_lcore_state(lcore_id) != FINISHED)
+				done = 0;
+		cnt = rte_reorder_mp_drain_burst(b, robufs, BURST);
+		for (i = 0; i < cnt && ret == 0; i++, next++)
+			if (robufs[i] != mp_bufs[next])
+				ret = -1;
+		/* once all packets are inserted, the drain cannot stall */
+		if (done && cnt == 0)
+			ret = -1;
+	}
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+
+	rte_reorder_free(b);
+	TEST_ASSERT_SUCCESS(ret, "Packet %u not drained in order", next);
+	rte_pktmbuf_free_bulk(mp_bufs, MP_NUM_PKTS);
+
+	return 0;
+}
+
 static int
 test_setup(void)
 {
@@ -380,6 +644,9 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_mp_insert_drain),
+		TEST_CASE(test_reorder_mp_gap_timeout),
+		TEST_CASE(test_reorder_mp_concurrent),
 		TEST_CASES_END()
 	}
 };
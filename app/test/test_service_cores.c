@@ -8,6 +8,7 @@
 #include <rte_malloc.h>
 #include <rte_memcpy.h>
 #include <rte_cycles.h>
+#include <rte_lcore_poll.h>
 
 #include <rte_service.h>
 #include <rte_service_component.h>
@@ -899,6 +900,313 @@ service_may_be_active(void)
 	return unregister_all();
 }
 
+/* find work every other call, and process 4 items */
+static int32_t
+half_idle_service(void *args)
+{
+	uint32_t *calls = args;
+
+	(*calls)++;
+	return (*calls & 1) ? -EAGAIN : 4;
+}
+
+static int
+lcore_poll_func(void *arg)
+{
+	int i;
+
+	RTE_SET_USED(arg);
+	rte_lcore_poll_stats_reset(rte_lcore_id());
+	for (i = 0; i < 10; i++)
+		rte_lcore_poll_idle();
+	for (i = 0; i < 5; i++)
+		rte_lcore_poll_busy(32);
+	rte_lcore_poll_busy(0);
+	return 0;
+}
+
+/* account the busy and idle polls of lcores and service cores */
+static int
+service_lcore_poll_stats(void)
+{
+	struct rte_lcore_poll_stats stats;
+	uint64_t calls, idle_calls;
+	uint32_t service_calls = 0;
+	uint32_t app_core, id;
+
+	unregister_all();
+
+	TEST_ASSERT_EQUAL(-EINVAL, rte_lcore_poll_stats_get(RTE_MAX_LCORE,
+			&stats), "Invalid lcore didn't return -EINVAL");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_lcore_poll_stats_reset(RTE_MAX_LCORE),
+			"Invalid lcore didn't return -EINVAL");
+
+	/* application loop */
+	app_core = rte_get_next_lcore(slcore_id, 1, 1);
+	rte_eal_wait_lcore(app_core);
+	TEST_ASSERT_EQUAL(0, rte_eal_remote_launch(lcore_poll_func, NULL,
+			app_core), "Launch on app lcore failed");
+	rte_eal_wait_lcore(app_core);
+	TEST_ASSERT_EQUAL(0, rte_lcore_poll_stats_get(app_core, &stats),
+			"Get lcore poll stats failed");
+	TEST_ASSERT_EQUAL(10, stats.idle_polls, "Wrong idle polls");
+	TEST_ASSERT_EQUAL(6, stats.busy_polls, "Wrong busy polls");
+	TEST_ASSERT_EQUAL(160, stats.pkts, "Wrong packet count");
+	TEST_ASSERT_EQUAL(5, stats.burst_hist[5], "Wrong burst histogram");
+	TEST_ASSERT(stats.busy_cycles + stats.idle_cycles > 0,
+			"No cycles accounted");
+	rte_lcore_poll_dump(stdout, app_core);
+
+	/* service core loop */
+	struct rte_service_spec service;
+	memset(&service, 0, sizeof(struct rte_service_spec));
+	service.callback = half_idle_service;
+	service.callback_userdata = &service_calls;
+	snprintf(service.name, sizeof(service.name), DUMMY_SERVICE_NAME);
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service, &id),
+			"Register of service failed");
+	rte_service_component_runstate_set(id, 1);
+	rte_service_runstate_set(id, 1);
+	rte_service_set_stats_enable(id, 1);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Service core add did not return zero");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_reset_all(slcore_id),
+			"Service core reset did not return zero");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(id, slcore_id, 1),
+			"Enabling valid service and core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Starting service core failed");
+	rte_delay_ms(100);
+	rte_service_runstate_set(id, 0);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(slcore_id),
+			"Stopping service core failed");
+	rte_eal_wait_lcore(slcore_id);
+
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(id,
+			RTE_SERVICE_ATTR_CALL_COUNT, &calls),
+			"Get call count failed");
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(id,
+			RTE_SERVICE_ATTR_IDLE_CALL_COUNT, &idle_calls),
+			"Get idle call count failed");
+	TEST_ASSERT_EQUAL(service_calls, calls, "Wrong call count");
+	TEST_ASSERT_EQUAL((service_calls + 1) / 2, idle_calls,
+			"Wrong idle call count");
+
+	TEST_ASSERT_EQUAL(0, rte_lcore_poll_stats_get(slcore_id, &stats),
+			"Get lcore poll stats failed");
+	/* the loops after the service was stopped are idle too */
+	TEST_ASSERT_EQUAL(calls - idle_calls, stats.busy_polls,
+			"Wrong service core busy polls");
+	TEST_ASSERT(stats.idle_polls >= idle_calls,
+			"Wrong service core idle polls");
+	TEST_ASSERT_EQUAL(4 * stats.busy_polls, stats.pkts,
+			"Wrong service core item count");
+	TEST_ASSERT_EQUAL(stats.busy_polls, stats.burst_hist[2],
+			"Wrong service core burst histogram");
+	rte_service_dump(stdout, UINT32_MAX);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_reset_all(slcore_id),
+			"Service core reset did not return zero");
+	TEST_ASSERT_EQUAL(0, rte_lcore_poll_stats_get(slcore_id, &stats),
+			"Get lcore poll stats failed");
+	TEST_ASSERT_EQUAL(0, stats.busy_polls + stats.idle_polls,
+			"Service core poll stats not reset");
+
+	return unregister_all();
+}
+
+/* never find any work */
+static int32_t
+idle_service(void *args)
+{
+	uint32_t *calls = args;
+
+	(*calls)++;
+	return -EAGAIN;
+}
+
+/* a service returning -EAGAIN is only accounted as idle */
+static int
+service_idle_callback(void)
+{
+	struct rte_lcore_poll_stats stats;
+	uint64_t calls, idle_calls;
+	uint32_t service_calls = 0;
+	uint32_t id;
+
+	unregister_all();
+
+	struct rte_service_spec service;
+	memset(&service, 0, sizeof(struct rte_service_spec));
+	service.callback = idle_service;
+	service.callback_userdata = &service_calls;
+	snprintf(service.name, sizeof(service.name), DUMMY_SERVICE_NAME);
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service, &id),
+			"Register of service failed");
+	rte_service_component_runstate_set(id, 1);
+	rte_service_runstate_set(id, 1);
+	rte_service_set_stats_enable(id, 1);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Service core add did not return zero");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_attr_reset_all(slcore_id),
+			"Service core reset did not return zero");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(id, slcore_id, 1),
+			"Enabling valid service and core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Starting service core failed");
+	rte_delay_ms(100);
+	rte_service_runstate_set(id, 0);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(slcore_id),
+			"Stopping service core failed");
+	rte_eal_wait_lcore(slcore_id);
+
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(id,
+			RTE_SERVICE_ATTR_CALL_COUNT, &calls),
+			"Get call count failed");
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(id,
+			RTE_SERVICE_ATTR_IDLE_CALL_COUNT, &idle_calls),
+			"Get idle call count failed");
+	TEST_ASSERT(calls > 0, "Service not called");
+	TEST_ASSERT_EQUAL(service_calls, calls, "Wrong call count");
+	TEST_ASSERT_EQUAL(calls, idle_calls, "Wrong idle call count");
+
+	TEST_ASSERT_EQUAL(0, rte_lcore_poll_stats_get(slcore_id, &stats),
+			"Get lcore poll stats failed");
+	TEST_ASSERT_EQUAL(0, stats.busy_polls,
+			"Idle service accounted as busy");
+	TEST_ASSERT_EQUAL(0, stats.pkts, "Idle service accounted items");
+	TEST_ASSERT(stats.idle_polls >= idle_calls,
+			"Wrong service core idle polls");
+
+	return unregister_all();
+}
+
+/* spend some cycles on every call, so that the rebalancer measures a load */
+static int32_t
+busy_service(void *args)
+{
+	RTE_SET_USED(args);
+	rte_delay_us(100);
+	return 1;
+}
+
+/* move services between service cores depending on their measured load */
+static int
+service_rebalance(void)
+{
+	struct rte_service_rebalance_conf conf = {
+		.period_ms = 0,
+		.threshold_pct = 10,
+		.hold_periods = 1000,
+	};
+	struct rte_service_spec service;
+	uint32_t app_core, ids[2], i;
+
+	/* needs a second service core besides slcore_id */
+	app_core = rte_get_next_lcore(slcore_id, 1, 0);
+	if (app_core >= RTE_MAX_LCORE)
+		return TEST_SKIPPED;
+
+	unregister_all();
+
+	TEST_ASSERT_EQUAL(-ENOTSUP, rte_service_rebalance_run(),
+			"Rebalance pass didn't fail while disabled");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_rebalance_enable(NULL),
+			"Invalid rebalancer configuration accepted");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_pin_set(1000, 1),
+			"Pinned invalid service id");
+
+	/* two busy services packed on the same service core */
+	memset(&service, 0, sizeof(struct rte_service_spec));
+	service.callback = busy_service;
+	for (i = 0; i < RTE_DIM(ids); i++) {
+		snprintf(service.name, sizeof(service.name), "busy_%u", i);
+		TEST_ASSERT_EQUAL(0, rte_service_component_register(&service,
+				&ids[i]), "Register of service failed");
+		rte_service_component_runstate_set(ids[i], 1);
+		rte_service_runstate_set(ids[i], 1);
+		rte_service_set_stats_enable(ids[i], 1);
+		TEST_ASSERT_EQUAL(0, rte_service_pin_set(ids[i], 1),
+				"Pinning service failed");
+		TEST_ASSERT_EQUAL(1, rte_service_pin_get(ids[i]),
+				"Service not pinned");
+	}
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Service core add did not return zero");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(app_core),
+			"Service core add did not return zero");
+	for (i = 0; i < RTE_DIM(ids); i++)
+		TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(ids[i],
+				slcore_id, 1), "Mapping service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Starting service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(app_core),
+			"Starting service core failed");
+
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_enable(&conf),
+			"Enabling rebalancer failed");
+	TEST_ASSERT_EQUAL(-EALREADY, rte_service_rebalance_enable(&conf),
+			"Rebalancer enabled twice");
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_run(),
+			"First rebalance pass moved services");
+
+	/* pinned services are never moved */
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_run(),
+			"Pinned services were moved");
+
+	/* one of the services moves to the idle service core */
+	TEST_ASSERT_EQUAL(0, rte_service_pin_set(ids[1], 0),
+			"Unpinning service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_pin_get(ids[1]),
+			"Service still pinned");
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(1, rte_service_rebalance_run(),
+			"Rebalance pass didn't move the service");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(ids[0], slcore_id),
+			"Pinned service was unmapped");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_get(ids[1], slcore_id),
+			"Moved service still mapped to its service core");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(ids[1], app_core),
+			"Moved service not mapped to the idle service core");
+
+	/* a moved service is held on its new service core */
+	rte_delay_ms(100);
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_run(),
+			"Held service was moved");
+
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_disable(),
+			"Disabling rebalancer failed");
+	TEST_ASSERT_EQUAL(-EALREADY, rte_service_rebalance_disable(),
+			"Rebalancer disabled twice");
+
+	/* periodic passes, with all the services pinned */
+	TEST_ASSERT_EQUAL(0, rte_service_pin_set(ids[1], 1),
+			"Pinning service failed");
+	conf.period_ms = 10;
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_enable(&conf),
+			"Enabling periodic rebalancer failed");
+	rte_delay_ms(50);
+	TEST_ASSERT_EQUAL(0, rte_service_rebalance_disable(),
+			"Disabling periodic rebalancer failed");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(ids[1], app_core),
+			"Pinned service was moved by periodic pass");
+
+	for (i = 0; i < RTE_DIM(ids); i++)
+		rte_service_runstate_set(ids[i], 0);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(slcore_id),
+			"Stopping service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(app_core),
+			"Stopping service core failed");
+	rte_eal_wait_lcore(slcore_id);
+	rte_eal_wait_lcore(app_core);
+
+	return unregister_all();
+}
+
 static struct unit_test_suite service_tests  = {
 	.suite_name = "service core test suite",
 	.setup = testsuite_setup,
@@ -920,6 +1228,9 @@ static struct unit_test_suite service_tests  = {
 		TEST_CASE_ST(dummy_register, NULL, service_app_lcore_mt_safe),
 		TEST_CASE_ST(dummy_register, NULL, service_app_lcore_mt_unsafe),
 		TEST_CASE_ST(dummy_register, NULL, service_may_be_active),
+		TEST_CASE_ST(dummy_register, NULL, service_lcore_poll_stats),
+		TEST_CASE_ST(dummy_register, NULL, service_idle_callback),
+		TEST_CASE_ST(dummy_register, NULL, service_rebalance),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
@@ -0,0 +1,385 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_metrics.h>
+#include <rte_telemetry.h>
+#include <rte_telemetry_shm.h>
+
+#include "test.h"
+
+#define SHM_TEST_NB_METRICS 4
+#define SHM_TEST_NB_UPDATES 5
+#define SHM_TEST_PERIOD_MS 10
+#define SHM_TEST_TIMEOUT_MS 2000
+#define SHM_TEST_READ_RETRIES 16
+#define SHM_TEST_NB_VALUES 64
+#define SHM_TEST_NB_WRITES 100000
+
+static const char * const shm_test_names[SHM_TEST_NB_METRICS] = {
+	"shm_test_rx", "shm_test_tx", "shm_test_drop", "shm_test_err",
+};
+
+/* map the snapshots read-only, as an external collector does */
+static const struct rte_telemetry_shm_hdr *
+shm_test_map(size_t *size)
+{
+	char path[PATH_MAX];
+	struct stat st;
+	void *p;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/telemetry_shm",
+		rte_eal_get_runtime_dir());
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return NULL;
+	}
+	p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return NULL;
+
+	*size = st.st_size;
+	return p;
+}
+
+/* check the global metrics record of a copied snapshot */
+static int
+shm_test_check_metrics(const struct rte_telemetry_shm_hdr *hdr,
+		const struct rte_telemetry_shm_buf *buf, uint64_t base)
+{
+	const struct rte_telemetry_shm_record *recs =
+		rte_telemetry_shm_records(hdr, buf);
+	const struct rte_telemetry_shm_name *names =
+		rte_telemetry_shm_names(hdr, buf);
+	const uint64_t *values = rte_telemetry_shm_values(hdr, buf);
+	uint32_t r, i;
+	int found = 0;
+
+	for (r = 0; r < buf->nb_records; r++) {
+		if (recs[r].type != RTE_TELEMETRY_SHM_METRICS ||
+				recs[r].port_id != RTE_TELEMETRY_SHM_GLOBAL)
+			continue;
+		for (i = 0; i < recs[r].nb_values; i++) {
+			int m;
+
+			for (m = 0; m < SHM_TEST_NB_METRICS; m++)
+				if (strcmp(names[recs[r].first_name + i].name,
+						shm_test_names[m]) == 0)
+					break;
+			if (m == SHM_TEST_NB_METRICS)
+				continue;
+			TEST_ASSERT_EQUAL(values[recs[r].first_value + i],
+				base + m, "Wrong value of %s: %"PRIu64
+				" instead of %"PRIu64, shm_test_names[m],
+				values[recs[r].first_value + i], base + m);
+			found++;
+		}
+	}
+	TEST_ASSERT_EQUAL(found, SHM_TEST_NB_METRICS,
+		"Found %d of %d metrics", found, SHM_TEST_NB_METRICS);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Update the metrics several times, and check that each update is in
+ * the snapshots read once the publisher went through a whole period.
+ */
+static int
+test_telemetry_shm_publish(void)
+{
+	struct rte_telemetry_shm_params params = {
+		.period_ms = SHM_TEST_PERIOD_MS,
+	};
+	const struct rte_telemetry_shm_hdr *hdr;
+	uint64_t values[SHM_TEST_NB_METRICS];
+	uint64_t gen, last_gen = 0, deadline;
+	void *copy = NULL;
+	size_t size = 0;
+	int key, i, u, ret;
+
+	rte_metrics_init(rte_socket_id());
+	key = rte_metrics_reg_names(shm_test_names, SHM_TEST_NB_METRICS);
+	TEST_ASSERT(key >= 0, "Cannot register the metrics");
+
+	ret = rte_telemetry_shm_enable(&params);
+	TEST_ASSERT_SUCCESS(ret, "Cannot enable the snapshots: %d", ret);
+	ret = rte_telemetry_shm_enable(&params);
+	TEST_ASSERT_EQUAL(ret, -EALREADY, "Enabled twice: %d", ret);
+
+	hdr = shm_test_map(&size);
+	if (hdr == NULL) {
+		rte_telemetry_shm_disable();
+		TEST_ASSERT(0, "Cannot map the snapshots");
+	}
+	ret = TEST_FAILED;
+	if (hdr->magic != RTE_TELEMETRY_SHM_MAGIC ||
+			hdr->version != RTE_TELEMETRY_SHM_VERSION ||
+			hdr->period_ms != SHM_TEST_PERIOD_MS) {
+		printf("Wrong snapshots header\n");
+		goto out;
+	}
+	copy = malloc(hdr->buf_size);
+	if (copy == NULL)
+		goto out;
+
+	for (u = 1; u <= SHM_TEST_NB_UPDATES; u++) {
+		for (i = 0; i < SHM_TEST_NB_METRICS; i++)
+			values[i] = u * 100 + i;
+		if (rte_metrics_update_values(RTE_METRICS_GLOBAL, key,
+				values, SHM_TEST_NB_METRICS) < 0) {
+			printf("Cannot update the metrics\n");
+			goto out;
+		}
+
+		/* the snapshot in progress may predate the update */
+		gen = __atomic_load_n(&hdr->generation, __ATOMIC_ACQUIRE) + 2;
+		deadline = rte_get_timer_cycles() +
+			rte_get_timer_hz() * SHM_TEST_TIMEOUT_MS / MS_PER_S;
+		while (__atomic_load_n(&hdr->generation, __ATOMIC_ACQUIRE) <
+				gen) {
+			if (rte_get_timer_cycles() > deadline) {
+				printf("No snapshot published\n");
+				goto out;
+			}
+			rte_delay_ms(1);
+		}
+
+		gen = rte_telemetry_shm_read(hdr, copy, SHM_TEST_READ_RETRIES);
+		if (gen <= last_gen) {
+			printf("Read snapshot %"PRIu64" after %"PRIu64"\n",
+				gen, last_gen);
+			goto out;
+		}
+		last_gen = gen;
+		if (shm_test_check_metrics(hdr, copy, u * 100) !=
+				TEST_SUCCESS)
+			goto out;
+	}
+	ret = TEST_SUCCESS;
+
+out:
+	free(copy);
+	munmap((void *)(uintptr_t)hdr, size);
+	if (rte_telemetry_shm_disable() != 0)
+		ret = TEST_FAILED;
+	if (rte_telemetry_shm_disable() != -ENOENT)
+		ret = TEST_FAILED;
+	rte_metrics_deinit();
+
+	return ret;
+}
+
+/* snapshots written in memory following the protocol of the publisher */
+struct shm_test_region {
+	struct rte_telemetry_shm_hdr *hdr;
+	volatile int done;
+	volatile uint64_t nb_writes;
+};
+
+static struct rte_telemetry_shm_hdr *
+shm_test_region_create(void)
+{
+	struct rte_telemetry_shm_hdr *hdr;
+	size_t buf_size;
+
+	buf_size = sizeof(struct rte_telemetry_shm_buf) +
+		sizeof(struct rte_telemetry_shm_record) +
+		sizeof(struct rte_telemetry_shm_name) +
+		SHM_TEST_NB_VALUES * sizeof(uint64_t);
+	buf_size = RTE_ALIGN_CEIL(buf_size, RTE_CACHE_LINE_SIZE);
+
+	hdr = aligned_alloc(RTE_CACHE_LINE_SIZE,
+		RTE_CACHE_LINE_ROUNDUP(sizeof(*hdr)) + 2 * buf_size);
+	if (hdr == NULL)
+		return NULL;
+	memset(hdr, 0, RTE_CACHE_LINE_ROUNDUP(sizeof(*hdr)) + 2 * buf_size);
+
+	hdr->magic = RTE_TELEMETRY_SHM_MAGIC;
+	hdr->version = RTE_TELEMETRY_SHM_VERSION;
+	hdr->buf_offset = RTE_CACHE_LINE_ROUNDUP(sizeof(*hdr));
+	hdr->buf_size = buf_size;
+	hdr->max_records = 1;
+	hdr->max_names = 1;
+	hdr->max_values = SHM_TEST_NB_VALUES;
+
+	return hdr;
+}
+
+/* all the values of snapshot g are g, so that torn copies are seen */
+static void
+shm_test_region_write(struct rte_telemetry_shm_hdr *hdr)
+{
+	const uint64_t gen = hdr->generation + 1;
+	struct rte_telemetry_shm_buf *buf =
+		rte_telemetry_shm_buf(hdr, gen & 1);
+	uint64_t *values = rte_telemetry_shm_values(hdr, buf);
+	int i;
+
+	__atomic_store_n(&buf->seq, buf->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	buf->generation = gen;
+	buf->nb_values = SHM_TEST_NB_VALUES;
+	for (i = 0; i < SHM_TEST_NB_VALUES; i++)
+		__atomic_store_n(&values[i], gen, __ATOMIC_RELAXED);
+
+	__atomic_store_n(&buf->seq, buf->seq + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&hdr->generation, gen, __ATOMIC_RELEASE);
+}
+
+static int
+shm_test_check_copy(const struct rte_telemetry_shm_hdr *hdr,
+		const struct rte_telemetry_shm_buf *copy, uint64_t gen)
+{
+	const uint64_t *values = rte_telemetry_shm_values(hdr, copy);
+	int i;
+
+	TEST_ASSERT_EQUAL(copy->generation, gen,
+		"Copied snapshot %"PRIu64" instead of %"PRIu64,
+		copy->generation, gen);
+	for (i = 0; i < SHM_TEST_NB_VALUES; i++)
+		TEST_ASSERT_EQUAL(values[i], gen,
+			"Torn copy of snapshot %"PRIu64": value %d is %"PRIu64,
+			gen, i, values[i]);
+
+	return TEST_SUCCESS;
+}
+
+static int
+shm_test_writer(void *arg)
+{
+	struct shm_test_region *region = arg;
+
+	while (!region->done && region->nb_writes < SHM_TEST_NB_WRITES) {
+		shm_test_region_write(region->hdr);
+		region->nb_writes++;
+	}
+
+	return 0;
+}
+
+/*
+ * Check the copies of snapshots overwritten while they are read: the
+ * reader retries while the sequence counter is odd or changes.
+ */
+static int
+test_telemetry_shm_read_retry(void)
+{
+	struct shm_test_region region = { .done = 0, .nb_writes = 0 };
+	struct rte_telemetry_shm_hdr *hdr;
+	struct rte_telemetry_shm_buf *buf;
+	uint64_t gen, nb_reads = 0;
+	unsigned int worker;
+	void *copy;
+	int ret = TEST_FAILED;
+
+	hdr = shm_test_region_create();
+	TEST_ASSERT_NOT_NULL(hdr, "Cannot allocate the snapshots");
+	copy = malloc(hdr->buf_size);
+	if (copy == NULL) {
+		free(hdr);
+		TEST_ASSERT(0, "Cannot allocate the copy");
+	}
+
+	if (rte_telemetry_shm_read(hdr, copy, SHM_TEST_READ_RETRIES) != 0) {
+		printf("Read a snapshot before the first one\n");
+		goto out;
+	}
+
+	/* the latest of several snapshots is read */
+	for (gen = 1; gen <= 3; gen++) {
+		shm_test_region_write(hdr);
+		if (rte_telemetry_shm_read(hdr, copy, 0) != gen ||
+				shm_test_check_copy(hdr, copy, gen) !=
+				TEST_SUCCESS)
+			goto out;
+	}
+
+	/* a snapshot being written is never copied */
+	buf = rte_telemetry_shm_buf(hdr, hdr->generation & 1);
+	buf->seq++;
+	if (rte_telemetry_shm_read(hdr, copy, 0) != 0 ||
+			rte_telemetry_shm_read(hdr, copy,
+				SHM_TEST_READ_RETRIES) != 0) {
+		printf("Read a snapshot being written\n");
+		goto out;
+	}
+	buf->seq++;
+	if (rte_telemetry_shm_read(hdr, copy, 0) != 3 ||
+			shm_test_check_copy(hdr, copy, 3) != TEST_SUCCESS)
+		goto out;
+
+	worker = rte_get_next_lcore(rte_lcore_id(), 1, 0);
+	if (worker >= RTE_MAX_LCORE) {
+		printf("Not enough lcores to overwrite the snapshots while read\n");
+		ret = TEST_SUCCESS;
+		goto out;
+	}
+
+	/* every successful copy is consistent while the writer runs */
+	region.hdr = hdr;
+	rte_eal_remote_launch(shm_test_writer, &region, worker);
+	while (region.nb_writes < SHM_TEST_NB_WRITES) {
+		gen = rte_telemetry_shm_read(hdr, copy, SHM_TEST_READ_RETRIES);
+		if (gen == 0)
+			continue;
+		nb_reads++;
+		if (shm_test_check_copy(hdr, copy, gen) != TEST_SUCCESS) {
+			region.done = 1;
+			rte_eal_wait_lcore(worker);
+			goto out;
+		}
+	}
+	rte_eal_wait_lcore(worker);
+	printf("%"PRIu64" consistent copies during %"PRIu64" writes\n",
+		nb_reads, region.nb_writes);
+	ret = TEST_SUCCESS;
+
+out:
+	free(copy);
+	free(hdr);
+
+	return ret;
+}
+
+static struct unit_test_suite telemetry_shm_testsuite = {
+	.suite_name = "Telemetry Shared Memory Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_telemetry_shm_read_retry),
+		TEST_CASE(test_telemetry_shm_publish),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_telemetry_shm(void)
+{
+	return unit_test_suite_runner(&telemetry_shm_testsuite);
+}
+
+REGISTER_TEST_COMMAND(telemetry_shm_autotest, test_telemetry_shm);
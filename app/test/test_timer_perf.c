@@ -16,6 +16,9 @@
 #include <rte_pause.h>
 
 #define MAX_ITERATIONS 1000000
+/* number of armed timers for the backend comparison */
+#define BACKEND_NB_TIMERS 1000000
+#define WHEEL_NB_TIMERS 10000000
 
 int outstanding_count = 0;
 
@@ -33,6 +36,77 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
+static void
+expired_cb(struct rte_timer *t __rte_unused)
+{
+}
+
+/* measure arm, reset, poll and stop of nb armed timers of a backend */
+static int
+timer_perf_backend(const char *name, enum rte_timer_backend backend,
+		   unsigned int nb)
+{
+	struct rte_timer_data_params params = {
+		.backend = backend,
+	};
+	const uint64_t ticks = rte_get_timer_hz() * DELAY_SECONDS;
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t start_tsc, end_tsc;
+	struct rte_timer *tms;
+	uint32_t id;
+	unsigned int i;
+
+	tms = rte_malloc(NULL, sizeof(*tms) * nb, 0);
+	if (tms == NULL) {
+		printf("Not enough memory for %u timers, skipping\n", nb);
+		return 0;
+	}
+	if (rte_timer_data_alloc_params(&id, &params) < 0) {
+		printf("Failed to allocate %s timer data\n", name);
+		rte_free(tms);
+		return -1;
+	}
+
+	for (i = 0; i < nb; i++)
+		rte_timer_init(&tms[i]);
+
+	/* timeouts spread between 1 and 2 seconds */
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < nb; i++)
+		rte_timer_alt_reset(id, &tms[i], ticks + rte_rand() % ticks,
+				    SINGLE, lcore_id, NULL, NULL);
+	end_tsc = rte_rdtsc();
+	printf("%s: time per arm with %u timers: %"PRIu64" cycles\n", name,
+			nb, (end_tsc - start_tsc) / nb);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < nb; i++)
+		rte_timer_alt_reset(id, &tms[rte_rand() % nb],
+				    ticks + rte_rand() % ticks, SINGLE,
+				    lcore_id, NULL, NULL);
+	end_tsc = rte_rdtsc();
+	printf("%s: time per reset with %u timers: %"PRIu64" cycles\n", name,
+			nb, (end_tsc - start_tsc) / nb);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < MAX_ITERATIONS; i++)
+		rte_timer_alt_manage(id, NULL, 0, expired_cb);
+	end_tsc = rte_rdtsc();
+	printf("%s: time per manage: %"PRIu64" cycles\n",
+			name, (end_tsc - start_tsc) / MAX_ITERATIONS);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < nb; i++)
+		rte_timer_alt_stop(id, &tms[i]);
+	end_tsc = rte_rdtsc();
+	printf("%s: time per stop with %u timers: %"PRIu64" cycles\n", name,
+			nb, (end_tsc - start_tsc) / nb);
+
+	rte_timer_data_dealloc(id);
+	rte_free(tms);
+	return 0;
+}
+
 static int
 test_timer_perf(void)
 {
@@ -128,6 +202,16 @@ test_timer_perf(void)
 			(end_tsc - start_tsc + iterations/2) / iterations);
 
 	rte_free(tms);
+
+	printf("\n");
+	if (timer_perf_backend("skiplist", RTE_TIMER_BACKEND_SKIPLIST,
+			BACKEND_NB_TIMERS) < 0 ||
+	    timer_perf_backend("wheel", RTE_TIMER_BACKEND_WHEEL,
+			BACKEND_NB_TIMERS) < 0 ||
+	    timer_perf_backend("wheel", RTE_TIMER_BACKEND_WHEEL,
+			WHEEL_NB_TIMERS) < 0)
+		return -1;
+
 	return 0;
 }
 
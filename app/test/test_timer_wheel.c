@@ -0,0 +1,343 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_timer.h>
+
+#include "test.h"
+
+#define NB_TIMERS	4096
+/* 2^10 timer cycles per wheel tick */
+#define WHEEL_TICK	1024
+
+static uint32_t timer_data_id;
+static struct rte_timer *tims;
+static uint64_t *expire_at;
+static unsigned int nb_expired;
+static unsigned int nb_early;
+static unsigned int nb_bursts;
+static unsigned int max_burst;
+
+static int
+wheel_setup(void)
+{
+	struct rte_timer_data_params params = {
+		.backend = RTE_TIMER_BACKEND_WHEEL,
+		.wheel_tick = WHEEL_TICK,
+	};
+	unsigned int i;
+
+	TEST_ASSERT_SUCCESS(rte_timer_data_alloc_params(&timer_data_id,
+			&params), "Failed to allocate wheel timer data");
+
+	tims = rte_zmalloc(NULL, sizeof(*tims) * NB_TIMERS, 0);
+	expire_at = rte_zmalloc(NULL, sizeof(*expire_at) * NB_TIMERS, 0);
+	TEST_ASSERT(tims != NULL && expire_at != NULL,
+		    "Failed to allocate timers");
+	for (i = 0; i < NB_TIMERS; i++)
+		rte_timer_init(&tims[i]);
+
+	nb_expired = 0;
+	nb_early = 0;
+	nb_bursts = 0;
+	max_burst = 0;
+
+	return TEST_SUCCESS;
+}
+
+static void
+wheel_teardown(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	rte_timer_stop_all(timer_data_id, &lcore_id, 1, NULL, NULL);
+	rte_timer_data_dealloc(timer_data_id);
+	rte_free(tims);
+	rte_free(expire_at);
+}
+
+static void
+count_expired(struct rte_timer *tim)
+{
+	uint64_t now = rte_get_timer_cycles();
+	unsigned int idx = tim - tims;
+
+	if (now < expire_at[idx])
+		nb_early++;
+	nb_expired++;
+}
+
+static void
+count_burst(struct rte_timer **burst, unsigned int nb, void *arg)
+{
+	unsigned int i;
+
+	RTE_SET_USED(arg);
+	for (i = 0; i < nb; i++)
+		count_expired(burst[i]);
+	nb_bursts++;
+	max_burst = RTE_MAX(max_burst, nb);
+}
+
+static int
+arm_timer(unsigned int idx, uint64_t ticks, enum rte_timer_type type)
+{
+	expire_at[idx] = rte_get_timer_cycles() + ticks;
+	return rte_timer_alt_reset(timer_data_id, &tims[idx], ticks, type,
+				   rte_lcore_id(), NULL, NULL);
+}
+
+/* poll the timers until all expired or the delay elapsed */
+static void
+manage_until(unsigned int expected, uint64_t delay)
+{
+	uint64_t end = rte_get_timer_cycles() + delay;
+
+	while (nb_expired < expected && rte_get_timer_cycles() < end)
+		rte_timer_alt_manage(timer_data_id, NULL, 0, count_expired);
+}
+
+static int
+test_wheel_params(void)
+{
+	struct rte_timer_data_params params = {
+		.backend = RTE_TIMER_BACKEND_SKIPLIST,
+	};
+	uint32_t id;
+
+	TEST_ASSERT_EQUAL(rte_timer_data_alloc_params(&id, NULL), -EINVAL,
+			  "NULL params accepted");
+
+	params.backend = RTE_TIMER_BACKEND_WHEEL + 1;
+	TEST_ASSERT_EQUAL(rte_timer_data_alloc_params(&id, &params), -EINVAL,
+			  "Invalid backend accepted");
+
+	params.backend = RTE_TIMER_BACKEND_SKIPLIST;
+	TEST_ASSERT_SUCCESS(rte_timer_data_alloc_params(&id, &params),
+			    "Failed to allocate skiplist timer data");
+	TEST_ASSERT_SUCCESS(rte_timer_data_dealloc(id),
+			    "Failed to free skiplist timer data");
+
+	/* default tick */
+	params.backend = RTE_TIMER_BACKEND_WHEEL;
+	params.wheel_tick = 0;
+	TEST_ASSERT_SUCCESS(rte_timer_data_alloc_params(&id, &params),
+			    "Failed to allocate wheel timer data");
+	TEST_ASSERT_SUCCESS(rte_timer_data_dealloc(id),
+			    "Failed to free wheel timer data");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_wheel_expiry(void)
+{
+	uint64_t hz = rte_get_timer_hz();
+	unsigned int i;
+
+	/* spread timers from a few ticks to 50 ms, over several levels */
+	for (i = 0; i < NB_TIMERS; i++)
+		TEST_ASSERT_SUCCESS(arm_timer(i, rte_rand() % (hz / 20),
+				SINGLE), "Failed to arm timer %u", i);
+
+	manage_until(NB_TIMERS, hz);
+
+	TEST_ASSERT_EQUAL(nb_expired, NB_TIMERS, "Only %u of %u timers expired",
+			  nb_expired, NB_TIMERS);
+	TEST_ASSERT_EQUAL(nb_early, 0, "%u timers expired early", nb_early);
+	for (i = 0; i < NB_TIMERS; i++)
+		TEST_ASSERT(!rte_timer_pending(&tims[i]),
+			    "Timer %u still pending", i);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_wheel_long_expiry(void)
+{
+	uint64_t hz = rte_get_timer_hz();
+
+	/* level 0 covers 2^18 cycles with this tick, go past level 1 */
+	TEST_ASSERT_SUCCESS(arm_timer(0, hz / 5, SINGLE),
+			    "Failed to arm timer");
+	/* beyond the last level, kept in the overflow list */
+	TEST_ASSERT_SUCCESS(arm_timer(1, UINT64_MAX / 2, SINGLE),
+			    "Failed to arm timer");
+
+	manage_until(1, hz);
+
+	TEST_ASSERT_EQUAL(nb_expired, 1, "Timer did not expire");
+	TEST_ASSERT_EQUAL(nb_early, 0, "Timer expired early");
+	TEST_ASSERT(rte_timer_pending(&tims[1]), "Overflow timer not pending");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_wheel_stop_reset(void)
+{
+	uint64_t hz = rte_get_timer_hz();
+	unsigned int i, nb_stopped = 0;
+
+	for (i = 0; i < NB_TIMERS; i++)
+		TEST_ASSERT_SUCCESS(arm_timer(i, rte_rand() % (hz / 20),
+				SINGLE), "Failed to arm timer %u", i);
+
+	/* stop half of the timers and push some of the others back */
+	for (i = 0; i < NB_TIMERS; i++) {
+		if (i & 1) {
+			TEST_ASSERT_SUCCESS(rte_timer_alt_stop(timer_data_id,
+					&tims[i]), "Failed to stop timer %u", i);
+			nb_stopped++;
+		} else if ((i & 7) == 0) {
+			TEST_ASSERT_SUCCESS(arm_timer(i, hz / 10, SINGLE),
+					    "Failed to reset timer %u", i);
+		}
+	}
+
+	manage_until(NB_TIMERS, hz / 2);
+
+	TEST_ASSERT_EQUAL(nb_expired, NB_TIMERS - nb_stopped,
+			  "%u timers expired, expected %u", nb_expired,
+			  NB_TIMERS - nb_stopped);
+	TEST_ASSERT_EQUAL(nb_early, 0, "%u timers expired early", nb_early);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_wheel_periodic(void)
+{
+	uint64_t hz = rte_get_timer_hz();
+
+	TEST_ASSERT_SUCCESS(arm_timer(0, hz / 1000, PERIODICAL),
+			    "Failed to arm periodic timer");
+
+	manage_until(10, hz);
+
+	TEST_ASSERT_EQUAL(nb_expired, 10, "Periodic timer expired %u times",
+			  nb_expired);
+	TEST_ASSERT(rte_timer_pending(&tims[0]),
+		    "Periodic timer not reloaded");
+	TEST_ASSERT_SUCCESS(rte_timer_alt_stop(timer_data_id, &tims[0]),
+			    "Failed to stop periodic timer");
+
+	return TEST_SUCCESS;
+}
+
+static void
+reset_burst(struct rte_timer **burst, unsigned int nb, void *arg)
+{
+	uint64_t ticks = *(uint64_t *)arg;
+	unsigned int i, idx;
+
+	for (i = 0; i < nb; i++) {
+		idx = burst[i] - tims;
+		/* re-arm even timers once, from the callback */
+		if ((idx & 1) == 0 && expire_at[idx] != UINT64_MAX) {
+			if (arm_timer(idx, ticks, SINGLE) == 0)
+				expire_at[idx] = UINT64_MAX;
+			continue;
+		}
+		nb_expired++;
+	}
+	nb_bursts++;
+	max_burst = RTE_MAX(max_burst, nb);
+}
+
+static int
+test_wheel_burst(void)
+{
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t ticks = hz / 1000;
+	uint64_t end;
+	unsigned int i;
+	int ret, total = 0;
+
+	for (i = 0; i < NB_TIMERS; i++)
+		TEST_ASSERT_SUCCESS(arm_timer(i, ticks, SINGLE),
+				    "Failed to arm timer %u", i);
+
+	end = rte_get_timer_cycles() + hz;
+	while (nb_expired < NB_TIMERS && rte_get_timer_cycles() < end) {
+		ret = rte_timer_alt_manage_burst(timer_data_id, reset_burst,
+						 &ticks);
+		TEST_ASSERT(ret >= 0, "Burst manage failed");
+		total += ret;
+	}
+
+	TEST_ASSERT_EQUAL(nb_expired, NB_TIMERS, "Only %u of %u timers expired",
+			  nb_expired, NB_TIMERS);
+	/* even timers were re-armed from the callback and expired twice */
+	TEST_ASSERT_EQUAL(total, NB_TIMERS + NB_TIMERS / 2,
+			  "Burst manage reported %d expired timers", total);
+	TEST_ASSERT(max_burst <= RTE_TIMER_MANAGE_BURST_SIZE,
+		    "Burst of %u timers", max_burst);
+	for (i = 0; i < NB_TIMERS; i++)
+		TEST_ASSERT(!rte_timer_pending(&tims[i]),
+			    "Timer %u still pending", i);
+
+	TEST_ASSERT_EQUAL(rte_timer_alt_manage_burst(timer_data_id, NULL,
+			NULL), -EINVAL, "NULL callback accepted");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_wheel_burst_periodic(void)
+{
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t end = rte_get_timer_cycles() + hz;
+
+	TEST_ASSERT_SUCCESS(arm_timer(0, hz / 1000, PERIODICAL),
+			    "Failed to arm periodic timer");
+	TEST_ASSERT_SUCCESS(arm_timer(1, hz / 1000, SINGLE),
+			    "Failed to arm timer");
+
+	while (nb_expired < 10 && rte_get_timer_cycles() < end)
+		rte_timer_alt_manage_burst(timer_data_id, count_burst, NULL);
+
+	TEST_ASSERT_EQUAL(nb_expired, 10, "%u expirations", nb_expired);
+	TEST_ASSERT_EQUAL(nb_early, 0, "Timer expired early");
+	TEST_ASSERT(rte_timer_pending(&tims[0]),
+		    "Periodic timer not reloaded");
+	TEST_ASSERT(!rte_timer_pending(&tims[1]), "Single timer reloaded");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite timer_wheel_testsuite = {
+	.suite_name = "timer wheel autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_wheel_params),
+		TEST_CASE_ST(wheel_setup, wheel_teardown, test_wheel_expiry),
+		TEST_CASE_ST(wheel_setup, wheel_teardown,
+			     test_wheel_long_expiry),
+		TEST_CASE_ST(wheel_setup, wheel_teardown,
+			     test_wheel_stop_reset),
+		TEST_CASE_ST(wheel_setup, wheel_teardown, test_wheel_periodic),
+		TEST_CASE_ST(wheel_setup, wheel_teardown, test_wheel_burst),
+		TEST_CASE_ST(wheel_setup, wheel_teardown,
+			     test_wheel_burst_periodic),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_timer_wheel(void)
+{
+	return unit_test_suite_runner(&timer_wheel_testsuite);
+}
+
+REGISTER_TEST_COMMAND(timer_wheel_autotest, test_timer_wheel);
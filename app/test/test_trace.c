@@ -0,0 +1,399 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_trace.h>
+
+#include "test.h"
+
+#define NB_EVENTS 1000
+#define NB_DISCARD_EVENTS 100000
+#define NB_PERF_ITERATIONS 1000000
+/* stream packet header and context */
+#define STREAM_HDR_SIZE 16
+/* event timestamp and id, then 64-bit fields */
+#define EVENT_SIZE(nb_fields) (12 + 8 * (nb_fields))
+
+RTE_TRACE_POINT_DEFINE(test_trace_two);
+RTE_TRACE_POINT_DEFINE(test_trace_four);
+
+RTE_TRACE_POINT_REGISTER(test_trace_two, "app.test.two", "a,b");
+RTE_TRACE_POINT_REGISTER(test_trace_four, "app.test.four", "a,b,c,d");
+
+static char trace_dir[PATH_MAX];
+
+/* number of stream files in the trace directory, i.e. of thread buffers */
+static int
+trace_nb_streams(void)
+{
+	char path[PATH_MAX + 32];
+	struct stat st;
+	int n = 0;
+
+	for (;;) {
+		snprintf(path, sizeof(path), "%s/channel0_%d", trace_dir, n);
+		if (stat(path, &st) != 0)
+			return n;
+		n++;
+	}
+}
+
+static long
+trace_stream_size(int index)
+{
+	char path[PATH_MAX + 32];
+	struct stat st;
+
+	snprintf(path, sizeof(path), "%s/channel0_%d", trace_dir, index);
+	if (stat(path, &st) != 0)
+		return -1;
+	return st.st_size;
+}
+
+/* first field of the first event of a stream */
+static int
+trace_stream_first_arg(int index, uint64_t *arg)
+{
+	char path[PATH_MAX + 32];
+	FILE *f;
+	int ret;
+
+	snprintf(path, sizeof(path), "%s/channel0_%d", trace_dir, index);
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -1;
+	ret = fseek(f, STREAM_HDR_SIZE + EVENT_SIZE(0), SEEK_SET) == 0 &&
+		fread(arg, sizeof(*arg), 1, f) == 1 ? 0 : -1;
+	fclose(f);
+	return ret;
+}
+
+/* run a function in a new thread, so that it gets a new trace buffer */
+static int
+trace_run_thread(void *(*fn)(void *), void *arg)
+{
+	pthread_t thread;
+
+	if (pthread_create(&thread, NULL, fn, arg) != 0)
+		return -1;
+	return pthread_join(thread, NULL) == 0 ? 0 : -1;
+}
+
+static void *
+trace_emit_events(void *arg __rte_unused)
+{
+	unsigned int i;
+
+	for (i = 0; i < NB_EVENTS; i++)
+		rte_trace_point_emit(test_trace_two, i, &i);
+	rte_trace_point_disable(&__test_trace_two);
+	for (i = 0; i < NB_EVENTS / 2; i++)
+		rte_trace_point_emit(test_trace_two, i, &i);
+	for (i = 0; i < NB_EVENTS / 10; i++)
+		rte_trace_point_emit(test_trace_four, i, 1, 2, 3);
+	return NULL;
+}
+
+static void *
+trace_emit_many(void *arg __rte_unused)
+{
+	unsigned int i;
+
+	for (i = 0; i < NB_DISCARD_EVENTS; i++)
+		rte_trace_point_emit(test_trace_two, i, 0);
+	return NULL;
+}
+
+static int
+test_trace_setup(void)
+{
+	snprintf(trace_dir, sizeof(trace_dir), "/tmp/dpdk_trace_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(trace_dir),
+			     "Failed to create trace directory");
+	return TEST_SUCCESS;
+}
+
+static void
+test_trace_teardown(void)
+{
+	char path[PATH_MAX + 32];
+	int i, n;
+
+	rte_trace_pattern("*", 0);
+	rte_trace_mode_set(RTE_TRACE_MODE_OVERWRITE);
+
+	n = trace_nb_streams();
+	for (i = 0; i < n; i++) {
+		snprintf(path, sizeof(path), "%s/channel0_%d", trace_dir, i);
+		unlink(path);
+	}
+	snprintf(path, sizeof(path), "%s/metadata", trace_dir);
+	unlink(path);
+	rmdir(trace_dir);
+}
+
+static int
+test_trace_point_lookup(void)
+{
+	TEST_ASSERT_EQUAL(rte_trace_point_lookup("app.test.two"),
+			  &__test_trace_two, "Lookup of app.test.two failed");
+	TEST_ASSERT_EQUAL(rte_trace_point_lookup("app.test.four"),
+			  &__test_trace_four, "Lookup of app.test.four failed");
+	TEST_ASSERT_NOT_NULL(rte_trace_point_lookup("lib.mempool.generic.get"),
+			     "Mempool tracepoint is not registered");
+	TEST_ASSERT_NOT_NULL(rte_trace_point_lookup("lib.ring.enqueue"),
+			     "Ring tracepoint is not registered");
+	TEST_ASSERT_NULL(rte_trace_point_lookup("app.test.none"),
+			 "Lookup of unknown tracepoint succeeded");
+	TEST_ASSERT_NULL(rte_trace_point_lookup(NULL),
+			 "Lookup of NULL succeeded");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_trace_point_enable(void)
+{
+	rte_trace_point_t unregistered = 0;
+
+	TEST_ASSERT(!rte_trace_point_is_enabled(&__test_trace_two),
+		    "Tracepoint enabled by default");
+	TEST_ASSERT(!rte_trace_is_enabled(), "Tracing enabled by default");
+
+	TEST_ASSERT_SUCCESS(rte_trace_point_enable(&__test_trace_two),
+			    "Failed to enable tracepoint");
+	TEST_ASSERT(rte_trace_point_is_enabled(&__test_trace_two),
+		    "Tracepoint not enabled");
+	TEST_ASSERT(rte_trace_is_enabled(), "Tracing not enabled");
+	TEST_ASSERT_SUCCESS(rte_trace_point_disable(&__test_trace_two),
+			    "Failed to disable tracepoint");
+	TEST_ASSERT(!rte_trace_is_enabled(), "Tracing still enabled");
+
+	TEST_ASSERT_EQUAL(rte_trace_pattern("app.test.*", 1), 2,
+			  "Pattern did not match the test tracepoints");
+	TEST_ASSERT(rte_trace_point_is_enabled(&__test_trace_two) &&
+		    rte_trace_point_is_enabled(&__test_trace_four),
+		    "Pattern did not enable the test tracepoints");
+	TEST_ASSERT_EQUAL(rte_trace_pattern("app.test.*", 0), 2,
+			  "Pattern did not match the test tracepoints");
+	TEST_ASSERT(!rte_trace_is_enabled(), "Tracing still enabled");
+	TEST_ASSERT_EQUAL(rte_trace_pattern("app.none.*", 1), 0,
+			  "Pattern matched unknown tracepoints");
+
+	TEST_ASSERT_FAIL(rte_trace_point_enable(&unregistered),
+			 "Enabled an unregistered tracepoint");
+	TEST_ASSERT_FAIL(rte_trace_point_enable(NULL),
+			 "Enabled a NULL tracepoint");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_trace_save(void)
+{
+	char path[PATH_MAX + 32];
+	long expected;
+	uint64_t arg;
+	int stream;
+
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	stream = trace_nb_streams();
+
+	rte_trace_pattern("app.test.*", 1);
+	TEST_ASSERT_SUCCESS(trace_run_thread(trace_emit_events, NULL),
+			    "Failed to run tracing thread");
+	rte_trace_pattern("app.test.*", 0);
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	rte_trace_dump(stdout);
+
+	snprintf(path, sizeof(path), "%s/metadata", trace_dir);
+	TEST_ASSERT(access(path, R_OK) == 0, "No trace metadata");
+	TEST_ASSERT_EQUAL(trace_nb_streams(), stream + 1,
+			  "No stream for the tracing thread");
+
+	/* events emitted while disabled are not recorded */
+	expected = STREAM_HDR_SIZE + NB_EVENTS * EVENT_SIZE(2) +
+		NB_EVENTS / 10 * EVENT_SIZE(4);
+	TEST_ASSERT_EQUAL(trace_stream_size(stream), expected,
+			  "Unexpected stream size %ld, expected %ld",
+			  trace_stream_size(stream), expected);
+	TEST_ASSERT_SUCCESS(trace_stream_first_arg(stream, &arg),
+			    "Failed to read stream");
+	TEST_ASSERT_EQUAL(arg, 0, "Unexpected first event");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_trace_mode(void)
+{
+	long nb_kept;
+	uint64_t arg;
+	int stream;
+
+	/* oldest events are overwritten */
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	stream = trace_nb_streams();
+	rte_trace_point_enable(&__test_trace_two);
+	TEST_ASSERT_SUCCESS(trace_run_thread(trace_emit_many, NULL),
+			    "Failed to run tracing thread");
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	nb_kept = (trace_stream_size(stream) - STREAM_HDR_SIZE) /
+		EVENT_SIZE(2);
+	TEST_ASSERT(nb_kept > 0 && nb_kept < NB_DISCARD_EVENTS,
+		    "Unexpected number of events kept %ld", nb_kept);
+	TEST_ASSERT_SUCCESS(trace_stream_first_arg(stream, &arg),
+			    "Failed to read stream");
+	TEST_ASSERT_EQUAL(arg, (uint64_t)(NB_DISCARD_EVENTS - nb_kept),
+			  "Oldest events were not overwritten");
+
+	/* newest events are dropped */
+	rte_trace_mode_set(RTE_TRACE_MODE_DISCARD);
+	TEST_ASSERT_EQUAL(rte_trace_mode_get(), RTE_TRACE_MODE_DISCARD,
+			  "Failed to set discard mode");
+	TEST_ASSERT_SUCCESS(trace_run_thread(trace_emit_many, NULL),
+			    "Failed to run tracing thread");
+	rte_trace_mode_set(RTE_TRACE_MODE_OVERWRITE);
+	rte_trace_point_disable(&__test_trace_two);
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	TEST_ASSERT_EQUAL((trace_stream_size(stream + 1) - STREAM_HDR_SIZE) /
+			  EVENT_SIZE(2), nb_kept,
+			  "Unexpected number of events kept");
+	TEST_ASSERT_SUCCESS(trace_stream_first_arg(stream + 1, &arg),
+			    "Failed to read stream");
+	TEST_ASSERT_EQUAL(arg, 0, "Oldest events were not kept");
+
+	return TEST_SUCCESS;
+}
+
+#ifdef RTE_ENABLE_TRACE_FP
+static void *
+trace_ring_ops(void *arg)
+{
+	struct rte_ring *r = arg;
+	void *obj = NULL;
+
+	rte_ring_enqueue(r, obj);
+	rte_ring_dequeue(r, &obj);
+	return NULL;
+}
+
+static void *
+trace_mempool_ops(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	void *obj;
+
+	if (rte_mempool_generic_get(mp, &obj, 1, NULL) == 0)
+		rte_mempool_generic_put(mp, &obj, 1, NULL);
+	return NULL;
+}
+
+static int
+test_trace_fast_path(void)
+{
+	struct rte_mempool *mp;
+	struct rte_ring *r;
+	int stream, ret;
+
+	r = rte_ring_create("test_trace", 64, SOCKET_ID_ANY, 0);
+	TEST_ASSERT_NOT_NULL(r, "Failed to create ring");
+
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	stream = trace_nb_streams();
+	TEST_ASSERT_EQUAL(rte_trace_pattern("lib.ring.*", 1), 2,
+			  "Ring tracepoints are not registered");
+	ret = trace_run_thread(trace_ring_ops, r);
+	rte_trace_pattern("lib.ring.*", 0);
+	rte_ring_free(r);
+	TEST_ASSERT_SUCCESS(ret, "Failed to run tracing thread");
+
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	TEST_ASSERT_EQUAL(trace_stream_size(stream),
+			  STREAM_HDR_SIZE + 2 * EVENT_SIZE(3),
+			  "Ring operations were not traced");
+
+	mp = rte_mempool_create("test_trace", 63, 64, 0, 0, NULL, NULL, NULL,
+			NULL, SOCKET_ID_ANY, 0);
+	TEST_ASSERT_NOT_NULL(mp, "Failed to create mempool");
+
+	stream = trace_nb_streams();
+	TEST_ASSERT_EQUAL(rte_trace_pattern("lib.mempool.generic.*", 1), 2,
+			  "Mempool tracepoints are not registered");
+	ret = trace_run_thread(trace_mempool_ops, mp);
+	rte_trace_pattern("lib.mempool.generic.*", 0);
+	rte_mempool_free(mp);
+	TEST_ASSERT_SUCCESS(ret, "Failed to run tracing thread");
+
+	TEST_ASSERT_SUCCESS(rte_trace_save(trace_dir), "Failed to save trace");
+	TEST_ASSERT_EQUAL(trace_stream_size(stream),
+			  STREAM_HDR_SIZE + EVENT_SIZE(4) + EVENT_SIZE(3),
+			  "Mempool operations were not traced");
+
+	return TEST_SUCCESS;
+}
+#endif
+
+static int
+test_trace_perf(void)
+{
+	uint64_t start, disabled, enabled;
+	unsigned int i;
+
+	start = rte_rdtsc();
+	for (i = 0; i < NB_PERF_ITERATIONS; i++)
+		rte_trace_point_emit(test_trace_four, i, 1, 2, 3);
+	disabled = rte_rdtsc() - start;
+
+	rte_trace_point_enable(&__test_trace_four);
+	start = rte_rdtsc();
+	for (i = 0; i < NB_PERF_ITERATIONS; i++)
+		rte_trace_point_emit(test_trace_four, i, 1, 2, 3);
+	enabled = rte_rdtsc() - start;
+	rte_trace_point_disable(&__test_trace_four);
+
+	printf("Cycles per event: disabled %.2f, enabled %.2f\n",
+	       (double)disabled / NB_PERF_ITERATIONS,
+	       (double)enabled / NB_PERF_ITERATIONS);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite trace_tests = {
+	.suite_name = "trace autotest",
+	.setup = test_trace_setup,
+	.teardown = test_trace_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_trace_point_lookup),
+		TEST_CASE(test_trace_point_enable),
+		TEST_CASE(test_trace_save),
+		TEST_CASE(test_trace_mode),
+#ifdef RTE_ENABLE_TRACE_FP
+		TEST_CASE(test_trace_fast_path),
+#endif
+		TEST_CASE(test_trace_perf),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_trace(void)
+{
+	return unit_test_suite_runner(&trace_tests);
+}
+
+REGISTER_TEST_COMMAND(trace_autotest, test_trace);
@@ -3,10 +3,12 @@
  */
 
 #include <stdbool.h>
+#include <string.h>
 
 #include <rte_cycles.h>
 #include <rte_eventdev_pmd.h>
 #include <rte_eventdev_pmd_vdev.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 
 #include "dsw_evdev.h"
@@ -92,6 +94,53 @@ dsw_port_release(void *p)
 	rte_ring_free(port->ctl_in_ring);
 }
 
+static void
+dsw_queue_free_order_windows(struct dsw_queue *queue)
+{
+	rte_free(queue->order_windows);
+	queue->order_windows = NULL;
+	queue->order_window_size = 0;
+}
+
+static int
+dsw_queue_alloc_order_windows(const struct rte_eventdev *dev,
+			      struct dsw_queue *queue,
+			      uint32_t nb_sequences)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	struct dsw_order_slot *slots;
+	uint32_t window_size;
+	uint16_t port_id;
+
+	if (nb_sequences == 0 || nb_sequences > DSW_MAX_ORDER_SEQUENCES)
+		nb_sequences = DSW_MAX_ORDER_SEQUENCES;
+	window_size = rte_align32pow2(nb_sequences);
+
+	queue->order_windows =
+		rte_zmalloc_socket(NULL, dsw->num_ports *
+				   (sizeof(struct dsw_order_window) +
+				    window_size *
+				    sizeof(struct dsw_order_slot)),
+				   RTE_CACHE_LINE_SIZE,
+				   dev->data->socket_id);
+	if (queue->order_windows == NULL)
+		return -ENOMEM;
+
+	queue->order_window_size = window_size;
+
+	slots = (struct dsw_order_slot *)
+		&queue->order_windows[dsw->num_ports];
+	for (port_id = 0; port_id < dsw->num_ports; port_id++) {
+		struct dsw_order_window *window =
+			&queue->order_windows[port_id];
+
+		rte_spinlock_init(&window->lock);
+		window->slots = &slots[port_id * window_size];
+	}
+
+	return 0;
+}
+
 static int
 dsw_queue_setup(struct rte_eventdev *dev, uint8_t queue_id,
 		const struct rte_event_queue_conf *conf)
@@ -102,6 +151,8 @@ dsw_queue_setup(struct rte_eventdev *dev, uint8_t queue_id,
 	if (RTE_EVENT_QUEUE_CFG_ALL_TYPES & conf->event_queue_cfg)
 		return -ENOTSUP;
 
+	dsw_queue_free_order_windows(queue);
+
 	/* SINGLE_LINK is better off treated as TYPE_ATOMIC, since it
 	 * avoid the "fake" TYPE_PARALLEL flow_id assignment. Since
 	 * the queue will only have a single serving port, no
@@ -111,9 +162,15 @@ dsw_queue_setup(struct rte_eventdev *dev, uint8_t queue_id,
 	if (RTE_EVENT_QUEUE_CFG_SINGLE_LINK & conf->event_queue_cfg)
 		queue->schedule_type = RTE_SCHED_TYPE_ATOMIC;
 	else {
-		if (conf->schedule_type == RTE_SCHED_TYPE_ORDERED)
-			return -ENOTSUP;
-		/* atomic or parallel */
+		if (conf->schedule_type == RTE_SCHED_TYPE_ORDERED) {
+			int rc;
+
+			rc = dsw_queue_alloc_order_windows(dev, queue,
+					conf->nb_atomic_order_sequences);
+			if (rc < 0)
+				return rc;
+		}
+		/* atomic, ordered or parallel */
 		queue->schedule_type = conf->schedule_type;
 	}
 
@@ -129,15 +186,18 @@ dsw_queue_def_conf(struct rte_eventdev *dev __rte_unused,
 {
 	*queue_conf = (struct rte_event_queue_conf) {
 		.nb_atomic_flows = 4096,
+		.nb_atomic_order_sequences = DSW_MAX_ORDER_SEQUENCES,
 		.schedule_type = RTE_SCHED_TYPE_ATOMIC,
 		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL
 	};
 }
 
 static void
-dsw_queue_release(struct rte_eventdev *dev __rte_unused,
-		  uint8_t queue_id __rte_unused)
+dsw_queue_release(struct rte_eventdev *dev, uint8_t queue_id)
 {
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+
+	dsw_queue_free_order_windows(&dsw->queues[queue_id]);
 }
 
 static void
@@ -229,11 +289,31 @@ dsw_configure(const struct rte_eventdev *dev)
 {
 	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
 	const struct rte_event_dev_config *conf = &dev->data->dev_conf;
+	uint16_t old_num_ports = dsw->num_ports;
 	int32_t min_max_in_flight;
+	uint8_t queue_id;
 
 	dsw->num_ports = conf->nb_event_ports;
 	dsw->num_queues = conf->nb_event_queues;
 
+	/* Ordered queues set up before the reconfiguration have one
+	 * reorder window per port of the old configuration.
+	 */
+	for (queue_id = 0; queue_id < dsw->num_queues &&
+		     dsw->num_ports != old_num_ports; queue_id++) {
+		struct dsw_queue *queue = &dsw->queues[queue_id];
+		uint32_t window_size = queue->order_window_size;
+		int rc;
+
+		if (queue->order_windows == NULL)
+			continue;
+
+		dsw_queue_free_order_windows(queue);
+		rc = dsw_queue_alloc_order_windows(dev, queue, window_size);
+		if (rc < 0)
+			return rc;
+	}
+
 	/* Avoid a situation where consumer ports are holding all the
 	 * credits, without making use of them.
 	 */
@@ -263,6 +343,39 @@ initial_flow_to_port_assignment(struct dsw_evdev *dsw)
 	}
 }
 
+static void
+dsw_reset_order_windows(struct dsw_evdev *dsw)
+{
+	uint16_t port_id;
+	uint8_t queue_id;
+
+	dsw->num_ordered_queues = 0;
+	rte_atomic32_init(&dsw->order_stalled);
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
+		struct dsw_queue *queue = &dsw->queues[queue_id];
+
+		if (queue->order_windows == NULL)
+			continue;
+
+		dsw->num_ordered_queues++;
+
+		for (port_id = 0; port_id < dsw->num_ports; port_id++) {
+			struct dsw_order_window *window =
+				&queue->order_windows[port_id];
+
+			window->next_seq = 0;
+			window->head = 0;
+			window->stalled = 0;
+			memset(window->slots, 0, queue->order_window_size *
+			       sizeof(struct dsw_order_slot));
+		}
+	}
+
+	for (port_id = 0; port_id < dsw->num_ports; port_id++)
+		dsw->ports[port_id].order_ctxs_len = 0;
+}
+
 static int
 dsw_start(struct rte_eventdev *dev)
 {
@@ -274,6 +387,8 @@ dsw_start(struct rte_eventdev *dev)
 
 	initial_flow_to_port_assignment(dsw);
 
+	dsw_reset_order_windows(dsw);
+
 	now = rte_get_timer_cycles();
 	for (i = 0; i < dsw->num_ports; i++) {
 		dsw->ports[i].measurement_start = now;
@@ -324,11 +439,33 @@ dsw_port_drain_in_ring(uint8_t dev_id, struct dsw_port *port,
 		flush(dev_id, ev, flush_arg);
 }
 
+static void
+dsw_queue_drain_order_windows(uint8_t dev_id, struct dsw_evdev *dsw,
+			      struct dsw_queue *queue,
+			      eventdev_stop_flush_t flush, void *flush_arg)
+{
+	uint16_t port_id;
+	uint16_t i;
+
+	for (port_id = 0; port_id < dsw->num_ports; port_id++) {
+		struct dsw_order_window *window =
+			&queue->order_windows[port_id];
+
+		for (i = 0; i < queue->order_window_size; i++) {
+			struct dsw_order_slot *slot = &window->slots[i];
+
+			if (slot->state == DSW_ORDER_SLOT_FORWARD)
+				flush(dev_id, slot->event, flush_arg);
+		}
+	}
+}
+
 static void
 dsw_drain(uint8_t dev_id, struct dsw_evdev *dsw,
 	  eventdev_stop_flush_t flush, void *flush_arg)
 {
 	uint16_t port_id;
+	uint8_t queue_id;
 
 	if (flush == NULL)
 		return;
@@ -340,6 +477,14 @@ dsw_drain(uint8_t dev_id, struct dsw_evdev *dsw,
 		dsw_port_drain_paused(dev_id, port, flush, flush_arg);
 		dsw_port_drain_in_ring(dev_id, port, flush, flush_arg);
 	}
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
+		struct dsw_queue *queue = &dsw->queues[queue_id];
+
+		if (queue->order_windows != NULL)
+			dsw_queue_drain_order_windows(dev_id, dsw, queue,
+						      flush, flush_arg);
+	}
 }
 
 static void
@@ -361,6 +506,10 @@ static int
 dsw_close(struct rte_eventdev *dev)
 {
 	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	uint8_t queue_id;
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++)
+		dsw_queue_free_order_windows(&dsw->queues[queue_id]);
 
 	dsw->num_ports = 0;
 	dsw->num_queues = 0;
@@ -384,7 +533,8 @@ static struct rte_eventdev_ops dsw_evdev_ops = {
 	.dev_close = dsw_close,
 	.xstats_get = dsw_xstats_get,
 	.xstats_get_names = dsw_xstats_get_names,
-	.xstats_get_by_name = dsw_xstats_get_by_name
+	.xstats_get_by_name = dsw_xstats_get_by_name,
+	.dev_selftest = test_dsw_eventdev
 };
 
 static int
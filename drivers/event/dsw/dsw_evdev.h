@@ -7,6 +7,7 @@
 
 #include <rte_event_ring.h>
 #include <rte_eventdev.h>
+#include <rte_spinlock.h>
 
 #define DSW_PMD_NAME RTE_STR(event_dsw)
 
@@ -36,6 +37,24 @@
  */
 #define DSW_PARALLEL_FLOWS (1024)
 
+/* Events on ordered queues are spread over the serving ports like
+ * parallel events, and are tagged with the id of the port which
+ * enqueued them, and a sequence number of the queue's reorder window
+ * of that source port. The tag takes the place of the flow id until
+ * dequeue, where the original flow id is restored.
+ *
+ * The events forwarded (or released) by the ports that dequeued them
+ * are put back in sequence order in the reorder window, and leave it
+ * in order, from whichever port completes the oldest event.
+ */
+#define DSW_MAX_ORDER_SEQUENCES (1024)
+#define DSW_ORDER_SEQ_BITS (14)
+#define DSW_ORDER_SEQ_MASK ((1<<(DSW_ORDER_SEQ_BITS))-1)
+#define DSW_ORDER_TAG(_port_id, _seq)				\
+	(((uint32_t)(_port_id)<<DSW_ORDER_SEQ_BITS)|((_seq)&DSW_ORDER_SEQ_MASK))
+#define DSW_ORDER_TAG_PORT(_tag) ((_tag)>>DSW_ORDER_SEQ_BITS)
+#define DSW_ORDER_TAG_SEQ(_tag) ((_tag)&DSW_ORDER_SEQ_MASK)
+
 /* 'Background tasks' are polling the control rings for *
  *  migration-related messages, or flush the output buffer (so
  *  buffered events doesn't linger too long). Shouldn't be too low,
@@ -109,6 +128,43 @@ struct dsw_queue_flow {
 	uint16_t flow_hash;
 };
 
+/* Reorder state of an event dequeued from an ordered queue. */
+struct dsw_order_ctx {
+	uint8_t ordered;
+	uint8_t queue_id;
+	uint8_t src_port_id;
+	uint16_t seq;
+};
+
+enum dsw_order_slot_state {
+	DSW_ORDER_SLOT_PENDING,
+	DSW_ORDER_SLOT_FORWARD,
+	DSW_ORDER_SLOT_RELEASE
+};
+
+struct dsw_order_slot {
+	struct rte_event event;
+	/* Flow id of the event, while it carries the order tag. */
+	uint32_t flow_id;
+	uint8_t state;
+};
+
+/* The events enqueued by one port to an ordered queue, in order. */
+struct dsw_order_window {
+	/* Only written by the source port. */
+	uint32_t next_seq;
+
+	rte_spinlock_t lock __rte_cache_aligned;
+	/* Oldest sequence number not yet retired. */
+	uint32_t head;
+	/* Reordered events are held up by a full downstream reorder
+	 * window, or by a paused flow.
+	 */
+	uint8_t stalled;
+
+	struct dsw_order_slot *slots;
+};
+
 enum dsw_migration_state {
 	DSW_MIGRATION_STATE_IDLE,
 	DSW_MIGRATION_STATE_PAUSING,
@@ -176,6 +232,13 @@ struct dsw_port {
 	uint16_t seen_events_idx;
 	struct dsw_queue_flow seen_events[DSW_MAX_EVENTS_RECORDED];
 
+	/* Reorder state of the dequeued events not yet forwarded or
+	 * released, in dequeue order.
+	 */
+	uint16_t order_ctxs_len;
+	uint16_t order_ctxs_start;
+	struct dsw_order_ctx order_ctxs[DSW_MAX_PORT_DEQUEUE_DEPTH];
+
 	uint64_t new_enqueued;
 	uint64_t forward_enqueued;
 	uint64_t release_enqueued;
@@ -207,6 +270,10 @@ struct dsw_queue {
 	uint8_t serving_ports[DSW_MAX_PORTS];
 	uint16_t num_serving_ports;
 
+	/* For ordered queues, one reorder window per source port. */
+	uint16_t order_window_size;
+	struct dsw_order_window *order_windows;
+
 	uint8_t flow_to_port_map[DSW_MAX_FLOWS] __rte_cache_aligned;
 };
 
@@ -217,9 +284,13 @@ struct dsw_evdev {
 	uint16_t num_ports;
 	struct dsw_queue queues[DSW_MAX_QUEUES];
 	uint8_t num_queues;
+	uint8_t num_ordered_queues;
 	int32_t max_inflight;
 
 	rte_atomic32_t credits_on_loan __rte_cache_aligned;
+
+	/* Number of reorder windows with stalled events. */
+	rte_atomic32_t order_stalled __rte_cache_aligned;
 };
 
 #define DSW_CTL_PAUS_REQ (0)
@@ -262,6 +333,8 @@ int dsw_xstats_get(const struct rte_eventdev *dev,
 uint64_t dsw_xstats_get_by_name(const struct rte_eventdev *dev,
 				const char *name, unsigned int *id);
 
+int test_dsw_eventdev(void);
+
 static inline struct dsw_evdev *
 dsw_pmd_priv(const struct rte_eventdev *eventdev)
 {
@@ -0,0 +1,277 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_eventdev.h>
+
+#include "dsw_evdev.h"
+
+#define TEST_NUM_PORTS (4)
+#define TEST_PRODUCER_PORT (TEST_NUM_PORTS-1)
+#define TEST_CONSUMER_PORT (0)
+#define TEST_ORDERED_QUEUE (0)
+#define TEST_ATOMIC_QUEUE (1)
+#define TEST_NUM_EVENTS (64)
+#define TEST_MAX_POLLS (1000)
+
+static int evdev;
+
+static int
+test_configure(uint8_t nb_ports)
+{
+	struct rte_event_dev_config config = {
+		.nb_event_queues = 2,
+		.nb_event_ports = nb_ports,
+		.nb_events_limit = 4096,
+		.nb_event_queue_flows = 1024,
+		.nb_event_port_dequeue_depth = DSW_MAX_PORT_DEQUEUE_DEPTH,
+		.nb_event_port_enqueue_depth = DSW_MAX_PORT_ENQUEUE_DEPTH
+	};
+
+	return rte_event_dev_configure(evdev, &config);
+}
+
+static int
+test_setup_queues(void)
+{
+	struct rte_event_queue_conf conf = {
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = TEST_NUM_EVENTS,
+		.schedule_type = RTE_SCHED_TYPE_ORDERED
+	};
+
+	if (rte_event_queue_setup(evdev, TEST_ORDERED_QUEUE, &conf) < 0)
+		return -1;
+
+	conf.schedule_type = RTE_SCHED_TYPE_ATOMIC;
+	if (rte_event_queue_setup(evdev, TEST_ATOMIC_QUEUE, &conf) < 0)
+		return -1;
+
+	return 0;
+}
+
+/* Ports 1 to 2 serve the ordered queue, port 0 the atomic queue, and
+ * the last port only produces events.
+ */
+static int
+test_setup_ports(void)
+{
+	struct rte_event_port_conf conf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = DSW_MAX_PORT_DEQUEUE_DEPTH,
+		.enqueue_depth = DSW_MAX_PORT_ENQUEUE_DEPTH
+	};
+	uint8_t ordered_queue = TEST_ORDERED_QUEUE;
+	uint8_t atomic_queue = TEST_ATOMIC_QUEUE;
+	uint8_t port_id;
+
+	for (port_id = 0; port_id < TEST_NUM_PORTS; port_id++)
+		if (rte_event_port_setup(evdev, port_id, &conf) < 0)
+			return -1;
+
+	if (rte_event_port_link(evdev, TEST_CONSUMER_PORT, &atomic_queue,
+				NULL, 1) != 1)
+		return -1;
+
+	for (port_id = 1; port_id < TEST_PRODUCER_PORT; port_id++)
+		if (rte_event_port_link(evdev, port_id, &ordered_queue,
+					NULL, 1) != 1)
+			return -1;
+
+	return 0;
+}
+
+/* Buffered events are only sent on the background task of the port,
+ * which an enqueue of zero events schedules for the next call.
+ */
+static void
+test_flush_port(uint8_t port_id)
+{
+	rte_event_enqueue_burst(evdev, port_id, NULL, 0);
+	rte_event_enqueue_burst(evdev, port_id, NULL, 0);
+}
+
+static int
+test_enqueue_all(uint8_t port_id, const struct rte_event *events,
+		 uint16_t num)
+{
+	uint16_t enqueued = 0;
+	int polls;
+
+	for (polls = 0; enqueued < num && polls < TEST_MAX_POLLS; polls++)
+		enqueued += rte_event_enqueue_burst(evdev, port_id,
+						    &events[enqueued],
+						    num - enqueued);
+
+	test_flush_port(port_id);
+
+	return enqueued == num ? 0 : -1;
+}
+
+/* The events forwarded by the ports serving the ordered queue must
+ * reach the next queue in the original order, whatever the order in
+ * which the ports forward them.
+ */
+static int
+test_ordered_across_ports(void)
+{
+	struct rte_event events[TEST_NUM_EVENTS];
+	struct rte_event port_events[TEST_NUM_PORTS][TEST_NUM_EVENTS];
+	uint16_t port_num[TEST_NUM_PORTS] = { 0 };
+	uint16_t num, total;
+	uint8_t port_id;
+	int polls;
+	int i;
+
+	for (i = 0; i < TEST_NUM_EVENTS; i++) {
+		memset(&events[i], 0, sizeof(events[i]));
+		events[i].op = RTE_EVENT_OP_NEW;
+		events[i].queue_id = TEST_ORDERED_QUEUE;
+		events[i].sched_type = RTE_SCHED_TYPE_ORDERED;
+		events[i].flow_id = i;
+		events[i].u64 = i;
+	}
+
+	if (test_enqueue_all(TEST_PRODUCER_PORT, events,
+			     TEST_NUM_EVENTS) < 0) {
+		printf("%d: failed to enqueue new events\n", __LINE__);
+		return -1;
+	}
+
+	total = 0;
+	for (polls = 0; total < TEST_NUM_EVENTS && polls < TEST_MAX_POLLS;
+	     polls++) {
+		for (port_id = 1; port_id < TEST_PRODUCER_PORT; port_id++) {
+			uint16_t len = port_num[port_id];
+
+			num = rte_event_dequeue_burst(evdev, port_id,
+						      &port_events[port_id][len],
+						      TEST_NUM_EVENTS - len, 0);
+			port_num[port_id] += num;
+			total += num;
+		}
+	}
+	if (total != TEST_NUM_EVENTS) {
+		printf("%d: dequeued %u of %u ordered events\n", __LINE__,
+		       total, TEST_NUM_EVENTS);
+		return -1;
+	}
+
+	/* forward from the last serving port first */
+	for (port_id = TEST_PRODUCER_PORT - 1; port_id > 0; port_id--) {
+		for (i = 0; i < port_num[port_id]; i++) {
+			struct rte_event *event = &port_events[port_id][i];
+
+			event->op = RTE_EVENT_OP_FORWARD;
+			event->queue_id = TEST_ATOMIC_QUEUE;
+			event->sched_type = RTE_SCHED_TYPE_ATOMIC;
+			event->flow_id = 0;
+		}
+		if (test_enqueue_all(port_id, port_events[port_id],
+				     port_num[port_id]) < 0) {
+			printf("%d: failed to forward events of port %u\n",
+			       __LINE__, port_id);
+			return -1;
+		}
+	}
+
+	total = 0;
+	for (polls = 0; total < TEST_NUM_EVENTS && polls < TEST_MAX_POLLS;
+	     polls++) {
+		for (port_id = 1; port_id < TEST_PRODUCER_PORT; port_id++)
+			test_flush_port(port_id);
+		total += rte_event_dequeue_burst(evdev, TEST_CONSUMER_PORT,
+						 &events[total],
+						 TEST_NUM_EVENTS - total, 0);
+	}
+	if (total != TEST_NUM_EVENTS) {
+		printf("%d: dequeued %u of %u forwarded events\n", __LINE__,
+		       total, TEST_NUM_EVENTS);
+		return -1;
+	}
+
+	for (i = 0; i < TEST_NUM_EVENTS; i++) {
+		if (events[i].queue_id != TEST_ATOMIC_QUEUE ||
+		    events[i].u64 != (uint64_t)i) {
+			printf("%d: event %d out of order (seq %"PRIu64")\n",
+			       __LINE__, i, events[i].u64);
+			return -1;
+		}
+	}
+
+	/* release the events on the consumer port */
+	rte_event_dequeue_burst(evdev, TEST_CONSUMER_PORT, events, 1, 0);
+
+	return 0;
+}
+
+/* The queues are set up with fewer ports than the producer port id,
+ * and kept across the reconfiguration adding the other ports, so that
+ * the reorder windows have to follow the number of ports.
+ */
+static int
+test_ordered(void)
+{
+	int ret;
+
+	if (test_configure(2) < 0 || test_setup_queues() < 0) {
+		printf("%d: failed to set up queues\n", __LINE__);
+		return -1;
+	}
+	if (test_configure(TEST_NUM_PORTS) < 0) {
+		printf("%d: failed to reconfigure\n", __LINE__);
+		return -1;
+	}
+	if (test_setup_ports() < 0) {
+		printf("%d: failed to set up ports\n", __LINE__);
+		return -1;
+	}
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: failed to start device\n", __LINE__);
+		return -1;
+	}
+
+	ret = test_ordered_across_ports();
+
+	rte_event_dev_stop(evdev);
+	if (rte_event_dev_close(evdev) < 0) {
+		printf("%d: failed to close device\n", __LINE__);
+		return -1;
+	}
+
+	return ret;
+}
+
+int
+test_dsw_eventdev(void)
+{
+	const char *eventdev_name = DSW_PMD_NAME;
+
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		printf("%d: Eventdev %s not found - creating.\n",
+		       __LINE__, eventdev_name);
+		if (rte_vdev_init(eventdev_name, NULL) < 0) {
+			printf("Error creating eventdev\n");
+			return -1;
+		}
+		evdev = rte_event_dev_get_dev_id(eventdev_name);
+		if (evdev < 0) {
+			printf("Error finding newly created eventdev\n");
+			return -1;
+		}
+	}
+
+	printf("*** Running Ordered Across Ports test...\n");
+	if (test_ordered() < 0) {
+		printf("ERROR - Ordered Across Ports test FAILED.\n");
+		return -1;
+	}
+
+	return 0;
+}
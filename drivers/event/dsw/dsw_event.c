@@ -266,6 +266,9 @@ dsw_port_remove_paused_flow(struct dsw_port *port, uint8_t queue_id,
 static void
 dsw_port_flush_out_buffers(struct dsw_evdev *dsw, struct dsw_port *source_port);
 
+static void
+dsw_port_order_drain_stalled(struct dsw_evdev *dsw, struct dsw_port *port);
+
 static void
 dsw_port_handle_pause_flow(struct dsw_evdev *dsw, struct dsw_port *port,
 			   uint8_t originating_port_id, uint8_t queue_id,
@@ -545,19 +548,66 @@ dsw_port_buffer_parallel(struct dsw_evdev *dsw, struct dsw_port *source_port,
 	dsw_port_buffer_non_paused(dsw, source_port, dest_port_id, &event);
 }
 
+static bool
+dsw_port_order_window_space(struct dsw_evdev *dsw, struct dsw_port *port,
+			    uint8_t queue_id, uint16_t num)
+{
+	struct dsw_queue *queue = &dsw->queues[queue_id];
+	struct dsw_order_window *window = &queue->order_windows[port->id];
+	uint32_t head;
+
+	head = __atomic_load_n(&window->head, __ATOMIC_ACQUIRE);
+
+	return window->next_seq - head + num <= queue->order_window_size;
+}
+
+static void
+dsw_port_buffer_ordered(struct dsw_evdev *dsw, struct dsw_port *source_port,
+			struct rte_event event)
+{
+	struct dsw_queue *queue = &dsw->queues[event.queue_id];
+	struct dsw_order_window *window =
+		&queue->order_windows[source_port->id];
+	uint32_t seq = window->next_seq;
+	uint8_t dest_port_id;
+
+	/* The slot was reset when its previous sequence number was
+	 * retired, and is not visible to any other port before the
+	 * event is enqueued.
+	 */
+	window->slots[seq & (queue->order_window_size - 1)].flow_id =
+		event.flow_id;
+	window->next_seq++;
+
+	/* Spread the events over the serving ports like parallel
+	 * events, the tag serving as flow id for the migrations.
+	 */
+	event.flow_id = DSW_ORDER_TAG(source_port->id, seq);
+
+	dest_port_id = dsw_schedule(dsw, event.queue_id,
+				    dsw_flow_id_hash(event.flow_id));
+
+	dsw_port_buffer_non_paused(dsw, source_port, dest_port_id, &event);
+}
+
 static void
 dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *source_port,
 		      const struct rte_event *event)
 {
+	uint8_t schedule_type = dsw->queues[event->queue_id].schedule_type;
 	uint16_t flow_hash;
 	uint8_t dest_port_id;
 
-	if (unlikely(dsw->queues[event->queue_id].schedule_type ==
-		     RTE_SCHED_TYPE_PARALLEL)) {
+	if (unlikely(schedule_type == RTE_SCHED_TYPE_PARALLEL)) {
 		dsw_port_buffer_parallel(dsw, source_port, *event);
 		return;
 	}
 
+	if (unlikely(schedule_type == RTE_SCHED_TYPE_ORDERED)) {
+		dsw_port_buffer_ordered(dsw, source_port, *event);
+		return;
+	}
+
 	flow_hash = dsw_flow_id_hash(event->flow_id);
 
 	if (unlikely(dsw_port_is_flow_paused(source_port, event->queue_id,
@@ -630,7 +680,7 @@ dsw_port_end_migration(struct dsw_evdev *dsw, struct dsw_port *port)
 
 	dsw_port_migration_stats(port);
 
-	if (dsw->queues[queue_id].schedule_type != RTE_SCHED_TYPE_PARALLEL) {
+	if (dsw->queues[queue_id].schedule_type == RTE_SCHED_TYPE_ATOMIC) {
 		dsw_port_remove_paused_flow(port, queue_id, flow_hash);
 		dsw_port_flush_paused_events(dsw, port, queue_id, flow_hash);
 	}
@@ -759,11 +809,12 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 
 	/* No need to go through the whole pause procedure for
 	 * parallel queues, since atomic/ordered semantics need not to
-	 * be maintained.
+	 * be maintained, nor for ordered queues, since the order is
+	 * restored by the reorder windows.
 	 */
 
 	if (dsw->queues[source_port->migration_target_qf.queue_id].schedule_type
-	    == RTE_SCHED_TYPE_PARALLEL) {
+	    != RTE_SCHED_TYPE_ATOMIC) {
 		uint8_t queue_id = source_port->migration_target_qf.queue_id;
 		uint16_t flow_hash = source_port->migration_target_qf.flow_hash;
 		uint8_t dest_port_id = source_port->migration_target_port_id;
@@ -998,6 +1049,9 @@ dsw_port_bg_process(struct dsw_evdev *dsw, struct dsw_port *port)
 
 		dsw_port_consider_migration(dsw, port, now);
 
+		if (unlikely(rte_atomic32_read(&dsw->order_stalled) > 0))
+			dsw_port_order_drain_stalled(dsw, port);
+
 		port->ops_since_bg_task = 0;
 	}
 }
@@ -1011,6 +1065,257 @@ dsw_port_flush_out_buffers(struct dsw_evdev *dsw, struct dsw_port *source_port)
 		dsw_port_transmit_buffered(dsw, source_port, dest_port_id);
 }
 
+static void
+dsw_order_window_set_stalled(struct dsw_evdev *dsw,
+			     struct dsw_order_window *window, bool stalled)
+{
+	if (stalled == window->stalled)
+		return;
+
+	window->stalled = stalled;
+
+	if (stalled)
+		rte_atomic32_inc(&dsw->order_stalled);
+	else
+		rte_atomic32_dec(&dsw->order_stalled);
+}
+
+static bool
+dsw_port_order_emit(struct dsw_evdev *dsw, struct dsw_port *port,
+		    const struct rte_event *event)
+{
+	switch (dsw->queues[event->queue_id].schedule_type) {
+	case RTE_SCHED_TYPE_ORDERED:
+		if (!dsw_port_order_window_space(dsw, port, event->queue_id,
+						 1))
+			return false;
+		break;
+	case RTE_SCHED_TYPE_ATOMIC:
+		/* Paused events of this port would be overtaken by the
+		 * next events of the window, sent by another port.
+		 */
+		if (dsw_port_is_flow_paused(port, event->queue_id,
+					    dsw_flow_id_hash(event->flow_id)))
+			return false;
+		break;
+	}
+
+	dsw_port_buffer_event(dsw, port, event);
+
+	return true;
+}
+
+static void
+dsw_port_order_drain(struct dsw_evdev *dsw, struct dsw_port *port,
+		     struct dsw_queue *queue, struct dsw_order_window *window)
+{
+	const uint32_t mask = queue->order_window_size - 1;
+
+	while (rte_spinlock_trylock(&window->lock)) {
+		uint32_t head = window->head;
+		struct dsw_order_slot *slot;
+		bool stalled = false;
+		uint8_t state;
+
+		for (;;) {
+			slot = &window->slots[head & mask];
+			state = __atomic_load_n(&slot->state,
+						__ATOMIC_ACQUIRE);
+
+			if (state == DSW_ORDER_SLOT_PENDING)
+				break;
+
+			if (state == DSW_ORDER_SLOT_FORWARD &&
+			    !dsw_port_order_emit(dsw, port, &slot->event)) {
+				stalled = true;
+				break;
+			}
+
+			slot->state = DSW_ORDER_SLOT_PENDING;
+			head++;
+		}
+
+		/* The events must reach the destination rings before
+		 * another port may send the following ones.
+		 */
+		dsw_port_flush_out_buffers(dsw, port);
+
+		__atomic_store_n(&window->head, head, __ATOMIC_RELEASE);
+		dsw_order_window_set_stalled(dsw, window, stalled);
+
+		rte_spinlock_unlock(&window->lock);
+
+		if (stalled)
+			return;
+
+		/* The port completing the head slot while the lock
+		 * was held may have failed to take it.
+		 */
+		rte_smp_mb();
+
+		if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) ==
+		    DSW_ORDER_SLOT_PENDING)
+			return;
+	}
+}
+
+static void
+dsw_port_order_retire(struct dsw_evdev *dsw, struct dsw_port *port,
+		      const struct dsw_order_ctx *ctx,
+		      const struct rte_event *event)
+{
+	struct dsw_queue *queue = &dsw->queues[ctx->queue_id];
+	struct dsw_order_window *window =
+		&queue->order_windows[ctx->src_port_id];
+	const uint32_t mask = queue->order_window_size - 1;
+	struct dsw_order_slot *slot = &window->slots[ctx->seq & mask];
+	uint32_t head;
+
+	if (event != NULL && event->op != RTE_EVENT_OP_RELEASE) {
+		slot->event = *event;
+		__atomic_store_n(&slot->state, DSW_ORDER_SLOT_FORWARD,
+				 __ATOMIC_RELEASE);
+	} else
+		__atomic_store_n(&slot->state, DSW_ORDER_SLOT_RELEASE,
+				 __ATOMIC_RELEASE);
+
+	/* Either this port sees the head reaching the slot, or the
+	 * port moving the head sees the slot completed.
+	 */
+	rte_smp_mb();
+
+	head = __atomic_load_n(&window->head, __ATOMIC_RELAXED);
+
+	if ((head & mask) == (ctx->seq & mask))
+		dsw_port_order_drain(dsw, port, queue, window);
+}
+
+/* Forward or release (if event is NULL or a release) the oldest
+ * event dequeued by the port and not yet forwarded or released.
+ */
+static void
+dsw_port_order_complete(struct dsw_evdev *dsw, struct dsw_port *port,
+			const struct rte_event *event)
+{
+	struct dsw_order_ctx *ctx = &port->order_ctxs[port->order_ctxs_start];
+
+	port->order_ctxs_start++;
+	port->order_ctxs_len--;
+
+	if (ctx->ordered)
+		dsw_port_order_retire(dsw, port, ctx, event);
+	else if (event != NULL && event->op != RTE_EVENT_OP_RELEASE)
+		dsw_port_buffer_event(dsw, port, event);
+}
+
+static void
+dsw_port_order_release_all(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	while (port->order_ctxs_len > 0)
+		dsw_port_order_complete(dsw, port, NULL);
+}
+
+static void
+dsw_port_order_record(struct dsw_evdev *dsw, struct dsw_port *port,
+		      struct rte_event *events, uint16_t num)
+{
+	uint16_t i;
+
+	port->order_ctxs_start = 0;
+	port->order_ctxs_len = num;
+
+	for (i = 0; i < num; i++) {
+		struct rte_event *event = &events[i];
+		struct dsw_order_ctx *ctx = &port->order_ctxs[i];
+		struct dsw_queue *queue = &dsw->queues[event->queue_id];
+		struct dsw_order_window *window;
+
+		ctx->ordered =
+			(queue->schedule_type == RTE_SCHED_TYPE_ORDERED);
+		if (!ctx->ordered)
+			continue;
+
+		ctx->queue_id = event->queue_id;
+		ctx->src_port_id = DSW_ORDER_TAG_PORT(event->flow_id);
+		ctx->seq = DSW_ORDER_TAG_SEQ(event->flow_id);
+
+		window = &queue->order_windows[ctx->src_port_id];
+		event->flow_id = window->slots[ctx->seq &
+				(queue->order_window_size - 1)].flow_id;
+	}
+}
+
+static void
+dsw_port_order_drain_stalled(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	uint8_t queue_id;
+	uint16_t port_id;
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
+		struct dsw_queue *queue = &dsw->queues[queue_id];
+
+		if (queue->order_windows == NULL)
+			continue;
+
+		for (port_id = 0; port_id < dsw->num_ports; port_id++) {
+			struct dsw_order_window *window =
+				&queue->order_windows[port_id];
+
+			if (window->stalled)
+				dsw_port_order_drain(dsw, port, queue,
+						     window);
+		}
+	}
+}
+
+/* Check there is room in the reorder windows of the port for the
+ * events of the burst going to ordered queues.
+ */
+static bool
+dsw_port_order_check_space(struct dsw_evdev *dsw, struct dsw_port *port,
+			   const struct rte_event events[],
+			   uint16_t events_len)
+{
+	uint16_t needed[DSW_MAX_QUEUES] = { 0 };
+	uint16_t ctx_idx = port->order_ctxs_start;
+	uint16_t ctxs_left = port->order_ctxs_len;
+	bool any_needed = false;
+	uint16_t i;
+
+	for (i = 0; i < events_len; i++) {
+		const struct rte_event *event = &events[i];
+		bool ordered_ctx = false;
+
+		if (event->op != RTE_EVENT_OP_NEW && ctxs_left > 0) {
+			ordered_ctx = port->order_ctxs[ctx_idx].ordered;
+			ctx_idx++;
+			ctxs_left--;
+		}
+
+		/* Forwarded ordered events first go to the reorder
+		 * window they were dequeued from.
+		 */
+		if (event->op == RTE_EVENT_OP_RELEASE || ordered_ctx)
+			continue;
+
+		if (dsw->queues[event->queue_id].schedule_type ==
+		    RTE_SCHED_TYPE_ORDERED) {
+			needed[event->queue_id]++;
+			any_needed = true;
+		}
+	}
+
+	if (!any_needed)
+		return true;
+
+	for (i = 0; i < dsw->num_queues; i++)
+		if (needed[i] > 0 &&
+		    !dsw_port_order_window_space(dsw, port, i, needed[i]))
+			return false;
+
+	return true;
+}
+
 uint16_t
 dsw_event_enqueue(void *port, const struct rte_event *ev)
 {
@@ -1079,6 +1384,10 @@ dsw_event_enqueue_burst_generic(void *port, const struct rte_event events[],
 		     source_port->new_event_threshold))
 		return 0;
 
+	if (unlikely(dsw->num_ordered_queues > 0) &&
+	    !dsw_port_order_check_space(dsw, source_port, events, events_len))
+		return 0;
+
 	enough_credits = dsw_port_acquire_credits(dsw, source_port,
 						  num_non_release);
 	if (unlikely(!enough_credits))
@@ -1092,8 +1401,11 @@ dsw_event_enqueue_burst_generic(void *port, const struct rte_event events[],
 	for (i = 0; i < events_len; i++) {
 		const struct rte_event *event = &events[i];
 
-		if (likely(num_release == 0 ||
-			   event->op != RTE_EVENT_OP_RELEASE))
+		if (unlikely(source_port->order_ctxs_len > 0 &&
+			     event->op != RTE_EVENT_OP_NEW))
+			dsw_port_order_complete(dsw, source_port, event);
+		else if (likely(num_release == 0 ||
+				event->op != RTE_EVENT_OP_RELEASE))
 			dsw_port_buffer_event(dsw, source_port, event);
 		dsw_port_queue_enqueue_stats(source_port, event->queue_id);
 	}
@@ -1101,7 +1413,7 @@ dsw_event_enqueue_burst_generic(void *port, const struct rte_event events[],
 	DSW_LOG_DP_PORT(DEBUG, source_port->id, "%d non-release events "
 			"accepted.\n", num_non_release);
 
-	return num_non_release;
+	return events_len;
 }
 
 uint16_t
@@ -1212,6 +1524,10 @@ dsw_event_dequeue_burst(void *port, struct rte_event *events, uint16_t num,
 
 	source_port->pending_releases = 0;
 
+	/* Events of ordered queues are released implicitly too. */
+	if (unlikely(source_port->order_ctxs_len > 0))
+		dsw_port_order_release_all(dsw, source_port);
+
 	dsw_port_bg_process(dsw, source_port);
 
 	if (unlikely(num > source_port->dequeue_depth))
@@ -1249,5 +1565,11 @@ dsw_event_dequeue_burst(void *port, struct rte_event *events, uint16_t num,
 	dsw_stable_sort(events, dequeued, sizeof(events[0]), dsw_cmp_event);
 #endif
 
+	/* The reorder state follows the order the application sees
+	 * the events in.
+	 */
+	if (unlikely(dsw->num_ordered_queues > 0))
+		dsw_port_order_record(dsw, source_port, events, dequeued);
+
 	return dequeued;
 }
@@ -19,6 +19,7 @@
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define SCHED_PARTITIONS_ARG "sched_partitions"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
@@ -47,6 +48,14 @@ sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
 			break;
 		}
 
+		/* partitions are assigned on start, a running port can only
+		 * be linked to the QIDs scheduled by its partition
+		 */
+		if (sw->started && q->part != p->part) {
+			rte_errno = EINVAL;
+			break;
+		}
+
 		for (j = 0; j < q->cq_num_mapped_cqs; j++) {
 			if (q->cq_map[j] == p->id)
 				break;
@@ -369,7 +378,7 @@ sw_init_qid_iqs(struct sw_evdev *sw)
 			continue;
 
 		for (j = 0; j < SW_IQS_MAX; j++)
-			iq_init(sw, &qid->iq[j]);
+			iq_init(&sw->parts[qid->part], &qid->iq[j]);
 	}
 }
 
@@ -385,6 +394,16 @@ sw_qids_empty(struct sw_evdev *sw)
 		}
 	}
 
+	/* events on their way to another partition */
+	for (i = 0; i < sw->sched_partitions; i++) {
+		for (j = 0; j < sw->sched_partitions; j++) {
+			struct rte_event_ring *r = sw->parts[i].out_rings[j];
+
+			if (r != NULL && rte_event_ring_count(r))
+				return 0;
+		}
+	}
+
 	return 1;
 }
 
@@ -429,9 +448,9 @@ sw_drain_ports(struct rte_eventdev *dev)
 }
 
 static void
-sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
+sw_drain_queue(struct rte_eventdev *dev, struct sw_sched_part *part,
+		struct sw_iq *iq)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	eventdev_stop_flush_t flush;
 	uint8_t dev_id;
 	void *arg;
@@ -443,7 +462,7 @@ sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
 	while (iq_count(iq) > 0) {
 		struct rte_event ev;
 
-		iq_dequeue_burst(sw, iq, &ev, 1);
+		iq_dequeue_burst(part, iq, &ev, 1);
 
 		if (flush)
 			flush(dev_id, ev, arg);
@@ -457,8 +476,11 @@ sw_drain_queues(struct rte_eventdev *dev)
 	unsigned int i, j;
 
 	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+
 		for (j = 0; j < SW_IQS_MAX; j++)
-			sw_drain_queue(dev, &sw->qids[i].iq[j]);
+			sw_drain_queue(dev, &sw->parts[qid->part],
+					&qid->iq[j]);
 	}
 }
 
@@ -475,7 +497,8 @@ sw_clean_qid_iqs(struct rte_eventdev *dev)
 		for (j = 0; j < SW_IQS_MAX; j++) {
 			if (!qid->iq[j].head)
 				continue;
-			iq_free_chunk_list(sw, qid->iq[j].head);
+			iq_free_chunk_list(&sw->parts[qid->part],
+					qid->iq[j].head);
 			qid->iq[j].head = NULL;
 		}
 	}
@@ -517,16 +540,26 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
-	int num_chunks, i;
+	char buf[RTE_RING_NAMESIZE];
+	int num_chunks;
+	uint32_t i, j;
 
 	sw->qid_count = conf->nb_event_queues;
 	sw->port_count = conf->nb_event_ports;
 	sw->nb_events_limit = conf->nb_events_limit;
 	rte_atomic32_set(&sw->inflights, 0);
+	/* the credits cached by ports set up before are taken from the
+	 * pool reset above, drop them so that they are not returned twice
+	 */
+	for (i = 0; i < RTE_DIM(sw->ports); i++)
+		sw->ports[i].inflight_credits = 0;
 
-	/* Number of chunks sized for worst-case spread of events across IQs */
-	num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
-			sw->qid_count*SW_IQS_MAX*2;
+	/* Number of chunks sized for worst-case spread of events across IQs,
+	 * all the events of the device may be in the IQs of any partition.
+	 * The chunks are distributed to the partitions in sw_start().
+	 */
+	num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) *
+			sw->sched_partitions + sw->qid_count*SW_IQS_MAX*2;
 
 	/* If this is a reconfiguration, free the previous IQ allocation. All
 	 * IQ chunk references were cleaned out of the QIDs in sw_stop(), and
@@ -543,9 +576,31 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	if (!sw->chunks)
 		return -ENOMEM;
 
-	sw->chunk_list_head = NULL;
-	for (i = 0; i < num_chunks; i++)
-		iq_free_chunk(sw, &sw->chunks[i]);
+	/* Rings of the events sent by a partition to the QIDs of another
+	 * one, large enough to hold all the events of the device.
+	 */
+	for (i = 0; i < sw->sched_partitions; i++) {
+		for (j = 0; j < sw->sched_partitions; j++) {
+			struct sw_sched_part *part = &sw->parts[i];
+
+			if (i == j)
+				continue;
+
+			snprintf(buf, sizeof(buf), "sw%d_pt%u_%u",
+					data->dev_id, i, j);
+			if (part->out_rings[j] == NULL)
+				part->out_rings[j] = rte_event_ring_create(buf,
+						SW_INFLIGHT_EVENTS_TOTAL,
+						data->socket_id,
+						RING_F_SP_ENQ | RING_F_SC_DEQ |
+						RING_F_EXACT_SZ);
+			if (part->out_rings[j] == NULL) {
+				SW_LOG_ERR("Error creating partition ring %s\n",
+						buf);
+				return -ENOMEM;
+			}
+		}
+	}
 
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
@@ -629,16 +684,36 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	static const char * const q_type_strings[] = {
 			"Ordered", "Atomic", "Parallel", "Directed"
 	};
+	struct sw_point_stats stats = {0};
+	uint64_t sched_called = 0, sched_cq_qid_called = 0;
+	uint64_t sched_no_iq_enqueues = 0, sched_no_cq_enqueues = 0;
+	uint64_t sched_part_ring_drops = 0;
 	uint32_t i;
-	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
-			sw->port_count, sw->qid_count);
+	fprintf(f, "EventDev %s: ports %d, qids %d, partitions %d\n",
+			"todo-fix-name", sw->port_count, sw->qid_count,
+			sw->sched_partitions);
+
+	for (i = 0; i < sw->sched_partitions; i++) {
+		const struct sw_sched_part *part = &sw->parts[i];
+
+		stats.rx_pkts += part->stats.rx_pkts;
+		stats.rx_dropped += part->stats.rx_dropped;
+		stats.tx_pkts += part->stats.tx_pkts;
+		sched_called += part->sched_called;
+		sched_cq_qid_called += part->sched_cq_qid_called;
+		sched_no_iq_enqueues += part->sched_no_iq_enqueues;
+		sched_no_cq_enqueues += part->sched_no_cq_enqueues;
+		sched_part_ring_drops += part->sched_part_ring_drops;
+	}
 
 	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+		stats.rx_pkts, stats.rx_dropped, stats.tx_pkts);
+	fprintf(f, "\tsched calls: %"PRIu64"\n", sched_called);
+	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sched_cq_qid_called);
+	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sched_no_iq_enqueues);
+	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sched_no_cq_enqueues);
+	fprintf(f, "\tsched partition ring drop: %"PRIu64"\n",
+			sched_part_ring_drops);
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -654,8 +729,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 				COL_RED, i, COL_RESET);
 			continue;
 		}
-		fprintf(f, "  Port %d %s\n", i,
-			p->is_directed ? " (SingleCons)" : "");
+		fprintf(f, "  Port %d %s(partition %u)\n", i,
+			p->is_directed ? " (SingleCons) " : "", p->part);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64
 			"\t%sinflight %d%s\n", sw->ports[i].stats.rx_pkts,
 			sw->ports[i].stats.rx_dropped,
@@ -719,7 +794,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		int affinities_per_port[SW_PORTS_MAX] = {0};
 		uint32_t inflights = 0;
 
-		fprintf(f, "  Queue %d (%s)\n", i, q_type_strings[qid->type]);
+		fprintf(f, "  Queue %d (%s, partition %u)\n", i,
+			q_type_strings[qid->type], qid->part);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64"\n",
 			qid->stats.rx_pkts, qid->stats.rx_dropped,
 			qid->stats.tx_pkts);
@@ -770,6 +846,108 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	}
 }
 
+/* Find the group of a QID or port in the link graph */
+static uint32_t
+sw_part_find(uint32_t *parent, uint32_t node)
+{
+	while (parent[node] != node)
+		node = parent[node] = parent[parent[node]];
+	return node;
+}
+
+/* Split the QIDs and ports in the scheduler partitions. The QIDs and ports
+ * connected by links form groups which are scheduled by a single partition,
+ * the largest groups being assigned first to the least loaded partition.
+ */
+static void
+sw_assign_parts(struct sw_evdev *sw)
+{
+	const uint32_t nb_nodes = sw->qid_count + sw->port_count;
+	uint32_t parent[RTE_EVENT_MAX_QUEUES_PER_DEV + SW_PORTS_MAX];
+	uint32_t weight[RTE_EVENT_MAX_QUEUES_PER_DEV + SW_PORTS_MAX];
+	int32_t group_part[RTE_EVENT_MAX_QUEUES_PER_DEV + SW_PORTS_MAX];
+	uint32_t load[SW_SCHED_PARTITIONS_MAX] = {0};
+	uint32_t nb_qids[SW_SCHED_PARTITIONS_MAX] = {0};
+	uint32_t i, j, chunk;
+
+	/* ports are the nodes following the QIDs */
+	for (i = 0; i < nb_nodes; i++) {
+		parent[i] = i;
+		weight[i] = 0;
+		group_part[i] = -1;
+	}
+
+	for (i = 0; i < sw->qid_count; i++) {
+		const struct sw_qid *qid = &sw->qids[i];
+
+		for (j = 0; j < qid->cq_num_mapped_cqs; j++) {
+			uint32_t a = sw_part_find(parent, i);
+			uint32_t b = sw_part_find(parent,
+					sw->qid_count + qid->cq_map[j]);
+
+			parent[b] = a;
+		}
+	}
+
+	for (i = 0; i < nb_nodes; i++)
+		weight[sw_part_find(parent, i)]++;
+
+	for (;;) {
+		uint32_t group = nb_nodes, max = 0, part = 0;
+
+		for (i = 0; i < nb_nodes; i++) {
+			if (parent[i] == i && group_part[i] < 0 &&
+					weight[i] > max) {
+				group = i;
+				max = weight[i];
+			}
+		}
+		if (group == nb_nodes)
+			break;
+
+		for (j = 1; j < sw->sched_partitions; j++)
+			if (load[j] < load[part])
+				part = j;
+
+		group_part[group] = part;
+		load[part] += max;
+	}
+
+	for (i = 0; i < sw->sched_partitions; i++) {
+		sw->parts[i].qid_count = 0;
+		sw->parts[i].port_count = 0;
+		sw->parts[i].chunk_list_head = NULL;
+	}
+
+	for (i = 0; i < sw->qid_count; i++) {
+		sw->qids[i].part = group_part[sw_part_find(parent, i)];
+		nb_qids[sw->qids[i].part]++;
+	}
+
+	for (i = 0; i < sw->port_count; i++) {
+		struct sw_port *p = &sw->ports[i];
+		struct sw_sched_part *part;
+
+		p->part = group_part[sw_part_find(parent, sw->qid_count + i)];
+		part = &sw->parts[p->part];
+		part->ports[part->port_count++] = i;
+	}
+
+	/* Give each partition the IQ chunks for the worst-case spread of the
+	 * events of the device across its IQs, as counted in
+	 * sw_dev_configure().
+	 */
+	chunk = 0;
+	for (i = 0; i < sw->sched_partitions; i++) {
+		uint32_t num_chunks =
+			((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
+			nb_qids[i]*SW_IQS_MAX*2;
+
+		for (j = 0; j < num_chunks; j++)
+			iq_free_chunk(&sw->parts[i], &sw->chunks[chunk++]);
+	}
+}
+
 static int
 sw_start(struct rte_eventdev *dev)
 {
@@ -800,19 +978,22 @@ sw_start(struct rte_eventdev *dev)
 			return -ENOLINK;
 		}
 
-	/* build up our prioritized array of qids */
+	sw_assign_parts(sw);
+
+	/* build up our prioritized arrays of qids */
 	/* We don't use qsort here, as if all/multiple entries have the same
 	 * priority, the result is non-deterministic. From "man 3 qsort":
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
-			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
-			}
+			struct sw_sched_part *part =
+				&sw->parts[sw->qids[i].part];
+
+			if (sw->qids[i].priority == j)
+				part->qids_prioritized[part->qid_count++] =
+					&sw->qids[i];
 		}
 	}
 
@@ -832,6 +1013,7 @@ sw_stop(struct rte_eventdev *dev)
 {
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	int32_t runstate;
+	uint32_t i;
 
 	/* Stop the scheduler if it's running */
 	runstate = rte_service_runstate_get(sw->service_id);
@@ -843,7 +1025,9 @@ sw_stop(struct rte_eventdev *dev)
 
 	/* Flush all events out of the device */
 	while (!(sw_qids_empty(sw) && sw_ports_empty(sw))) {
-		sw_event_schedule(dev);
+		/* each call schedules one of the partitions */
+		for (i = 0; i < sw->sched_partitions; i++)
+			sw_event_schedule(dev);
 		sw_drain_ports(dev);
 		sw_drain_queues(dev);
 	}
@@ -871,11 +1055,21 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->sched_partitions; i++) {
+		struct sw_sched_part *part = &sw->parts[i];
+		uint32_t j;
+
+		for (j = 0; j < sw->sched_partitions; j++) {
+			rte_event_ring_free(part->out_rings[j]);
+			part->out_rings[j] = NULL;
+		}
+
+		memset(&part->stats, 0, sizeof(part->stats));
+		part->sched_called = 0;
+		part->sched_no_iq_enqueues = 0;
+		part->sched_no_cq_enqueues = 0;
+		part->sched_cq_qid_called = 0;
+	}
 
 	return 0;
 }
@@ -911,11 +1105,24 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 }
 
 
+static int
+set_sched_partitions(const char *key __rte_unused, const char *value,
+		void *opaque)
+{
+	int *partitions = opaque;
+	*partitions = atoi(value);
+	if (*partitions < 1 || *partitions > SW_SCHED_PARTITIONS_MAX)
+		return -1;
+	return 0;
+}
+
 static int32_t sw_sched_service_func(void *args)
 {
 	struct rte_eventdev *dev = args;
-	sw_event_schedule(dev);
-	return 0;
+	uint32_t nb_events = sw_event_schedule(dev);
+
+	/* events pulled from the ports and pushed to the CQs */
+	return nb_events != 0 ? (int32_t)nb_events : -EAGAIN;
 }
 
 static int
@@ -957,6 +1164,7 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		SCHED_PARTITIONS_ARG,
 		NULL
 	};
 	const char *name;
@@ -966,6 +1174,8 @@ sw_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int sched_partitions = 1;
+	uint32_t i;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -1007,13 +1217,25 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_PARTITIONS_ARG,
+					set_sched_partitions,
+					&sched_partitions);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched partitions parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, sched_partitions=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			sched_partitions);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -1038,6 +1260,11 @@ sw_probe(struct rte_vdev_device *vdev)
 	/* copy values passed from vdev command line to instance */
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
+	sw->sched_partitions = sched_partitions;
+	for (i = 0; i < RTE_DIM(sw->parts); i++) {
+		rte_spinlock_init(&sw->parts[i].lock);
+		sw->parts[i].id = i;
+	}
 
 	/* register service with EAL */
 	struct rte_service_spec service;
@@ -1048,6 +1275,9 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	/* the partitions can be scheduled by several cores in parallel */
+	if (sched_partitions > 1)
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
@@ -1082,7 +1312,8 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int> " CREDIT_QUANTA_ARG "=<int> "
+		SCHED_PARTITIONS_ARG "=<int>");
 
 /* declared extern in header, for access from other .c files */
 int eventdev_sw_log_level;
@@ -9,6 +9,7 @@
 #include <rte_eventdev.h>
 #include <rte_eventdev_pmd_vdev.h>
 #include <rte_atomic.h>
+#include <rte_spinlock.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
@@ -21,6 +22,7 @@
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+#define SW_SCHED_PARTITIONS_MAX 8
 
 /* Should be power-of-two minus one, to leave room for the next pointer */
 #define SW_EVS_PER_Q_CHUNK 255
@@ -127,6 +129,8 @@ struct sw_qid {
 	uint32_t window_size;          /* Used to wrap reorder_buffer_index */
 
 	uint8_t priority;
+	/* scheduler partition owning this QID, set on start */
+	uint8_t part;
 };
 
 struct sw_hist_list_entry {
@@ -156,6 +160,11 @@ struct sw_port {
 	 */
 	uint8_t unlinks_in_progress;
 
+	/* scheduler partition pulling events from and filling the CQ of this
+	 * port, set on start
+	 */
+	uint8_t part;
+
 	int16_t is_directed; /** Takes from a single directed QID */
 	/**
 	 * For loadbalanced we can optimise pulling packets from
@@ -203,6 +212,36 @@ struct sw_port {
 	uint8_t num_qids_mapped;
 };
 
+/* Scheduling state of a partition of the QIDs and ports. Each partition
+ * is scheduled by one core at a time, see sw_event_schedule().
+ */
+struct sw_sched_part {
+	rte_spinlock_t lock; /* held by the core scheduling the partition */
+	uint8_t id;
+
+	/* Array of pointers to the QIDs of the partition sorted by priority */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* Ports whose events are pulled by the partition */
+	uint32_t port_count;
+	uint8_t ports[SW_PORTS_MAX];
+
+	/* Free IQ chunks of the QIDs of the partition */
+	struct sw_queue_chunk *chunk_list_head;
+
+	/* Events sent to the QIDs of each other partition, in FIFO order */
+	struct rte_event_ring *out_rings[SW_SCHED_PARTITIONS_MAX];
+
+	/* Stats */
+	struct sw_point_stats stats;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+	uint64_t sched_part_ring_drops; /* ring of another partition full */
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -227,22 +266,18 @@ struct sw_evdev {
 
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
-	struct sw_queue_chunk *chunk_list_head;
 	struct sw_queue_chunk *chunks;
 
 	/* Cache how many packets are in each cq */
 	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	/* QIDs and ports are split in partitions scheduled in parallel, the
+	 * ports linked to a QID being in the partition of the QID.
+	 */
+	uint32_t sched_partitions;
+	struct sw_sched_part parts[SW_SCHED_PARTITIONS_MAX];
 
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
 
 	uint8_t started;
 	uint32_t credit_update_quanta;
@@ -277,7 +312,7 @@ uint16_t sw_event_enqueue_burst(void *port, const struct rte_event ev[],
 uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
-void sw_event_schedule(struct rte_eventdev *dev);
+uint32_t sw_event_schedule(struct rte_eventdev *dev);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
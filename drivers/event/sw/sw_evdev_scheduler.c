@@ -26,9 +26,34 @@
 /* use cheap bit mixing, we only need to lose a few bits */
 #define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
 
+/* Partition to try first on the next call of this lcore */
+static RTE_DEFINE_PER_LCORE(uint32_t, sw_sched_part_next);
+
+/* Push an event to an IQ of its QID, or to the ring of the partition owning
+ * the QID. Returns 1 if the event was enqueued to an IQ of this partition.
+ */
+static __rte_always_inline uint32_t
+sw_enqueue_qid(struct sw_sched_part *part, struct sw_qid *qid,
+		uint32_t iq_num, const struct rte_event *qe)
+{
+	if (unlikely(qid->part != part->id)) {
+		/* rings are sized for all the events of the device */
+		if (rte_event_ring_enqueue_burst(part->out_rings[qid->part],
+				qe, 1, NULL) != 1)
+			part->sched_part_ring_drops++;
+		return 0;
+	}
+
+	qid->iq_pkt_mask |= (1 << (iq_num));
+	iq_enqueue(part, &qid->iq[iq_num], qe);
+	qid->iq_pkt_count[iq_num]++;
+	qid->stats.rx_pkts++;
+	return 1;
+}
+
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count)
+sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_sched_part *part,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
 	struct rte_event blocked_qes[MAX_PER_IQ_DEQUEUE];
@@ -43,7 +68,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	 */
 	uint32_t qid_id = qid->id;
 
-	iq_dequeue_burst(sw, &qid->iq[iq_num], qes, count);
+	iq_dequeue_burst(part, &qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
 		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
@@ -104,14 +129,15 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			p->cq_buf_count = 0;
 		}
 	}
-	iq_put_back(sw, &qid->iq[iq_num], blocked_qes, nb_blocked);
+	iq_put_back(part, &qid->iq[iq_num], blocked_qes, nb_blocked);
 
 	return count - nb_blocked;
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count, int keep_order)
+sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_sched_part *part,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count,
+		int keep_order)
 {
 	uint32_t i;
 	uint32_t cq_idx = qid->cq_next_tx;
@@ -168,7 +194,7 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 					(void *)&p->hist_list[head].rob_entry);
 
 		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
-		iq_pop(sw, &qid->iq[iq_num]);
+		iq_pop(part, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
 		p->inflights++;
@@ -181,8 +207,9 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count __rte_unused)
+sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_sched_part *part,
+		struct sw_qid * const qid, uint32_t iq_num,
+		unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
 	struct sw_port *port = &sw->ports[cq_id];
@@ -194,7 +221,7 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 
 	/* burst dequeue from the QID IQ ring */
 	struct sw_iq *iq = &qid->iq[iq_num];
-	uint32_t ret = iq_dequeue_burst(sw, iq,
+	uint32_t ret = iq_dequeue_burst(part, iq,
 			&port->cq_buf[port->cq_buf_count], count_free);
 	port->cq_buf_count += ret;
 
@@ -209,15 +236,15 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_evdev *sw, struct sw_sched_part *part)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
 
-	sw->sched_cq_qid_called++;
+	part->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	for (qid_idx = 0; qid_idx < part->qid_count; qid_idx++) {
+		struct sw_qid *qid = part->qids_prioritized[qid_idx];
 
 		int type = qid->type;
 		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
@@ -231,14 +258,14 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 
 		if (count > 0) {
 			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
-						iq_num, count);
+				pkts_done += sw_schedule_dir_to_cq(sw, part,
+						qid, iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
-						iq_num, count);
+				pkts_done += sw_schedule_atomic_to_cq(sw, part,
+						qid, iq_num, count);
 			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
-						iq_num, count,
+				pkts_done += sw_schedule_parallel_to_cq(sw,
+						part, qid, iq_num, count,
 						type == RTE_SCHED_TYPE_ORDERED);
 		}
 
@@ -254,19 +281,19 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 	return pkts;
 }
 
-/* This function will perform re-ordering of packets, and injecting into
- * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
- * contiguous in that array, this function accepts a "range" of QIDs to scan.
+/* This function will perform re-ordering of packets of the ordered QIDs of
+ * a partition, and injecting into the appropriate QID IQ.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_evdev *sw, struct sw_sched_part *part)
 {
 	/* Perform egress reordering */
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
+	uint32_t qid_idx;
 
-	for (; qid_start < qid_end; qid_start++) {
-		struct sw_qid *qid = &sw->qids[qid_start];
+	for (qid_idx = 0; qid_idx < part->qid_count; qid_idx++) {
+		struct sw_qid *qid = part->qids_prioritized[qid_idx];
 		int i, num_entries_in_use;
 
 		if (qid->type != RTE_SCHED_TYPE_ORDERED)
@@ -295,22 +322,16 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				dest_iq  = PRIO_TO_IQ(qe->priority);
 
 				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+					part->stats.rx_dropped++;
 					continue;
 				}
 
-				pkts_iter++;
-
-				struct sw_qid *q = &sw->qids[dest_qid];
-				struct sw_iq *iq = &q->iq[dest_iq];
-
 				/* we checked for space above, so enqueue must
 				 * succeed
 				 */
-				iq_enqueue(sw, iq, qe);
-				q->iq_pkt_mask |= (1 << (dest_iq));
-				q->iq_pkt_count[dest_iq]++;
-				q->stats.rx_pkts++;
+				pkts_iter += sw_enqueue_qid(part,
+						&sw->qids[dest_qid], dest_iq,
+						qe);
 			}
 
 			entry->ready = (j != entry->num_fragments);
@@ -343,7 +364,8 @@ sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
 }
 
 static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_evdev *sw, struct sw_sched_part *part,
+		uint32_t port_id, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
 	uint32_t pkts_iter = 0;
@@ -422,7 +444,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				 */
 				int num_frag = rob_entry->num_fragments;
 				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
+					part->stats.rx_dropped++;
 				else {
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
@@ -433,12 +455,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 			/* Use the iq_num from above to push the QE
 			 * into the qid at the right priority
 			 */
-
-			qid->iq_pkt_mask |= (1 << (iq_num));
-			iq_enqueue(sw, &qid->iq[iq_num], qe);
-			qid->iq_pkt_count[iq_num]++;
-			qid->stats.rx_pkts++;
-			pkts_iter++;
+			pkts_iter += sw_enqueue_qid(part, qid, iq_num, qe);
 		}
 
 end_qe:
@@ -450,19 +467,22 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_evdev *sw, struct sw_sched_part *part,
+		uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(sw, part, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_evdev *sw,
+		struct sw_sched_part *part, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(sw, part, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_evdev *sw, struct sw_sched_part *part,
+		uint32_t port_id)
 {
 	uint32_t pkts_iter = 0;
 	struct sw_port *port = &sw->ports[port_id];
@@ -480,18 +500,13 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 
 		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
-		struct sw_iq *iq = &qid->iq[iq_num];
 
 		port->stats.rx_pkts++;
 
 		/* Use the iq_num from above to push the QE
 		 * into the qid at the right priority
 		 */
-		qid->iq_pkt_mask |= (1 << (iq_num));
-		iq_enqueue(sw, iq, qe);
-		qid->iq_pkt_count[iq_num]++;
-		qid->stats.rx_pkts++;
-		pkts_iter++;
+		pkts_iter += sw_enqueue_qid(part, qid, iq_num, qe);
 
 end_qe:
 		port->pp_buf_start++;
@@ -501,18 +516,41 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 	return pkts_iter;
 }
 
-void
-sw_event_schedule(struct rte_eventdev *dev)
+/* Pull the events sent by the other partitions to the QIDs of a partition */
+static uint32_t
+sw_schedule_pull_parts(struct sw_evdev *sw, struct sw_sched_part *part)
+{
+	struct rte_event qes[MAX_PER_IQ_DEQUEUE];
+	uint32_t pkts_iter = 0;
+	uint32_t i, j, n;
+
+	for (i = 0; i < sw->sched_partitions; i++) {
+		if (i == part->id)
+			continue;
+
+		n = rte_event_ring_dequeue_burst(
+				sw->parts[i].out_rings[part->id], qes,
+				RTE_DIM(qes), NULL);
+		for (j = 0; j < n; j++)
+			pkts_iter += sw_enqueue_qid(part,
+					&sw->qids[qes[j].queue_id],
+					PRIO_TO_IQ(qes[j].priority), &qes[j]);
+	}
+
+	return pkts_iter;
+}
+
+static uint32_t
+sw_schedule_part(struct sw_evdev *sw, struct sw_sched_part *part)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	part->sched_called++;
 	if (unlikely(!sw->started))
-		return;
+		return 0;
 
 	do {
 		uint32_t in_pkts_this_iteration = 0;
@@ -520,27 +558,36 @@ sw_event_schedule(struct rte_eventdev *dev)
 		/* Pull from rx_ring for ports */
 		do {
 			in_pkts = 0;
-			for (i = 0; i < sw->port_count; i++) {
-				/* ack the unlinks in progress as done */
-				if (sw->ports[i].unlinks_in_progress)
-					sw->ports[i].unlinks_in_progress = 0;
+			for (i = 0; i < part->port_count; i++) {
+				const uint8_t port_id = part->ports[i];
+				struct sw_port *port = &sw->ports[port_id];
 
-				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
-				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+				/* ack the unlinks in progress as done */
+				if (port->unlinks_in_progress)
+					port->unlinks_in_progress = 0;
+
+				if (port->is_directed)
+					in_pkts += sw_schedule_pull_port_dir(sw,
+							part, port_id);
+				else if (port->num_ordered_qids > 0)
+					in_pkts += sw_schedule_pull_port_lb(sw,
+							part, port_id);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(
+							sw, part, port_id);
 			}
 
+			/* Events from the other partitions */
+			if (sw->sched_partitions > 1)
+				in_pkts += sw_schedule_pull_parts(sw, part);
+
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
-					sw->qid_count);
+			in_pkts += sw_schedule_reorder(sw, part);
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
-		out_pkts = sw_schedule_qid_to_cq(sw);
+		out_pkts = sw_schedule_qid_to_cq(sw, part);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -548,21 +595,53 @@ sw_event_schedule(struct rte_eventdev *dev)
 			break;
 	} while ((int)out_pkts_total < sched_quanta);
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	part->stats.tx_pkts += out_pkts_total;
+	part->stats.rx_pkts += in_pkts_total;
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	part->sched_no_iq_enqueues += (in_pkts_total == 0);
+	part->sched_no_cq_enqueues += (out_pkts_total == 0);
 
 	/* push all the internal buffered QEs in port->cq_ring to the
 	 * worker cores: aka, do the ring transfers batched.
 	 */
-	for (i = 0; i < sw->port_count; i++) {
-		struct rte_event_ring *worker = sw->ports[i].cq_worker_ring;
-		rte_event_ring_enqueue_burst(worker, sw->ports[i].cq_buf,
-				sw->ports[i].cq_buf_count,
-				&sw->cq_ring_space[i]);
-		sw->ports[i].cq_buf_count = 0;
+	for (i = 0; i < part->port_count; i++) {
+		const uint8_t port_id = part->ports[i];
+		struct sw_port *port = &sw->ports[port_id];
+
+		rte_event_ring_enqueue_burst(port->cq_worker_ring,
+				port->cq_buf, port->cq_buf_count,
+				&sw->cq_ring_space[port_id]);
+		port->cq_buf_count = 0;
+	}
+
+	return in_pkts_total + out_pkts_total;
+}
+
+uint32_t
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	const uint32_t nb_parts = sw->sched_partitions;
+	uint32_t i, idx, nb_events;
+
+	if (nb_parts == 1)
+		return sw_schedule_part(sw, &sw->parts[0]);
+
+	/* Schedule the first partition not taken by another core, starting
+	 * after the last one scheduled by this core to visit all of them.
+	 */
+	idx = RTE_PER_LCORE(sw_sched_part_next);
+	for (i = 0; i < nb_parts; i++, idx++) {
+		struct sw_sched_part *part = &sw->parts[idx % nb_parts];
+
+		if (!rte_spinlock_trylock(&part->lock))
+			continue;
+
+		nb_events = sw_schedule_part(sw, part);
+		rte_spinlock_unlock(&part->lock);
+		RTE_PER_LCORE(sw_sched_part_next) = idx % nb_parts + 1;
+		return nb_events;
 	}
 
+	return 0;
 }
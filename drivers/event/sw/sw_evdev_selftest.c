@@ -864,15 +864,15 @@ xstats_tests(struct test *t)
 	int ret = rte_event_dev_xstats_names_get(evdev,
 					RTE_EVENT_DEV_XSTATS_DEVICE,
 					0, xstats_names, ids, XSTATS_MAX);
-	if (ret != 6) {
-		printf("%d: expected 6 stats, got return %d\n", __LINE__, ret);
+	if (ret != 7) {
+		printf("%d: expected 7 stats, got return %d\n", __LINE__, ret);
 		return -1;
 	}
 	ret = rte_event_dev_xstats_get(evdev,
 					RTE_EVENT_DEV_XSTATS_DEVICE,
 					0, ids, values, ret);
-	if (ret != 6) {
-		printf("%d: expected 6 stats, got return %d\n", __LINE__, ret);
+	if (ret != 7) {
+		printf("%d: expected 7 stats, got return %d\n", __LINE__, ret);
 		return -1;
 	}
 
@@ -950,7 +950,7 @@ xstats_tests(struct test *t)
 	ret = rte_event_dev_xstats_get(evdev,
 					RTE_EVENT_DEV_XSTATS_DEVICE,
 					0, ids, values, num_stats);
-	static const uint64_t expected[] = {3, 3, 0, 1, 0, 0};
+	static const uint64_t expected[] = {3, 3, 0, 1, 0, 0, 0};
 	for (i = 0; (signed int)i < ret; i++) {
 		if (expected[i] != values[i]) {
 			printf(
@@ -966,7 +966,7 @@ xstats_tests(struct test *t)
 					0, NULL, 0);
 
 	/* ensure reset statistics are zero-ed */
-	static const uint64_t expected_zero[] = {0, 0, 0, 0, 0, 0};
+	static const uint64_t expected_zero[] = {0, 0, 0, 0, 0, 0, 0};
 	ret = rte_event_dev_xstats_get(evdev,
 					RTE_EVENT_DEV_XSTATS_DEVICE,
 					0, ids, values, num_stats);
@@ -1453,7 +1453,7 @@ xstats_id_reset_tests(struct test *t)
 	for (i = 0; i < XSTATS_MAX; i++)
 		ids[i] = i;
 
-#define NUM_DEV_STATS 6
+#define NUM_DEV_STATS 7
 	/* Device names / values */
 	int num_stats = rte_event_dev_xstats_names_get(evdev,
 					RTE_EVENT_DEV_XSTATS_DEVICE,
@@ -1497,8 +1497,9 @@ xstats_id_reset_tests(struct test *t)
 	static const char * const dev_names[] = {
 		"dev_rx", "dev_tx", "dev_drop", "dev_sched_calls",
 		"dev_sched_no_iq_enq", "dev_sched_no_cq_enq",
+		"dev_sched_part_ring_drop",
 	};
-	uint64_t dev_expected[] = {NPKTS, NPKTS, 0, 1, 0, 0};
+	uint64_t dev_expected[] = {NPKTS, NPKTS, 0, 1, 0, 0, 0};
 	for (i = 0; (int)i < ret; i++) {
 		unsigned int id;
 		uint64_t val = rte_event_dev_xstats_by_name_get(evdev,
@@ -1535,11 +1536,11 @@ xstats_id_reset_tests(struct test *t)
 		}
 	};
 
-/* 48 is stat offset from start of the devices whole xstats.
+/* 49 is stat offset from start of the devices whole xstats.
  * This WILL break every time we add a statistic to a port
  * or the device, but there is no other way to test
  */
-#define PORT_OFF 48
+#define PORT_OFF 49
 /* num stats for the tested port. CQ size adds more stats to a port */
 #define NUM_PORT_STATS 21
 /* the port to test. */
@@ -1663,7 +1664,7 @@ xstats_id_reset_tests(struct test *t)
 /* queue offset from start of the devices whole xstats.
  * This will break every time we add a statistic to a device/port/queue
  */
-#define QUEUE_OFF 90
+#define QUEUE_OFF 91
 	const uint32_t queue = 0;
 	num_stats = rte_event_dev_xstats_names_get(evdev,
 					RTE_EVENT_DEV_XSTATS_QUEUE, queue,
@@ -3155,6 +3156,142 @@ worker_loopback(struct test *t, uint8_t disable_implicit_release)
 	return 0;
 }
 
+static int
+sched_partitions(struct test *t)
+{
+	/* QID 0 (ordered) is linked to ports 0 and 1, QID 1 (atomic) to
+	 * port 2: each group ends up in its own partition. Port 3 only
+	 * produces.
+	 */
+	const char *eventdev_name = "event_sw_parts";
+	const int main_evdev = evdev;
+	struct rte_event ev[8], deq[2][8];
+	const unsigned int num_events = RTE_DIM(ev);
+	unsigned int i, p, nb_deq[2];
+	uint32_t service_id;
+	uint8_t qid;
+	int ret = -1;
+
+	if (rte_vdev_init(eventdev_name, "sched_partitions=2") < 0) {
+		printf("%d: Error creating eventdev\n", __LINE__);
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0 ||
+			rte_event_dev_service_id_get(evdev, &service_id) < 0) {
+		printf("%d: Error getting eventdev service\n", __LINE__);
+		goto out;
+	}
+	rte_service_runstate_set(service_id, 1);
+	rte_service_set_runstate_mapped_check(service_id, 0);
+
+	if (init(t, 2, 4) < 0 ||
+			create_ports(t, 4) < 0 ||
+			create_ordered_qids(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		goto err;
+	}
+	if (rte_event_port_link(evdev, t->port[0], &t->qid[0], NULL, 1) != 1 ||
+			rte_event_port_link(evdev, t->port[1], &t->qid[0],
+				NULL, 1) != 1 ||
+			rte_event_port_link(evdev, t->port[2], &t->qid[1],
+				NULL, 1) != 1) {
+		printf("%d: Error links queue to ports\n", __LINE__);
+		goto err;
+	}
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		goto err;
+	}
+
+	/* a started port can't be linked to a QID of another partition */
+	qid = t->qid[1];
+	if (rte_event_port_link(evdev, t->port[0], &qid, NULL, 1) != 0 ||
+			rte_errno != EINVAL) {
+		printf("%d: Error, link across partitions accepted\n",
+				__LINE__);
+		goto err;
+	}
+
+	for (i = 0; i < num_events; i++) {
+		ev[i] = (struct rte_event){
+			.op = RTE_EVENT_OP_NEW,
+			.queue_id = t->qid[0],
+			.flow_id = i,
+			.u64 = i,
+		};
+	}
+	if (rte_event_enqueue_burst(evdev, t->port[3], ev, num_events) !=
+			num_events) {
+		printf("%d: Error with enqueue\n", __LINE__);
+		goto err;
+	}
+	/* each iteration schedules one partition */
+	for (i = 0; i < 4; i++)
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+
+	for (p = 0; p < 2; p++) {
+		nb_deq[p] = rte_event_dequeue_burst(evdev, t->port[p],
+				deq[p], num_events, 0);
+		if (nb_deq[p] == 0) {
+			printf("%d: Error, port %u got no event\n",
+					__LINE__, p);
+			goto err;
+		}
+	}
+	if (nb_deq[0] + nb_deq[1] != num_events) {
+		printf("%d: Error, ordered events not scheduled\n", __LINE__);
+		goto err;
+	}
+
+	/* forward to the other partition, the last worker first */
+	for (p = 2; p-- > 0;) {
+		for (i = 0; i < nb_deq[p]; i++) {
+			deq[p][i].op = RTE_EVENT_OP_FORWARD;
+			deq[p][i].queue_id = t->qid[1];
+			deq[p][i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		}
+		if (rte_event_enqueue_burst(evdev, t->port[p], deq[p],
+				nb_deq[p]) != nb_deq[p]) {
+			printf("%d: Error with forward\n", __LINE__);
+			goto err;
+		}
+	}
+	for (i = 0; i < 4; i++)
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+
+	if (rte_event_dequeue_burst(evdev, t->port[2], ev, num_events, 0) !=
+			num_events) {
+		printf("%d: Error, forwarded events not scheduled\n",
+				__LINE__);
+		goto err;
+	}
+	for (i = 0; i < num_events; i++) {
+		if (ev[i].u64 != i || ev[i].queue_id != t->qid[1]) {
+			printf("%d: Error, event %u out of order\n",
+					__LINE__, i);
+			goto err;
+		}
+	}
+	if (rte_event_dev_xstats_by_name_get(evdev,
+			"dev_sched_part_ring_drop", NULL) != 0) {
+		printf("%d: Error, events dropped between partitions\n",
+				__LINE__);
+		goto err;
+	}
+
+	ret = 0;
+err:
+	if (ret != 0)
+		rte_event_dev_dump(evdev, stdout);
+	cleanup(t);
+out:
+	rte_vdev_uninit(eventdev_name);
+	evdev = main_evdev;
+	return ret;
+}
+
 static struct rte_mempool *eventdev_func_mempool;
 
 int
@@ -3367,6 +3504,12 @@ test_sw_eventdev(void)
 		printf("ERROR - Stop Flush test FAILED.\n");
 		goto test_fail;
 	}
+	printf("*** Running Scheduler Partitions test...\n");
+	ret = sched_partitions(t);
+	if (ret != 0) {
+		printf("ERROR - Scheduler Partitions test FAILED.\n");
+		goto test_fail;
+	}
 	if (rte_lcore_count() >= 3) {
 		printf("*** Running Worker loopback test...\n");
 		ret = worker_loopback(t, 0);
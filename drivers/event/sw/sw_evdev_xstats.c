@@ -17,6 +17,7 @@ enum xstats_type {
 	/* device instance specific */
 	no_iq_enq,
 	no_cq_enq,
+	part_ring_drop,
 	/* port_specific */
 	rx_used,
 	rx_free,
@@ -47,20 +48,39 @@ struct sw_xstats_entry {
 };
 
 static uint64_t
-get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
-		enum xstats_type type, int extra_arg __rte_unused)
+get_part_stat(const struct sw_sched_part *part, enum xstats_type type)
 {
 	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
+	case rx: return part->stats.rx_pkts;
+	case tx: return part->stats.tx_pkts;
+	case dropped: return part->stats.rx_dropped;
+	case calls: return part->sched_called;
+	case no_iq_enq: return part->sched_no_iq_enqueues;
+	case no_cq_enq: return part->sched_no_cq_enqueues;
+	case part_ring_drop: return part->sched_part_ring_drops;
 	default: return -1;
 	}
 }
 
+static uint64_t
+get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
+		enum xstats_type type, int extra_arg __rte_unused)
+{
+	uint64_t val = 0;
+	uint32_t i;
+
+	/* device stats are the sum of the stats of the partitions */
+	for (i = 0; i < sw->sched_partitions; i++) {
+		uint64_t part_val = get_part_stat(&sw->parts[i], type);
+
+		if (part_val == (uint64_t)-1)
+			return -1;
+		val += part_val;
+	}
+
+	return val;
+}
+
 static uint64_t
 get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg __rte_unused)
@@ -177,9 +197,10 @@ sw_xstats_init(struct sw_evdev *sw)
 	 */
 	static const char * const dev_stats[] = { "rx", "tx", "drop",
 			"sched_calls", "sched_no_iq_enq", "sched_no_cq_enq",
+			"sched_part_ring_drop",
 	};
 	static const enum xstats_type dev_types[] = { rx, tx, dropped,
-			calls, no_iq_enq, no_cq_enq,
+			calls, no_iq_enq, no_cq_enq, part_ring_drop,
 	};
 	/* all device stats are allowed to be reset */
 
@@ -46,6 +46,12 @@ extern "C" {
  */
 #define RTE_DISTRIB_MAX_WORKERS 64
 
+/**
+ * Maximum number of workers allowed in burst mode, which does not track
+ * in-flight tags in a bitmask. Must be a multiple of 64, see active_workers.
+ */
+#define RTE_DIST_BURST_MAX_WORKERS 256
+
 #define RTE_DISTRIBUTOR_NAMESIZE 32 /**< Length of name for instance */
 
 /**
@@ -105,6 +111,7 @@ struct rte_distributor_v20 {
 enum rte_distributor_match_function {
 	RTE_DIST_MATCH_SCALAR = 0,
 	RTE_DIST_MATCH_VECTOR,
+	RTE_DIST_MATCH_VECTOR_AVX512,
 	RTE_DIST_NUM_MATCH_FNS
 };
 
@@ -142,13 +149,20 @@ struct rte_distributor {
 	 * on the worker core. Second cache line are the backlog
 	 * that are going to go to the worker core.
 	 */
-	uint16_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS][RTE_DIST_BURST_SIZE*2]
-			__rte_cache_aligned;
+	uint16_t in_flight_tags[RTE_DIST_BURST_MAX_WORKERS]
+			[RTE_DIST_BURST_SIZE*2] __rte_cache_aligned;
 
-	struct rte_distributor_backlog backlog[RTE_DISTRIB_MAX_WORKERS]
+	/**
+	 * Bitmap of the workers with tags in flight or in their backlog:
+	 * flow matching skips the other workers, so that its cost follows
+	 * the number of busy workers rather than the number of workers.
+	 */
+	uint64_t active_workers[RTE_DIST_BURST_MAX_WORKERS / 64];
+
+	struct rte_distributor_backlog backlog[RTE_DIST_BURST_MAX_WORKERS]
 			__rte_cache_aligned;
 
-	struct rte_distributor_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
+	struct rte_distributor_buffer bufs[RTE_DIST_BURST_MAX_WORKERS];
 
 	struct rte_distributor_returned_pkts returns;
 
@@ -167,6 +181,22 @@ find_match_vec(struct rte_distributor *d,
 			uint16_t *data_ptr,
 			uint16_t *output_ptr);
 
+void
+find_match_avx512(struct rte_distributor *d,
+			uint16_t *data_ptr,
+			uint16_t *output_ptr);
+
+/*
+ * Iterate over the active workers of a distributor, see active_workers.
+ * The bitmap must not be modified while iterating.
+ */
+#define RTE_DIST_FOREACH_ACTIVE(d, word, bits, wkr)			\
+	for ((word) = 0; (word) < RTE_DIM((d)->active_workers); (word)++) \
+		for ((bits) = (d)->active_workers[word];		\
+			(bits) != 0 &&					\
+			((wkr) = (word) * 64 + rte_bsf64(bits), 1);	\
+			(bits) &= (bits) - 1)
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,7 @@
 #include <rte_mbuf.h>
 #include <rte_memory.h>
 #include <rte_cycles.h>
+#include <rte_cpuflags.h>
 #include <rte_function_versioning.h>
 #include <rte_memzone.h>
 #include <rte_errno.h>
@@ -235,11 +236,13 @@ find_match_scalar(struct rte_distributor *d,
 			uint16_t *output_ptr)
 {
 	struct rte_distributor_backlog *bl;
-	uint16_t i, j, w;
+	unsigned int i, word;
+	uint64_t active;
+	uint16_t j, w;
 
 	/*
 	 * Function overview:
-	 * 1. Loop through all worker ID's
+	 * 1. Loop through all active worker ID's
 	 * 2. Compare the current inflights to the incoming tags
 	 * 3. Compare the current backlog to the incoming tags
 	 * 4. Add any matches to the output
@@ -248,18 +251,13 @@ find_match_scalar(struct rte_distributor *d,
 	for (j = 0 ; j < RTE_DIST_BURST_SIZE; j++)
 		output_ptr[j] = 0;
 
-	for (i = 0; i < d->num_workers; i++) {
+	RTE_DIST_FOREACH_ACTIVE(d, word, active, i) {
 		bl = &d->backlog[i];
 
 		for (j = 0; j < RTE_DIST_BURST_SIZE ; j++)
 			for (w = 0; w < RTE_DIST_BURST_SIZE; w++)
-				if (d->in_flight_tags[i][j] == data_ptr[w]) {
-					output_ptr[j] = i+1;
-					break;
-				}
-		for (j = 0; j < RTE_DIST_BURST_SIZE; j++)
-			for (w = 0; w < RTE_DIST_BURST_SIZE; w++)
-				if (bl->tags[j] == data_ptr[w]) {
+				if (d->in_flight_tags[i][w] == data_ptr[j] ||
+						bl->tags[w] == data_ptr[j]) {
 					output_ptr[j] = i+1;
 					break;
 				}
@@ -273,6 +271,16 @@ find_match_scalar(struct rte_distributor *d,
 }
 
 
+/* marks whether a worker has tags in flight or in its backlog */
+static inline void
+set_active(struct rte_distributor *d, unsigned int wkr, int active)
+{
+	if (active)
+		d->active_workers[wkr / 64] |= UINT64_C(1) << (wkr % 64);
+	else
+		d->active_workers[wkr / 64] &= ~(UINT64_C(1) << (wkr % 64));
+}
+
 /*
  * When the handshake bits indicate that there are packets coming
  * back from the worker, this function is called to copy and store
@@ -347,6 +355,7 @@ release(struct rte_distributor *d, unsigned int wkr)
 	}
 
 	d->backlog[wkr].count = 0;
+	set_active(d, wkr, buf->count != 0);
 
 	/* Clear the GET bit.
 	 * Sync with worker on GET_BUF flag. Release bufptrs.
@@ -417,6 +426,11 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 		case RTE_DIST_MATCH_VECTOR:
 			find_match_vec(d, &flows[0], &matches[0]);
 			break;
+#ifdef CC_DISTRIBUTOR_AVX512_SUPPORT
+		case RTE_DIST_MATCH_VECTOR_AVX512:
+			find_match_avx512(d, &flows[0], &matches[0]);
+			break;
+#endif
 		default:
 			find_match_scalar(d, &flows[0], &matches[0]);
 		}
@@ -475,6 +489,7 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 
 				bl->tags[idx] = new_tag;
 				bl->pkts[idx] = next_value;
+				set_active(d, wkr, 1);
 				/*
 				 * Now that we've just added an unpinned flow
 				 * to a worker, we need to ensure that all
@@ -630,9 +645,11 @@ rte_distributor_create_v1705(const char *name,
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(*d) & RTE_CACHE_LINE_MASK) != 0);
 	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 7) != 0);
+	RTE_BUILD_BUG_ON((RTE_DIST_BURST_MAX_WORKERS & 63) != 0);
 
 	if (name == NULL || num_workers >=
-		(unsigned int)RTE_MIN(RTE_DISTRIB_MAX_WORKERS, RTE_MAX_LCORE)) {
+		(unsigned int)RTE_MIN(RTE_DIST_BURST_MAX_WORKERS,
+				RTE_MAX_LCORE)) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
@@ -670,6 +687,10 @@ rte_distributor_create_v1705(const char *name,
 #if defined(RTE_ARCH_X86)
 	d->dist_match_fn = RTE_DIST_MATCH_VECTOR;
 #endif
+#ifdef CC_DISTRIBUTOR_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0)
+		d->dist_match_fn = RTE_DIST_MATCH_VECTOR_AVX512;
+#endif
 
 	/*
 	 * Set up the backlog tags so they're pointing at the second cache
@@ -39,7 +39,8 @@ struct rte_mbuf;
  *   The NUMA node on which the memory is to be allocated
  * @param num_workers
  *   The maximum number of workers that will request packets from this
- *   distributor
+ *   distributor. Must be lower than RTE_MAX_LCORE, and than 64 with the
+ *   legacy API or 256 with the burst API.
  * @param alg_type
  *   Call the legacy API, or use the new burst API. legacy uses 32-bit
  *   flow ID, and works on a single packet at a time. Latest uses 15-
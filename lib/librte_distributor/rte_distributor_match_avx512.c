@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <rte_mbuf.h>
+#include "rte_distributor.h"
+#include "distributor_private.h"
+#include "immintrin.h"
+
+
+void
+find_match_avx512(struct rte_distributor *d,
+			uint16_t *data_ptr,
+			uint16_t *output_ptr)
+{
+	/* Setup */
+	__m512i incoming_fids[RTE_DIST_BURST_SIZE];
+	__m512i worker_fids;
+	__mmask16 match;
+	unsigned int i, word;
+	uint64_t active;
+	uint16_t j;
+
+	/*
+	 * Function overview:
+	 * 1. Broadcast each incoming flow ID into its own zmm reg
+	 * 2. Loop through all active worker ID's
+	 *  2a. Load the current inflights and backlog of that worker, which
+	 *      are contiguous, into a single zmm reg
+	 *  2b. Compare each incoming flow ID to all 16 of them at once
+	 *  2c. Store the worker id for any incoming flow ID that matched
+	 */
+
+	for (j = 0; j < RTE_DIST_BURST_SIZE; j++) {
+		incoming_fids[j] = _mm512_set1_epi32(data_ptr[j]);
+		output_ptr[j] = 0;
+	}
+
+	RTE_DIST_FOREACH_ACTIVE(d, word, active, i) {
+		/*
+		 * Zero extend the 16-bit tags, so that only AVX512F is
+		 * needed for the compares.
+		 */
+		worker_fids = _mm512_cvtepu16_epi32(
+			_mm256_load_si256((__m256i *)&d->in_flight_tags[i]));
+
+		for (j = 0; j < RTE_DIST_BURST_SIZE; j++) {
+			match = _mm512_cmpeq_epi32_mask(worker_fids,
+					incoming_fids[j]);
+			if (match != 0)
+				output_ptr[j] = i + 1;
+		}
+	}
+
+	/*
+	 * At this stage, the output contains 8 16-bit values, with
+	 * each non-zero value containing the worker ID on which the
+	 * corresponding flow is pinned to.
+	 */
+}
@@ -23,11 +23,12 @@ find_match_vec(struct rte_distributor *d,
 	__m128i mask2;
 	__m128i output;
 	struct rte_distributor_backlog *bl;
-	uint16_t i;
+	unsigned int i, word;
+	uint64_t active;
 
 	/*
 	 * Function overview:
-	 * 2. Loop through all worker ID's
+	 * 2. Loop through all active worker ID's
 	 *  2a. Load the current inflights for that worker into an xmm reg
 	 *  2b. Load the current backlog for that worker into an xmm reg
 	 *  2c. use cmpestrm to intersect flow_ids with backlog and inflights
@@ -39,7 +40,7 @@ find_match_vec(struct rte_distributor *d,
 	output = _mm_set1_epi16(0);
 	incoming_fids = _mm_load_si128((__m128i *)data_ptr);
 
-	for (i = 0; i < d->num_workers; i++) {
+	RTE_DIST_FOREACH_ACTIVE(d, word, active, i) {
 		bl = &d->backlog[i];
 
 		inflight_fids =
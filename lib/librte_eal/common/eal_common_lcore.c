@@ -5,6 +5,7 @@
 #include <unistd.h>
 #include <limits.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include <rte_errno.h>
 #include <rte_log.h>
@@ -12,6 +13,7 @@
 #include <rte_lcore.h>
 #include <rte_common.h>
 #include <rte_debug.h>
+#include <rte_lcore_poll.h>
 
 #include "eal_private.h"
 #include "eal_thread.h"
@@ -203,3 +205,91 @@ rte_socket_id_by_idx(unsigned int idx)
 	}
 	return config->numa_nodes[idx];
 }
+
+struct __rte_lcore_poll __rte_lcore_polls[RTE_MAX_LCORE];
+
+int
+rte_lcore_poll_stats_get(unsigned int lcore_id,
+		struct rte_lcore_poll_stats *stats)
+{
+	const struct __rte_lcore_poll *p;
+	unsigned int i;
+
+	if (lcore_id >= RTE_MAX_LCORE || stats == NULL)
+		return -EINVAL;
+
+	/* the counters are only incremented by their lcore, so the values
+	 * read here are consistent enough without synchronization
+	 */
+	p = &__rte_lcore_polls[lcore_id];
+	stats->busy_polls = p->stats.busy_polls - p->base.busy_polls;
+	stats->idle_polls = p->stats.idle_polls - p->base.idle_polls;
+	stats->busy_cycles = p->stats.busy_cycles - p->base.busy_cycles;
+	stats->idle_cycles = p->stats.idle_cycles - p->base.idle_cycles;
+	stats->pkts = p->stats.pkts - p->base.pkts;
+	for (i = 0; i < RTE_LCORE_POLL_HIST_SIZE; i++) {
+		stats->burst_hist[i] = p->stats.burst_hist[i] -
+			p->base.burst_hist[i];
+		stats->cpp_hist[i] = p->stats.cpp_hist[i] -
+			p->base.cpp_hist[i];
+	}
+
+	return 0;
+}
+
+int
+rte_lcore_poll_stats_reset(unsigned int lcore_id)
+{
+	struct __rte_lcore_poll *p;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	/* the lcore keeps counting, the reset only moves the reference */
+	p = &__rte_lcore_polls[lcore_id];
+	p->base = p->stats;
+
+	return 0;
+}
+
+static void
+lcore_poll_dump_hist(FILE *f, const char *name, const uint64_t *hist)
+{
+	unsigned int i;
+
+	fprintf(f, "    %s:", name);
+	for (i = 0; i < RTE_LCORE_POLL_HIST_SIZE; i++) {
+		if (hist[i] == 0)
+			continue;
+		fprintf(f, " %s%u:%"PRIu64,
+			i == RTE_LCORE_POLL_HIST_SIZE - 1 ? ">=" : "",
+			1u << i, hist[i]);
+	}
+	fprintf(f, "\n");
+}
+
+int
+rte_lcore_poll_dump(FILE *f, unsigned int lcore_id)
+{
+	struct rte_lcore_poll_stats stats;
+	uint64_t polls, cycles;
+
+	if (f == NULL || rte_lcore_poll_stats_get(lcore_id, &stats) < 0)
+		return -EINVAL;
+
+	polls = stats.busy_polls + stats.idle_polls;
+	cycles = stats.busy_cycles + stats.idle_cycles;
+	fprintf(f, "  lcore %u: busy %.2f%%\tpolls %"PRIu64" (idle %"PRIu64
+		")\tcycles/poll %"PRIu64"\tpkts %"PRIu64
+		"\tcycles/pkt %"PRIu64"\n",
+		lcore_id, cycles != 0 ? 100. * stats.busy_cycles / cycles : 0.,
+		polls, stats.idle_polls, polls != 0 ? cycles / polls : 0,
+		stats.pkts,
+		stats.pkts != 0 ? stats.busy_cycles / stats.pkts : 0);
+	if (stats.pkts == 0)
+		return 0;
+	lcore_poll_dump_hist(f, "pkts/poll", stats.burst_hist);
+	lcore_poll_dump_hist(f, "cycles/pkt", stats.cpp_hist);
+
+	return 0;
+}
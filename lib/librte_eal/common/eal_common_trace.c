@@ -0,0 +1,514 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/queue.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <rte_byteorder.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_spinlock.h>
+#include <rte_string_fns.h>
+#include <rte_trace.h>
+#include <rte_version.h>
+
+#include "eal_private.h"
+
+/* records per thread buffer, must be a power of 2 */
+#define TRACE_BUF_RECORDS 16384
+#define TRACE_POINT_MAX (__RTE_TRACE_FIELD_ID_MASK + 1)
+#define TRACE_CTF_MAGIC 0xC1FC1FC1
+
+RTE_DEFINE_PER_LCORE(struct __rte_trace_mem *, trace_mem);
+
+struct trace_point {
+	STAILQ_ENTRY(trace_point) next;
+	rte_trace_point_t *handle;
+	char name[RTE_TRACE_POINT_NAMESIZE];
+	char fields[RTE_TRACE_POINT_ARGS_MAX][RTE_TRACE_POINT_NAMESIZE];
+	unsigned int nb_fields;
+};
+
+static STAILQ_HEAD(, trace_point) trace_points =
+	STAILQ_HEAD_INITIALIZER(trace_points);
+static unsigned int nb_trace_points;
+static enum rte_trace_mode trace_mode = RTE_TRACE_MODE_OVERWRITE;
+
+/* thread buffers, kept after the thread exits so they can be saved */
+static struct __rte_trace_mem *trace_mems;
+static unsigned int nb_trace_mems;
+static rte_spinlock_t trace_mem_lock = RTE_SPINLOCK_INITIALIZER;
+/* notifies the exit of the threads owning a buffer */
+static pthread_key_t trace_mem_key;
+static pthread_once_t trace_mem_once = PTHREAD_ONCE_INIT;
+
+static struct trace_point *
+trace_point_find(const rte_trace_point_t *handle)
+{
+	struct trace_point *tp;
+
+	STAILQ_FOREACH(tp, &trace_points, next)
+		if (tp->handle == handle)
+			return tp;
+	return NULL;
+}
+
+static int
+trace_parse_fields(struct trace_point *tp, const char *fields)
+{
+	const char *p = fields;
+	size_t len;
+
+	while (*p != '\0') {
+		len = strcspn(p, ",");
+		if (len == 0 || len >= RTE_TRACE_POINT_NAMESIZE ||
+				tp->nb_fields == RTE_TRACE_POINT_ARGS_MAX)
+			return -EINVAL;
+		memcpy(tp->fields[tp->nb_fields], p, len);
+		tp->fields[tp->nb_fields][len] = '\0';
+		tp->nb_fields++;
+		p += len;
+		if (*p == ',')
+			p++;
+	}
+	return 0;
+}
+
+static bool
+trace_name_is_valid(const char *name, bool field)
+{
+	const char *p;
+
+	if (*name == '\0')
+		return false;
+	for (p = name; *p != '\0'; p++)
+		if (!isalnum((unsigned char)*p) && *p != '_' &&
+				(field || *p != '.'))
+			return false;
+	return true;
+}
+
+int
+__rte_trace_point_register(rte_trace_point_t *handle, const char *name,
+		const char *fields)
+{
+	struct trace_point *tp;
+	unsigned int i;
+
+	if (handle == NULL || name == NULL || fields == NULL ||
+			!trace_name_is_valid(name, false) ||
+			strlen(name) >= RTE_TRACE_POINT_NAMESIZE)
+		goto fail;
+	if (nb_trace_points == TRACE_POINT_MAX)
+		goto fail;
+	STAILQ_FOREACH(tp, &trace_points, next)
+		if (strcmp(tp->name, name) == 0 || tp->handle == handle)
+			goto fail;
+
+	tp = calloc(1, sizeof(*tp));
+	if (tp == NULL)
+		goto fail;
+	if (trace_parse_fields(tp, fields) < 0)
+		goto free;
+	for (i = 0; i < tp->nb_fields; i++)
+		if (!trace_name_is_valid(tp->fields[i], true))
+			goto free;
+	strlcpy(tp->name, name, sizeof(tp->name));
+	tp->handle = handle;
+
+	*handle = nb_trace_points++;
+	if (trace_mode == RTE_TRACE_MODE_DISCARD)
+		*handle |= __RTE_TRACE_FIELD_DISCARD;
+	STAILQ_INSERT_TAIL(&trace_points, tp, next);
+	return 0;
+
+free:
+	free(tp);
+fail:
+	RTE_LOG(ERR, EAL, "Cannot register tracepoint %s\n",
+		name != NULL ? name : "(null)");
+	return -EINVAL;
+}
+
+/*
+ * The buffer of an exited thread is kept, but its per-lcore pointer is
+ * gone. The buffer is looked up rather than dereferenced, as it may have
+ * been freed by eal_trace_fini() already.
+ */
+static void
+trace_mem_thread_exit(void *arg)
+{
+	struct __rte_trace_mem *mem;
+
+	rte_spinlock_lock(&trace_mem_lock);
+	for (mem = trace_mems; mem != NULL; mem = mem->next) {
+		if (mem == arg) {
+			mem->owner = NULL;
+			break;
+		}
+	}
+	rte_spinlock_unlock(&trace_mem_lock);
+}
+
+static void
+trace_mem_key_create(void)
+{
+	if (pthread_key_create(&trace_mem_key, trace_mem_thread_exit) != 0)
+		RTE_LOG(ERR, EAL, "Cannot track the trace buffers owners\n");
+}
+
+struct __rte_trace_mem *
+__rte_trace_mem_alloc(void)
+{
+	static bool alloc_failed;
+	struct __rte_trace_mem *mem;
+	size_t sz;
+
+	sz = sizeof(*mem) + sizeof(mem->rec[0]) * TRACE_BUF_RECORDS;
+	if (posix_memalign((void **)&mem, RTE_CACHE_LINE_SIZE, sz) != 0) {
+		if (!alloc_failed)
+			RTE_LOG(ERR, EAL, "Cannot allocate trace buffer\n");
+		alloc_failed = true;
+		return NULL;
+	}
+	memset(mem, 0, sizeof(*mem));
+	mem->mask = TRACE_BUF_RECORDS - 1;
+	mem->lcore_id = rte_lcore_id();
+	mem->tid = rte_sys_gettid();
+	mem->owner = &RTE_PER_LCORE(trace_mem);
+
+	pthread_once(&trace_mem_once, trace_mem_key_create);
+	pthread_setspecific(trace_mem_key, mem);
+
+	rte_spinlock_lock(&trace_mem_lock);
+	mem->index = nb_trace_mems++;
+	mem->next = trace_mems;
+	trace_mems = mem;
+	rte_spinlock_unlock(&trace_mem_lock);
+
+	RTE_PER_LCORE(trace_mem) = mem;
+	return mem;
+}
+
+rte_trace_point_t *
+rte_trace_point_lookup(const char *name)
+{
+	struct trace_point *tp;
+
+	if (name == NULL)
+		return NULL;
+	STAILQ_FOREACH(tp, &trace_points, next)
+		if (strcmp(tp->name, name) == 0)
+			return tp->handle;
+	return NULL;
+}
+
+int
+rte_trace_point_enable(rte_trace_point_t *handle)
+{
+	if (handle == NULL || trace_point_find(handle) == NULL)
+		return -EINVAL;
+	__atomic_or_fetch(handle, __RTE_TRACE_FIELD_ENABLE, __ATOMIC_RELEASE);
+	return 0;
+}
+
+int
+rte_trace_point_disable(rte_trace_point_t *handle)
+{
+	if (handle == NULL || trace_point_find(handle) == NULL)
+		return -EINVAL;
+	__atomic_and_fetch(handle, ~__RTE_TRACE_FIELD_ENABLE,
+			__ATOMIC_RELEASE);
+	return 0;
+}
+
+int
+rte_trace_point_is_enabled(rte_trace_point_t *handle)
+{
+	if (handle == NULL)
+		return 0;
+	return (__atomic_load_n(handle, __ATOMIC_ACQUIRE) &
+		__RTE_TRACE_FIELD_ENABLE) != 0;
+}
+
+int
+rte_trace_pattern(const char *pattern, int enable)
+{
+	struct trace_point *tp;
+	int found = 0;
+
+	if (pattern == NULL)
+		return -EINVAL;
+	STAILQ_FOREACH(tp, &trace_points, next) {
+		if (fnmatch(pattern, tp->name, 0) != 0)
+			continue;
+		if (enable)
+			rte_trace_point_enable(tp->handle);
+		else
+			rte_trace_point_disable(tp->handle);
+		found++;
+	}
+	return found;
+}
+
+int
+rte_trace_is_enabled(void)
+{
+	struct trace_point *tp;
+
+	STAILQ_FOREACH(tp, &trace_points, next)
+		if (rte_trace_point_is_enabled(tp->handle))
+			return 1;
+	return 0;
+}
+
+void
+rte_trace_mode_set(enum rte_trace_mode mode)
+{
+	struct trace_point *tp;
+
+	trace_mode = mode;
+	STAILQ_FOREACH(tp, &trace_points, next) {
+		if (mode == RTE_TRACE_MODE_DISCARD)
+			__atomic_or_fetch(tp->handle,
+				__RTE_TRACE_FIELD_DISCARD, __ATOMIC_RELEASE);
+		else
+			__atomic_and_fetch(tp->handle,
+				~__RTE_TRACE_FIELD_DISCARD, __ATOMIC_RELEASE);
+	}
+}
+
+enum rte_trace_mode
+rte_trace_mode_get(void)
+{
+	return trace_mode;
+}
+
+static int
+trace_save_metadata(const char *dir)
+{
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t tsc, real_ns, tsc_ns, epoch_ns;
+	struct trace_point *tp;
+	char path[PATH_MAX];
+	struct timespec ts;
+	unsigned int i;
+	FILE *f;
+	int ret;
+
+	snprintf(path, sizeof(path), "%s/metadata", dir);
+	f = fopen(path, "w");
+	if (f == NULL)
+		return -errno;
+
+	/* map the TSC to the wall clock, so that viewers show real time */
+	clock_gettime(CLOCK_REALTIME, &ts);
+	tsc = rte_rdtsc();
+	real_ns = (uint64_t)ts.tv_sec * NS_PER_S + ts.tv_nsec;
+	tsc_ns = tsc / hz * NS_PER_S + tsc % hz * NS_PER_S / hz;
+	epoch_ns = real_ns - tsc_ns;
+
+	fprintf(f, "/* CTF 1.8 */\n\n"
+		"typealias integer {size = 32; align = 8; signed = false;} "
+		":= uint32_t;\n"
+		"typealias integer {size = 64; align = 8; signed = false;} "
+		":= uint64_t;\n\n"
+		"trace {\n"
+		"\tmajor = 1;\n"
+		"\tminor = 8;\n"
+		"\tbyte_order = %s;\n"
+		"\tpacket.header := struct {\n"
+		"\t\tuint32_t magic;\n"
+		"\t\tuint32_t stream_id;\n"
+		"\t};\n"
+		"};\n\n"
+		"env {\n"
+		"\tdpdk_version = \"%s\";\n"
+		"\ttracer_name = \"dpdk\";\n"
+		"};\n\n"
+		"clock {\n"
+		"\tname = \"dpdk\";\n"
+		"\tfreq = %" PRIu64 ";\n"
+		"\toffset_s = %" PRIu64 ";\n"
+		"\toffset = %" PRIu64 ";\n"
+		"};\n\n"
+		"typealias integer {size = 64; align = 8; signed = false; "
+		"map = clock.dpdk.value;} := uint64_clock_t;\n\n"
+		"stream {\n"
+		"\tid = 0;\n"
+		"\tpacket.context := struct {\n"
+		"\t\tuint32_t lcore_id;\n"
+		"\t\tuint32_t thread_id;\n"
+		"\t};\n"
+		"\tevent.header := struct {\n"
+		"\t\tuint64_clock_t timestamp;\n"
+		"\t\tuint32_t id;\n"
+		"\t};\n"
+		"};\n",
+		RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN ? "le" : "be",
+		rte_version(), hz, epoch_ns / NS_PER_S,
+		epoch_ns % NS_PER_S * hz / NS_PER_S);
+
+	STAILQ_FOREACH(tp, &trace_points, next) {
+		fprintf(f, "\nevent {\n"
+			"\tid = %" PRIu64 ";\n"
+			"\tname = \"%s\";\n"
+			"\tstream_id = 0;\n"
+			"\tfields := struct {\n",
+			*tp->handle & __RTE_TRACE_FIELD_ID_MASK, tp->name);
+		for (i = 0; i < tp->nb_fields; i++)
+			fprintf(f, "\t\tuint64_t %s;\n", tp->fields[i]);
+		fprintf(f, "\t};\n};\n");
+	}
+
+	ret = ferror(f) ? -EIO : 0;
+	if (fclose(f) != 0 && ret == 0)
+		ret = -errno;
+	return ret;
+}
+
+/*
+ * Stream layout, all integers byte aligned: packet header and context take
+ * 16 bytes, then each event is the 64-bit timestamp, the 32-bit id and one
+ * 64-bit value per field.
+ */
+static int
+trace_save_stream(const char *dir, struct __rte_trace_mem *mem,
+		const uint8_t *nb_fields)
+{
+	const struct __rte_trace_rec *rec;
+	uint32_t hdr[4];
+	char path[PATH_MAX];
+	uint64_t head, idx;
+	uint32_t id;
+	FILE *f;
+	int ret;
+
+	snprintf(path, sizeof(path), "%s/channel0_%u", dir, mem->index);
+	f = fopen(path, "w");
+	if (f == NULL)
+		return -errno;
+
+	hdr[0] = TRACE_CTF_MAGIC;
+	hdr[1] = 0;
+	hdr[2] = mem->lcore_id;
+	hdr[3] = mem->tid;
+	fwrite(hdr, sizeof(hdr), 1, f);
+
+	head = __atomic_load_n(&mem->head, __ATOMIC_ACQUIRE);
+	idx = head > (uint64_t)mem->mask + 1 ? head - mem->mask - 1 : 0;
+	for (; idx < head; idx++) {
+		rec = &mem->rec[idx & mem->mask];
+		id = rec->id;
+		fwrite(&rec->tsc, sizeof(rec->tsc), 1, f);
+		fwrite(&id, sizeof(id), 1, f);
+		fwrite(rec->args, sizeof(rec->args[0]), nb_fields[id], f);
+	}
+
+	ret = ferror(f) ? -EIO : 0;
+	if (fclose(f) != 0 && ret == 0)
+		ret = -errno;
+	return ret;
+}
+
+int
+rte_trace_save(const char *dir)
+{
+	uint8_t nb_fields[TRACE_POINT_MAX] = { 0 };
+	struct __rte_trace_mem *mem;
+	struct trace_point *tp;
+	int ret;
+
+	if (dir == NULL)
+		return -EINVAL;
+	if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+		ret = -errno;
+		goto fail;
+	}
+
+	ret = trace_save_metadata(dir);
+	if (ret < 0)
+		goto fail;
+
+	STAILQ_FOREACH(tp, &trace_points, next)
+		nb_fields[*tp->handle & __RTE_TRACE_FIELD_ID_MASK] =
+			tp->nb_fields;
+
+	rte_spinlock_lock(&trace_mem_lock);
+	for (mem = trace_mems; mem != NULL && ret == 0; mem = mem->next)
+		ret = trace_save_stream(dir, mem, nb_fields);
+	rte_spinlock_unlock(&trace_mem_lock);
+	if (ret == 0)
+		return 0;
+fail:
+	RTE_LOG(ERR, EAL, "Cannot save trace in %s: %s\n", dir,
+		strerror(-ret));
+	return ret;
+}
+
+void
+rte_trace_dump(FILE *f)
+{
+	struct __rte_trace_mem *mem;
+	struct trace_point *tp;
+	uint64_t head;
+
+	fprintf(f, "trace mode: %s\n", trace_mode == RTE_TRACE_MODE_DISCARD ?
+		"discard" : "overwrite");
+	fprintf(f, "tracepoints: %u\n", nb_trace_points);
+	STAILQ_FOREACH(tp, &trace_points, next)
+		fprintf(f, "  %-32s %s\n", tp->name,
+			rte_trace_point_is_enabled(tp->handle) ?
+			"enabled" : "disabled");
+
+	fprintf(f, "buffers: %u\n", nb_trace_mems);
+	rte_spinlock_lock(&trace_mem_lock);
+	for (mem = trace_mems; mem != NULL; mem = mem->next) {
+		head = __atomic_load_n(&mem->head, __ATOMIC_RELAXED);
+		fprintf(f, "  channel0_%u: lcore %d, thread %d, "
+			"%" PRIu64 " events, %" PRIu64 " retained\n",
+			mem->index, (int)mem->lcore_id, mem->tid, head,
+			RTE_MIN(head, (uint64_t)mem->mask + 1));
+	}
+	rte_spinlock_unlock(&trace_mem_lock);
+}
+
+/*
+ * Called once the application stopped using the lcores: the threads still
+ * alive lose their buffer, and get a new one if they emit events again.
+ */
+void
+eal_trace_fini(void)
+{
+	struct __rte_trace_mem *mem;
+	struct trace_point *tp;
+
+	STAILQ_FOREACH(tp, &trace_points, next)
+		rte_trace_point_disable(tp->handle);
+
+	rte_spinlock_lock(&trace_mem_lock);
+	while (trace_mems != NULL) {
+		mem = trace_mems;
+		trace_mems = mem->next;
+		if (mem->owner != NULL)
+			*mem->owner = NULL;
+		free(mem);
+	}
+	nb_trace_mems = 0;
+	rte_spinlock_unlock(&trace_mem_lock);
+}
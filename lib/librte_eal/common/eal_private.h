@@ -444,4 +444,11 @@ rte_option_usage(void);
 uint64_t
 eal_get_baseaddr(void);
 
+/**
+ * Disable the tracepoints and free the trace buffers of all threads.
+ * Called once the lcores stopped emitting events.
+ */
+void
+eal_trace_fini(void);
+
 #endif /* _EAL_PRIVATE_H_ */
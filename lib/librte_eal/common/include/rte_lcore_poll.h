@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_LCORE_POLL_H_
+#define _RTE_LCORE_POLL_H_
+
+/**
+ * @file
+ *
+ * RTE Lcore Poll Accounting
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Accounting of the busy and idle iterations of a polling loop, to measure
+ * the real headroom of an lcore. The loop reports every iteration with
+ * rte_lcore_poll_busy() or rte_lcore_poll_idle(); the cycles elapsed since
+ * the previous report are accounted to the iteration, along with the
+ * number of packets it processed:
+ *
+ * @code
+ *	for (;;) {
+ *		nb_rx = rte_eth_rx_burst(port, queue, pkts, BURST_SIZE);
+ *		if (nb_rx == 0) {
+ *			rte_lcore_poll_idle();
+ *			continue;
+ *		}
+ *		process(pkts, nb_rx);
+ *		rte_lcore_poll_busy(nb_rx);
+ *	}
+ * @endcode
+ *
+ * The first iteration reported after the loop was paused also accounts the
+ * pause, the statistics are meant for lcores which keep polling.
+ *
+ * Service cores account their loops automatically.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_compat.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+
+/**
+ * Number of buckets of the histograms. Bucket i counts the values
+ * between 2^i and 2^(i + 1) - 1, the last bucket counts all values above.
+ */
+#define RTE_LCORE_POLL_HIST_SIZE 16
+
+/** Poll statistics of an lcore. */
+struct rte_lcore_poll_stats {
+	uint64_t busy_polls;  /**< Iterations which did some work. */
+	uint64_t idle_polls;  /**< Iterations which found no work. */
+	uint64_t busy_cycles; /**< Cycles spent in busy iterations. */
+	uint64_t idle_cycles; /**< Cycles spent in idle iterations. */
+	uint64_t pkts;        /**< Packets processed by busy iterations. */
+	/** Histogram of the number of packets per busy iteration. */
+	uint64_t burst_hist[RTE_LCORE_POLL_HIST_SIZE];
+	/** Histogram of the cycles per packet of busy iterations. */
+	uint64_t cpp_hist[RTE_LCORE_POLL_HIST_SIZE];
+};
+
+/** @internal Poll accounting state of an lcore. */
+struct __rte_lcore_poll {
+	uint64_t tsc; /**< End of the previous iteration. */
+	struct rte_lcore_poll_stats stats;
+	/** Snapshot taken at the last reset, written by the readers only. */
+	struct rte_lcore_poll_stats base __rte_cache_aligned;
+} __rte_cache_aligned;
+
+/** @internal Poll accounting state of all lcores. */
+extern struct __rte_lcore_poll __rte_lcore_polls[RTE_MAX_LCORE];
+
+/** @internal Histogram bucket of a value. */
+static inline unsigned int
+__rte_lcore_poll_bucket(uint32_t v)
+{
+	unsigned int b = rte_fls_u32(v | 1) - 1;
+
+	return RTE_MIN(b, RTE_LCORE_POLL_HIST_SIZE - 1u);
+}
+
+/** @internal Account an iteration and return its duration in cycles. */
+static inline uint64_t
+__rte_lcore_poll_cycles(struct __rte_lcore_poll *p)
+{
+	const uint64_t now = rte_rdtsc();
+	/* the first report only starts the accounting */
+	const uint64_t cycles = p->tsc != 0 ? now - p->tsc : 0;
+
+	p->tsc = now;
+	return cycles;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Report an iteration of the polling loop of the calling lcore which did
+ * some work. Does nothing if the caller is not an EAL thread.
+ *
+ * @param nb_pkts
+ *   Number of packets processed, or 0 if unknown, in which case the
+ *   iteration is not accounted in the histograms.
+ */
+__rte_experimental
+static inline void
+rte_lcore_poll_busy(uint32_t nb_pkts)
+{
+	const unsigned int lcore_id = rte_lcore_id();
+	struct __rte_lcore_poll *p;
+	uint64_t cycles;
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	p = &__rte_lcore_polls[lcore_id];
+	cycles = __rte_lcore_poll_cycles(p);
+	p->stats.busy_polls++;
+	p->stats.busy_cycles += cycles;
+	if (nb_pkts == 0)
+		return;
+	p->stats.pkts += nb_pkts;
+	p->stats.burst_hist[__rte_lcore_poll_bucket(nb_pkts)]++;
+	p->stats.cpp_hist[__rte_lcore_poll_bucket(
+		(uint32_t)RTE_MIN(cycles, (uint64_t)UINT32_MAX) / nb_pkts)]++;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Report an iteration of the polling loop of the calling lcore which found
+ * no work. Does nothing if the caller is not an EAL thread.
+ */
+__rte_experimental
+static inline void
+rte_lcore_poll_idle(void)
+{
+	const unsigned int lcore_id = rte_lcore_id();
+	struct __rte_lcore_poll *p;
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	p = &__rte_lcore_polls[lcore_id];
+	p->stats.idle_cycles += __rte_lcore_poll_cycles(p);
+	p->stats.idle_polls++;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the poll statistics of an lcore since the last reset.
+ * Can be called from any thread.
+ *
+ * @param lcore_id
+ *   Lcore id.
+ * @param stats
+ *   Statistics filled on success.
+ * @return
+ *   0 on success, -EINVAL on bad argument.
+ */
+__rte_experimental
+int
+rte_lcore_poll_stats_get(unsigned int lcore_id,
+		struct rte_lcore_poll_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reset the poll statistics of an lcore. Can be called from any thread,
+ * but not concurrently with another reset of the same lcore.
+ *
+ * @param lcore_id
+ *   Lcore id.
+ * @return
+ *   0 on success, -EINVAL on bad argument.
+ */
+__rte_experimental
+int
+rte_lcore_poll_stats_reset(unsigned int lcore_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Dump the poll statistics of an lcore: busy ratio, cycles per poll and
+ * per packet, and the non empty buckets of the histograms.
+ *
+ * @param f
+ *   File to dump to.
+ * @param lcore_id
+ *   Lcore id.
+ * @return
+ *   0 on success, -EINVAL on bad argument.
+ */
+__rte_experimental
+int
+rte_lcore_poll_dump(FILE *f, unsigned int lcore_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LCORE_POLL_H_ */
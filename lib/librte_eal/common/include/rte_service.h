@@ -32,6 +32,7 @@ extern "C" {
 #include <sys/queue.h>
 
 #include <rte_config.h>
+#include <rte_compat.h>
 #include <rte_lcore.h>
 
 #define RTE_SERVICE_NAME_MAX 32
@@ -345,7 +346,8 @@ int32_t rte_service_lcore_count_services(uint32_t lcore);
 
 /**
  * Dumps any information available about the service. When id is UINT32_MAX,
- * this function dumps info for all services.
+ * this function dumps info for all services, the service cores, and the
+ * poll statistics of the lcores (see rte_lcore_poll.h).
  *
  * @retval 0 Statistics have been successfully dumped
  * @retval -EINVAL Invalid service id provided
@@ -362,6 +364,12 @@ int32_t rte_service_dump(FILE *f, uint32_t id);
  */
 #define RTE_SERVICE_ATTR_CALL_COUNT 1
 
+/**
+ * Returns the count of invocations of this service function which found no
+ * work, i.e. returned -EAGAIN.
+ */
+#define RTE_SERVICE_ATTR_IDLE_CALL_COUNT 2
+
 /**
  * Get an attribute from a service.
  *
@@ -400,7 +408,8 @@ rte_service_lcore_attr_get(uint32_t lcore, uint32_t attr_id,
 			   uint64_t *attr_value);
 
 /**
- * Reset all attribute values of a service core.
+ * Reset all attribute values of a service core, including its poll
+ * statistics.
  *
  * @param lcore The service core to reset all the statistics of
  * @retval 0 Successfully reset attributes
@@ -410,6 +419,113 @@ rte_service_lcore_attr_get(uint32_t lcore, uint32_t attr_id,
 int32_t
 rte_service_lcore_attr_reset_all(uint32_t lcore);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Configuration of the service rebalancer.
+ *
+ * The rebalancer measures the cycles spent by each service between two of
+ * its passes, and moves services from the most loaded service core to the
+ * least loaded one while their loads differ by more than the threshold.
+ * Only the services mapped to a single running service core, with
+ * statistics enabled (see rte_service_set_stats_enable()), and not pinned
+ * (see rte_service_pin_set()) are moved. The services mapped to several
+ * service cores are accounted on each of them, but are left in place.
+ */
+struct rte_service_rebalance_conf {
+	/**
+	 * Period of the passes in milliseconds, run from the EAL alarm
+	 * thread. With 0, the passes are run by the application calling
+	 * rte_service_rebalance_run().
+	 */
+	uint32_t period_ms;
+	/**
+	 * Difference of load between the most and least loaded service cores,
+	 * in percent of a core, up to which no service is moved.
+	 */
+	uint32_t threshold_pct;
+	/** Number of passes a service stays on a service core once moved. */
+	uint32_t hold_periods;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable the service rebalancer. To change its configuration, disable it
+ * first.
+ *
+ * @param conf The configuration of the rebalancer.
+ * @retval 0 Success
+ *         -EINVAL conf was NULL or threshold_pct was more than 100.
+ *         -EALREADY The rebalancer is already enabled.
+ *         -ENOMEM The periodic pass could not be scheduled.
+ */
+__rte_experimental
+int32_t
+rte_service_rebalance_enable(const struct rte_service_rebalance_conf *conf);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Disable the service rebalancer. The mapping of the services is left as
+ * is. Once this function returns, no periodic pass is running.
+ *
+ * @retval 0 Success
+ *         -EALREADY The rebalancer was not enabled.
+ */
+__rte_experimental
+int32_t rte_service_rebalance_disable(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Run a pass of the service rebalancer. The first pass after the rebalancer
+ * is enabled only takes the reference of the measurements.
+ *
+ * A service which is not MT safe is unmapped from its service core, which
+ * then completes its current loop before the service is mapped to the new
+ * core. It must thus not be called from a service core.
+ *
+ * @retval >=0 Number of services moved.
+ *         -ENOTSUP The rebalancer is not enabled.
+ *         -EBUSY Called from a service core.
+ */
+__rte_experimental
+int32_t rte_service_rebalance_run(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Pin a service to its current service cores, so that the rebalancer never
+ * moves it. Its load is still accounted on these cores.
+ *
+ * @param id The id of the service.
+ * @param pinned If non-zero the service is pinned, otherwise it is unpinned.
+ * @retval 0 Success
+ *         -EINVAL Invalid service id.
+ */
+__rte_experimental
+int32_t rte_service_pin_set(uint32_t id, uint32_t pinned);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get whether a service is pinned to its current service cores.
+ *
+ * @param id The id of the service.
+ * @retval 1 The service is pinned.
+ * @retval 0 The service can be moved by the rebalancer.
+ *         -EINVAL Invalid service id.
+ */
+__rte_experimental
+int32_t rte_service_pin_get(uint32_t id);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,6 +14,10 @@
 
 /**
  * Signature of callback function to run a service.
+ *
+ * The callback returns -EAGAIN if it found no work to do, or the number of
+ * items (e.g. packets or events) processed if known, 0 otherwise. This is
+ * used to account the busy and idle loops of the service cores.
  */
 typedef int32_t (*rte_service_func)(void *args);
 
@@ -0,0 +1,342 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_TRACE_H_
+#define _RTE_TRACE_H_
+
+/**
+ * @file
+ *
+ * RTE Trace
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Low overhead tracing of the data path. Tracepoints are registered at
+ * constructor time, every thread emitting events gets its own lock-free
+ * buffer of fixed size records, timestamped with the TSC. Tracepoints are
+ * disabled by default and are enabled at runtime, a disabled tracepoint
+ * only costs a load and a predictable branch. The buffers can be saved in
+ * Common Trace Format (CTF) for post-processing with tools like
+ * babeltrace or Trace Compass.
+ *
+ * Tracepoints in the fast path of the libraries (ethdev, mempool, ring)
+ * are only compiled in with RTE_ENABLE_TRACE_FP.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_compat.h>
+#include <rte_cycles.h>
+#include <rte_per_lcore.h>
+
+/** Tracepoint handle. */
+typedef uint64_t rte_trace_point_t;
+
+/** Maximum number of 64-bit arguments recorded by a tracepoint. */
+#define RTE_TRACE_POINT_ARGS_MAX 4
+
+/** Maximum length of a tracepoint name. */
+#define RTE_TRACE_POINT_NAMESIZE 64
+
+/** Trace buffer mode. */
+enum rte_trace_mode {
+	/** Oldest records are overwritten when a buffer is full. */
+	RTE_TRACE_MODE_OVERWRITE,
+	/** New records are dropped when a buffer is full. */
+	RTE_TRACE_MODE_DISCARD,
+};
+
+/** @internal Tracepoint handle layout. */
+#define __RTE_TRACE_FIELD_ENABLE (UINT64_C(1) << 63)
+#define __RTE_TRACE_FIELD_DISCARD (UINT64_C(1) << 62)
+#define __RTE_TRACE_FIELD_ID_MASK UINT64_C(0xffff)
+
+/** @internal Trace record, fixed size so that wrapping stays trivial. */
+struct __rte_trace_rec {
+	uint64_t tsc;
+	uint64_t id;
+	uint64_t args[RTE_TRACE_POINT_ARGS_MAX];
+};
+
+/** @internal Per thread trace buffer, written by its owner only. */
+struct __rte_trace_mem {
+	uint64_t head;      /**< Number of records written. */
+	uint32_t mask;      /**< Number of records in the buffer - 1. */
+	uint32_t index;     /**< Buffer index, used to name the stream. */
+	uint32_t lcore_id;  /**< Lcore of the owner thread. */
+	int tid;            /**< System thread id of the owner thread. */
+	/** Per-lcore pointer of the owner thread, NULL once it exited. */
+	struct __rte_trace_mem **owner;
+	struct __rte_trace_mem *next;
+	struct __rte_trace_rec rec[] __rte_cache_aligned;
+};
+
+RTE_DECLARE_PER_LCORE(struct __rte_trace_mem *, trace_mem);
+
+/**
+ * Declare a tracepoint handle defined in another file, e.g. in the header
+ * of the library owning it.
+ */
+#define RTE_TRACE_POINT_DECLARE(tp) extern rte_trace_point_t __##tp
+
+/** Define a tracepoint handle. */
+#define RTE_TRACE_POINT_DEFINE(tp) rte_trace_point_t __##tp
+
+/**
+ * Register a tracepoint defined with RTE_TRACE_POINT_DEFINE.
+ *
+ * @param tp
+ *   Tracepoint handle.
+ * @param name
+ *   Name of the tracepoint, e.g. "lib.ring.enqueue".
+ * @param fields
+ *   Comma separated names of the arguments recorded, up to
+ *   RTE_TRACE_POINT_ARGS_MAX, e.g. "ring,nb_req,nb_enq".
+ */
+#define RTE_TRACE_POINT_REGISTER(tp, name, fields)			\
+RTE_INIT(tp##_register)							\
+{									\
+	__rte_trace_point_register(&__##tp, name, fields);		\
+}
+
+/**
+ * @internal
+ * Register a tracepoint, use RTE_TRACE_POINT_REGISTER instead.
+ */
+__rte_experimental
+int
+__rte_trace_point_register(rte_trace_point_t *tp, const char *name,
+		const char *fields);
+
+/**
+ * @internal
+ * Allocate the trace buffer of the calling thread.
+ */
+__rte_experimental
+struct __rte_trace_mem *
+__rte_trace_mem_alloc(void);
+
+#ifdef ALLOW_EXPERIMENTAL_API
+/** @internal Record an event, use rte_trace_point_emit instead. */
+static __rte_always_inline void
+__rte_trace_point_emit(rte_trace_point_t *tp, uint64_t a0, uint64_t a1,
+		uint64_t a2, uint64_t a3)
+{
+	const uint64_t val = __atomic_load_n(tp, __ATOMIC_RELAXED);
+	struct __rte_trace_mem *mem;
+	struct __rte_trace_rec *rec;
+
+	if (likely((val & __RTE_TRACE_FIELD_ENABLE) == 0))
+		return;
+
+	mem = RTE_PER_LCORE(trace_mem);
+	if (unlikely(mem == NULL)) {
+		mem = __rte_trace_mem_alloc();
+		if (mem == NULL)
+			return;
+	}
+	if ((val & __RTE_TRACE_FIELD_DISCARD) && mem->head > mem->mask)
+		return;
+
+	rec = &mem->rec[mem->head & mem->mask];
+	rec->tsc = rte_rdtsc();
+	rec->id = val & __RTE_TRACE_FIELD_ID_MASK;
+	rec->args[0] = a0;
+	rec->args[1] = a1;
+	rec->args[2] = a2;
+	rec->args[3] = a3;
+	/* make the record visible before it is accounted */
+	__atomic_store_n(&mem->head, mem->head + 1, __ATOMIC_RELEASE);
+}
+
+#define __RTE_TRACE_ARGS(a0, a1, a2, a3, ...)				\
+	(uint64_t)(uintptr_t)(a0), (uint64_t)(uintptr_t)(a1),		\
+	(uint64_t)(uintptr_t)(a2), (uint64_t)(uintptr_t)(a3)
+
+/**
+ * Record an event on a tracepoint, if it is enabled.
+ *
+ * @param tp
+ *   Tracepoint handle, as given to RTE_TRACE_POINT_DEFINE.
+ * @param ...
+ *   One to RTE_TRACE_POINT_ARGS_MAX integer or pointer arguments, in the
+ *   order of the fields given at registration.
+ */
+#define rte_trace_point_emit(tp, ...)					\
+	__rte_trace_point_emit(&__##tp,					\
+		__RTE_TRACE_ARGS(__VA_ARGS__, 0, 0, 0, 0))
+#else
+#define rte_trace_point_emit(tp, ...) do { } while (0)
+#endif
+
+#if defined(ALLOW_EXPERIMENTAL_API) && defined(RTE_ENABLE_TRACE_FP)
+/**
+ * Record an event on a fast path tracepoint. Compiled out unless
+ * RTE_ENABLE_TRACE_FP is set.
+ */
+#define rte_trace_point_emit_fp(tp, ...) rte_trace_point_emit(tp, __VA_ARGS__)
+#else
+#define rte_trace_point_emit_fp(tp, ...) do { } while (0)
+#endif
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Look up a tracepoint by name.
+ *
+ * @param name
+ *   Name given at registration.
+ * @return
+ *   Tracepoint handle, or NULL if not found.
+ */
+__rte_experimental
+rte_trace_point_t *
+rte_trace_point_lookup(const char *name);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable a tracepoint.
+ *
+ * @param tp
+ *   Tracepoint handle.
+ * @return
+ *   0 on success, -EINVAL if the tracepoint is not registered.
+ */
+__rte_experimental
+int
+rte_trace_point_enable(rte_trace_point_t *tp);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Disable a tracepoint.
+ *
+ * @param tp
+ *   Tracepoint handle.
+ * @return
+ *   0 on success, -EINVAL if the tracepoint is not registered.
+ */
+__rte_experimental
+int
+rte_trace_point_disable(rte_trace_point_t *tp);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Check if a tracepoint is enabled.
+ *
+ * @param tp
+ *   Tracepoint handle.
+ * @return
+ *   1 if enabled, 0 otherwise.
+ */
+__rte_experimental
+int
+rte_trace_point_is_enabled(rte_trace_point_t *tp);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable or disable the tracepoints matching a shell pattern.
+ *
+ * @param pattern
+ *   Pattern as understood by fnmatch(3), e.g. "lib.ethdev.*".
+ * @param enable
+ *   Non-zero to enable, 0 to disable.
+ * @return
+ *   Number of tracepoints matching the pattern, -EINVAL on bad argument.
+ */
+__rte_experimental
+int
+rte_trace_pattern(const char *pattern, int enable);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Check if any tracepoint is enabled.
+ *
+ * @return
+ *   1 if at least one tracepoint is enabled, 0 otherwise.
+ */
+__rte_experimental
+int
+rte_trace_is_enabled(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the mode of all trace buffers, RTE_TRACE_MODE_OVERWRITE by default.
+ *
+ * @param mode
+ *   Trace buffer mode.
+ */
+__rte_experimental
+void
+rte_trace_mode_set(enum rte_trace_mode mode);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the mode of the trace buffers.
+ *
+ * @return
+ *   Trace buffer mode.
+ */
+__rte_experimental
+enum rte_trace_mode
+rte_trace_mode_get(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Save the trace buffers in CTF format: a "metadata" file describing the
+ * tracepoints and one "channel0_<n>" stream file per thread buffer.
+ * Threads may keep tracing while the buffers are saved, but records being
+ * overwritten at that time can be inconsistent; disable the tracepoints
+ * first for an exact snapshot.
+ *
+ * @param dir
+ *   Directory where the trace is saved, created if it does not exist.
+ * @return
+ *   0 on success, negative errno value on failure.
+ */
+__rte_experimental
+int
+rte_trace_save(const char *dir);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Dump the state of the tracepoints and of the trace buffers.
+ *
+ * @param f
+ *   File to dump to.
+ */
+__rte_experimental
+void
+rte_trace_dump(FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TRACE_H_ */
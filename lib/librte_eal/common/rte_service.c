@@ -20,6 +20,10 @@
 #include <rte_atomic.h>
 #include <rte_memory.h>
 #include <rte_malloc.h>
+#include <rte_lcore_poll.h>
+#include <rte_alarm.h>
+#include <rte_spinlock.h>
+#include <rte_pause.h>
 
 #include "eal_private.h"
 
@@ -28,6 +32,7 @@
 #define SERVICE_F_REGISTERED    (1 << 0)
 #define SERVICE_F_STATS_ENABLED (1 << 1)
 #define SERVICE_F_START_CHECK   (1 << 2)
+#define SERVICE_F_PINNED        (1 << 3)
 
 /* runstates for services and lcores, denoting if they are active or not */
 #define RUNSTATE_STOPPED 0
@@ -52,6 +57,7 @@ struct rte_service_spec_impl {
 	/* per service statistics */
 	rte_atomic32_t num_mapped_cores;
 	uint64_t calls;
+	uint64_t idle_calls;
 	uint64_t cycles_spent;
 } __rte_cache_aligned;
 
@@ -63,6 +69,9 @@ struct core_state {
 	uint8_t is_service_core; /* set if core is currently a service core */
 	uint8_t service_active_on_lcore[RTE_SERVICE_NUM_MAX];
 	uint64_t loops;
+	/* services which did some work in the current loop, and items */
+	uint32_t loop_busy;
+	uint32_t loop_items;
 	uint64_t calls_per_service[RTE_SERVICE_NUM_MAX];
 } __rte_cache_aligned;
 
@@ -71,6 +80,24 @@ static struct rte_service_spec_impl *rte_services;
 static struct core_state *lcore_states;
 static uint32_t rte_service_library_initialized;
 
+/* state of the rebalancer, which moves services between service cores */
+struct service_rebalance {
+	rte_spinlock_t lock;
+	uint32_t enabled;
+	struct rte_service_rebalance_conf conf;
+	/* number of passes since enabled, and TSC of the last one */
+	uint64_t passes;
+	uint64_t last_tsc;
+	/* cycles spent by the services at the last pass */
+	uint64_t last_cycles[RTE_SERVICE_NUM_MAX];
+	/* first pass at which a moved service can be moved again */
+	uint64_t next_move[RTE_SERVICE_NUM_MAX];
+};
+
+static struct service_rebalance rebalance = {
+	.lock = RTE_SPINLOCK_INITIALIZER,
+};
+
 int32_t
 rte_service_init(void)
 {
@@ -122,6 +149,7 @@ rte_service_finalize(void)
 	if (!rte_service_library_initialized)
 		return;
 
+	rte_service_rebalance_disable();
 	rte_free(rte_services);
 	rte_free(lcore_states);
 
@@ -159,6 +187,12 @@ service_mt_safe(struct rte_service_spec_impl *s)
 	return !!(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE);
 }
 
+static inline int
+service_pinned(struct rte_service_spec_impl *s)
+{
+	return !!(s->internal_flags & SERVICE_F_PINNED);
+}
+
 int32_t
 rte_service_set_stats_enable(uint32_t id, int32_t enabled)
 {
@@ -173,6 +207,28 @@ rte_service_set_stats_enable(uint32_t id, int32_t enabled)
 	return 0;
 }
 
+int32_t
+rte_service_pin_set(uint32_t id, uint32_t pinned)
+{
+	struct rte_service_spec_impl *s;
+	SERVICE_VALID_GET_OR_ERR_RET(id, s, -EINVAL);
+
+	if (pinned)
+		s->internal_flags |= SERVICE_F_PINNED;
+	else
+		s->internal_flags &= ~(SERVICE_F_PINNED);
+
+	return 0;
+}
+
+int32_t
+rte_service_pin_get(uint32_t id)
+{
+	struct rte_service_spec_impl *s;
+	SERVICE_VALID_GET_OR_ERR_RET(id, s, -EINVAL);
+	return service_pinned(s);
+}
+
 int32_t
 rte_service_set_runstate_mapped_check(uint32_t id, int32_t enabled)
 {
@@ -331,16 +387,25 @@ rte_service_runner_do_callback(struct rte_service_spec_impl *s,
 			       struct core_state *cs, uint32_t service_idx)
 {
 	void *userdata = s->spec.callback_userdata;
+	int32_t ret;
 
 	if (service_stats_enabled(s)) {
 		uint64_t start = rte_rdtsc();
-		s->spec.callback(userdata);
+		ret = s->spec.callback(userdata);
 		uint64_t end = rte_rdtsc();
 		s->cycles_spent += end - start;
 		cs->calls_per_service[service_idx]++;
 		s->calls++;
+		if (ret == -EAGAIN)
+			s->idle_calls++;
 	} else
-		s->spec.callback(userdata);
+		ret = s->spec.callback(userdata);
+
+	if (ret != -EAGAIN) {
+		cs->loop_busy++;
+		if (ret > 0)
+			cs->loop_items += ret;
+	}
 }
 
 
@@ -383,7 +448,7 @@ rte_service_may_be_active(uint32_t id)
 	int32_t lcore_count = rte_service_lcore_list(ids, RTE_MAX_LCORE);
 	int i;
 
-	if (!service_valid(id))
+	if (id >= RTE_SERVICE_NUM_MAX || !service_valid(id))
 		return -EINVAL;
 
 	for (i = 0; i < lcore_count; i++) {
@@ -437,11 +502,17 @@ rte_service_runner_func(void *arg)
 	while (lcore_states[lcore].runstate == RUNSTATE_RUNNING) {
 		const uint64_t service_mask = cs->service_mask;
 
+		cs->loop_busy = 0;
+		cs->loop_items = 0;
 		for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
 			/* return value ignored as no change to code flow */
 			service_run(i, cs, service_mask);
 		}
 
+		if (cs->loop_busy != 0)
+			rte_lcore_poll_busy(cs->loop_items);
+		else
+			rte_lcore_poll_idle();
 		cs->loops++;
 
 		rte_smp_rmb();
@@ -605,6 +676,235 @@ rte_service_map_lcore_get(uint32_t id, uint32_t lcore)
 	return ret;
 }
 
+/* wait for a running service core to complete its current loop, after
+ * which it no longer runs the services removed from its mask
+ */
+static void
+service_lcore_quiesce(uint32_t lcore)
+{
+	volatile uint64_t *loops = &lcore_states[lcore].loops;
+	uint64_t start;
+
+	rte_smp_mb();
+	start = *loops;
+	while (*loops == start && lcore_config[lcore].state == RUNNING)
+		rte_pause();
+}
+
+static void
+service_move(uint32_t id, uint32_t from, uint32_t to)
+{
+	struct rte_service_spec_impl *s = &rte_services[id];
+	uint32_t on = 1;
+	uint32_t off = 0;
+
+	if (service_mt_safe(s)) {
+		service_update(&s->spec, to, &on, NULL);
+		service_update(&s->spec, from, &off, NULL);
+	} else {
+		/* the service must never run on both cores at once */
+		service_update(&s->spec, from, &off, NULL);
+		service_lcore_quiesce(from);
+		service_update(&s->spec, to, &on, NULL);
+	}
+
+	RTE_LOG(DEBUG, EAL, "service %s moved from lcore %u to lcore %u\n",
+		s->spec.name, from, to);
+}
+
+static inline int
+service_movable(uint32_t id, uint64_t load, uint64_t gap)
+{
+	struct rte_service_spec_impl *s = &rte_services[id];
+
+	return service_valid(id) && !service_pinned(s) &&
+		rte_atomic32_read(&s->num_mapped_cores) == 1 &&
+		load != 0 && load < gap &&
+		rebalance.passes >= rebalance.next_move[id];
+}
+
+/* measure the load of the services and service cores in per mille of a core
+ * since the last pass, then move the services from the most to the least
+ * loaded service core, picking each time the one which balances them best.
+ * Called with the rebalancer lock held.
+ */
+static int32_t
+service_rebalance_pass(void)
+{
+	uint64_t service_load[RTE_SERVICE_NUM_MAX];
+	uint64_t lcore_load[RTE_MAX_LCORE];
+	uint32_t lcores[RTE_MAX_LCORE];
+	uint32_t nb_lcores = 0;
+	uint64_t now, window, threshold;
+	uint32_t i, j;
+	int32_t moved = 0;
+
+	now = rte_rdtsc();
+	window = now - rebalance.last_tsc;
+	if (window == 0)
+		window = 1;
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		uint64_t cycles = rte_services[i].cycles_spent;
+		uint64_t last = rebalance.last_cycles[i];
+
+		/* the statistics may have been reset since the last pass */
+		if (cycles < last)
+			last = 0;
+		service_load[i] = (cycles - last) * 1000 / window;
+		rebalance.last_cycles[i] = cycles;
+	}
+	rebalance.last_tsc = now;
+
+	/* the first pass only takes the reference */
+	if (rebalance.passes++ == 0)
+		return 0;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		struct core_state *cs = &lcore_states[i];
+		uint64_t load = 0;
+
+		if (!cs->is_service_core || cs->runstate != RUNSTATE_RUNNING)
+			continue;
+		for (j = 0; j < RTE_SERVICE_NUM_MAX; j++) {
+			int32_t mapped = rte_atomic32_read(
+				&rte_services[j].num_mapped_cores);
+
+			if ((cs->service_mask & (UINT64_C(1) << j)) &&
+					mapped > 0)
+				load += service_load[j] / mapped;
+		}
+		lcore_load[i] = load;
+		lcores[nb_lcores++] = i;
+	}
+
+	threshold = rebalance.conf.threshold_pct * 10;
+	while (nb_lcores >= 2 && moved < RTE_SERVICE_NUM_MAX) {
+		uint32_t hi = lcores[0];
+		uint32_t lo = lcores[0];
+		uint64_t gap, best_dist = UINT64_MAX;
+		int32_t best = -1;
+
+		for (i = 1; i < nb_lcores; i++) {
+			if (lcore_load[lcores[i]] > lcore_load[hi])
+				hi = lcores[i];
+			if (lcore_load[lcores[i]] < lcore_load[lo])
+				lo = lcores[i];
+		}
+
+		gap = lcore_load[hi] - lcore_load[lo];
+		if (gap <= threshold)
+			break;
+
+		/* best is the service closest to half the gap */
+		for (j = 0; j < RTE_SERVICE_NUM_MAX; j++) {
+			uint64_t dist;
+
+			if (!(lcore_states[hi].service_mask &
+					(UINT64_C(1) << j)) ||
+					!service_movable(j, service_load[j], gap))
+				continue;
+			dist = RTE_MAX(2 * service_load[j], gap) -
+				RTE_MIN(2 * service_load[j], gap);
+			if (dist < best_dist) {
+				best_dist = dist;
+				best = j;
+			}
+		}
+		if (best < 0)
+			break;
+
+		service_move(best, hi, lo);
+		rebalance.next_move[best] = rebalance.passes +
+			rebalance.conf.hold_periods + 1;
+		lcore_load[hi] -= service_load[best];
+		lcore_load[lo] += service_load[best];
+		moved++;
+	}
+
+	return moved;
+}
+
+static void
+service_rebalance_alarm(void *arg)
+{
+	RTE_SET_USED(arg);
+
+	rte_spinlock_lock(&rebalance.lock);
+	if (rebalance.enabled) {
+		service_rebalance_pass();
+		rte_eal_alarm_set(rebalance.conf.period_ms * 1000ULL,
+				service_rebalance_alarm, NULL);
+	}
+	rte_spinlock_unlock(&rebalance.lock);
+}
+
+int32_t
+rte_service_rebalance_enable(const struct rte_service_rebalance_conf *conf)
+{
+	int ret = 0;
+
+	if (conf == NULL || conf->threshold_pct > 100)
+		return -EINVAL;
+
+	rte_spinlock_lock(&rebalance.lock);
+	if (rebalance.enabled) {
+		rte_spinlock_unlock(&rebalance.lock);
+		return -EALREADY;
+	}
+
+	rebalance.conf = *conf;
+	rebalance.passes = 0;
+	memset(rebalance.next_move, 0, sizeof(rebalance.next_move));
+	if (conf->period_ms != 0) {
+		/* take the reference now, so that the first period counts */
+		service_rebalance_pass();
+		ret = rte_eal_alarm_set(conf->period_ms * 1000ULL,
+				service_rebalance_alarm, NULL);
+	}
+	if (ret == 0)
+		rebalance.enabled = 1;
+	rte_spinlock_unlock(&rebalance.lock);
+
+	return ret;
+}
+
+int32_t
+rte_service_rebalance_disable(void)
+{
+	rte_spinlock_lock(&rebalance.lock);
+	if (!rebalance.enabled) {
+		rte_spinlock_unlock(&rebalance.lock);
+		return -EALREADY;
+	}
+	rebalance.enabled = 0;
+	rte_spinlock_unlock(&rebalance.lock);
+
+	/* waits for a pass being run from the alarm thread to complete */
+	if (rebalance.conf.period_ms != 0)
+		rte_eal_alarm_cancel(service_rebalance_alarm, NULL);
+
+	return 0;
+}
+
+int32_t
+rte_service_rebalance_run(void)
+{
+	unsigned int lcore = rte_lcore_id();
+	int32_t ret;
+
+	if (lcore < RTE_MAX_LCORE && lcore_states[lcore].is_service_core)
+		return -EBUSY;
+
+	rte_spinlock_lock(&rebalance.lock);
+	if (rebalance.enabled)
+		ret = service_rebalance_pass();
+	else
+		ret = -ENOTSUP;
+	rte_spinlock_unlock(&rebalance.lock);
+
+	return ret;
+}
+
 static void
 set_lcore_state(uint32_t lcore, int32_t state)
 {
@@ -746,6 +1046,9 @@ rte_service_attr_get(uint32_t id, uint32_t attr_id, uint64_t *attr_value)
 	case RTE_SERVICE_ATTR_CALL_COUNT:
 		*attr_value = s->calls;
 		return 0;
+	case RTE_SERVICE_ATTR_IDLE_CALL_COUNT:
+		*attr_value = s->idle_calls;
+		return 0;
 	default:
 		return -EINVAL;
 	}
@@ -788,16 +1091,17 @@ rte_service_dump_one(FILE *f, struct rte_service_spec_impl *s,
 	if (reset) {
 		s->cycles_spent = 0;
 		s->calls = 0;
+		s->idle_calls = 0;
 		return;
 	}
 
 	if (f == NULL)
 		return;
 
-	fprintf(f, "  %s: stats %d\tcalls %"PRIu64"\tcycles %"
-			PRIu64"\tavg: %"PRIu64"\n",
+	fprintf(f, "  %s: stats %d\tcalls %"PRIu64"\tidle %"PRIu64
+			"\tcycles %"PRIu64"\tavg: %"PRIu64"\n",
 			s->spec.name, service_stats_enabled(s), s->calls,
-			s->cycles_spent, s->cycles_spent / calls);
+			s->idle_calls, s->cycles_spent, s->cycles_spent / calls);
 }
 
 int32_t
@@ -824,6 +1128,7 @@ rte_service_lcore_attr_reset_all(uint32_t lcore)
 		return -ENOTSUP;
 
 	cs->loops = 0;
+	rte_lcore_poll_stats_reset(lcore);
 
 	return 0;
 }
@@ -887,5 +1192,15 @@ rte_service_dump(FILE *f, uint32_t id)
 		service_dump_calls_per_lcore(f, i, reset);
 	}
 
+	fprintf(f, "Lcore Poll Summary\n");
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		struct rte_lcore_poll_stats stats;
+
+		rte_lcore_poll_stats_get(i, &stats);
+		if (stats.busy_polls + stats.idle_polls == 0)
+			continue;
+		rte_lcore_poll_dump(f, i);
+	}
+
 	return 0;
 }
@@ -966,6 +966,7 @@ rte_eal_cleanup(void)
 {
 	rte_service_finalize();
 	rte_mp_channel_cleanup();
+	eal_trace_fini();
 	eal_cleanup_config(&internal_config);
 	return 0;
 }
@@ -29,6 +29,7 @@
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_mempool.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
@@ -38,6 +39,7 @@
 #include <rte_kvargs.h>
 #include <rte_class.h>
 #include <rte_ether.h>
+#include <rte_rcu_qsbr.h>
 
 #include "rte_ethdev.h"
 #include "rte_ethdev_driver.h"
@@ -58,6 +60,11 @@ static rte_spinlock_t rte_eth_rx_cb_lock = RTE_SPINLOCK_INITIALIZER;
 /* spinlock for add/remove tx callbacks */
 static rte_spinlock_t rte_eth_tx_cb_lock = RTE_SPINLOCK_INITIALIZER;
 
+/* spinlock for the callback arrays waiting to be freed */
+static rte_spinlock_t eth_cb_retired_lock = RTE_SPINLOCK_INITIALIZER;
+
+static void eth_cb_free_all(uint16_t port_id);
+
 /* spinlock for shared data allocation */
 static rte_spinlock_t rte_eth_shared_data_lock = RTE_SPINLOCK_INITIALIZER;
 
@@ -1582,6 +1589,7 @@ rte_eth_dev_close(uint16_t port_id)
 	RTE_FUNC_PTR_OR_RET(*dev->dev_ops->dev_close);
 	dev->data->dev_started = 0;
 	(*dev->dev_ops->dev_close)(dev);
+	eth_cb_free_all(port_id);
 
 	/* check behaviour flag - temporary for PMD migration */
 	if ((dev->data->dev_flags & RTE_ETH_DEV_CLOSE_REMOVE) != 0) {
@@ -3999,6 +4007,219 @@ rte_eth_dev_filter_ctrl(uint16_t port_id, enum rte_filter_type filter_type,
 							     filter_op, arg));
 }
 
+/* Inline operations of a queue, allocated on first use. */
+struct eth_cb_queue {
+	struct rte_eth_queue_cb_stats stats;
+	uint32_t inline_refs[RTE_ETH_CB_INLINE_MAX];
+} __rte_cache_aligned;
+
+/* Per-process state of the callback arrays of a port. */
+static struct {
+	struct rte_rcu_qsbr *qsbr;
+	/* arrays waiting to be freed, oldest first */
+	struct rte_eth_rxtx_cb_array *retired;
+	struct rte_eth_rxtx_cb_array *retired_tail;
+	uint32_t nb_retired;
+	struct eth_cb_queue *rxq[RTE_MAX_QUEUES_PER_PORT];
+	struct eth_cb_queue *txq[RTE_MAX_QUEUES_PER_PORT];
+} eth_cb_ctrl[RTE_MAX_ETHPORTS];
+
+/*
+ * Allocate the array of a queue for the callbacks of the list, plus extra
+ * callbacks about to be added.
+ */
+static struct rte_eth_rxtx_cb_array *
+eth_cb_array_alloc(const struct rte_eth_rxtx_callback *cb, unsigned int extra)
+{
+	struct rte_eth_rxtx_cb_array *array;
+	unsigned int nb_cbs = extra;
+
+	for (; cb != NULL; cb = cb->next)
+		nb_cbs++;
+
+	return rte_zmalloc("ethdev_cb_array", sizeof(*array) +
+			nb_cbs * sizeof(array->cbs[0]), RTE_CACHE_LINE_SIZE);
+}
+
+/*
+ * Fill the array with the callback list and the inline operations of the
+ * queue, publish it and return the replaced array.
+ * Called with the RX or TX callback lock held.
+ */
+static struct rte_eth_rxtx_cb_array *
+eth_cb_array_publish(struct rte_eth_rxtx_cb_array **slot,
+		const struct rte_eth_rxtx_callback *cb,
+		struct eth_cb_queue *q, struct rte_eth_rxtx_cb_array *array)
+{
+	struct rte_eth_rxtx_cb_array *old = *slot;
+	unsigned int i;
+
+	for (i = 0; q != NULL && i < RTE_ETH_CB_INLINE_MAX; i++)
+		if (q->inline_refs[i] != 0)
+			array->inline_ops |= 1u << i;
+	if (array->inline_ops != 0)
+		array->stats = &q->stats;
+
+	for (; cb != NULL; cb = cb->next) {
+		memcpy(&array->cbs[array->nb_cbs].fn, &cb->fn, sizeof(cb->fn));
+		array->cbs[array->nb_cbs].param = cb->param;
+		array->nb_cbs++;
+	}
+
+	if (array->nb_cbs == 0 && array->inline_ops == 0) {
+		/* nothing to run, keep the burst functions lean */
+		rte_free(array);
+		array = NULL;
+	}
+
+	__atomic_store_n(slot, array, __ATOMIC_RELEASE);
+
+	return old;
+}
+
+/*
+ * Free the retired arrays of a port whose grace period is over, oldest
+ * first. Called with the retired lock held.
+ */
+static void
+eth_cb_array_reclaim(uint16_t port_id, struct rte_rcu_qsbr *v)
+{
+	struct rte_eth_rxtx_cb_array *array;
+
+	while ((array = eth_cb_ctrl[port_id].retired) != NULL &&
+			rte_rcu_qsbr_check(v, array->token, false) == 1) {
+		eth_cb_ctrl[port_id].retired = array->next;
+		eth_cb_ctrl[port_id].nb_retired--;
+		rte_free(array);
+	}
+	if (eth_cb_ctrl[port_id].retired == NULL)
+		eth_cb_ctrl[port_id].retired_tail = NULL;
+}
+
+/*
+ * Queue an array replaced by eth_cb_array_publish() until no lcore uses it
+ * anymore. With a QSBR variable, the arrays whose grace period is over are
+ * freed, and the caller waits for a grace period when RTE_ETH_CB_RETIRED_MAX
+ * arrays are queued. Without it, they are kept until the port is closed.
+ */
+static void
+eth_cb_array_retire(uint16_t port_id, struct rte_eth_rxtx_cb_array *array)
+{
+	struct rte_rcu_qsbr *v;
+	uint64_t token = 0;
+	bool wait;
+
+	if (array == NULL)
+		return;
+
+	rte_spinlock_lock(&eth_cb_retired_lock);
+	v = eth_cb_ctrl[port_id].qsbr;
+	if (v != NULL)
+		array->token = rte_rcu_qsbr_start(v);
+	array->next = NULL;
+	if (eth_cb_ctrl[port_id].retired_tail != NULL)
+		eth_cb_ctrl[port_id].retired_tail->next = array;
+	else
+		eth_cb_ctrl[port_id].retired = array;
+	eth_cb_ctrl[port_id].retired_tail = array;
+	eth_cb_ctrl[port_id].nb_retired++;
+	if (v != NULL) {
+		eth_cb_array_reclaim(port_id, v);
+		token = array->token;
+	}
+	wait = v != NULL &&
+		eth_cb_ctrl[port_id].nb_retired >= RTE_ETH_CB_RETIRED_MAX;
+	rte_spinlock_unlock(&eth_cb_retired_lock);
+
+	if (!wait)
+		return;
+
+	/* Too many arrays queued, wait until all of them can be freed */
+	rte_rcu_qsbr_check(v, token, true);
+	rte_spinlock_lock(&eth_cb_retired_lock);
+	if (eth_cb_ctrl[port_id].qsbr == v)
+		eth_cb_array_reclaim(port_id, v);
+	rte_spinlock_unlock(&eth_cb_retired_lock);
+}
+
+/*
+ * Without a QSBR variable, the retired arrays are kept until the port is
+ * closed: refuse to add callbacks or operations once RTE_ETH_CB_RETIRED_MAX
+ * arrays are kept. Removals are always allowed, each of them follows an add.
+ */
+static bool
+eth_cb_retired_full(uint16_t port_id)
+{
+	bool full;
+
+	rte_spinlock_lock(&eth_cb_retired_lock);
+	full = eth_cb_ctrl[port_id].qsbr == NULL &&
+		eth_cb_ctrl[port_id].nb_retired >= RTE_ETH_CB_RETIRED_MAX;
+	rte_spinlock_unlock(&eth_cb_retired_lock);
+
+	return full;
+}
+
+static void
+eth_cb_list_free(struct rte_eth_rxtx_callback *cb)
+{
+	while (cb != NULL) {
+		struct rte_eth_rxtx_callback *next = cb->next;
+
+		rte_free(cb);
+		cb = next;
+	}
+}
+
+/*
+ * Free the callbacks, inline operations and callback arrays of all the
+ * queues of a closed port. No lcore may run its burst functions anymore.
+ */
+static void
+eth_cb_free_all(uint16_t port_id)
+{
+	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
+	struct rte_eth_rxtx_cb_array *array;
+	unsigned int i;
+
+	rte_spinlock_lock(&rte_eth_rx_cb_lock);
+	for (i = 0; i < RTE_MAX_QUEUES_PER_PORT; i++) {
+		eth_cb_list_free(dev->post_rx_burst_cbs[i]);
+		dev->post_rx_burst_cbs[i] = NULL;
+		rte_free(dev->post_rx_burst_arrays[i]);
+		dev->post_rx_burst_arrays[i] = NULL;
+		rte_free(eth_cb_ctrl[port_id].rxq[i]);
+		eth_cb_ctrl[port_id].rxq[i] = NULL;
+	}
+	rte_spinlock_unlock(&rte_eth_rx_cb_lock);
+
+	rte_spinlock_lock(&rte_eth_tx_cb_lock);
+	for (i = 0; i < RTE_MAX_QUEUES_PER_PORT; i++) {
+		eth_cb_list_free(dev->pre_tx_burst_cbs[i]);
+		dev->pre_tx_burst_cbs[i] = NULL;
+		rte_free(dev->pre_tx_burst_arrays[i]);
+		dev->pre_tx_burst_arrays[i] = NULL;
+		rte_free(eth_cb_ctrl[port_id].txq[i]);
+		eth_cb_ctrl[port_id].txq[i] = NULL;
+	}
+	rte_spinlock_unlock(&rte_eth_tx_cb_lock);
+
+	rte_spinlock_lock(&eth_cb_retired_lock);
+	array = eth_cb_ctrl[port_id].retired;
+	eth_cb_ctrl[port_id].retired = NULL;
+	eth_cb_ctrl[port_id].retired_tail = NULL;
+	eth_cb_ctrl[port_id].nb_retired = 0;
+	eth_cb_ctrl[port_id].qsbr = NULL;
+	rte_spinlock_unlock(&eth_cb_retired_lock);
+
+	while (array != NULL) {
+		struct rte_eth_rxtx_cb_array *next = array->next;
+
+		rte_free(array);
+		array = next;
+	}
+}
+
 const struct rte_eth_rxtx_callback *
 rte_eth_add_rx_callback(uint16_t port_id, uint16_t queue_id,
 		rte_rx_callback_fn fn, void *user_param)
@@ -4013,8 +4234,16 @@ rte_eth_add_rx_callback(uint16_t port_id, uint16_t queue_id,
 		rte_errno = EINVAL;
 		return NULL;
 	}
-	struct rte_eth_rxtx_callback *cb = rte_zmalloc(NULL, sizeof(*cb), 0);
+	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
+	struct rte_eth_rxtx_callback *cb;
+	struct rte_eth_rxtx_cb_array *array;
 
+	if (eth_cb_retired_full(port_id)) {
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+
+	cb = rte_zmalloc(NULL, sizeof(*cb), 0);
 	if (cb == NULL) {
 		rte_errno = ENOMEM;
 		return NULL;
@@ -4024,20 +4253,32 @@ rte_eth_add_rx_callback(uint16_t port_id, uint16_t queue_id,
 	cb->param = user_param;
 
 	rte_spinlock_lock(&rte_eth_rx_cb_lock);
+	array = eth_cb_array_alloc(dev->post_rx_burst_cbs[queue_id], 1);
+	if (array == NULL) {
+		rte_spinlock_unlock(&rte_eth_rx_cb_lock);
+		rte_free(cb);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
 	/* Add the callbacks in fifo order. */
-	struct rte_eth_rxtx_callback *tail =
-		rte_eth_devices[port_id].post_rx_burst_cbs[queue_id];
+	struct rte_eth_rxtx_callback *tail = dev->post_rx_burst_cbs[queue_id];
 
 	if (!tail) {
-		rte_eth_devices[port_id].post_rx_burst_cbs[queue_id] = cb;
+		dev->post_rx_burst_cbs[queue_id] = cb;
 
 	} else {
 		while (tail->next)
 			tail = tail->next;
 		tail->next = cb;
 	}
+	array = eth_cb_array_publish(&dev->post_rx_burst_arrays[queue_id],
+			dev->post_rx_burst_cbs[queue_id],
+			eth_cb_ctrl[port_id].rxq[queue_id], array);
 	rte_spinlock_unlock(&rte_eth_rx_cb_lock);
 
+	eth_cb_array_retire(port_id, array);
+
 	return cb;
 }
 
@@ -4056,8 +4297,16 @@ rte_eth_add_first_rx_callback(uint16_t port_id, uint16_t queue_id,
 		return NULL;
 	}
 
-	struct rte_eth_rxtx_callback *cb = rte_zmalloc(NULL, sizeof(*cb), 0);
+	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
+	struct rte_eth_rxtx_callback *cb;
+	struct rte_eth_rxtx_cb_array *array;
 
+	if (eth_cb_retired_full(port_id)) {
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+
+	cb = rte_zmalloc(NULL, sizeof(*cb), 0);
 	if (cb == NULL) {
 		rte_errno = ENOMEM;
 		return NULL;
@@ -4067,12 +4316,25 @@ rte_eth_add_first_rx_callback(uint16_t port_id, uint16_t queue_id,
 	cb->param = user_param;
 
 	rte_spinlock_lock(&rte_eth_rx_cb_lock);
+	array = eth_cb_array_alloc(dev->post_rx_burst_cbs[queue_id], 1);
+	if (array == NULL) {
+		rte_spinlock_unlock(&rte_eth_rx_cb_lock);
+		rte_free(cb);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
 	/* Add the callbacks at fisrt position*/
-	cb->next = rte_eth_devices[port_id].post_rx_burst_cbs[queue_id];
+	cb->next = dev->post_rx_burst_cbs[queue_id];
 	rte_smp_wmb();
-	rte_eth_devices[port_id].post_rx_burst_cbs[queue_id] = cb;
+	dev->post_rx_burst_cbs[queue_id] = cb;
+	array = eth_cb_array_publish(&dev->post_rx_burst_arrays[queue_id],
+			dev->post_rx_burst_cbs[queue_id],
+			eth_cb_ctrl[port_id].rxq[queue_id], array);
 	rte_spinlock_unlock(&rte_eth_rx_cb_lock);
 
+	eth_cb_array_retire(port_id, array);
+
 	return cb;
 }
 
@@ -4091,8 +4353,16 @@ rte_eth_add_tx_callback(uint16_t port_id, uint16_t queue_id,
 		return NULL;
 	}
 
-	struct rte_eth_rxtx_callback *cb = rte_zmalloc(NULL, sizeof(*cb), 0);
+	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
+	struct rte_eth_rxtx_callback *cb;
+	struct rte_eth_rxtx_cb_array *array;
 
+	if (eth_cb_retired_full(port_id)) {
+		rte_errno = ENOSPC;
+		return NULL;
+	}
+
+	cb = rte_zmalloc(NULL, sizeof(*cb), 0);
 	if (cb == NULL) {
 		rte_errno = ENOMEM;
 		return NULL;
@@ -4102,20 +4372,32 @@ rte_eth_add_tx_callback(uint16_t port_id, uint16_t queue_id,
 	cb->param = user_param;
 
 	rte_spinlock_lock(&rte_eth_tx_cb_lock);
+	array = eth_cb_array_alloc(dev->pre_tx_burst_cbs[queue_id], 1);
+	if (array == NULL) {
+		rte_spinlock_unlock(&rte_eth_tx_cb_lock);
+		rte_free(cb);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
 	/* Add the callbacks in fifo order. */
-	struct rte_eth_rxtx_callback *tail =
-		rte_eth_devices[port_id].pre_tx_burst_cbs[queue_id];
+	struct rte_eth_rxtx_callback *tail = dev->pre_tx_burst_cbs[queue_id];
 
 	if (!tail) {
-		rte_eth_devices[port_id].pre_tx_burst_cbs[queue_id] = cb;
+		dev->pre_tx_burst_cbs[queue_id] = cb;
 
 	} else {
 		while (tail->next)
 			tail = tail->next;
 		tail->next = cb;
 	}
+	array = eth_cb_array_publish(&dev->pre_tx_burst_arrays[queue_id],
+			dev->pre_tx_burst_cbs[queue_id],
+			eth_cb_ctrl[port_id].txq[queue_id], array);
 	rte_spinlock_unlock(&rte_eth_tx_cb_lock);
 
+	eth_cb_array_retire(port_id, array);
+
 	return cb;
 }
 
@@ -4135,9 +4417,15 @@ rte_eth_remove_rx_callback(uint16_t port_id, uint16_t queue_id,
 	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
 	struct rte_eth_rxtx_callback *cb;
 	struct rte_eth_rxtx_callback **prev_cb;
+	struct rte_eth_rxtx_cb_array *array;
 	int ret = -EINVAL;
 
 	rte_spinlock_lock(&rte_eth_rx_cb_lock);
+	array = eth_cb_array_alloc(dev->post_rx_burst_cbs[queue_id], 0);
+	if (array == NULL) {
+		rte_spinlock_unlock(&rte_eth_rx_cb_lock);
+		return -ENOMEM;
+	}
 	prev_cb = &dev->post_rx_burst_cbs[queue_id];
 	for (; *prev_cb != NULL; prev_cb = &cb->next) {
 		cb = *prev_cb;
@@ -4148,8 +4436,18 @@ rte_eth_remove_rx_callback(uint16_t port_id, uint16_t queue_id,
 			break;
 		}
 	}
+	if (ret == 0)
+		array = eth_cb_array_publish(
+				&dev->post_rx_burst_arrays[queue_id],
+				dev->post_rx_burst_cbs[queue_id],
+				eth_cb_ctrl[port_id].rxq[queue_id], array);
 	rte_spinlock_unlock(&rte_eth_rx_cb_lock);
 
+	if (ret == 0)
+		eth_cb_array_retire(port_id, array);
+	else
+		rte_free(array);
+
 	return ret;
 }
 
@@ -4170,8 +4468,14 @@ rte_eth_remove_tx_callback(uint16_t port_id, uint16_t queue_id,
 	int ret = -EINVAL;
 	struct rte_eth_rxtx_callback *cb;
 	struct rte_eth_rxtx_callback **prev_cb;
+	struct rte_eth_rxtx_cb_array *array;
 
 	rte_spinlock_lock(&rte_eth_tx_cb_lock);
+	array = eth_cb_array_alloc(dev->pre_tx_burst_cbs[queue_id], 0);
+	if (array == NULL) {
+		rte_spinlock_unlock(&rte_eth_tx_cb_lock);
+		return -ENOMEM;
+	}
 	prev_cb = &dev->pre_tx_burst_cbs[queue_id];
 	for (; *prev_cb != NULL; prev_cb = &cb->next) {
 		cb = *prev_cb;
@@ -4182,11 +4486,195 @@ rte_eth_remove_tx_callback(uint16_t port_id, uint16_t queue_id,
 			break;
 		}
 	}
+	if (ret == 0)
+		array = eth_cb_array_publish(
+				&dev->pre_tx_burst_arrays[queue_id],
+				dev->pre_tx_burst_cbs[queue_id],
+				eth_cb_ctrl[port_id].txq[queue_id], array);
 	rte_spinlock_unlock(&rte_eth_tx_cb_lock);
 
+	if (ret == 0)
+		eth_cb_array_retire(port_id, array);
+	else
+		rte_free(array);
+
 	return ret;
 }
 
+/* Add or remove inline operations of an RX or TX queue. */
+static int
+eth_cb_inline_update(uint16_t port_id, uint16_t queue_id, uint32_t ops,
+		bool add, bool rx)
+{
+	const uint32_t valid_ops = rx ?
+		RTE_ETH_CB_INLINE_COUNT | RTE_ETH_CB_INLINE_TIMESTAMP :
+		RTE_ETH_CB_INLINE_COUNT;
+	rte_spinlock_t *lock = rx ? &rte_eth_rx_cb_lock : &rte_eth_tx_cb_lock;
+	struct rte_eth_rxtx_cb_array **slot;
+	struct rte_eth_rxtx_cb_array *array;
+	struct rte_eth_rxtx_callback *list;
+	struct eth_cb_queue **q;
+	struct rte_eth_dev *dev;
+	unsigned int i;
+
+#ifndef RTE_ETHDEV_RXTX_CALLBACKS
+	return -ENOTSUP;
+#endif
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -EINVAL);
+	dev = &rte_eth_devices[port_id];
+	if (queue_id >= (rx ? dev->data->nb_rx_queues :
+			dev->data->nb_tx_queues) ||
+			ops == 0 || (ops & ~valid_ops) != 0)
+		return -EINVAL;
+
+	if (rx) {
+		slot = &dev->post_rx_burst_arrays[queue_id];
+		q = &eth_cb_ctrl[port_id].rxq[queue_id];
+	} else {
+		slot = &dev->pre_tx_burst_arrays[queue_id];
+		q = &eth_cb_ctrl[port_id].txq[queue_id];
+	}
+
+	rte_spinlock_lock(lock);
+	list = rx ? dev->post_rx_burst_cbs[queue_id] :
+		dev->pre_tx_burst_cbs[queue_id];
+
+	for (i = 0; !add && i < RTE_ETH_CB_INLINE_MAX; i++) {
+		if ((ops & (1u << i)) != 0 &&
+				(*q == NULL || (*q)->inline_refs[i] == 0)) {
+			rte_spinlock_unlock(lock);
+			return -EINVAL;
+		}
+	}
+	if (add && eth_cb_retired_full(port_id)) {
+		rte_spinlock_unlock(lock);
+		return -ENOSPC;
+	}
+	if (*q == NULL) {
+		*q = rte_zmalloc("ethdev_cb_queue", sizeof(**q),
+				RTE_CACHE_LINE_SIZE);
+		if (*q == NULL) {
+			rte_spinlock_unlock(lock);
+			return -ENOMEM;
+		}
+	}
+	array = eth_cb_array_alloc(list, 0);
+	if (array == NULL) {
+		rte_spinlock_unlock(lock);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < RTE_ETH_CB_INLINE_MAX; i++) {
+		if ((ops & (1u << i)) == 0)
+			continue;
+		if (add)
+			(*q)->inline_refs[i]++;
+		else
+			(*q)->inline_refs[i]--;
+	}
+	array = eth_cb_array_publish(slot, list, *q, array);
+	rte_spinlock_unlock(lock);
+
+	eth_cb_array_retire(port_id, array);
+
+	return 0;
+}
+
+int
+rte_eth_add_rx_inline(uint16_t port_id, uint16_t queue_id, uint32_t ops)
+{
+	return eth_cb_inline_update(port_id, queue_id, ops, true, true);
+}
+
+int
+rte_eth_remove_rx_inline(uint16_t port_id, uint16_t queue_id, uint32_t ops)
+{
+	return eth_cb_inline_update(port_id, queue_id, ops, false, true);
+}
+
+int
+rte_eth_add_tx_inline(uint16_t port_id, uint16_t queue_id, uint32_t ops)
+{
+	return eth_cb_inline_update(port_id, queue_id, ops, true, false);
+}
+
+int
+rte_eth_remove_tx_inline(uint16_t port_id, uint16_t queue_id, uint32_t ops)
+{
+	return eth_cb_inline_update(port_id, queue_id, ops, false, false);
+}
+
+static int
+eth_cb_inline_stats_get(const struct eth_cb_queue *q,
+		struct rte_eth_queue_cb_stats *stats)
+{
+	if (stats == NULL)
+		return -EINVAL;
+
+	if (q == NULL) {
+		memset(stats, 0, sizeof(*stats));
+		return 0;
+	}
+	stats->pkts = __atomic_load_n(&q->stats.pkts, __ATOMIC_RELAXED);
+	stats->bursts = __atomic_load_n(&q->stats.bursts, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int
+rte_eth_rx_inline_stats_get(uint16_t port_id, uint16_t queue_id,
+		struct rte_eth_queue_cb_stats *stats)
+{
+#ifndef RTE_ETHDEV_RXTX_CALLBACKS
+	return -ENOTSUP;
+#endif
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -EINVAL);
+	if (queue_id >= rte_eth_devices[port_id].data->nb_rx_queues)
+		return -EINVAL;
+
+	return eth_cb_inline_stats_get(eth_cb_ctrl[port_id].rxq[queue_id],
+			stats);
+}
+
+int
+rte_eth_tx_inline_stats_get(uint16_t port_id, uint16_t queue_id,
+		struct rte_eth_queue_cb_stats *stats)
+{
+#ifndef RTE_ETHDEV_RXTX_CALLBACKS
+	return -ENOTSUP;
+#endif
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -EINVAL);
+	if (queue_id >= rte_eth_devices[port_id].data->nb_tx_queues)
+		return -EINVAL;
+
+	return eth_cb_inline_stats_get(eth_cb_ctrl[port_id].txq[queue_id],
+			stats);
+}
+
+int
+rte_eth_rxtx_callbacks_rcu_set(uint16_t port_id, struct rte_rcu_qsbr *v)
+{
+#ifndef RTE_ETHDEV_RXTX_CALLBACKS
+	return -ENOTSUP;
+#endif
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -EINVAL);
+
+	rte_spinlock_lock(&eth_cb_retired_lock);
+	eth_cb_ctrl[port_id].qsbr = v;
+	/* the arrays retired so far may be freed after a grace period */
+	if (v != NULL && eth_cb_ctrl[port_id].retired != NULL) {
+		uint64_t token = rte_rcu_qsbr_start(v);
+		struct rte_eth_rxtx_cb_array *array;
+
+		for (array = eth_cb_ctrl[port_id].retired; array != NULL;
+				array = array->next)
+			array->token = token;
+	}
+	rte_spinlock_unlock(&eth_cb_retired_lock);
+
+	return 0;
+}
+
 int
 rte_eth_rx_queue_info_get(uint16_t port_id, uint16_t queue_id,
 	struct rte_eth_rxq_info *qinfo)
@@ -4418,6 +4906,251 @@ rte_eth_read_clock(uint16_t port_id, uint64_t *clock)
 	return eth_err(port_id, (*dev->dev_ops->read_clock)(dev, clock));
 }
 
+/* Number of reads of the device clock for a correlation. */
+#define ETH_CLOCK_SAMPLES 8
+/* Duration of the first measure of the device clock frequency. */
+#define ETH_CLOCK_CALIB_MS 10
+
+/* Per-process RX timestamping state of a port. */
+static struct {
+	struct rte_eth_clock_corr corr;
+	/* start of the measure of the clock frequency */
+	uint64_t ref_clock;
+	uint64_t ref_tsc;
+	/* the frequency is being measured, outside of the lock */
+	int calibrating;
+} eth_clock[RTE_MAX_ETHPORTS];
+
+/* spinlock for the RX timestamping state */
+static rte_spinlock_t eth_clock_lock = RTE_SPINLOCK_INITIALIZER;
+
+static uint64_t
+eth_clock_tsc_to_ns(uint64_t tsc)
+{
+	const uint64_t hz = rte_get_tsc_hz();
+
+	return tsc / hz * NS_PER_S + tsc % hz * NS_PER_S / hz;
+}
+
+/* Set the frequency of the clock, with a 32-bit fixed point multiplier. */
+static void
+eth_clock_set_hz(struct rte_eth_clock_corr *corr, double hz)
+{
+	const double ns_per_tick = (double)NS_PER_S / hz;
+	uint32_t shift = 0;
+
+	while (shift < 63 && ns_per_tick * (double)(UINT64_C(1) << (shift + 1))
+			< (double)UINT32_MAX)
+		shift++;
+	corr->mult = (uint64_t)(ns_per_tick * (double)(UINT64_C(1) << shift) +
+			0.5);
+	corr->shift = shift;
+	corr->clock_hz = (uint64_t)(hz + 0.5);
+}
+
+/*
+ * Read the device clock along with the TSC, keeping the read with the
+ * smallest TSC window.
+ */
+static int
+eth_clock_sample(uint16_t port_id, uint64_t *clock, uint64_t *tsc)
+{
+	uint64_t best = UINT64_MAX;
+	uint64_t start, end, c;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < ETH_CLOCK_SAMPLES; i++) {
+		start = rte_rdtsc_precise();
+		ret = rte_eth_read_clock(port_id, &c);
+		end = rte_rdtsc_precise();
+		if (ret != 0)
+			return ret;
+		if (end - start < best) {
+			best = end - start;
+			*clock = c;
+			*tsc = start + (end - start) / 2;
+		}
+	}
+
+	return 0;
+}
+
+/* Correlate the clock with the TSC, called with eth_clock_lock held. */
+static int
+eth_clock_sync(uint16_t port_id)
+{
+	struct rte_eth_clock_corr *corr = &eth_clock[port_id].corr;
+	uint64_t clock, tsc;
+	int ret;
+
+	if (corr->mode == RTE_ETH_RX_TIMESTAMP_SW) {
+		clock = tsc = rte_rdtsc();
+	} else {
+		ret = eth_clock_sample(port_id, &clock, &tsc);
+		if (ret != 0)
+			return ret;
+		/* measure the frequency on the longest period available */
+		if (tsc - eth_clock[port_id].ref_tsc >=
+				rte_get_tsc_hz() / 1000 * ETH_CLOCK_CALIB_MS) {
+			double hz = (double)(clock - eth_clock[port_id].ref_clock) *
+				rte_get_tsc_hz() /
+				(tsc - eth_clock[port_id].ref_tsc);
+
+			if (hz < 1000.)
+				return -EIO;
+			eth_clock_set_hz(corr, hz);
+		}
+	}
+
+	corr->clock = clock;
+	corr->tsc = tsc;
+	corr->ns = eth_clock_tsc_to_ns(tsc);
+
+	return 0;
+}
+
+int
+rte_eth_rx_timestamp_enable(uint16_t port_id)
+{
+	struct rte_eth_clock_corr *corr;
+	struct rte_eth_dev *dev;
+	uint16_t q;
+	int ret;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
+	dev = &rte_eth_devices[port_id];
+	corr = &eth_clock[port_id].corr;
+
+	rte_spinlock_lock(&eth_clock_lock);
+	if (corr->mode != RTE_ETH_RX_TIMESTAMP_NONE ||
+			eth_clock[port_id].calibrating) {
+		rte_spinlock_unlock(&eth_clock_lock);
+		return -EBUSY;
+	}
+	memset(&eth_clock[port_id], 0, sizeof(eth_clock[port_id]));
+
+	if ((dev->data->dev_conf.rxmode.offloads &
+			DEV_RX_OFFLOAD_TIMESTAMP) != 0 &&
+			eth_clock_sample(port_id, &eth_clock[port_id].ref_clock,
+				&eth_clock[port_id].ref_tsc) == 0) {
+		/* measure the frequency without holding the lock */
+		eth_clock[port_id].calibrating = 1;
+		rte_spinlock_unlock(&eth_clock_lock);
+		rte_delay_ms(ETH_CLOCK_CALIB_MS);
+		rte_spinlock_lock(&eth_clock_lock);
+		eth_clock[port_id].calibrating = 0;
+		corr->mode = RTE_ETH_RX_TIMESTAMP_HW;
+	} else {
+		for (q = 0; q < dev->data->nb_rx_queues; q++) {
+			ret = rte_eth_add_rx_inline(port_id, q,
+					RTE_ETH_CB_INLINE_TIMESTAMP);
+			if (ret != 0) {
+				while (q-- != 0)
+					rte_eth_remove_rx_inline(port_id, q,
+						RTE_ETH_CB_INLINE_TIMESTAMP);
+				rte_spinlock_unlock(&eth_clock_lock);
+				return ret;
+			}
+		}
+		corr->mode = RTE_ETH_RX_TIMESTAMP_SW;
+		eth_clock_set_hz(corr, rte_get_tsc_hz());
+	}
+
+	ret = eth_clock_sync(port_id);
+	/* conversions divide by the frequency */
+	if (ret == 0 && corr->clock_hz == 0)
+		ret = -EIO;
+	if (ret != 0) {
+		corr->mode = RTE_ETH_RX_TIMESTAMP_NONE;
+		rte_spinlock_unlock(&eth_clock_lock);
+		return ret;
+	}
+	ret = corr->mode;
+	rte_spinlock_unlock(&eth_clock_lock);
+
+	return ret;
+}
+
+int
+rte_eth_rx_timestamp_disable(uint16_t port_id)
+{
+	struct rte_eth_clock_corr *corr;
+	uint16_t q;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
+	corr = &eth_clock[port_id].corr;
+
+	rte_spinlock_lock(&eth_clock_lock);
+	if (corr->mode == RTE_ETH_RX_TIMESTAMP_NONE) {
+		rte_spinlock_unlock(&eth_clock_lock);
+		return -EINVAL;
+	}
+	if (corr->mode == RTE_ETH_RX_TIMESTAMP_SW)
+		for (q = 0; q < rte_eth_devices[port_id].data->nb_rx_queues;
+				q++)
+			rte_eth_remove_rx_inline(port_id, q,
+					RTE_ETH_CB_INLINE_TIMESTAMP);
+	corr->mode = RTE_ETH_RX_TIMESTAMP_NONE;
+	rte_spinlock_unlock(&eth_clock_lock);
+
+	return 0;
+}
+
+int
+rte_eth_clock_sync(uint16_t port_id)
+{
+	int ret;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
+
+	rte_spinlock_lock(&eth_clock_lock);
+	if (eth_clock[port_id].corr.mode == RTE_ETH_RX_TIMESTAMP_NONE)
+		ret = -EINVAL;
+	else
+		ret = eth_clock_sync(port_id);
+	rte_spinlock_unlock(&eth_clock_lock);
+
+	return ret;
+}
+
+int
+rte_eth_clock_corr_get(uint16_t port_id, struct rte_eth_clock_corr *corr)
+{
+	int ret = 0;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
+	if (corr == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&eth_clock_lock);
+	if (eth_clock[port_id].corr.mode == RTE_ETH_RX_TIMESTAMP_NONE)
+		ret = -EINVAL;
+	else
+		*corr = eth_clock[port_id].corr;
+	rte_spinlock_unlock(&eth_clock_lock);
+
+	return ret;
+}
+
+uint16_t
+rte_eth_rx_timestamp_to_ns(const struct rte_eth_clock_corr *corr,
+		struct rte_mbuf * const *pkts, uint16_t nb_pkts, uint64_t *ns)
+{
+	uint16_t i, nb_ts = 0;
+
+	for (i = 0; i < nb_pkts; i++) {
+		if ((pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0) {
+			ns[i] = 0;
+			continue;
+		}
+		ns[i] = rte_eth_clock_to_ns(corr, pkts[i]->timestamp);
+		nb_ts++;
+	}
+
+	return nb_ts;
+}
+
 int
 rte_eth_dev_get_reg_info(uint16_t port_id, struct rte_dev_reg_info *info)
 {
@@ -4767,6 +5500,14 @@ rte_eth_devargs_parse(const char *dargs, struct rte_eth_devargs *eth_da)
 	return result;
 }
 
+RTE_TRACE_POINT_DEFINE(rte_ethdev_trace_rx_burst);
+RTE_TRACE_POINT_DEFINE(rte_ethdev_trace_tx_burst);
+
+RTE_TRACE_POINT_REGISTER(rte_ethdev_trace_rx_burst, "lib.ethdev.rx.burst",
+	"port_id,queue_id,nb_pkts,nb_rx");
+RTE_TRACE_POINT_REGISTER(rte_ethdev_trace_tx_burst, "lib.ethdev.tx.burst",
+	"port_id,queue_id,nb_pkts,nb_tx");
+
 RTE_INIT(ethdev_init_log)
 {
 	rte_eth_dev_logtype = rte_log_register("lib.ethdev");
@@ -156,7 +156,9 @@ extern "C" {
 #include <rte_errno.h>
 #include <rte_common.h>
 #include <rte_config.h>
+#include <rte_cycles.h>
 #include <rte_ether.h>
+#include <rte_trace.h>
 
 #include "rte_dev_info.h"
 
@@ -2038,6 +2040,8 @@ int rte_eth_dev_set_link_down(uint16_t port_id);
  * Close a stopped Ethernet device. The device cannot be restarted!
  * The function frees all port resources if the driver supports
  * the flag RTE_ETH_DEV_CLOSE_REMOVE.
+ * The RX/TX callbacks and inline operations still added to the queues of
+ * the port are removed and freed, as well as the arrays running them.
  *
  * @param port_id
  *   The port identifier of the Ethernet device.
@@ -3493,8 +3497,12 @@ struct rte_eth_rxtx_callback;
  *   A generic pointer parameter which will be passed to each invocation of the
  *   callback function on this port and queue.
  *
+ * This function may wait for the lcores running the burst functions of the
+ * port, see rte_eth_rxtx_callbacks_rcu_set().
+ *
  * @return
- *   NULL on error.
+ *   NULL on error, with rte_errno set to ENOSPC when too many replaced
+ *   callback arrays are kept, see rte_eth_rxtx_callbacks_rcu_set().
  *   On success, a pointer value which can later be used to remove the callback.
  */
 const struct rte_eth_rxtx_callback *
@@ -3522,8 +3530,12 @@ rte_eth_add_rx_callback(uint16_t port_id, uint16_t queue_id,
  *   A generic pointer parameter which will be passed to each invocation of the
  *   callback function on this port and queue.
  *
+ * This function may wait for the lcores running the burst functions of the
+ * port, see rte_eth_rxtx_callbacks_rcu_set().
+ *
  * @return
- *   NULL on error.
+ *   NULL on error, with rte_errno set to ENOSPC when too many replaced
+ *   callback arrays are kept, see rte_eth_rxtx_callbacks_rcu_set().
  *   On success, a pointer value which can later be used to remove the callback.
  */
 const struct rte_eth_rxtx_callback *
@@ -3550,8 +3562,12 @@ rte_eth_add_first_rx_callback(uint16_t port_id, uint16_t queue_id,
  *   A generic pointer parameter which will be passed to each invocation of the
  *   callback function on this port and queue.
  *
+ * This function may wait for the lcores running the burst functions of the
+ * port, see rte_eth_rxtx_callbacks_rcu_set().
+ *
  * @return
- *   NULL on error.
+ *   NULL on error, with rte_errno set to ENOSPC when too many replaced
+ *   callback arrays are kept, see rte_eth_rxtx_callbacks_rcu_set().
  *   On success, a pointer value which can later be used to remove the callback.
  */
 const struct rte_eth_rxtx_callback *
@@ -3587,6 +3603,10 @@ rte_eth_add_tx_callback(uint16_t port_id, uint16_t queue_id,
  *   - -ENOTSUP: Callback support is not available.
  *   - -EINVAL:  The port_id or the queue_id is out of range, or the callback
  *               is NULL or not found for the port/queue.
+ *   - -ENOMEM:  Not enough memory to update the callbacks of the queue.
+ *
+ * This function may wait for the lcores running the burst functions of the
+ * port, see rte_eth_rxtx_callbacks_rcu_set().
  */
 int rte_eth_remove_rx_callback(uint16_t port_id, uint16_t queue_id,
 		const struct rte_eth_rxtx_callback *user_cb);
@@ -3620,10 +3640,192 @@ int rte_eth_remove_rx_callback(uint16_t port_id, uint16_t queue_id,
  *   - -ENOTSUP: Callback support is not available.
  *   - -EINVAL:  The port_id or the queue_id is out of range, or the callback
  *               is NULL or not found for the port/queue.
+ *   - -ENOMEM:  Not enough memory to update the callbacks of the queue.
+ *
+ * This function may wait for the lcores running the burst functions of the
+ * port, see rte_eth_rxtx_callbacks_rcu_set().
  */
 int rte_eth_remove_tx_callback(uint16_t port_id, uint16_t queue_id,
 		const struct rte_eth_rxtx_callback *user_cb);
 
+/** Count the packets and bursts of a queue, see rte_eth_queue_cb_stats. */
+#define RTE_ETH_CB_INLINE_COUNT     (1u << 0)
+/**
+ * Timestamp the received packets which have no PKT_RX_TIMESTAMP flag with
+ * the TSC, and set the flag. RX only.
+ */
+#define RTE_ETH_CB_INLINE_TIMESTAMP (1u << 1)
+/** Number of inline operations. */
+#define RTE_ETH_CB_INLINE_MAX       2
+
+/**
+ * Number of replaced callback arrays of a port waiting to be freed, beyond
+ * which callbacks and inline operations can not be added without a QSBR
+ * variable, see rte_eth_rxtx_callbacks_rcu_set().
+ */
+#define RTE_ETH_CB_RETIRED_MAX      512
+
+/**
+ * Counters of the RTE_ETH_CB_INLINE_COUNT operation. On RX, packets
+ * returned by the driver are counted, before running the callbacks. On TX,
+ * packets accepted by the driver are counted, after running the callbacks.
+ */
+struct rte_eth_queue_cb_stats {
+	uint64_t pkts;   /**< Number of packets. */
+	uint64_t bursts; /**< Number of bursts with at least one packet. */
+};
+
+struct rte_rcu_qsbr;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable operations done by the burst function of an RX queue itself,
+ * without calling any callback. They run before the RX callbacks.
+ *
+ * Operations are reference counted: an operation enabled twice stays
+ * enabled until it is disabled twice.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The RX queue on the Ethernet device.
+ * @param ops
+ *   RTE_ETH_CB_INLINE_* operations to enable.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: Callback support is not available.
+ *   - -EINVAL: The port_id, queue_id or ops is invalid.
+ *   - -ENOMEM: Not enough memory.
+ *   - -ENOSPC: Too many replaced arrays are kept, see
+ *              rte_eth_rxtx_callbacks_rcu_set().
+ */
+__rte_experimental
+int rte_eth_add_rx_inline(uint16_t port_id, uint16_t queue_id, uint32_t ops);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Disable operations enabled with rte_eth_add_rx_inline().
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The RX queue on the Ethernet device.
+ * @param ops
+ *   RTE_ETH_CB_INLINE_* operations to disable.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: Callback support is not available.
+ *   - -EINVAL: The port_id, queue_id or ops is invalid, or one of the
+ *              operations is not enabled.
+ *   - -ENOMEM: Not enough memory.
+ */
+__rte_experimental
+int rte_eth_remove_rx_inline(uint16_t port_id, uint16_t queue_id,
+		uint32_t ops);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable operations done by the burst function of a TX queue itself,
+ * without calling any callback. Only RTE_ETH_CB_INLINE_COUNT is supported.
+ *
+ * @see rte_eth_add_rx_inline()
+ */
+__rte_experimental
+int rte_eth_add_tx_inline(uint16_t port_id, uint16_t queue_id, uint32_t ops);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Disable operations enabled with rte_eth_add_tx_inline().
+ *
+ * @see rte_eth_remove_rx_inline()
+ */
+__rte_experimental
+int rte_eth_remove_tx_inline(uint16_t port_id, uint16_t queue_id,
+		uint32_t ops);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the counters of the RTE_ETH_CB_INLINE_COUNT operation of an RX queue.
+ * They are kept when the operation is disabled.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The RX queue on the Ethernet device.
+ * @param stats
+ *   Counters filled on success.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: Callback support is not available.
+ *   - -EINVAL: The port_id or queue_id is invalid, or stats is NULL.
+ */
+__rte_experimental
+int rte_eth_rx_inline_stats_get(uint16_t port_id, uint16_t queue_id,
+		struct rte_eth_queue_cb_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the counters of the RTE_ETH_CB_INLINE_COUNT operation of a TX queue.
+ *
+ * @see rte_eth_rx_inline_stats_get()
+ */
+__rte_experimental
+int rte_eth_tx_inline_stats_get(uint16_t port_id, uint16_t queue_id,
+		struct rte_eth_queue_cb_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the QSBR variable of the lcores calling the burst functions of a
+ * port.
+ *
+ * The burst functions run the callbacks and inline operations of a queue
+ * from an immutable array, which is replaced whenever a callback or an
+ * operation is added or removed.
+ *
+ * By default, the replaced arrays are only freed when the port is closed.
+ * Once RTE_ETH_CB_RETIRED_MAX of them are kept, adding a callback or an
+ * inline operation fails with ENOSPC, removing them still succeeds.
+ *
+ * With a QSBR variable, each replaced array is freed by a later add or
+ * remove, once all the threads registered to the variable reported a
+ * quiescent state since it was replaced. All the threads calling the burst
+ * functions of the port must then be registered and online. The functions
+ * adding and removing callbacks and inline operations do not block, except
+ * when RTE_ETH_CB_RETIRED_MAX arrays are waiting: they then block until the
+ * registered threads report a quiescent state, so they must not be called
+ * by a thread registered to the variable and online. The variable is reset
+ * when the port is closed.
+ *
+ * Note that the callbacks themselves are never freed by the library, see
+ * rte_eth_remove_rx_callback().
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param v
+ *   QSBR variable, or NULL to keep the replaced arrays until the port is
+ *   closed.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: Callback support is not available.
+ *   - -EINVAL: The port_id is invalid.
+ */
+__rte_experimental
+int rte_eth_rxtx_callbacks_rcu_set(uint16_t port_id, struct rte_rcu_qsbr *v);
+
 /**
  * Retrieve information about given port's RX queue.
  *
@@ -4024,6 +4226,186 @@ __rte_experimental
 int
 rte_eth_read_clock(uint16_t port_id, uint64_t *clock);
 
+/** Source of the RX timestamps of a port. */
+enum rte_eth_rx_timestamp_mode {
+	RTE_ETH_RX_TIMESTAMP_NONE, /**< Timestamping disabled. */
+	/**
+	 * Packets timestamped by the device, in ticks of the device clock,
+	 * with the DEV_RX_OFFLOAD_TIMESTAMP offload.
+	 */
+	RTE_ETH_RX_TIMESTAMP_HW,
+	/** Packets timestamped with the TSC when rte_eth_rx_burst() returns. */
+	RTE_ETH_RX_TIMESTAMP_SW,
+};
+
+/**
+ * Correlation between the clock of the RX timestamps of a port and the
+ * TSC, used to convert the timestamps to nanoseconds of the TSC time base,
+ * i.e. rte_rdtsc() * NS_PER_S / rte_get_tsc_hz().
+ */
+struct rte_eth_clock_corr {
+	uint64_t clock;    /**< Clock of the timestamps at correlation time. */
+	uint64_t tsc;      /**< TSC at correlation time. */
+	uint64_t ns;       /**< TSC at correlation time, in nanoseconds. */
+	uint64_t clock_hz; /**< Estimated frequency of the clock. */
+	/** Nanoseconds per clock tick, as a fixed point number. */
+	uint64_t mult;
+	uint32_t shift;    /**< Number of fractional bits of mult. */
+	/** enum rte_eth_rx_timestamp_mode of the timestamps. */
+	uint32_t mode;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable the timestamping of the packets received on all the RX queues of
+ * an Ethernet device, to be converted to nanoseconds with the correlation
+ * returned by rte_eth_clock_corr_get().
+ *
+ * The timestamps are the ones of the device when the DEV_RX_OFFLOAD_TIMESTAMP
+ * offload is enabled and the device clock can be read with
+ * rte_eth_read_clock(); the frequency of the device clock is then measured
+ * for 10 ms. Otherwise the packets are timestamped with the TSC when
+ * rte_eth_rx_burst() returns, see RTE_ETH_CB_INLINE_TIMESTAMP.
+ *
+ * Must be called after the setup of the RX queues.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @return
+ *   - (>0): Success, the enum rte_eth_rx_timestamp_mode in use.
+ *   - -ENODEV: The port ID is invalid.
+ *   - -EBUSY: Timestamping is already enabled.
+ *   - -ENOTSUP: Callback support is not available and the device cannot
+ *     timestamp packets.
+ *   - -EIO: The frequency of the device clock could not be measured.
+ *   - (<0): Error code of the driver or of rte_eth_add_rx_inline().
+ */
+__rte_experimental
+int
+rte_eth_rx_timestamp_enable(uint16_t port_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Disable the timestamping enabled by rte_eth_rx_timestamp_enable().
+ * Hardware timestamps are still provided as long as the offload is enabled.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @return
+ *   - 0: Success.
+ *   - -ENODEV: The port ID is invalid.
+ *   - -EINVAL: Timestamping is not enabled.
+ */
+__rte_experimental
+int
+rte_eth_rx_timestamp_disable(uint16_t port_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Correlate again the clock of the RX timestamps of a port with the TSC,
+ * and refine the estimation of its frequency. To be called periodically,
+ * e.g. every second, to limit the drift of the conversions.
+ *
+ * Reading the device clock is too expensive to be done on every burst, so
+ * the correlation is only refreshed by this function.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @return
+ *   - 0: Success.
+ *   - -ENODEV: The port ID is invalid.
+ *   - -EINVAL: Timestamping is not enabled.
+ *   - (<0): Error code of the driver.
+ */
+__rte_experimental
+int
+rte_eth_clock_sync(uint16_t port_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the latest correlation between the clock of the RX timestamps of a
+ * port and the TSC.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param corr
+ *   Correlation filled on success.
+ * @return
+ *   - 0: Success.
+ *   - -ENODEV: The port ID is invalid.
+ *   - -EINVAL: Timestamping is not enabled, or corr is NULL.
+ */
+__rte_experimental
+int
+rte_eth_clock_corr_get(uint16_t port_id, struct rte_eth_clock_corr *corr);
+
+/** @internal Convert a number of clock ticks to nanoseconds. */
+static inline uint64_t
+__rte_eth_clock_delta_ns(const struct rte_eth_clock_corr *corr,
+		uint64_t delta)
+{
+	if (likely(delta <= UINT32_MAX))
+		return (delta * corr->mult) >> corr->shift;
+	return delta / corr->clock_hz * NS_PER_S +
+		delta % corr->clock_hz * NS_PER_S / corr->clock_hz;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Convert an RX timestamp to nanoseconds of the TSC time base.
+ *
+ * @param corr
+ *   Correlation returned by rte_eth_clock_corr_get().
+ * @param timestamp
+ *   The timestamp field of a packet with the PKT_RX_TIMESTAMP flag.
+ * @return
+ *   The timestamp in nanoseconds.
+ */
+__rte_experimental
+static inline uint64_t
+rte_eth_clock_to_ns(const struct rte_eth_clock_corr *corr, uint64_t timestamp)
+{
+	if (timestamp >= corr->clock)
+		return corr->ns +
+			__rte_eth_clock_delta_ns(corr, timestamp - corr->clock);
+	return corr->ns - __rte_eth_clock_delta_ns(corr,
+			corr->clock - timestamp);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Convert the RX timestamps of a burst of packets to nanoseconds of the TSC
+ * time base.
+ *
+ * @param corr
+ *   Correlation returned by rte_eth_clock_corr_get().
+ * @param pkts
+ *   Received packets.
+ * @param nb_pkts
+ *   Number of packets.
+ * @param ns
+ *   Array of nb_pkts timestamps filled in nanoseconds, 0 for the packets
+ *   without the PKT_RX_TIMESTAMP flag.
+ * @return
+ *   Number of packets with a timestamp.
+ */
+__rte_experimental
+uint16_t
+rte_eth_rx_timestamp_to_ns(const struct rte_eth_clock_corr *corr,
+		struct rte_mbuf * const *pkts, uint16_t nb_pkts, uint64_t *ns);
+
 /**
  * Config l2 tunnel ether type of an Ethernet device for filtering specific
  * tunnel packets by ether type.
@@ -4160,6 +4542,42 @@ rte_eth_dev_get_sec_ctx(uint16_t port_id);
 
 #include <rte_ethdev_core.h>
 
+/* fast path tracepoints, compiled in with RTE_ENABLE_TRACE_FP */
+RTE_TRACE_POINT_DECLARE(rte_ethdev_trace_rx_burst);
+RTE_TRACE_POINT_DECLARE(rte_ethdev_trace_tx_burst);
+
+#ifdef RTE_ETHDEV_RXTX_CALLBACKS
+/** @internal Run the inline operations and callbacks of an RX queue. */
+static inline uint16_t
+__rte_eth_rx_cb_run(const struct rte_eth_rxtx_cb_array *cbs,
+		uint16_t port_id, uint16_t queue_id, struct rte_mbuf **rx_pkts,
+		uint16_t nb_rx, const uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	if (cbs->inline_ops & RTE_ETH_CB_INLINE_COUNT) {
+		cbs->stats->pkts += nb_rx;
+		cbs->stats->bursts += nb_rx != 0;
+	}
+	if ((cbs->inline_ops & RTE_ETH_CB_INLINE_TIMESTAMP) && nb_rx != 0) {
+		const uint64_t now = rte_rdtsc();
+
+		for (i = 0; i < nb_rx; i++) {
+			if ((rx_pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0) {
+				rx_pkts[i]->timestamp = now;
+				rx_pkts[i]->ol_flags |= PKT_RX_TIMESTAMP;
+			}
+		}
+	}
+
+	for (i = 0; i < cbs->nb_cbs; i++)
+		nb_rx = cbs->cbs[i].fn.rx(port_id, queue_id, rx_pkts, nb_rx,
+				nb_pkts, cbs->cbs[i].param);
+
+	return nb_rx;
+}
+#endif
+
 /**
  *
  * Retrieve a burst of input packets from a receive queue of an Ethernet
@@ -4262,18 +4680,16 @@ rte_eth_rx_burst(uint16_t port_id, uint16_t queue_id,
 				     rx_pkts, nb_pkts);
 
 #ifdef RTE_ETHDEV_RXTX_CALLBACKS
-	if (unlikely(dev->post_rx_burst_cbs[queue_id] != NULL)) {
-		struct rte_eth_rxtx_callback *cb =
-				dev->post_rx_burst_cbs[queue_id];
-
-		do {
-			nb_rx = cb->fn.rx(port_id, queue_id, rx_pkts, nb_rx,
-						nb_pkts, cb->param);
-			cb = cb->next;
-		} while (cb != NULL);
-	}
+	const struct rte_eth_rxtx_cb_array *cbs =
+			dev->post_rx_burst_arrays[queue_id];
+
+	if (unlikely(cbs != NULL))
+		nb_rx = __rte_eth_rx_cb_run(cbs, port_id, queue_id, rx_pkts,
+				nb_rx, nb_pkts);
 #endif
 
+	rte_trace_point_emit_fp(rte_ethdev_trace_rx_burst, port_id, queue_id,
+			nb_pkts, nb_rx);
 	return nb_rx;
 }
 
@@ -4514,6 +4930,7 @@ rte_eth_tx_burst(uint16_t port_id, uint16_t queue_id,
 		 struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 {
 	struct rte_eth_dev *dev = &rte_eth_devices[port_id];
+	uint16_t nb_tx;
 
 #ifdef RTE_LIBRTE_ETHDEV_DEBUG
 	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, 0);
@@ -4526,18 +4943,31 @@ rte_eth_tx_burst(uint16_t port_id, uint16_t queue_id,
 #endif
 
 #ifdef RTE_ETHDEV_RXTX_CALLBACKS
-	struct rte_eth_rxtx_callback *cb = dev->pre_tx_burst_cbs[queue_id];
-
-	if (unlikely(cb != NULL)) {
-		do {
-			nb_pkts = cb->fn.tx(port_id, queue_id, tx_pkts, nb_pkts,
-					cb->param);
-			cb = cb->next;
-		} while (cb != NULL);
+	const struct rte_eth_rxtx_cb_array *cbs =
+			dev->pre_tx_burst_arrays[queue_id];
+	uint16_t i;
+
+	if (unlikely(cbs != NULL)) {
+		for (i = 0; i < cbs->nb_cbs; i++)
+			nb_pkts = cbs->cbs[i].fn.tx(port_id, queue_id, tx_pkts,
+					nb_pkts, cbs->cbs[i].param);
+	}
+#endif
+
+	nb_tx = (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id], tx_pkts,
+			nb_pkts);
+
+#ifdef RTE_ETHDEV_RXTX_CALLBACKS
+	if (unlikely(cbs != NULL) &&
+			(cbs->inline_ops & RTE_ETH_CB_INLINE_COUNT) != 0) {
+		cbs->stats->pkts += nb_tx;
+		cbs->stats->bursts += nb_tx != 0;
 	}
 #endif
 
-	return (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id], tx_pkts, nb_pkts);
+	rte_trace_point_emit_fp(rte_ethdev_trace_tx_burst, port_id, queue_id,
+			nb_pkts, nb_tx);
+	return nb_tx;
 }
 
 /**
@@ -660,6 +660,29 @@ struct rte_eth_rxtx_callback {
 	void *param;
 };
 
+/**
+ * @internal
+ * Callbacks and inline operations of a queue, run by the burst functions.
+ * The array is never modified once published: adding or removing a callback
+ * or an operation publishes a new array, see
+ * rte_eth_rxtx_callbacks_rcu_set().
+ */
+struct rte_eth_rxtx_cb_array {
+	uint32_t inline_ops; /**< RTE_ETH_CB_INLINE_* operations. */
+	uint16_t nb_cbs; /**< Number of callbacks. */
+	/** Counters of the queue, if RTE_ETH_CB_INLINE_COUNT is enabled. */
+	struct rte_eth_queue_cb_stats *stats;
+	struct rte_eth_rxtx_cb_array *next; /**< Next array waiting to be freed */
+	uint64_t token; /**< QSBR token of the array waiting to be freed. */
+	struct {
+		union {
+			rte_rx_callback_fn rx;
+			rte_tx_callback_fn tx;
+		} fn;
+		void *param;
+	} cbs[]; /**< Callbacks, in calling order. */
+};
+
 /**
  * @internal
  * The generic data structure associated with each ethernet device.
@@ -698,6 +721,12 @@ struct rte_eth_dev {
 	struct rte_eth_rxtx_callback *pre_tx_burst_cbs[RTE_MAX_QUEUES_PER_PORT];
 	enum rte_eth_dev_state state; /**< Flag indicating the port state */
 	void *security_ctx; /**< Context for security ops */
+	/**
+	 * Arrays built from post_rx_burst_cbs and pre_tx_burst_cbs, which are
+	 * the ones run by the burst functions.
+	 */
+	struct rte_eth_rxtx_cb_array *post_rx_burst_arrays[RTE_MAX_QUEUES_PER_PORT];
+	struct rte_eth_rxtx_cb_array *pre_tx_burst_arrays[RTE_MAX_QUEUES_PER_PORT];
 } __rte_cache_aligned;
 
 struct rte_eth_dev_sriov;
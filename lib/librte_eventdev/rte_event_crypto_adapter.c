@@ -6,6 +6,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_dev.h>
 #include <rte_errno.h>
 #include <rte_cryptodev.h>
@@ -24,10 +25,13 @@
 #define CRYPTO_ADAPTER_MEM_NAME_LEN 32
 #define CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES 100
 
-/* Flush an instance's enqueue buffers every CRYPTO_ENQ_FLUSH_THRESHOLD
- * iterations of eca_crypto_adapter_enq_run()
+/* Size of the per queue pair buffer of crypto ops staged for enqueue, ops
+ * are enqueued to the cryptodev once BATCH_SIZE of them are staged
  */
-#define CRYPTO_ENQ_FLUSH_THRESHOLD 1024
+#define CRYPTO_ADAPTER_OPS_BUFFER_SZ (4 * BATCH_SIZE)
+
+/* Staged crypto ops are enqueued once the oldest has waited this long */
+#define CRYPTO_ADAPTER_FLUSH_TIMEOUT_US 100
 
 struct rte_event_crypto_adapter {
 	/* Event device identifier */
@@ -44,8 +48,10 @@ struct rte_event_crypto_adapter {
 	uint16_t next_cdev_id;
 	/* Per crypto device structure */
 	struct crypto_device_info *cdevs;
-	/* Loop counter to flush crypto ops */
-	uint16_t transmit_loop_count;
+	/* Timer cycles a staged crypto op waits before being flushed */
+	uint64_t flush_timeout_ticks;
+	/* Timer cycles of the next check for staged crypto ops to flush */
+	uint64_t next_flush_tsc;
 	/* Per instance stats structure */
 	struct rte_event_crypto_adapter_stats crypto_stats;
 	/* Configuration callback for rte_service configuration */
@@ -95,7 +101,9 @@ struct crypto_queue_pair_info {
 	/* Pointer to hold rte_crypto_ops for batching */
 	struct rte_crypto_op **op_buffer;
 	/* No of crypto ops accumulated */
-	uint8_t len;
+	uint16_t len;
+	/* Timer cycles when the oldest staged crypto op was accumulated */
+	uint64_t ts;
 } __rte_cache_aligned;
 
 static struct rte_event_crypto_adapter **event_crypto_adapter;
@@ -250,6 +258,8 @@ rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
 	adapter->conf_cb = conf_cb;
 	adapter->conf_arg = conf_arg;
 	adapter->mode = mode;
+	adapter->flush_timeout_ticks = CRYPTO_ADAPTER_FLUSH_TIMEOUT_US *
+					rte_get_timer_hz() / US_PER_S;
 	strcpy(adapter->mem_name, mem_name);
 	adapter->cdevs = rte_zmalloc_socket(adapter->mem_name,
 					rte_cryptodev_count() *
@@ -323,20 +333,90 @@ rte_event_crypto_adapter_free(uint8_t id)
 	return 0;
 }
 
+static inline void
+eca_op_free(struct rte_crypto_op *op)
+{
+	rte_pktmbuf_free(op->sym->m_src);
+	rte_crypto_op_free(op);
+}
+
+static inline union rte_event_crypto_metadata *
+eca_op_metadata(struct rte_crypto_op *op)
+{
+	if (op->sess_type == RTE_CRYPTO_OP_WITH_SESSION)
+		return rte_cryptodev_sym_session_get_user_data(
+				op->sym->session);
+	if (op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
+			op->private_data_offset)
+		return (union rte_event_crypto_metadata *)
+			((uint8_t *)op + op->private_data_offset);
+	return NULL;
+}
+
+/* Enqueue the staged crypto ops of a queue pair, the ops the cryptodev
+ * does not accept remain staged until the flush timeout
+ */
+static unsigned int
+eca_qp_buffer_flush(struct rte_event_crypto_adapter *adapter,
+		uint8_t cdev_id, uint16_t qp_id,
+		struct crypto_queue_pair_info *qp_info)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	uint16_t n;
+
+	n = rte_cryptodev_enqueue_burst(cdev_id, qp_id, qp_info->op_buffer,
+					qp_info->len);
+	if (n == 0)
+		return 0;
+
+	stats->crypto_enq_count += n;
+	stats->crypto_enq_burst_count++;
+	qp_info->len -= n;
+	if (qp_info->len)
+		memmove(qp_info->op_buffer, &qp_info->op_buffer[n],
+			qp_info->len * sizeof(qp_info->op_buffer[0]));
+
+	return n;
+}
+
+static inline unsigned int
+eca_qp_buffer_add(struct rte_event_crypto_adapter *adapter,
+		uint8_t cdev_id, uint16_t qp_id,
+		struct crypto_queue_pair_info *qp_info,
+		struct rte_crypto_op *op)
+{
+	unsigned int n = 0;
+
+	if (unlikely(qp_info->len == CRYPTO_ADAPTER_OPS_BUFFER_SZ)) {
+		n = eca_qp_buffer_flush(adapter, cdev_id, qp_id, qp_info);
+		if (qp_info->len == CRYPTO_ADAPTER_OPS_BUFFER_SZ) {
+			adapter->crypto_stats.crypto_enq_fail++;
+			eca_op_free(op);
+			return n;
+		}
+	}
+
+	if (qp_info->len == 0)
+		qp_info->ts = rte_get_timer_cycles();
+	qp_info->op_buffer[qp_info->len++] = op;
+	if (qp_info->len >= BATCH_SIZE)
+		n += eca_qp_buffer_flush(adapter, cdev_id, qp_id, qp_info);
+
+	return n;
+}
+
 static inline unsigned int
 eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 		 struct rte_event *ev, unsigned int cnt)
 {
 	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	union rte_event_crypto_metadata *m_data = NULL;
-	struct crypto_queue_pair_info *qp_info = NULL;
+	union rte_event_crypto_metadata *m_data;
+	struct crypto_queue_pair_info *qp_info;
 	struct rte_crypto_op *crypto_op;
 	unsigned int i, n;
-	uint16_t qp_id, len, ret;
+	uint16_t qp_id;
 	uint8_t cdev_id;
 
-	len = 0;
-	ret = 0;
 	n = 0;
 	stats->event_deq_count += cnt;
 
@@ -344,120 +424,75 @@ eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 		crypto_op = ev[i].event_ptr;
 		if (crypto_op == NULL)
 			continue;
-		if (crypto_op->sess_type == RTE_CRYPTO_OP_WITH_SESSION) {
-			m_data = rte_cryptodev_sym_session_get_user_data(
-					crypto_op->sym->session);
-			if (m_data == NULL) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (!qp_info->qp_enabled) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
-		} else if (crypto_op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
-				crypto_op->private_data_offset) {
-			m_data = (union rte_event_crypto_metadata *)
-				 ((uint8_t *)crypto_op +
-					crypto_op->private_data_offset);
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (!qp_info->qp_enabled) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
-		} else {
-			rte_pktmbuf_free(crypto_op->sym->m_src);
-			rte_crypto_op_free(crypto_op);
+		m_data = eca_op_metadata(crypto_op);
+		if (m_data == NULL) {
+			eca_op_free(crypto_op);
 			continue;
 		}
 
-		if (len == BATCH_SIZE) {
-			struct rte_crypto_op **op_buffer = qp_info->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp_id,
-							  op_buffer,
-							  BATCH_SIZE);
-
-			stats->crypto_enq_count += ret;
-
-			while (ret < len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
-
-			len = 0;
+		cdev_id = m_data->request_info.cdev_id;
+		qp_id = m_data->request_info.queue_pair_id;
+		qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
+		if (!qp_info->qp_enabled) {
+			eca_op_free(crypto_op);
+			continue;
 		}
 
-		if (qp_info)
-			qp_info->len = len;
-		n += ret;
+		n += eca_qp_buffer_add(adapter, cdev_id, qp_id, qp_info,
+					crypto_op);
 	}
 
 	return n;
 }
 
+/* Enqueue the crypto ops staged for longer than the flush timeout */
 static unsigned int
-eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter)
+eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter, uint64_t now)
 {
 	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
 	struct crypto_device_info *curr_dev;
 	struct crypto_queue_pair_info *curr_queue;
-	struct rte_crypto_op **op_buffer;
 	struct rte_cryptodev *dev;
+	uint64_t next_flush_tsc;
+	unsigned int n;
 	uint8_t cdev_id;
 	uint16_t qp;
-	uint16_t ret;
 	uint16_t num_cdev = rte_cryptodev_count();
 
-	ret = 0;
+	n = 0;
+	next_flush_tsc = now + adapter->flush_timeout_ticks;
 	for (cdev_id = 0; cdev_id < num_cdev; cdev_id++) {
 		curr_dev = &adapter->cdevs[cdev_id];
 		dev = curr_dev->dev;
-		if (dev == NULL)
+		if (dev == NULL || curr_dev->qpairs == NULL)
 			continue;
 		for (qp = 0; qp < dev->data->nb_queue_pairs; qp++) {
 
 			curr_queue = &curr_dev->qpairs[qp];
-			if (!curr_queue->qp_enabled)
+			if (!curr_queue->qp_enabled || curr_queue->len == 0)
 				continue;
 
-			op_buffer = curr_queue->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp,
-							  op_buffer,
-							  curr_queue->len);
-			stats->crypto_enq_count += ret;
-
-			while (ret < curr_queue->len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
-			curr_queue->len = 0;
+			if (now - curr_queue->ts >=
+					adapter->flush_timeout_ticks) {
+				n += eca_qp_buffer_flush(adapter, cdev_id, qp,
+							 curr_queue);
+				stats->crypto_enq_timeout_count++;
+				/* Drop the ops the cryptodev still rejects,
+				 * so that they do not block the queue pair
+				 */
+				stats->crypto_enq_fail += curr_queue->len;
+				while (curr_queue->len)
+					eca_op_free(curr_queue->op_buffer[
+						--curr_queue->len]);
+			} else
+				next_flush_tsc = RTE_MIN(next_flush_tsc,
+					curr_queue->ts +
+					adapter->flush_timeout_ticks);
 		}
 	}
+	adapter->next_flush_tsc = next_flush_tsc;
 
-	return ret;
+	return n;
 }
 
 static int
@@ -467,6 +502,7 @@ eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
 	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
 	struct rte_event ev[BATCH_SIZE];
 	unsigned int nb_enq, nb_enqueued;
+	uint64_t now;
 	uint16_t n;
 	uint8_t event_dev_id = adapter->eventdev_id;
 	uint8_t event_port_id = adapter->event_port_id;
@@ -486,10 +522,9 @@ eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
 		nb_enqueued += eca_enq_to_cryptodev(adapter, ev, n);
 	}
 
-	if ((++adapter->transmit_loop_count &
-		(CRYPTO_ENQ_FLUSH_THRESHOLD - 1)) == 0) {
-		nb_enqueued += eca_crypto_enq_flush(adapter);
-	}
+	now = rte_get_timer_cycles();
+	if (now >= adapter->next_flush_tsc)
+		nb_enqueued += eca_crypto_enq_flush(adapter, now);
 
 	return nb_enqueued;
 }
@@ -499,7 +534,7 @@ eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 		  struct rte_crypto_op **ops, uint16_t num)
 {
 	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	union rte_event_crypto_metadata *m_data = NULL;
+	union rte_event_crypto_metadata *m_data;
 	uint8_t event_dev_id = adapter->eventdev_id;
 	uint8_t event_port_id = adapter->event_port_id;
 	struct rte_event events[BATCH_SIZE];
@@ -512,23 +547,15 @@ eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 	nb_enqueued = 0;
 	num = RTE_MIN(num, BATCH_SIZE);
 	for (i = 0; i < num; i++) {
-		struct rte_event *ev = &events[nb_ev++];
-		if (ops[i]->sess_type == RTE_CRYPTO_OP_WITH_SESSION) {
-			m_data = rte_cryptodev_sym_session_get_user_data(
-					ops[i]->sym->session);
-		} else if (ops[i]->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
-				ops[i]->private_data_offset) {
-			m_data = (union rte_event_crypto_metadata *)
-				 ((uint8_t *)ops[i] +
-				  ops[i]->private_data_offset);
-		}
+		struct rte_event *ev;
 
+		m_data = eca_op_metadata(ops[i]);
 		if (unlikely(m_data == NULL)) {
-			rte_pktmbuf_free(ops[i]->sym->m_src);
-			rte_crypto_op_free(ops[i]);
+			eca_op_free(ops[i]);
 			continue;
 		}
 
+		ev = &events[nb_ev++];
 		rte_memcpy(ev, &m_data->response_info, sizeof(*ev));
 		ev->event_ptr = ops[i];
 		ev->event_type = RTE_EVENT_TYPE_CRYPTODEV;
@@ -547,17 +574,17 @@ eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 		 nb_enqueued < nb_ev);
 
 	/* Free mbufs and rte_crypto_ops for failed events */
-	for (i = nb_enqueued; i < nb_ev; i++) {
-		struct rte_crypto_op *op = events[i].event_ptr;
-		rte_pktmbuf_free(op->sym->m_src);
-		rte_crypto_op_free(op);
-	}
+	for (i = nb_enqueued; i < nb_ev; i++)
+		eca_op_free(events[i].event_ptr);
 
 	stats->event_enq_fail_count += nb_ev - nb_enqueued;
 	stats->event_enq_count += nb_enqueued;
 	stats->event_enq_retry_count += retry - 1;
 }
 
+/* Completed crypto ops of all the queue pairs are gathered into bursts of
+ * up to BATCH_SIZE events for the event device
+ */
 static inline unsigned int
 eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 			unsigned int max_deq)
@@ -566,7 +593,7 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 	struct crypto_device_info *curr_dev;
 	struct crypto_queue_pair_info *curr_queue;
 	struct rte_crypto_op *ops[BATCH_SIZE];
-	uint16_t n, nb_deq;
+	uint16_t n, nb_ops, nb_deq;
 	struct rte_cryptodev *dev;
 	uint8_t cdev_id;
 	uint16_t qp, dev_qps;
@@ -574,15 +601,17 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 	uint16_t num_cdev = rte_cryptodev_count();
 
 	nb_deq = 0;
+	nb_ops = 0;
 	do {
-		uint16_t queues = 0;
 		done = true;
 
 		for (cdev_id = adapter->next_cdev_id;
 			cdev_id < num_cdev; cdev_id++) {
+			uint16_t queues = 0;
+
 			curr_dev = &adapter->cdevs[cdev_id];
 			dev = curr_dev->dev;
-			if (dev == NULL)
+			if (dev == NULL || curr_dev->qpairs == NULL)
 				continue;
 			dev_qps = dev->data->nb_queue_pairs;
 
@@ -595,14 +624,20 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 					continue;
 
 				n = rte_cryptodev_dequeue_burst(cdev_id, qp,
-					ops, BATCH_SIZE);
+					&ops[nb_ops], BATCH_SIZE - nb_ops);
 				if (!n)
 					continue;
 
 				done = false;
 				stats->crypto_deq_count += n;
-				eca_ops_enqueue_burst(adapter, ops, n);
+				stats->crypto_deq_burst_count++;
+				nb_ops += n;
 				nb_deq += n;
+				if (nb_ops == BATCH_SIZE) {
+					eca_ops_enqueue_burst(adapter, ops,
+							nb_ops);
+					nb_ops = 0;
+				}
 
 				if (nb_deq > max_deq) {
 					if ((qp + 1) == dev_qps) {
@@ -613,18 +648,25 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 					curr_dev->next_queue_pair_id = (qp + 1)
 						% dev->data->nb_queue_pairs;
 
-					return nb_deq;
+					goto out;
 				}
 			}
 		}
 	} while (done == false);
+
+out:
+	if (nb_ops)
+		eca_ops_enqueue_burst(adapter, ops, nb_ops);
+
 	return nb_deq;
 }
 
-static void
+static unsigned int
 eca_crypto_adapter_run(struct rte_event_crypto_adapter *adapter,
 			unsigned int max_ops)
 {
+	unsigned int nb_ops = 0;
+
 	while (max_ops) {
 		unsigned int e_cnt, d_cnt;
 
@@ -633,24 +675,28 @@ eca_crypto_adapter_run(struct rte_event_crypto_adapter *adapter,
 
 		d_cnt = eca_crypto_adapter_enq_run(adapter, max_ops);
 		max_ops -= RTE_MIN(max_ops, d_cnt);
+		nb_ops += e_cnt + d_cnt;
 
 		if (e_cnt == 0 && d_cnt == 0)
 			break;
 
 	}
+
+	return nb_ops;
 }
 
 static int
 eca_service_func(void *args)
 {
 	struct rte_event_crypto_adapter *adapter = args;
+	unsigned int nb_ops;
 
 	if (rte_spinlock_trylock(&adapter->lock) == 0)
-		return 0;
-	eca_crypto_adapter_run(adapter, adapter->max_nb);
+		return -EAGAIN;
+	nb_ops = eca_crypto_adapter_run(adapter, adapter->max_nb);
 	rte_spinlock_unlock(&adapter->lock);
 
-	return 0;
+	return nb_ops != 0 ? (int)nb_ops : -EAGAIN;
 }
 
 static int
@@ -718,6 +764,9 @@ eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
 		} else {
 			adapter->nb_qps -= enabled;
 			dev_info->num_qpairs -= enabled;
+			/* Drop the crypto ops staged for the queue pair */
+			while (qp_info->len)
+				eca_op_free(qp_info->op_buffer[--qp_info->len]);
 		}
 		qp_info->qp_enabled = !!add;
 	}
@@ -730,12 +779,13 @@ eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 {
 	struct crypto_device_info *dev_info = &adapter->cdevs[cdev_id];
 	struct crypto_queue_pair_info *qpairs;
+	uint16_t nb_qps = dev_info->dev->data->nb_queue_pairs;
 	uint32_t i;
 
 	if (dev_info->qpairs == NULL) {
 		dev_info->qpairs =
 		    rte_zmalloc_socket(adapter->mem_name,
-					dev_info->dev->data->nb_queue_pairs *
+					nb_qps *
 					sizeof(struct crypto_queue_pair_info),
 					0, adapter->socket_id);
 		if (dev_info->qpairs == NULL)
@@ -743,17 +793,21 @@ eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 
 		qpairs = dev_info->qpairs;
 		qpairs->op_buffer = rte_zmalloc_socket(adapter->mem_name,
-					BATCH_SIZE *
+					nb_qps * CRYPTO_ADAPTER_OPS_BUFFER_SZ *
 					sizeof(struct rte_crypto_op *),
 					0, adapter->socket_id);
 		if (!qpairs->op_buffer) {
 			rte_free(qpairs);
+			dev_info->qpairs = NULL;
 			return -ENOMEM;
 		}
+		for (i = 1; i < nb_qps; i++)
+			qpairs[i].op_buffer = qpairs->op_buffer +
+				i * CRYPTO_ADAPTER_OPS_BUFFER_SZ;
 	}
 
 	if (queue_pair_id == -1) {
-		for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++)
+		for (i = 0; i < nb_qps; i++)
 			eca_update_qp_info(adapter, dev_info, i, 1);
 	} else
 		eca_update_qp_info(adapter, dev_info,
@@ -950,6 +1004,7 @@ rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
 		}
 
 		if (dev_info->num_qpairs == 0) {
+			rte_free(dev_info->qpairs->op_buffer);
 			rte_free(dev_info->qpairs);
 			dev_info->qpairs = NULL;
 		}
@@ -125,6 +125,15 @@
  * operation in addition to the event information (response information)
  * needed to enqueue an event after the crypto operation has completed.
  *
+ * The SW adapter stages the crypto operations of each queue pair, whatever
+ * their session, and submits them to the cryptodev in bursts of 32
+ * operations, or once the oldest staged operation has waited for 100us.
+ * The operations the cryptodev still does not accept at that point are
+ * dropped and counted in crypto_enq_fail.
+ * Crypto completions of all the queue pairs are gathered into bursts of
+ * events. The crypto_enq_burst_count and crypto_deq_burst_count statistics
+ * give the burst sizes achieved.
+ *
  *
  * The event crypto adapter provides common APIs to configure the packet flow
  * from the crypto device to event devices for both SW and HW based transfers.
@@ -299,6 +308,18 @@ struct rte_event_crypto_adapter_stats {
 	/**< Event enqueue retry count */
 	uint64_t event_enq_fail_count;
 	/**< Event enqueue fail count */
+	uint64_t crypto_enq_burst_count;
+	/**< Cryptodev enqueue burst count, the average number of crypto ops
+	 * per enqueue burst is crypto_enq_count / crypto_enq_burst_count
+	 */
+	uint64_t crypto_enq_timeout_count;
+	/**< Count of queue pairs flushed as their oldest crypto op waited
+	 * for the flush timeout
+	 */
+	uint64_t crypto_deq_burst_count;
+	/**< Cryptodev dequeue burst count, the average number of crypto ops
+	 * per dequeue burst is crypto_deq_count / crypto_deq_burst_count
+	 */
 };
 
 /**
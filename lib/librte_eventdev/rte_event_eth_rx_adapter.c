@@ -14,7 +14,10 @@
 #include <rte_ethdev.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
 #include <rte_service_component.h>
+#include <rte_tailq.h>
 #include <rte_thash.h>
 #include <rte_interrupts.h>
 
@@ -25,6 +28,14 @@
 #define BATCH_SIZE		32
 #define BLOCK_CNT_THRESHOLD	10
 #define ETH_EVENT_BUFFER_SIZE	(4*BATCH_SIZE)
+/* Max number of WRR slots skipped for a polled queue found empty, the
+ * count of slots skipped doubles with each consecutive empty poll
+ */
+#define RXA_POLL_BACKOFF_MAX	64
+/* Max burst size of a polled queue, the burst size doubles from BATCH_SIZE
+ * while the queue returns full bursts
+ */
+#define RXA_BURST_MAX		(2 * BATCH_SIZE)
 
 #define ETH_RX_ADAPTER_SERVICE_NAME_LEN	32
 #define ETH_RX_ADAPTER_MEM_NAME_LEN	32
@@ -58,6 +69,32 @@ struct eth_rx_poll_entry {
 	uint16_t eth_rx_qid;
 };
 
+/*
+ * Event vector being filled with the mbufs of an Rx queue, there is an
+ * instance of this struct per Rx queue with event vectors enabled
+ */
+struct eth_rx_vector_data {
+	/* Entry in the list of vectors being filled */
+	TAILQ_ENTRY(eth_rx_vector_data) next;
+	/* Vector being filled, NULL if none */
+	struct rte_event_vector *vector_ev;
+	/* Mempool of the vectors */
+	struct rte_mempool *vector_pool;
+	/* Event enqueued for a vector */
+	uint64_t event;
+	/* Time at which the vector being filled got its first mbuf */
+	uint64_t ts;
+	/* Time after which a vector is enqueued even if not full */
+	uint64_t vector_timeout_ticks;
+	/* Number of mbufs of a full vector */
+	uint16_t max_vector_count;
+	/* Eth port and Rx queue of the vectors */
+	uint16_t port;
+	uint16_t queue;
+};
+
+TAILQ_HEAD(eth_rx_vector_list, eth_rx_vector_data);
+
 /* Instance per adapter */
 struct rte_eth_event_enqueue_buffer {
 	/* Count of events in this buffer */
@@ -91,6 +128,8 @@ struct rte_event_eth_rx_adapter {
 	uint32_t wrr_pos;
 	/* Event burst buffer */
 	struct rte_eth_event_enqueue_buffer event_enqueue_buffer;
+	/* Event vectors being filled, oldest first */
+	struct eth_rx_vector_list vector_list;
 	/* Per adapter stats */
 	struct rte_event_eth_rx_adapter_stats stats;
 	/* Block count, counts up to BLOCK_CNT_THRESHOLD */
@@ -198,8 +237,15 @@ struct eth_rx_queue_info {
 	int queue_enabled;	/* True if added */
 	int intr_enabled;
 	uint16_t wt;		/* Polling weight */
+	uint16_t poll_backoff;	/* WRR slots skipped after an empty poll */
+	uint16_t poll_skip;	/* WRR slots left to skip */
+	uint16_t rx_burst;	/* Packets requested per poll */
 	uint32_t flow_id_mask;	/* Set to ~0 if app provides flow id else 0 */
 	uint64_t event;
+	struct rte_event_eth_rx_adapter_queue_stats stats;
+	int ena_vector;		/* True if mbufs are aggregated in vectors */
+	int vector_flag;	/* True if added with QUEUE_EVENT_VECTOR */
+	struct eth_rx_vector_data vector_data;
 };
 
 static struct rte_event_eth_rx_adapter **event_eth_rx_adapter;
@@ -741,6 +787,151 @@ rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
 	return n;
 }
 
+/* Enqueue the vector being filled for an Rx queue to the event buffer */
+static inline void
+rxa_vector_enqueue(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_vector_data *vec, struct rte_event *ev)
+{
+	ev->event = vec->event;
+	ev->vec = vec->vector_ev;
+	vec->vector_ev = NULL;
+	TAILQ_REMOVE(&rx_adapter->vector_list, vec, next);
+}
+
+/* Aggregate mbufs in the vector of their Rx queue, and write an event
+ * to ev for each vector filled. Returns the number of events written.
+ */
+static inline uint16_t
+rxa_create_event_vector(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_queue_info *queue_info,
+		struct rte_event *ev,
+		struct rte_mbuf **mbufs,
+		uint16_t num)
+{
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	struct rte_event_vector *vector;
+	uint16_t nb_ev = 0;
+	uint16_t n;
+
+	while (num) {
+		if (vec->vector_ev == NULL) {
+			if (unlikely(rte_mempool_get(vec->vector_pool,
+					(void **)&vec->vector_ev) < 0)) {
+				vec->vector_ev = NULL;
+				rx_adapter->stats.rx_dropped += num;
+				while (num)
+					rte_pktmbuf_free(mbufs[--num]);
+				break;
+			}
+			vector = vec->vector_ev;
+			vector->nb_elem = 0;
+			vector->rsvd = 0;
+			vector->attr_valid = 1;
+			vector->port = vec->port;
+			vector->queue = vec->queue;
+			vec->ts = rte_get_tsc_cycles();
+			TAILQ_INSERT_TAIL(&rx_adapter->vector_list, vec, next);
+		}
+
+		vector = vec->vector_ev;
+		n = RTE_MIN(num, vec->max_vector_count - vector->nb_elem);
+		memcpy(&vector->mbufs[vector->nb_elem], mbufs,
+			n * sizeof(mbufs[0]));
+		vector->nb_elem += n;
+		mbufs += n;
+		num -= n;
+
+		if (vector->nb_elem == vec->max_vector_count)
+			rxa_vector_enqueue(rx_adapter, vec, &ev[nb_ev++]);
+	}
+
+	return nb_ev;
+}
+
+/* Enqueue the vectors which are not full but have waited for longer than
+ * the timeout of their Rx queue
+ */
+static inline void
+rxa_vector_expire(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+					&rx_adapter->event_enqueue_buffer;
+	struct eth_rx_vector_data *vec, *tmp;
+	uint64_t now;
+
+	if (TAILQ_EMPTY(&rx_adapter->vector_list))
+		return;
+
+	now = rte_get_tsc_cycles();
+	TAILQ_FOREACH_SAFE(vec, &rx_adapter->vector_list, next, tmp) {
+		if (buf->count == ETH_EVENT_BUFFER_SIZE)
+			break;
+		if (now - vec->ts < vec->vector_timeout_ticks)
+			continue;
+		rxa_vector_enqueue(rx_adapter, vec,
+				&buf->events[buf->count++]);
+	}
+
+	if (buf->count > 0)
+		rxa_flush_event_buffer(rx_adapter);
+}
+
+/* Free the mbufs of an event vector and return it to its mempool */
+static void
+rxa_vector_free(struct rte_event_vector *vector)
+{
+	rte_pktmbuf_free_bulk(vector->mbufs, vector->nb_elem);
+	rte_mempool_put(rte_mempool_from_obj(vector), vector);
+}
+
+/* Enqueue the vector being filled for an Rx queue, even if not full. It is
+ * only dropped if the event buffer stays full.
+ */
+static void
+rxa_vector_flush(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_queue_info *queue_info)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+					&rx_adapter->event_enqueue_buffer;
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+
+	if (vec->vector_ev == NULL)
+		return;
+
+	if (buf->count == ETH_EVENT_BUFFER_SIZE)
+		rxa_flush_event_buffer(rx_adapter);
+	if (buf->count < ETH_EVENT_BUFFER_SIZE) {
+		rxa_vector_enqueue(rx_adapter, vec,
+				&buf->events[buf->count++]);
+		rxa_flush_event_buffer(rx_adapter);
+		return;
+	}
+
+	rx_adapter->stats.rx_dropped += vec->vector_ev->nb_elem;
+	rxa_vector_free(vec->vector_ev);
+	vec->vector_ev = NULL;
+	TAILQ_REMOVE(&rx_adapter->vector_list, vec, next);
+}
+
+/* Release the events left in the event buffer, with their mbufs and
+ * vectors
+ */
+static void
+rxa_release_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+					&rx_adapter->event_enqueue_buffer;
+	uint16_t i;
+
+	for (i = 0; i < buf->count; i++) {
+		if (buf->events[i].event_type & RTE_EVENT_TYPE_VECTOR)
+			rxa_vector_free(buf->events[i].vec);
+		else
+			rte_pktmbuf_free(buf->events[i].mbuf);
+	}
+	buf->count = 0;
+}
+
 static inline void
 rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 		uint16_t eth_dev_id,
@@ -755,7 +946,8 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 					&dev_info->rx_queue[rx_queue_id];
 	struct rte_eth_event_enqueue_buffer *buf =
 					&rx_adapter->event_enqueue_buffer;
-	struct rte_event *ev = &buf->events[buf->count];
+	struct rte_event *ev_start = &buf->events[buf->count];
+	struct rte_event *ev = ev_start;
 	uint64_t event = eth_rx_queue_info->event;
 	uint32_t flow_id_mask = eth_rx_queue_info->flow_id_mask;
 	struct rte_mbuf *m = mbufs[0];
@@ -780,25 +972,31 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 		}
 	}
 
-	for (i = 0; i < num; i++) {
-		m = mbufs[i];
+	if (eth_rx_queue_info->ena_vector) {
+		num = rxa_create_event_vector(rx_adapter, eth_rx_queue_info,
+					ev_start, mbufs, num);
+	} else {
+		for (i = 0; i < num; i++) {
+			m = mbufs[i];
 
-		rss = do_rss ?
-			rxa_do_softrss(m, rx_adapter->rss_key_be) :
-			m->hash.rss;
-		ev->event = event;
-		ev->flow_id = (rss & ~flow_id_mask) |
-				(ev->flow_id & flow_id_mask);
-		ev->mbuf = m;
-		ev++;
+			rss = do_rss ?
+				rxa_do_softrss(m, rx_adapter->rss_key_be) :
+				m->hash.rss;
+			ev->event = event;
+			ev->flow_id = (rss & ~flow_id_mask) |
+					(ev->flow_id & flow_id_mask);
+			ev->mbuf = m;
+			ev++;
+		}
 	}
 
-	if (dev_info->cb_fn) {
+	if (dev_info->cb_fn && num) {
 
 		dropped = 0;
 		nb_cb = dev_info->cb_fn(eth_dev_id, rx_queue_id,
-					ETH_EVENT_BUFFER_SIZE, buf->count, ev,
-					num, dev_info->cb_arg, &dropped);
+					ETH_EVENT_BUFFER_SIZE, buf->count,
+					ev_start, num, dev_info->cb_arg,
+					&dropped);
 		if (unlikely(nb_cb > num))
 			RTE_EDEV_LOG_ERR("Rx CB returned %d (> %d) events",
 				nb_cb, num);
@@ -820,12 +1018,18 @@ rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 	uint32_t max_rx,
 	int *rxq_empty)
 {
-	struct rte_mbuf *mbufs[BATCH_SIZE];
+	struct rte_mbuf *mbufs[RXA_BURST_MAX];
 	struct rte_eth_event_enqueue_buffer *buf =
 					&rx_adapter->event_enqueue_buffer;
 	struct rte_event_eth_rx_adapter_stats *stats =
 					&rx_adapter->stats;
+	struct eth_rx_queue_info *queue_info =
+		&rx_adapter->eth_devices[port_id].rx_queue[queue_id];
+	struct rte_event_eth_rx_adapter_queue_stats *q_stats =
+		&queue_info->stats;
+	uint16_t burst = queue_info->rx_burst;
 	uint16_t n;
+	int full;
 	uint32_t nb_rx = 0;
 
 	if (rxq_empty)
@@ -833,23 +1037,45 @@ rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 	/* Don't do a batch dequeue from the rx queue if there isn't
 	 * enough space in the enqueue buffer.
 	 */
-	while (BATCH_SIZE <= (RTE_DIM(buf->events) - buf->count)) {
+	while (burst <= (RTE_DIM(buf->events) - buf->count)) {
 		if (buf->count >= BATCH_SIZE)
 			rxa_flush_event_buffer(rx_adapter);
 
 		stats->rx_poll_count++;
-		n = rte_eth_rx_burst(port_id, queue_id, mbufs, BATCH_SIZE);
+		q_stats->rx_poll_count++;
+		n = rte_eth_rx_burst(port_id, queue_id, mbufs, burst);
 		if (unlikely(!n)) {
+			q_stats->rx_empty_poll_count++;
 			if (rxq_empty)
 				*rxq_empty = 1;
 			break;
 		}
 		rxa_buffer_mbufs(rx_adapter, port_id, queue_id, mbufs, n);
 		nb_rx += n;
+		full = n == burst;
+		/* Larger bursts for a queue filling whole bursts, smaller
+		 * ones again once it returns less than half a burst
+		 */
+		if (full)
+			burst = RTE_MIN(burst * 2, RXA_BURST_MAX);
+		else if (n < burst / 2)
+			burst = RTE_MAX(burst / 2, BATCH_SIZE);
+		queue_info->rx_burst = burst;
 		if (rx_count + nb_rx > max_rx)
 			break;
+		/* A partial batch drained the queue, keep polling
+		 * only queues which fill whole batches, instead of
+		 * paying for an empty poll on each visit
+		 */
+		if (!full) {
+			if (rxq_empty)
+				*rxq_empty = 1;
+			break;
+		}
 	}
 
+	q_stats->rx_packets += nb_rx;
+
 	if (buf->count > 0)
 		rxa_flush_event_buffer(rx_adapter);
 
@@ -968,6 +1194,23 @@ rxa_intr_thread(void *arg)
 	return NULL;
 }
 
+/* Update the backoff of a polled queue after a poll, the number of
+ * WRR slots skipped doubles with each consecutive empty poll
+ */
+static inline void
+rxa_poll_backoff(struct eth_rx_queue_info *queue_info, int empty)
+{
+	if (likely(!empty)) {
+		queue_info->poll_backoff = 0;
+		return;
+	}
+
+	queue_info->poll_backoff = queue_info->poll_backoff ?
+		RTE_MIN(queue_info->poll_backoff * 2, RXA_POLL_BACKOFF_MAX) :
+		1;
+	queue_info->poll_skip = queue_info->poll_backoff;
+}
+
 /* Dequeue <port, q> from interrupt ring and enqueue received
  * mbufs to eventdev
  */
@@ -1016,6 +1259,7 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 			rx_adapter->qd = qd;
 			rx_adapter->qd_valid = 1;
 			dev_info = &rx_adapter->eth_devices[port];
+			dev_info->rx_queue[queue].stats.rx_intr_count++;
 			if (rxa_shared_intr(dev_info, queue))
 				dev_info->shared_intr_enabled = 1;
 			else {
@@ -1109,19 +1353,35 @@ rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 		unsigned int poll_idx = rx_adapter->wrr_sched[wrr_pos];
 		uint16_t qid = rx_adapter->eth_rx_poll[poll_idx].eth_rx_qid;
 		uint16_t d = rx_adapter->eth_rx_poll[poll_idx].eth_dev_id;
+		struct eth_rx_queue_info *queue_info =
+			&rx_adapter->eth_devices[d].rx_queue[qid];
+		uint32_t n;
+		int rxq_empty;
+
+		/* Skip the WRR slots of a queue backing off */
+		if (queue_info->poll_skip) {
+			queue_info->poll_skip--;
+			queue_info->stats.rx_skip_count++;
+			if (++wrr_pos == rx_adapter->wrr_len)
+				wrr_pos = 0;
+			continue;
+		}
 
 		/* Don't do a batch dequeue from the rx queue if there isn't
 		 * enough space in the enqueue buffer.
 		 */
 		if (buf->count >= BATCH_SIZE)
 			rxa_flush_event_buffer(rx_adapter);
-		if (BATCH_SIZE > (ETH_EVENT_BUFFER_SIZE - buf->count)) {
+		if (queue_info->rx_burst >
+				(ETH_EVENT_BUFFER_SIZE - buf->count)) {
 			rx_adapter->wrr_pos = wrr_pos;
 			return nb_rx;
 		}
 
-		nb_rx += rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
-				NULL);
+		n = rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
+				&rxq_empty);
+		rxa_poll_backoff(queue_info, n == 0 && rxq_empty);
+		nb_rx += n;
 		if (nb_rx > max_nb_rx) {
 			rx_adapter->wrr_pos =
 				    (wrr_pos + 1) % rx_adapter->wrr_len;
@@ -1139,19 +1399,23 @@ rxa_service_func(void *args)
 {
 	struct rte_event_eth_rx_adapter *rx_adapter = args;
 	struct rte_event_eth_rx_adapter_stats *stats;
+	uint32_t nb_rx;
 
 	if (rte_spinlock_trylock(&rx_adapter->rx_lock) == 0)
-		return 0;
+		return -EAGAIN;
 	if (!rx_adapter->rxa_started) {
 		rte_spinlock_unlock(&rx_adapter->rx_lock);
-		return 0;
+		return -EAGAIN;
 	}
 
 	stats = &rx_adapter->stats;
-	stats->rx_packets += rxa_intr_ring_dequeue(rx_adapter);
-	stats->rx_packets += rxa_poll(rx_adapter);
+	rxa_vector_expire(rx_adapter);
+	nb_rx = rxa_intr_ring_dequeue(rx_adapter);
+	nb_rx += rxa_poll(rx_adapter);
+	stats->rx_packets += nb_rx;
 	rte_spinlock_unlock(&rx_adapter->rx_lock);
-	return 0;
+
+	return nb_rx != 0 ? (int)nb_rx : -EAGAIN;
 }
 
 static int
@@ -1676,6 +1940,9 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	pollq = rxa_polled_queue(dev_info, rx_queue_id);
 	intrq = rxa_intr_queue(dev_info, rx_queue_id);
 	sintrq = rxa_shared_intr(dev_info, rx_queue_id);
+	rxa_vector_flush(rx_adapter, &dev_info->rx_queue[rx_queue_id]);
+	dev_info->rx_queue[rx_queue_id].ena_vector = 0;
+	dev_info->rx_queue[rx_queue_id].vector_flag = 0;
 	rxa_update_queue(rx_adapter, dev_info, rx_queue_id, 0);
 	rx_adapter->num_rx_polled -= pollq;
 	dev_info->nb_rx_poll -= pollq;
@@ -1684,6 +1951,62 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	dev_info->nb_shared_intr -= intrq && sintrq;
 }
 
+static void
+rxa_set_vector_data(struct eth_rx_queue_info *queue_info,
+		const struct rte_event_eth_rx_adapter_vector_config *config,
+		uint16_t port_id, uint16_t rx_queue_id)
+{
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	struct rte_event *vec_ev = (struct rte_event *)&vec->event;
+
+	vec->vector_pool = config->vector_mp;
+	vec->max_vector_count = config->vector_sz;
+	vec->vector_timeout_ticks = RTE_MAX(1.0, (double)rte_get_tsc_hz() *
+			config->vector_timeout_ns / 1E9);
+	vec->port = port_id;
+	vec->queue = rx_queue_id;
+
+	/* the mbufs of a vector are from the same Rx queue, the flow is the
+	 * one of the queue unless provided by the application
+	 */
+	vec->event = queue_info->event;
+	vec_ev->event_type = RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR;
+	if (queue_info->flow_id_mask == 0)
+		vec_ev->flow_id = (uint32_t)port_id << 12 | rx_queue_id;
+	queue_info->ena_vector = 1;
+}
+
+static int
+rxa_sw_vector_config(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_device_info *dev_info,
+		int32_t rx_queue_id,
+		const struct rte_event_eth_rx_adapter_vector_config *config)
+{
+	struct eth_rx_queue_info *queue_info;
+	int ret = -EINVAL;
+
+	if (rx_queue_id == -1) {
+		uint16_t nb_rx_queues;
+		uint16_t i;
+
+		nb_rx_queues = dev_info->dev->data->nb_rx_queues;
+		for (i = 0; i < nb_rx_queues; i++)
+			if (dev_info->rx_queue[i].vector_flag)
+				ret = rxa_sw_vector_config(rx_adapter,
+						dev_info, i, config);
+		return ret;
+	}
+
+	queue_info = &dev_info->rx_queue[rx_queue_id];
+	if (!queue_info->queue_enabled || !queue_info->vector_flag)
+		return -EINVAL;
+
+	rxa_vector_flush(rx_adapter, queue_info);
+	rxa_set_vector_data(queue_info, config, dev_info->dev->data->port_id,
+			rx_queue_id);
+	return 0;
+}
+
 static void
 rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	struct eth_device_info *dev_info,
@@ -1713,6 +2036,10 @@ rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 
 	queue_info = &dev_info->rx_queue[rx_queue_id];
 	queue_info->wt = conf->servicing_weight;
+	queue_info->poll_backoff = 0;
+	queue_info->poll_skip = 0;
+	queue_info->rx_burst = BATCH_SIZE;
+	memset(&queue_info->stats, 0, sizeof(queue_info->stats));
 
 	qi_ev = (struct rte_event *)&queue_info->event;
 	qi_ev->event = ev->event;
@@ -1726,6 +2053,12 @@ rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	} else
 		qi_ev->flow_id = 0;
 
+	/* vectors are enabled by rte_event_eth_rx_adapter_queue_vector_config */
+	rxa_vector_flush(rx_adapter, queue_info);
+	queue_info->ena_vector = 0;
+	queue_info->vector_flag = !!(conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR);
+
 	rxa_update_queue(rx_adapter, dev_info, rx_queue_id, 1);
 	if (rxa_polled_queue(dev_info, rx_queue_id)) {
 		rx_adapter->num_rx_polled += !pollq;
@@ -1992,6 +2325,7 @@ rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		return -ENOMEM;
 	}
 	rte_spinlock_init(&rx_adapter->rx_lock);
+	TAILQ_INIT(&rx_adapter->vector_list);
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
 		rx_adapter->eth_devices[i].dev = &rte_eth_devices[i];
 
@@ -2041,6 +2375,7 @@ rte_event_eth_rx_adapter_free(uint8_t id)
 		return -EBUSY;
 	}
 
+	rxa_release_event_buffer(rx_adapter);
 	if (rx_adapter->default_cb_arg)
 		rte_free(rx_adapter->conf_arg);
 	rte_free(rx_adapter->eth_devices);
@@ -2096,6 +2431,15 @@ rte_event_eth_rx_adapter_queue_add(uint8_t id,
 		return -EINVAL;
 	}
 
+	if ((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR) == 0 &&
+		(queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR)) {
+		RTE_EDEV_LOG_ERR("Event vectors are not supported,"
+				" eth port: %" PRIu16 " adapter id: %" PRIu8,
+				eth_dev_id, id);
+		return -ENOTSUP;
+	}
+
 	if (rx_queue_id != -1 && (uint16_t)rx_queue_id >=
 			rte_eth_devices[eth_dev_id].data->nb_rx_queues) {
 		RTE_EDEV_LOG_ERR("Invalid rx queue_id %" PRIu16,
@@ -2266,6 +2610,60 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 	return ret;
 }
 
+int
+rte_event_eth_rx_adapter_queue_vector_config(uint8_t id,
+		uint16_t eth_dev_id, int32_t rx_queue_id,
+		const struct rte_event_eth_rx_adapter_vector_config *config)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+	struct eth_device_info *dev_info;
+	uint32_t cap;
+	int ret;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if ((rx_adapter == NULL) || (config == NULL))
+		return -EINVAL;
+
+	ret = rte_event_eth_rx_adapter_caps_get(rx_adapter->eventdev_id,
+						eth_dev_id,
+						&cap);
+	if (ret)
+		return ret;
+
+	if (cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)
+		return -ENOTSUP;
+
+	if (config->vector_mp == NULL || config->vector_sz == 0 ||
+		config->vector_sz >
+			rte_event_vector_pool_nb_elem(config->vector_mp) ||
+		config->vector_timeout_ns == 0) {
+		RTE_EDEV_LOG_ERR("Invalid event vector configuration,"
+				" eth port: %" PRIu16 " adapter id: %" PRIu8,
+				eth_dev_id, id);
+		return -EINVAL;
+	}
+
+	if (rx_queue_id != -1 && (uint16_t)rx_queue_id >=
+		rte_eth_devices[eth_dev_id].data->nb_rx_queues) {
+		RTE_EDEV_LOG_ERR("Invalid rx queue_id %" PRIu16,
+			 (uint16_t)rx_queue_id);
+		return -EINVAL;
+	}
+
+	dev_info = &rx_adapter->eth_devices[eth_dev_id];
+	if (dev_info->rx_queue == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&rx_adapter->rx_lock);
+	ret = rxa_sw_vector_config(rx_adapter, dev_info, rx_queue_id, config);
+	rte_spinlock_unlock(&rx_adapter->rx_lock);
+
+	return ret;
+}
+
 int
 rte_event_eth_rx_adapter_start(uint8_t id)
 {
@@ -2348,6 +2746,73 @@ rte_event_eth_rx_adapter_stats_reset(uint8_t id)
 	return 0;
 }
 
+static int
+rxa_queue_info_get(uint8_t id, uint16_t eth_dev_id, uint16_t rx_queue_id,
+		struct rte_event_eth_rx_adapter **rx_adapter,
+		struct eth_rx_queue_info **queue_info)
+{
+	struct eth_device_info *dev_info;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+
+	*rx_adapter = rxa_id_to_adapter(id);
+	if (*rx_adapter == NULL || (*rx_adapter)->eth_devices == NULL)
+		return -EINVAL;
+
+	dev_info = &(*rx_adapter)->eth_devices[eth_dev_id];
+	if (dev_info->rx_queue == NULL ||
+		rx_queue_id >= dev_info->dev->data->nb_rx_queues ||
+		!dev_info->rx_queue[rx_queue_id].queue_enabled)
+		return -EINVAL;
+
+	if (dev_info->internal_event_port)
+		return -ENOTSUP;
+
+	*queue_info = &dev_info->rx_queue[rx_queue_id];
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_queue_stats_get(uint8_t id,
+		uint16_t eth_dev_id,
+		uint16_t rx_queue_id,
+		struct rte_event_eth_rx_adapter_queue_stats *stats)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+	struct eth_rx_queue_info *queue_info;
+	int ret;
+
+	if (stats == NULL)
+		return -EINVAL;
+
+	ret = rxa_queue_info_get(id, eth_dev_id, rx_queue_id, &rx_adapter,
+				&queue_info);
+	if (ret)
+		return ret;
+
+	*stats = queue_info->stats;
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_queue_stats_reset(uint8_t id,
+		uint16_t eth_dev_id,
+		uint16_t rx_queue_id)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+	struct eth_rx_queue_info *queue_info;
+	int ret;
+
+	ret = rxa_queue_info_get(id, eth_dev_id, rx_queue_id, &rx_adapter,
+				&queue_info);
+	if (ret)
+		return ret;
+
+	memset(&queue_info->stats, 0, sizeof(queue_info->stats));
+	return 0;
+}
+
 int
 rte_event_eth_rx_adapter_service_id_get(uint8_t id, uint32_t *service_id)
 {
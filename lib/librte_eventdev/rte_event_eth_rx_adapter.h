@@ -33,10 +33,13 @@
  *  - rte_event_eth_rx_adapter_free()
  *  - rte_event_eth_rx_adapter_queue_add()
  *  - rte_event_eth_rx_adapter_queue_del()
+ *  - rte_event_eth_rx_adapter_queue_vector_config()
  *  - rte_event_eth_rx_adapter_start()
  *  - rte_event_eth_rx_adapter_stop()
  *  - rte_event_eth_rx_adapter_stats_get()
  *  - rte_event_eth_rx_adapter_stats_reset()
+ *  - rte_event_eth_rx_adapter_queue_stats_get()
+ *  - rte_event_eth_rx_adapter_queue_stats_reset()
  *
  * The application creates an ethernet to event adapter using
  * rte_event_eth_rx_adapter_create_ext() or rte_event_eth_rx_adapter_create()
@@ -54,6 +57,21 @@
  * lower priority queues completely. If this parameter is zero and the receive
  * interrupt is enabled when configuring the device, the receive queue is
  * interrupt driven; else, the queue is assigned a servicing weight of one.
+ * Interrupt mode suits low rate queues, since the adapter service function
+ * only polls them after an Rx interrupt, until they are empty.
+ *
+ * A polled queue found empty skips its next slot in the polling sequence,
+ * then twice as many slots after each consecutive empty poll, up to a
+ * limit, so that idle queues cost few cycles while busy queues, which are
+ * polled for as long as they fill whole bursts, get most of them. The
+ * burst size of a queue grows while it fills whole bursts.
+ *
+ * A queue added with the RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag
+ * and configured with rte_event_eth_rx_adapter_queue_vector_config()
+ * aggregates its mbufs into event vectors of up to vector_sz mbufs, so that
+ * the event device schedules a burst of packets at the cost of a single
+ * event. A vector which is not full is enqueued once vector_timeout_ns has
+ * elapsed since it got its first mbuf.
  *
  * The application can start/stop the adapter using the
  * rte_event_eth_rx_adapter_start() and the rte_event_eth_rx_adapter_stop()
@@ -85,6 +103,7 @@ extern "C" {
 
 #include <stdint.h>
 
+#include <rte_compat.h>
 #include <rte_service.h>
 
 #include "rte_eventdev.h"
@@ -96,6 +115,12 @@ extern "C" {
 /**< This flag indicates the flow identifier is valid
  * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
  */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR	0x2
+/**< This flag indicates that the mbufs received from the queue are
+ * aggregated into event vectors, see struct rte_event_vector. Requires the
+ * RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR capability.
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
 
 /**
  * Adapter configuration structure that the adapter configuration callback
@@ -170,6 +195,34 @@ struct rte_event_eth_rx_adapter_queue_conf {
 	 *
 	 * The event adapter sets ev.event_type to RTE_EVENT_TYPE_ETHDEV in the
 	 * enqueued event.
+	 *
+	 * With RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR, an event carries
+	 * a vector of mbufs of this Rx queue, its event type is
+	 * RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR, and its flow ID is derived
+	 * from the port and queue identifiers unless provided as above.
+	 */
+};
+
+/**
+ * Event vector configuration of an Rx queue
+ * @see rte_event_eth_rx_adapter_queue_vector_config()
+ */
+struct rte_event_eth_rx_adapter_vector_config {
+	uint16_t vector_sz;
+	/**<
+	 * Number of mbufs after which an event vector is enqueued. It must not
+	 * exceed the number of elements of the vectors of vector_mp.
+	 */
+	uint64_t vector_timeout_ns;
+	/**<
+	 * Time after which an event vector is enqueued even if it holds less
+	 * than vector_sz mbufs.
+	 */
+	struct rte_mempool *vector_mp;
+	/**<
+	 * Mempool of the event vectors, created with
+	 * rte_event_vector_pool_create(). The packets are dropped while it is
+	 * empty.
 	 */
 };
 
@@ -203,6 +256,22 @@ struct rte_event_eth_rx_adapter_stats {
 	/**< Received packet count for interrupt mode Rx queues */
 };
 
+/**
+ * Per Rx queue statistics of the SW adapter
+ */
+struct rte_event_eth_rx_adapter_queue_stats {
+	uint64_t rx_packets;
+	/**< Received packet count */
+	uint64_t rx_poll_count;
+	/**< Receive queue poll count */
+	uint64_t rx_empty_poll_count;
+	/**< Receive queue polls which returned no packet */
+	uint64_t rx_skip_count;
+	/**< Polls skipped since the queue was found empty before */
+	uint64_t rx_intr_count;
+	/**< Rx interrupts handled, for interrupt mode Rx queues */
+};
+
 /**
  *
  * Callback function invoked by the SW adapter before it continues
@@ -377,6 +446,41 @@ int rte_event_eth_rx_adapter_queue_add(uint8_t id,
 int rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 				       int32_t rx_queue_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Configure the event vectors of Rx queues added to the SW adapter with the
+ * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag. The mbufs of such a
+ * queue are enqueued as single events until it is configured, and it must be
+ * configured again after being added again.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param eth_dev_id
+ *  Port identifier of Ethernet device.
+ *
+ * @param rx_queue_id
+ *  Ethernet device receive queue index.
+ *  If rx_queue_id is -1, then all Rx queues of the device added with the
+ *  RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag are configured.
+ *
+ * @param config
+ *  Event vector configuration of the queue.
+ *
+ * @return
+ *  - 0: Success, event vectors configured.
+ *  - -ENOTSUP: The queue is serviced by an internal event port.
+ *  - -EINVAL: Invalid configuration, or queue not added with the
+ *  RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag.
+ */
+__rte_experimental
+int
+rte_event_eth_rx_adapter_queue_vector_config(uint8_t id,
+		uint16_t eth_dev_id, int32_t rx_queue_id,
+		const struct rte_event_eth_rx_adapter_vector_config *config);
+
 /**
  * Start ethernet Rx event adapter
  *
@@ -433,6 +537,62 @@ int rte_event_eth_rx_adapter_stats_get(uint8_t id,
  */
 int rte_event_eth_rx_adapter_stats_reset(uint8_t id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the statistics of an Rx queue serviced by the SW adapter.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param eth_dev_id
+ *  Port identifier of Ethernet device.
+ *
+ * @param rx_queue_id
+ *  Ethernet device receive queue index.
+ *
+ * @param [out] stats
+ *  A pointer to structure used to retrieve the statistics of the queue.
+ *
+ * @return
+ *  - 0: Success, retrieved successfully.
+ *  - -ENOTSUP: The queue is serviced by an internal event port.
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int
+rte_event_eth_rx_adapter_queue_stats_get(uint8_t id,
+			uint16_t eth_dev_id,
+			uint16_t rx_queue_id,
+			struct rte_event_eth_rx_adapter_queue_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reset the statistics of an Rx queue serviced by the SW adapter.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param eth_dev_id
+ *  Port identifier of Ethernet device.
+ *
+ * @param rx_queue_id
+ *  Ethernet device receive queue index.
+ *
+ * @return
+ *  - 0: Success, statistics reset successfully.
+ *  - -ENOTSUP: The queue is serviced by an internal event port.
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int
+rte_event_eth_rx_adapter_queue_stats_reset(uint8_t id,
+			uint16_t eth_dev_id,
+			uint16_t rx_queue_id);
+
 /**
  * Retrieve the service ID of an adapter. If the adapter doesn't use
  * a rte_service function, this function returns -ESRCH.
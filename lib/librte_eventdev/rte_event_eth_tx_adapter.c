@@ -549,7 +549,7 @@ txa_service_func(void *args)
 	uint8_t dev_id;
 	uint8_t port;
 	uint16_t n;
-	uint32_t nb_tx, max_nb_tx;
+	uint32_t nb_tx, max_nb_tx, nb_flushed = 0;
 	struct rte_event ev[TXA_BATCH_SIZE];
 
 	dev_id = txa->eventdev_id;
@@ -557,10 +557,10 @@ txa_service_func(void *args)
 	port = txa->port_id;
 
 	if (txa->nb_queues == 0)
-		return 0;
+		return -EAGAIN;
 
 	if (!rte_spinlock_trylock(&txa->tx_lock))
-		return 0;
+		return -EAGAIN;
 
 	for (nb_tx = 0; nb_tx < max_nb_tx; nb_tx += n) {
 
@@ -578,7 +578,6 @@ txa_service_func(void *args)
 		uint16_t i;
 
 		tdi = txa->txa_ethdev;
-		nb_tx = 0;
 
 		RTE_ETH_FOREACH_DEV(i) {
 			uint16_t q;
@@ -595,15 +594,18 @@ txa_service_func(void *args)
 				if (unlikely(tqi == NULL || !tqi->added))
 					continue;
 
-				nb_tx += rte_eth_tx_buffer_flush(i, q,
+				nb_flushed += rte_eth_tx_buffer_flush(i, q,
 							tqi->tx_buf);
 			}
 		}
 
-		txa->stats.tx_packets += nb_tx;
+		txa->stats.tx_packets += nb_flushed;
 	}
 	rte_spinlock_unlock(&txa->tx_lock);
-	return 0;
+
+	/* events dequeued, and packets flushed from the Tx buffers */
+	nb_tx += nb_flushed;
+	return nb_tx != 0 ? (int)nb_tx : -EAGAIN;
 }
 
 static int
@@ -527,6 +527,10 @@ event_buffer_flush(struct event_buffer *bufp, uint8_t dev_id, uint8_t port_id,
 /*
  * Software event timer adapter implementation
  */
+
+/* Resolution below which the wheel tick follows the adapter tick */
+#define SWTIM_WHEEL_TICK_NS 10000
+
 struct swtim {
 	/* Identifier of service executing timer management logic. */
 	uint32_t service_id;
@@ -720,6 +724,7 @@ swtim_service_func(void *arg)
 	struct swtim *sw = swtim_pmd_priv(adapter);
 	uint16_t nb_evs_flushed = 0;
 	uint16_t nb_evs_invalid = 0;
+	uint64_t nb_expired = sw->stats.evtim_exp_count;
 
 	if (swtim_did_tick(sw)) {
 		rte_timer_alt_manage(sw->timer_data_id,
@@ -743,7 +748,11 @@ swtim_service_func(void *arg)
 		sw->stats.adapter_tick_count++;
 	}
 
-	return 0;
+	/* idle if no timer expired nor event was flushed */
+	nb_expired = sw->stats.evtim_exp_count - nb_expired;
+	if (nb_expired == 0 && nb_evs_flushed == 0 && nb_evs_invalid == 0)
+		return -EAGAIN;
+	return (int32_t)(nb_expired + nb_evs_flushed + nb_evs_invalid);
 }
 
 /* The adapter initialization function rounds the mempool size up to the next
@@ -783,6 +792,7 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 	struct swtim *sw;
 	unsigned int flags;
 	struct rte_service_spec service;
+	struct rte_timer_data_params params;
 
 	/* Allocate storage for private data area */
 #define SWTIM_NAMESIZE 32
@@ -837,7 +847,19 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 		}
 	}
 
-	ret = rte_timer_data_alloc(&sw->timer_data_id);
+	/* Event timers are typically armed and canceled at high rates, keep
+	 * them in timing wheels with O(1) arm and cancel. Expiry times are
+	 * rounded up to the wheel tick, so keep it well below the adapter
+	 * tick: use the default wheel resolution, unless the adapter tick is
+	 * finer.
+	 */
+	params.backend = RTE_TIMER_BACKEND_WHEEL;
+	params.wheel_tick = 0;
+	if (sw->timer_tick_ns < SWTIM_WHEEL_TICK_NS)
+		params.wheel_tick = RTE_MAX(sw->timer_tick_ns *
+					    rte_get_timer_hz() / NSECPERSEC,
+					    UINT64_C(1));
+	ret = rte_timer_data_alloc_params(&sw->timer_data_id, &params);
 	if (ret < 0) {
 		EVTIM_LOG_ERR("failed to allocate timer data instance");
 		rte_errno = -ret;
@@ -864,7 +886,7 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 			      ret);
 
 		rte_errno = ENOSPC;
-		goto free_mempool;
+		goto free_timer_data;
 	}
 
 	EVTIM_LOG_DBG("registered service %s with id %"PRIu32, service.name,
@@ -874,6 +896,8 @@ swtim_init(struct rte_event_timer_adapter *adapter)
 	adapter->data->service_inited = 1;
 
 	return 0;
+free_timer_data:
+	rte_timer_data_dealloc(sw->timer_data_id);
 free_mempool:
 	rte_mempool_free(sw->tim_pool);
 free_alloc:
@@ -911,6 +935,7 @@ swtim_uninit(struct rte_event_timer_adapter *adapter)
 		return ret;
 	}
 
+	rte_timer_data_dealloc(sw->timer_data_id);
 	rte_mempool_free(sw->tim_pool);
 	rte_free(sw);
 	adapter->data->adapter_priv = NULL;
@@ -1007,6 +1032,9 @@ __swtim_arm_burst(const struct rte_event_timer_adapter *adapter,
 	uint32_t lcore_id = rte_lcore_id();
 	struct rte_timer *tim, *tims[nb_evtims];
 	uint64_t cycles;
+	/* Destination of the previous event timer, checked already */
+	int checked_queue = -1;
+	uint8_t checked_sched_type = 0;
 
 #ifdef RTE_LIBRTE_EVENTDEV_DEBUG
 	/* Check that the service is running. */
@@ -1062,11 +1090,19 @@ __swtim_arm_burst(const struct rte_event_timer_adapter *adapter,
 			break;
 		}
 
-		if (unlikely(check_destination_event_queue(evtims[i],
-							   adapter) < 0)) {
-			evtims[i]->state = RTE_EVENT_TIMER_ERROR;
-			rte_errno = EINVAL;
-			break;
+		/* Bursts usually share their destination, skip the queue
+		 * attribute lookup when it was just checked
+		 */
+		if (evtims[i]->ev.queue_id != checked_queue ||
+		    evtims[i]->ev.sched_type != checked_sched_type) {
+			if (unlikely(check_destination_event_queue(evtims[i],
+							adapter) < 0)) {
+				evtims[i]->state = RTE_EVENT_TIMER_ERROR;
+				rte_errno = EINVAL;
+				break;
+			}
+			checked_queue = evtims[i]->ev.queue_id;
+			checked_sched_type = evtims[i]->ev.sched_type;
 		}
 
 		tim = tims[i];
@@ -1110,7 +1146,7 @@ swtim_cancel_burst(const struct rte_event_timer_adapter *adapter,
 		   uint16_t nb_evtims)
 {
 	int i, ret;
-	struct rte_timer *timp;
+	struct rte_timer *timp, *tims[nb_evtims];
 	uint64_t opaque;
 	struct swtim *sw = swtim_pmd_priv(adapter);
 
@@ -1145,7 +1181,7 @@ swtim_cancel_burst(const struct rte_event_timer_adapter *adapter,
 			break;
 		}
 
-		rte_mempool_put(sw->tim_pool, (void **)timp);
+		tims[i] = timp;
 
 		evtims[i]->state = RTE_EVENT_TIMER_CANCELED;
 		evtims[i]->impl_opaque[0] = 0;
@@ -1154,6 +1190,10 @@ swtim_cancel_burst(const struct rte_event_timer_adapter *adapter,
 		rte_smp_wmb();
 	}
 
+	/* Return the timer objects of the whole burst at once */
+	if (i > 0)
+		rte_mempool_put_bulk(sw->tim_pool, (void **)tims, i);
+
 	return i;
 }
 
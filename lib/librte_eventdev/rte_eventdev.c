@@ -28,6 +28,7 @@
 #include <rte_branch_prediction.h>
 #include <rte_common.h>
 #include <rte_malloc.h>
+#include <rte_mempool.h>
 #include <rte_errno.h>
 #include <rte_ethdev.h>
 #include <rte_cryptodev.h>
@@ -85,6 +86,37 @@ rte_event_dev_socket_id(uint8_t dev_id)
 	return dev->data->socket_id;
 }
 
+struct rte_mempool *
+rte_event_vector_pool_create(const char *name, unsigned int n,
+			unsigned int cache_size, uint16_t nb_elem,
+			int socket_id)
+{
+	unsigned int elt_size;
+
+	if (nb_elem == 0) {
+		RTE_EDEV_LOG_ERR("Invalid number of vector elements=%u",
+				nb_elem);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	elt_size = sizeof(struct rte_event_vector) +
+		nb_elem * sizeof(uint64_t);
+
+	return rte_mempool_create(name, n, elt_size, cache_size, 0,
+			NULL, NULL, NULL, NULL, socket_id, 0);
+}
+
+uint16_t
+rte_event_vector_pool_nb_elem(const struct rte_mempool *mp)
+{
+	if (mp->elt_size < sizeof(struct rte_event_vector))
+		return 0;
+
+	return RTE_MIN((mp->elt_size - sizeof(struct rte_event_vector)) /
+			sizeof(uint64_t), (size_t)UINT16_MAX);
+}
+
 int
 rte_event_dev_info_get(uint8_t dev_id, struct rte_event_dev_info *dev_info)
 {
@@ -214,8 +214,10 @@ extern "C" {
 #include <rte_config.h>
 #include <rte_memory.h>
 #include <rte_errno.h>
+#include <rte_compat.h>
 
 struct rte_mbuf; /* we just use mbuf pointers; no need to include rte_mbuf.h */
+struct rte_mempool;
 struct rte_event;
 
 /* Event device capability bitmap flags */
@@ -949,6 +951,19 @@ rte_event_dev_close(uint8_t dev_id);
  */
 #define RTE_EVENT_TYPE_ETH_RX_ADAPTER   0x4
 /**< The event generated from event eth Rx adapter */
+#define RTE_EVENT_TYPE_VECTOR           0x8
+/**< Flag set in the event type of an event carrying a vector of objects,
+ * see struct rte_event_vector, instead of a single one.
+ * The other bits of the event type give the source of the objects.
+ */
+#define RTE_EVENT_TYPE_ETHDEV_VECTOR \
+	(RTE_EVENT_TYPE_VECTOR | RTE_EVENT_TYPE_ETHDEV)
+/**< The event vector of mbufs generated from ethdev subsystem */
+#define RTE_EVENT_TYPE_CPU_VECTOR (RTE_EVENT_TYPE_VECTOR | RTE_EVENT_TYPE_CPU)
+/**< The event vector generated from cpu for pipelining */
+#define RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR \
+	(RTE_EVENT_TYPE_VECTOR | RTE_EVENT_TYPE_ETH_RX_ADAPTER)
+/**< The event vector of mbufs generated from event eth Rx adapter */
 #define RTE_EVENT_TYPE_MAX              0x10
 /**< Maximum number of event types */
 
@@ -998,6 +1013,50 @@ rte_event_dev_close(uint8_t dev_id);
  *
  */
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice
+ *
+ * Vector of objects carried by a single event, of type
+ * RTE_EVENT_TYPE_VECTOR, so that a burst of objects which are processed the
+ * same way is scheduled at the cost of one event.
+ *
+ * The vectors are allocated from a mempool created with
+ * rte_event_vector_pool_create(). The consumer of the event returns the
+ * vector to its mempool, rte_mempool_from_obj() gives it, once done with
+ * the objects.
+ */
+RTE_STD_C11
+struct rte_event_vector {
+	uint16_t nb_elem;
+	/**< Number of elements in the vector. */
+	uint16_t rsvd:15;
+	/**< Reserved for future use */
+	uint16_t attr_valid:1;
+	/**< Set if the port and queue attributes are valid. */
+	union {
+		struct {
+			uint16_t port;
+			/**< Ethernet port of the mbufs. */
+			uint16_t queue;
+			/**< Ethernet queue of the mbufs. */
+		};
+		uint32_t attr;
+		/**< Attributes of the objects, as set by the producer. */
+	};
+	uint64_t impl_opaque;
+	/**< Implementation specific opaque value. */
+	union {
+		struct rte_mbuf *mbufs[0];
+		/**< Elements of a vector of mbufs. */
+		void *ptrs[0];
+		/**< Elements of a vector of pointers. */
+		uint64_t u64s[0];
+		/**< Elements of a vector of opaque values. */
+	} __rte_aligned(16);
+	/**< Start of the elements of the vector. */
+};
+
 /**
  * The generic *rte_event* structure to hold the event attributes
  * for dequeue and enqueue operation
@@ -1071,9 +1130,57 @@ struct rte_event {
 		/**< Opaque event pointer */
 		struct rte_mbuf *mbuf;
 		/**< mbuf pointer if dequeued event is associated with mbuf */
+		struct rte_event_vector *vec;
+		/**< Event vector pointer if the event type has the
+		 * RTE_EVENT_TYPE_VECTOR flag set
+		 */
 	};
 };
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a mempool of event vectors.
+ *
+ * @param name
+ *   The name of the mempool.
+ * @param n
+ *   The number of event vectors in the mempool.
+ * @param cache_size
+ *   The size of the per-lcore object cache, see rte_mempool_create().
+ * @param nb_elem
+ *   The maximum number of elements of an event vector.
+ * @param socket_id
+ *   The socket identifier where the memory should be allocated, or
+ *   SOCKET_ID_ANY.
+ * @return
+ *   The pointer to the new mempool on success, NULL on error with rte_errno
+ *   set:
+ *    - EINVAL: nb_elem is zero.
+ *    - Other errors of rte_mempool_create().
+ */
+__rte_experimental
+struct rte_mempool *
+rte_event_vector_pool_create(const char *name, unsigned int n,
+			unsigned int cache_size, uint16_t nb_elem,
+			int socket_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the maximum number of elements of the event vectors of a mempool.
+ *
+ * @param mp
+ *   A mempool created with rte_event_vector_pool_create().
+ * @return
+ *   The maximum number of elements of an event vector.
+ */
+__rte_experimental
+uint16_t
+rte_event_vector_pool_nb_elem(const struct rte_mempool *mp);
+
 /* Ethdev Rx adapter capability bitmap flags */
 #define RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT	0x1
 /**< This flag is sent when the packet transfer mechanism is in HW.
@@ -1090,6 +1197,12 @@ struct rte_event {
  * @see struct rte_event_eth_rx_adapter_queue_conf::ev
  * @see struct rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
  */
+#define RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR	0x8
+/**< The adapter can aggregate the mbufs received from an ethdev Rx queue
+ * into event vectors.
+ * @see struct rte_event_vector
+ * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR
+ */
 
 /**
  * Retrieve the event device's ethdev Rx adapter capabilities for the
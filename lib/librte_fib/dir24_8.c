@@ -0,0 +1,607 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_cpuflags.h>
+#include <rte_debug.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_memory.h>
+#include <rte_prefetch.h>
+
+#include <rte_rib.h>
+#include <rte_fib.h>
+#include "dir24_8.h"
+
+#ifdef CC_DIR24_8_AVX512_SUPPORT
+#include "dir24_8_avx512.h"
+#endif
+
+#define DIR24_8_NAMESIZE	64
+
+#define ROUNDUP(x, y)	 RTE_ALIGN_CEIL(x, (1 << (32 - y)))
+
+static rte_fib_lookup_fn_t
+get_scalar_fn(enum rte_fib_dir24_8_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return dir24_8_lookup_bulk_1b;
+	case RTE_FIB_DIR24_8_2B:
+		return dir24_8_lookup_bulk_2b;
+	case RTE_FIB_DIR24_8_4B:
+		return dir24_8_lookup_bulk_4b;
+	case RTE_FIB_DIR24_8_8B:
+		return dir24_8_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+static rte_fib_lookup_fn_t
+get_vector_fn(struct dir24_8_tbl *dp)
+{
+#ifdef CC_DIR24_8_AVX512_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) <= 0)
+		return NULL;
+
+	/* tbl8 gathers use signed 32 bit entry indexes */
+	if ((uint64_t)dp->number_tbl8s * DIR24_8_TBL8_GRP_NUM_ENT > INT32_MAX)
+		return NULL;
+
+	switch (dp->nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return dir24_8_vec_lookup_bulk_1b;
+	case RTE_FIB_DIR24_8_2B:
+		return dir24_8_vec_lookup_bulk_2b;
+	case RTE_FIB_DIR24_8_4B:
+		return dir24_8_vec_lookup_bulk_4b;
+	case RTE_FIB_DIR24_8_8B:
+		return dir24_8_vec_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+#else
+	RTE_SET_USED(dp);
+	return NULL;
+#endif
+}
+
+rte_fib_lookup_fn_t
+dir24_8_get_lookup_fn(void *p, enum rte_fib_lookup_type type)
+{
+	struct dir24_8_tbl *dp = p;
+	rte_fib_lookup_fn_t ret_fn;
+
+	if (dp == NULL)
+		return NULL;
+
+	switch (type) {
+	case RTE_FIB_LOOKUP_DIR24_8_SCALAR_MACRO:
+		return get_scalar_fn(dp->nh_sz);
+	case RTE_FIB_LOOKUP_DIR24_8_SCALAR_UNI:
+		return dir24_8_lookup_bulk_uni;
+	case RTE_FIB_LOOKUP_DIR24_8_VECTOR_AVX512:
+		return get_vector_fn(dp);
+	case RTE_FIB_LOOKUP_DEFAULT:
+		ret_fn = get_vector_fn(dp);
+		return (ret_fn != NULL) ? ret_fn : get_scalar_fn(dp->nh_sz);
+	default:
+		return NULL;
+	}
+}
+
+static void
+write_to_fib(void *ptr, uint64_t val, enum rte_fib_dir24_8_nh_sz size, int n)
+{
+	int i;
+	uint8_t *ptr8 = (uint8_t *)ptr;
+	uint16_t *ptr16 = (uint16_t *)ptr;
+	uint32_t *ptr32 = (uint32_t *)ptr;
+	uint64_t *ptr64 = (uint64_t *)ptr;
+
+	switch (size) {
+	case RTE_FIB_DIR24_8_1B:
+		for (i = 0; i < n; i++)
+			ptr8[i] = (uint8_t)val;
+		break;
+	case RTE_FIB_DIR24_8_2B:
+		for (i = 0; i < n; i++)
+			ptr16[i] = (uint16_t)val;
+		break;
+	case RTE_FIB_DIR24_8_4B:
+		for (i = 0; i < n; i++)
+			ptr32[i] = (uint32_t)val;
+		break;
+	case RTE_FIB_DIR24_8_8B:
+		for (i = 0; i < n; i++)
+			ptr64[i] = (uint64_t)val;
+		break;
+	}
+}
+
+static uint64_t
+read_tbl8_ent(struct dir24_8_tbl *dp, uint32_t idx)
+{
+	switch (dp->nh_sz) {
+	case RTE_FIB_DIR24_8_1B:
+		return ((uint8_t *)dp->tbl8)[idx];
+	case RTE_FIB_DIR24_8_2B:
+		return ((uint16_t *)dp->tbl8)[idx];
+	case RTE_FIB_DIR24_8_4B:
+		return ((uint32_t *)dp->tbl8)[idx];
+	case RTE_FIB_DIR24_8_8B:
+	default:
+		return dp->tbl8[idx];
+	}
+}
+
+static int
+tbl8_get_idx(struct dir24_8_tbl *dp)
+{
+	uint32_t i, nb_slabs;
+	int bit_idx;
+
+	nb_slabs = RTE_ALIGN_CEIL(dp->number_tbl8s, BITMAP_SLAB_BIT_SIZE) >>
+		BITMAP_SLAB_BIT_SIZE_LOG2;
+	for (i = 0; (i < nb_slabs) && (dp->tbl8_idxes[i] == UINT64_MAX); i++)
+		;
+	if (i < nb_slabs) {
+		bit_idx = __builtin_ctzll(~dp->tbl8_idxes[i]);
+		if ((i << BITMAP_SLAB_BIT_SIZE_LOG2) + bit_idx <
+				dp->number_tbl8s)
+			return (i << BITMAP_SLAB_BIT_SIZE_LOG2) + bit_idx;
+	}
+	return -ENOSPC;
+}
+
+static inline void
+tbl8_set_idx(struct dir24_8_tbl *dp, uint32_t idx)
+{
+	dp->tbl8_idxes[idx >> BITMAP_SLAB_BIT_SIZE_LOG2] |=
+		1ULL << (idx & BITMAP_SLAB_BITMASK);
+}
+
+static inline void
+tbl8_free_idx(struct dir24_8_tbl *dp, uint32_t idx)
+{
+	dp->tbl8_idxes[idx >> BITMAP_SLAB_BIT_SIZE_LOG2] &=
+		~(1ULL << (idx & BITMAP_SLAB_BITMASK));
+}
+
+/*
+ * Return tbl8 groups whose readers went through a quiescent state
+ * to the free bitmap. If wait is set, block until the oldest one
+ * can be reclaimed.
+ */
+static void
+tbl8_reclaim(struct dir24_8_tbl *dp, bool wait)
+{
+	struct dir24_8_tbl8_dq_ent *ent;
+
+	while (dp->dq_cnt != 0) {
+		ent = &dp->dq[dp->dq_head];
+		if (rte_rcu_qsbr_check(dp->v, ent->token, wait) != 1)
+			break;
+		tbl8_free_idx(dp, ent->tbl8_idx);
+		dp->cur_tbl8s--;
+		dp->dq_head = (dp->dq_head + 1) % dp->number_tbl8s;
+		dp->dq_cnt--;
+		wait = false;
+	}
+}
+
+/*
+ * Check that n tbl8 groups can be allocated,
+ * reclaiming the retired ones if needed.
+ */
+static bool
+tbl8_reserve(struct dir24_8_tbl *dp, uint32_t n)
+{
+	while ((dp->number_tbl8s - dp->cur_tbl8s < n) && (dp->dq_cnt != 0))
+		tbl8_reclaim(dp, true);
+
+	return dp->number_tbl8s - dp->cur_tbl8s >= n;
+}
+
+static int
+tbl8_alloc(struct dir24_8_tbl *dp, uint64_t nh)
+{
+	int tbl8_idx;
+	uint8_t *tbl8_ptr;
+
+	if (!tbl8_reserve(dp, 1))
+		return -ENOSPC;
+	tbl8_idx = tbl8_get_idx(dp);
+	if (tbl8_idx < 0)
+		return tbl8_idx;
+	tbl8_set_idx(dp, tbl8_idx);
+	dp->cur_tbl8s++;
+
+	tbl8_ptr = (uint8_t *)dp->tbl8 +
+		(((uint64_t)tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT) <<
+		dp->nh_sz);
+	/*Init tbl8 entries with nexthop from tbl24*/
+	write_to_fib((void *)tbl8_ptr, nh | DIR24_8_EXT_ENT, dp->nh_sz,
+		DIR24_8_TBL8_GRP_NUM_ENT);
+	/* Group content must be visible before tbl24 is pointed to it */
+	rte_smp_wmb();
+
+	return tbl8_idx;
+}
+
+/*
+ * Release a tbl8 group which is not referenced from tbl24 anymore.
+ * Without RCU the group is reused right away, so lookups running
+ * concurrently may return a wrong next hop.
+ */
+static void
+tbl8_free(struct dir24_8_tbl *dp, uint32_t tbl8_idx)
+{
+	struct dir24_8_tbl8_dq_ent *ent;
+
+	if (dp->v == NULL) {
+		tbl8_free_idx(dp, tbl8_idx);
+		dp->cur_tbl8s--;
+		return;
+	}
+
+	if (dp->rcu_mode == RTE_FIB_QSBR_MODE_SYNC) {
+		rte_rcu_qsbr_synchronize(dp->v, RTE_QSBR_THRID_INVALID);
+		tbl8_free_idx(dp, tbl8_idx);
+		dp->cur_tbl8s--;
+		return;
+	}
+
+	/* every group is at most once in the queue, so it can't overflow */
+	ent = &dp->dq[(dp->dq_head + dp->dq_cnt) % dp->number_tbl8s];
+	ent->token = rte_rcu_qsbr_start(dp->v);
+	ent->tbl8_idx = tbl8_idx;
+	dp->dq_cnt++;
+}
+
+static void
+tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
+{
+	uint32_t i, base;
+	uint64_t nh;
+
+	base = tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT;
+	nh = read_tbl8_ent(dp, base);
+	for (i = 1; i < DIR24_8_TBL8_GRP_NUM_ENT; i++) {
+		if (nh != read_tbl8_ent(dp, base + i))
+			return;
+	}
+	write_to_fib(get_tbl24_p(dp, ip, dp->nh_sz),
+		nh & ~DIR24_8_EXT_ENT, dp->nh_sz, 1);
+	tbl8_free(dp, tbl8_idx);
+}
+
+/*
+ * Write next_hop to n tbl8 entries starting from ip, inside the group
+ * of the /24 containing ip. The group is allocated if needed.
+ */
+static int
+install_to_tbl8(struct dir24_8_tbl *dp, uint32_t ip, uint32_t n,
+	uint64_t next_hop)
+{
+	uint64_t tbl24_tmp;
+	int64_t tbl8_idx;
+	uint8_t *tbl8_ptr;
+
+	tbl24_tmp = get_tbl24(dp, ip, dp->nh_sz);
+	if (!is_entry_extended(tbl24_tmp)) {
+		tbl8_idx = tbl8_alloc(dp, tbl24_tmp);
+		if (tbl8_idx < 0)
+			return tbl8_idx;
+		/*update dir24 entry with tbl8 index*/
+		write_to_fib(get_tbl24_p(dp, ip, dp->nh_sz),
+			(tbl8_idx << 1) | DIR24_8_EXT_ENT, dp->nh_sz, 1);
+	} else
+		tbl8_idx = tbl24_tmp >> 1;
+
+	tbl8_ptr = (uint8_t *)dp->tbl8 +
+		(((tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT) + (uint8_t)ip) <<
+		dp->nh_sz);
+	/*update tbl8 with new next hop*/
+	write_to_fib((void *)tbl8_ptr, (next_hop << 1) | DIR24_8_EXT_ENT,
+		dp->nh_sz, n);
+	tbl8_recycle(dp, ip, tbl8_idx);
+
+	return 0;
+}
+
+/*
+ * Install next_hop for the [ledge, redge) address range.
+ * Edges are 64 bit wide so that the range can end at 2^32.
+ */
+static int
+install_to_fib(struct dir24_8_tbl *dp, uint64_t ledge, uint64_t redge,
+	uint64_t next_hop)
+{
+	uint64_t lalign, ralign;
+	uint32_t need_tbl8 = 0;
+	int ret;
+
+	if (ledge == redge)
+		return 0;
+
+	if ((ledge >> 8) == (redge >> 8))
+		/* range fits into a single tbl8 group */
+		return install_to_tbl8(dp, ledge, redge - ledge, next_hop);
+
+	lalign = ROUNDUP(ledge, 24);
+	ralign = redge & ~(uint64_t)UINT8_MAX;
+
+	/*
+	 * Make sure there is space for both edges tbl8 groups before
+	 * touching the table, so a failed install leaves it unchanged.
+	 */
+	if ((lalign != ledge) &&
+			!is_entry_extended(get_tbl24(dp, ledge, dp->nh_sz)))
+		need_tbl8++;
+	if ((ralign != redge) &&
+			!is_entry_extended(get_tbl24(dp, redge, dp->nh_sz)))
+		need_tbl8++;
+	if (!tbl8_reserve(dp, need_tbl8))
+		return -ENOSPC;
+
+	if (lalign != ledge) {
+		ret = install_to_tbl8(dp, ledge, lalign - ledge, next_hop);
+		if (ret != 0)
+			return ret;
+	}
+
+	write_to_fib(get_tbl24_p(dp, lalign, dp->nh_sz),
+		next_hop << 1, dp->nh_sz, (ralign - lalign) >> 8);
+
+	if (ralign != redge)
+		return install_to_tbl8(dp, ralign, redge - ralign, next_hop);
+
+	return 0;
+}
+
+static int
+modify_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib_node *tmp = NULL;
+	uint64_t ledge, redge;
+	uint32_t tmp_ip;
+	uint8_t tmp_depth;
+	int ret;
+
+	/*
+	 * Install next hop to the parts of the prefix which are not covered
+	 * by more specific routes, going through them in ascending order.
+	 */
+	ledge = ip;
+	do {
+		tmp = rte_rib_get_nxt(rib, ip, depth, tmp,
+			RTE_RIB_GET_NXT_COVER);
+		if (tmp != NULL) {
+			rte_rib_get_depth(tmp, &tmp_depth);
+			rte_rib_get_ip(tmp, &tmp_ip);
+			redge = tmp_ip & rte_rib_depth_to_mask(tmp_depth);
+		} else
+			redge = (uint64_t)ip + (1ULL << (32 - depth));
+
+		ret = install_to_fib(dp, ledge, redge, next_hop);
+		if (ret != 0)
+			return ret;
+
+		if (tmp != NULL)
+			ledge = redge + (1ULL << (32 - tmp_depth));
+	} while (tmp != NULL);
+
+	return 0;
+}
+
+int
+dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
+	uint64_t next_hop, int op)
+{
+	struct dir24_8_tbl *dp;
+	struct rte_rib *rib;
+	struct rte_rib_node *tmp = NULL;
+	struct rte_rib_node *node;
+	struct rte_rib_node *parent;
+	int ret = 0;
+	uint64_t par_nh, node_nh;
+
+	if ((fib == NULL) || (depth > RTE_FIB_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib_get_dp(fib);
+	rib = rte_fib_get_rib(fib);
+	RTE_ASSERT((dp != NULL) && (rib != NULL));
+
+	if (next_hop > get_max_nh(dp->nh_sz))
+		return -EINVAL;
+
+	ip &= rte_rib_depth_to_mask(depth);
+
+	node = rte_rib_lookup_exact(rib, ip, depth);
+	switch (op) {
+	case RTE_FIB_ADD:
+		if (node != NULL) {
+			rte_rib_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			ret = modify_fib(dp, rib, ip, depth, next_hop);
+			if (ret == 0)
+				rte_rib_set_nh(node, next_hop);
+			return ret;
+		}
+		if (depth > 24) {
+			/* the first route longer than /24 reserves a tbl8 */
+			tmp = rte_rib_get_nxt(rib, ip, 24, NULL,
+				RTE_RIB_GET_NXT_COVER);
+			if ((tmp == NULL) &&
+					(dp->rsvd_tbl8s >= dp->number_tbl8s))
+				return -ENOSPC;
+		}
+		node = rte_rib_insert(rib, ip, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib_set_nh(node, next_hop);
+		if ((depth > 24) && (tmp == NULL))
+			dp->rsvd_tbl8s++;
+
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL) {
+			rte_rib_get_nh(parent, &par_nh);
+			if (par_nh == next_hop)
+				return 0;
+		} else if (next_hop == dp->def_nh)
+			return 0;
+
+		ret = modify_fib(dp, rib, ip, depth, next_hop);
+		if (ret != 0) {
+			rte_rib_remove(rib, ip, depth);
+			if ((depth > 24) && (tmp == NULL))
+				dp->rsvd_tbl8s--;
+			return ret;
+		}
+		return 0;
+	case RTE_FIB_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		rte_rib_get_nh(node, &node_nh);
+		parent = rte_rib_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		if (par_nh != node_nh)
+			ret = modify_fib(dp, rib, ip, depth, par_nh);
+		if (ret == 0) {
+			rte_rib_remove(rib, ip, depth);
+			if (depth > 24) {
+				tmp = rte_rib_get_nxt(rib, ip, 24, NULL,
+					RTE_RIB_GET_NXT_COVER);
+				if (tmp == NULL)
+					dp->rsvd_tbl8s--;
+			}
+		}
+		return ret;
+	default:
+		break;
+	}
+	return -EINVAL;
+}
+
+void *
+dir24_8_create(const char *name, int socket_id, struct rte_fib_conf *fib_conf)
+{
+	char mem_name[DIR24_8_NAMESIZE];
+	struct dir24_8_tbl *dp;
+	uint64_t def_nh;
+	uint32_t num_tbl8;
+	enum rte_fib_dir24_8_nh_sz nh_sz;
+
+	if ((name == NULL) || (fib_conf == NULL) ||
+			(fib_conf->dir24_8.nh_sz < RTE_FIB_DIR24_8_1B) ||
+			(fib_conf->dir24_8.nh_sz > RTE_FIB_DIR24_8_8B) ||
+			(fib_conf->dir24_8.num_tbl8 >
+			get_max_nh(fib_conf->dir24_8.nh_sz)) ||
+			(fib_conf->dir24_8.num_tbl8 == 0) ||
+			(fib_conf->default_nh >
+			get_max_nh(fib_conf->dir24_8.nh_sz))) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	def_nh = fib_conf->default_nh;
+	nh_sz = fib_conf->dir24_8.nh_sz;
+	num_tbl8 = fib_conf->dir24_8.num_tbl8;
+
+	/*
+	 * Tables are followed by a few spare bytes, as the vector lookup
+	 * reads 32 bits for each 8 or 16 bit entry.
+	 */
+	snprintf(mem_name, sizeof(mem_name), "DP_%s", name);
+	dp = rte_zmalloc_socket(mem_name, sizeof(struct dir24_8_tbl) +
+		((uint64_t)DIR24_8_TBL24_NUM_ENT << nh_sz) + sizeof(uint32_t),
+		RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	/* Init table with default value */
+	write_to_fib(dp->tbl24, (def_nh << 1), nh_sz, 1 << 24);
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_%p", dp);
+	dp->tbl8 = rte_zmalloc_socket(mem_name,
+		(((uint64_t)num_tbl8 * DIR24_8_TBL8_GRP_NUM_ENT) << nh_sz) +
+		sizeof(uint32_t), RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->tbl8 == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp);
+		return NULL;
+	}
+	dp->def_nh = def_nh;
+	dp->nh_sz = nh_sz;
+	dp->number_tbl8s = num_tbl8;
+	dp->socket_id = socket_id;
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_idxes_%p", dp);
+	dp->tbl8_idxes = rte_zmalloc_socket(mem_name,
+			RTE_ALIGN_CEIL(dp->number_tbl8s, 64) >> 3,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->tbl8_idxes == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp->tbl8);
+		rte_free(dp);
+		return NULL;
+	}
+
+	return dp;
+}
+
+void
+dir24_8_free(void *p)
+{
+	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
+
+	rte_free(dp->dq);
+	rte_free(dp->tbl8_idxes);
+	rte_free(dp->tbl8);
+	rte_free(dp);
+}
+
+int
+dir24_8_rcu_qsbr_add(void *p, struct rte_fib_rcu_config *cfg)
+{
+	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
+	char mem_name[DIR24_8_NAMESIZE];
+
+	if ((dp == NULL) || (cfg == NULL) || (cfg->v == NULL) ||
+			(cfg->mode > RTE_FIB_QSBR_MODE_SYNC))
+		return -EINVAL;
+
+	if (dp->v != NULL)
+		return -EEXIST;
+
+	if (cfg->mode == RTE_FIB_QSBR_MODE_DQ) {
+		snprintf(mem_name, sizeof(mem_name), "DQ_%p", dp);
+		dp->dq = rte_zmalloc_socket(mem_name,
+			sizeof(*dp->dq) * dp->number_tbl8s,
+			RTE_CACHE_LINE_SIZE, dp->socket_id);
+		if (dp->dq == NULL)
+			return -ENOMEM;
+	}
+	dp->rcu_mode = cfg->mode;
+	dp->v = cfg->v;
+
+	return 0;
+}
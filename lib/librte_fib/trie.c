@@ -0,0 +1,566 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_memory.h>
+#include <rte_prefetch.h>
+
+#include <rte_rib6.h>
+#include <rte_fib6.h>
+#include "trie.h"
+
+#define TRIE_NAMESIZE		64
+
+static inline uint64_t
+get_max_nh(enum rte_fib_trie_nh_sz nh_sz)
+{
+	return (1ULL << ((8 << nh_sz) - 1)) - 1;
+}
+
+static rte_fib6_lookup_fn_t
+get_scalar_fn(enum rte_fib_trie_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return rte_trie_lookup_bulk_2b;
+	case RTE_FIB6_TRIE_4B:
+		return rte_trie_lookup_bulk_4b;
+	case RTE_FIB6_TRIE_8B:
+		return rte_trie_lookup_bulk_8b;
+	default:
+		return NULL;
+	}
+}
+
+static rte_fib6_lookup_fn_t
+get_batch_fn(enum rte_fib_trie_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return rte_trie_lookup_batch_2b;
+	case RTE_FIB6_TRIE_4B:
+		return rte_trie_lookup_batch_4b;
+	case RTE_FIB6_TRIE_8B:
+		return rte_trie_lookup_batch_8b;
+	default:
+		return NULL;
+	}
+}
+
+rte_fib6_lookup_fn_t
+trie_get_lookup_fn(void *p, enum rte_fib6_lookup_type type)
+{
+	struct rte_trie_tbl *dp = p;
+
+	if (dp == NULL)
+		return NULL;
+
+	switch (type) {
+	case RTE_FIB6_LOOKUP_DEFAULT:
+	case RTE_FIB6_LOOKUP_TRIE_SCALAR:
+		return get_scalar_fn(dp->nh_sz);
+	case RTE_FIB6_LOOKUP_TRIE_BATCH:
+		return get_batch_fn(dp->nh_sz);
+	default:
+		return NULL;
+	}
+}
+
+static void
+write_to_dp(void *ptr, uint64_t val, enum rte_fib_trie_nh_sz size, int n)
+{
+	int i;
+	uint16_t *ptr16 = (uint16_t *)ptr;
+	uint32_t *ptr32 = (uint32_t *)ptr;
+	uint64_t *ptr64 = (uint64_t *)ptr;
+
+	switch (size) {
+	case RTE_FIB6_TRIE_2B:
+		for (i = 0; i < n; i++)
+			ptr16[i] = (uint16_t)val;
+		break;
+	case RTE_FIB6_TRIE_4B:
+		for (i = 0; i < n; i++)
+			ptr32[i] = (uint32_t)val;
+		break;
+	case RTE_FIB6_TRIE_8B:
+		for (i = 0; i < n; i++)
+			ptr64[i] = (uint64_t)val;
+		break;
+	}
+}
+
+static int
+tbl8_alloc(struct rte_trie_tbl *dp, uint64_t nh)
+{
+	uint32_t tbl8_idx;
+
+	if (dp->tbl8_pool_pos == dp->number_tbl8s)
+		return -ENOSPC;
+	tbl8_idx = dp->tbl8_pool[dp->tbl8_pool_pos++];
+	dp->cur_tbl8s++;
+
+	/* Init tbl8 entries with the value of the entry they replace */
+	write_to_dp(get_tbl_p_by_idx(dp->tbl8,
+		(uint64_t)tbl8_idx * TRIE_TBL8_GRP_NUM_ENT, dp->nh_sz),
+		nh, dp->nh_sz, TRIE_TBL8_GRP_NUM_ENT);
+	/* Group content must be visible before the parent points to it */
+	rte_smp_wmb();
+
+	return tbl8_idx;
+}
+
+/*
+ * Return a tbl8 group and all its descendants to the pool.
+ * The group must not be referenced from the trie anymore; lookups
+ * running concurrently may still read it, as with rte_lpm6.
+ */
+static void
+tbl8_free(struct rte_trie_tbl *dp, uint32_t tbl8_idx)
+{
+	uint64_t base = (uint64_t)tbl8_idx * TRIE_TBL8_GRP_NUM_ENT;
+	uint64_t ent;
+	uint32_t i;
+
+	for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
+		ent = get_tbl_val_by_idx(dp->tbl8, base + i, dp->nh_sz);
+		if (is_entry_extended(ent))
+			tbl8_free(dp, ent >> 1);
+	}
+	dp->tbl8_pool[--dp->tbl8_pool_pos] = tbl8_idx;
+	dp->cur_tbl8s--;
+}
+
+/*
+ * Collapse the tbl8 group referenced by tbl[idx] if all its entries
+ * hold the same next hop.
+ */
+static void
+tbl8_recycle(struct rte_trie_tbl *dp, uint64_t *tbl, uint64_t idx,
+	uint32_t tbl8_idx)
+{
+	uint64_t base = (uint64_t)tbl8_idx * TRIE_TBL8_GRP_NUM_ENT;
+	uint64_t nh;
+	uint32_t i;
+
+	nh = get_tbl_val_by_idx(dp->tbl8, base, dp->nh_sz);
+	if (is_entry_extended(nh))
+		return;
+	for (i = 1; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
+		if (nh != get_tbl_val_by_idx(dp->tbl8, base + i, dp->nh_sz))
+			return;
+	}
+	set_tbl_val_by_idx(tbl, idx, nh, dp->nh_sz);
+	tbl8_free(dp, tbl8_idx);
+}
+
+/* Set n entries starting from tbl[idx], dropping the subtries they had */
+static void
+set_entries(struct rte_trie_tbl *dp, uint64_t *tbl, uint64_t idx,
+	uint64_t n, uint64_t val)
+{
+	uint64_t i, old;
+
+	for (i = idx; i < idx + n; i++) {
+		old = get_tbl_val_by_idx(tbl, i, dp->nh_sz);
+		set_tbl_val_by_idx(tbl, i, val, dp->nh_sz);
+		if (is_entry_extended(old))
+			tbl8_free(dp, old >> 1);
+	}
+}
+
+/* Index of the entry of the level starting at address byte pos */
+static inline uint32_t
+get_level_idx(const uint8_t *ip, int pos)
+{
+	return (pos == 0) ? get_tbl24_idx(ip) : ip[pos];
+}
+
+static inline int
+get_level_end(int pos)
+{
+	return (pos == 0) ? TRIE_TBL8_FIRST_BYTE : pos + 1;
+}
+
+/* Check that all the bytes of ip starting from pos are equal to val */
+static inline bool
+is_tail_filled(const uint8_t *ip, int pos, uint8_t val)
+{
+	for (; pos < RTE_FIB6_IPV6_ADDR_SIZE; pos++)
+		if (ip[pos] != val)
+			return false;
+	return true;
+}
+
+static int
+install_range(struct rte_trie_tbl *dp, uint64_t *tbl, uint64_t base, int pos,
+	const uint8_t *ledge, const uint8_t *redge, uint64_t val, bool dry);
+
+/*
+ * Install the range into the subtrie of entry tbl[base + idx],
+ * allocating the next level group if the entry holds a next hop.
+ * With dry set nothing is written and the number of groups which
+ * would be allocated is returned, tbl == NULL stands for a group
+ * which doesn't exist yet.
+ */
+static int
+install_to_subtrie(struct rte_trie_tbl *dp, uint64_t *tbl, uint64_t base,
+	uint32_t idx, int pos, const uint8_t *ledge, const uint8_t *redge,
+	uint64_t val, bool dry)
+{
+	uint64_t ent;
+	int tbl8_idx, ret;
+
+	ent = (tbl == NULL) ? 0 :
+		get_tbl_val_by_idx(tbl, base + idx, dp->nh_sz);
+
+	if (dry) {
+		if (!is_entry_extended(ent))
+			return 1 + install_range(dp, NULL, 0,
+				get_level_end(pos), ledge, redge, val, true);
+		return install_range(dp, dp->tbl8,
+			get_tbl8_idx(ent, 0), get_level_end(pos),
+			ledge, redge, val, true);
+	}
+
+	if (!is_entry_extended(ent)) {
+		tbl8_idx = tbl8_alloc(dp, ent);
+		if (tbl8_idx < 0)
+			return tbl8_idx;
+		set_tbl_val_by_idx(tbl, base + idx,
+			((uint64_t)tbl8_idx << 1) | TRIE_EXT_ENT, dp->nh_sz);
+	} else
+		tbl8_idx = ent >> 1;
+
+	ret = install_range(dp, dp->tbl8,
+		(uint64_t)tbl8_idx * TRIE_TBL8_GRP_NUM_ENT, get_level_end(pos),
+		ledge, redge, val, false);
+	tbl8_recycle(dp, tbl, base + idx, tbl8_idx);
+	return ret;
+}
+
+/*
+ * Install val for the [ledge, redge] address range inside the level
+ * starting at address byte pos whose first entry is tbl[base]. Entries
+ * fully covered by the range are written directly, the partially
+ * covered ones at the edges are handled in the next level.
+ */
+static int
+install_range(struct rte_trie_tbl *dp, uint64_t *tbl, uint64_t base, int pos,
+	const uint8_t *ledge, const uint8_t *redge, uint64_t val, bool dry)
+{
+	uint8_t edge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint32_t lidx, ridx;
+	int end = get_level_end(pos);
+	bool lfull, rfull;
+	int ret, cnt = 0;
+
+	lidx = get_level_idx(ledge, pos);
+	ridx = get_level_idx(redge, pos);
+	lfull = is_tail_filled(ledge, end, 0);
+	rfull = is_tail_filled(redge, end, UINT8_MAX);
+
+	if (lidx == ridx) {
+		if (lfull && rfull) {
+			if (!dry)
+				set_entries(dp, tbl, base + lidx, 1, val);
+			return 0;
+		}
+		return install_to_subtrie(dp, tbl, base, lidx, pos,
+			ledge, redge, val, dry);
+	}
+
+	if (lfull) {
+		if (!dry)
+			set_entries(dp, tbl, base + lidx, 1, val);
+	} else {
+		memcpy(edge, ledge, RTE_FIB6_IPV6_ADDR_SIZE);
+		memset(edge + end, UINT8_MAX, RTE_FIB6_IPV6_ADDR_SIZE - end);
+		ret = install_to_subtrie(dp, tbl, base, lidx, pos,
+			ledge, edge, val, dry);
+		if (ret < 0)
+			return ret;
+		cnt += ret;
+	}
+
+	if ((ridx - lidx > 1) && !dry)
+		set_entries(dp, tbl, base + lidx + 1, ridx - lidx - 1, val);
+
+	if (rfull) {
+		if (!dry)
+			set_entries(dp, tbl, base + ridx, 1, val);
+	} else {
+		memcpy(edge, redge, RTE_FIB6_IPV6_ADDR_SIZE);
+		memset(edge + end, 0, RTE_FIB6_IPV6_ADDR_SIZE - end);
+		ret = install_to_subtrie(dp, tbl, base, ridx, pos,
+			edge, redge, val, dry);
+		if (ret < 0)
+			return ret;
+		cnt += ret;
+	}
+
+	return dry ? cnt : 0;
+}
+
+/* Add one to a 128 bit address, return true if it wrapped around */
+static inline bool
+ip6_inc(uint8_t *ip)
+{
+	int i;
+
+	for (i = RTE_FIB6_IPV6_ADDR_SIZE - 1; i >= 0; i--)
+		if (++ip[i] != 0)
+			return false;
+	return true;
+}
+
+static inline void
+ip6_dec(uint8_t *ip)
+{
+	int i;
+
+	for (i = RTE_FIB6_IPV6_ADDR_SIZE - 1; i >= 0; i--)
+		if (ip[i]-- != 0)
+			return;
+}
+
+static inline void
+get_last_addr(uint8_t *ip, uint8_t depth)
+{
+	int i;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
+		ip[i] |= ~get_msk_part(depth, i);
+}
+
+/*
+ * Go through the parts of the ip/depth prefix which are not covered by
+ * more specific routes and install next_hop there. The first pass only
+ * counts the tbl8 groups to be allocated, so the trie is either fully
+ * updated or left unchanged.
+ */
+static int
+modify_dp(struct rte_trie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib6_node *tmp;
+	uint8_t ledge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t redge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t tmp_depth;
+	uint32_t need_tbl8;
+	bool ledge_valid;
+	int dry, ret;
+
+	for (dry = 1; dry >= 0; dry--) {
+		need_tbl8 = 0;
+		tmp = NULL;
+		memcpy(ledge, ip, RTE_FIB6_IPV6_ADDR_SIZE);
+		ledge_valid = true;
+		do {
+			tmp = rte_rib6_get_nxt(rib, ip, depth, tmp,
+				RTE_RIB6_GET_NXT_COVER);
+			if (tmp != NULL) {
+				rte_rib6_get_depth(tmp, &tmp_depth);
+				rte_rib6_get_ip(tmp, redge);
+				if (!ledge_valid ||
+						rte_rib6_is_equal(ledge, redge))
+					ret = 0;
+				else {
+					ip6_dec(redge);
+					ret = install_range(dp, dp->tbl24, 0, 0,
+						ledge, redge, next_hop << 1,
+						dry);
+				}
+				/* next range starts right after tmp */
+				rte_rib6_get_ip(tmp, ledge);
+				get_last_addr(ledge, tmp_depth);
+				ledge_valid = !ip6_inc(ledge);
+			} else {
+				memcpy(redge, ip, RTE_FIB6_IPV6_ADDR_SIZE);
+				get_last_addr(redge, depth);
+				if (!ledge_valid ||
+						memcmp(ledge, redge,
+						RTE_FIB6_IPV6_ADDR_SIZE) > 0)
+					ret = 0;
+				else
+					ret = install_range(dp, dp->tbl24, 0, 0,
+						ledge, redge, next_hop << 1,
+						dry);
+			}
+			if (ret < 0)
+				return ret;
+			need_tbl8 += ret;
+		} while (tmp != NULL);
+
+		if (dry && (need_tbl8 > dp->number_tbl8s - dp->cur_tbl8s))
+			return -ENOSPC;
+	}
+
+	return 0;
+}
+
+int
+trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop, int op)
+{
+	struct rte_trie_tbl *dp;
+	struct rte_rib6 *rib;
+	struct rte_rib6_node *node;
+	struct rte_rib6_node *parent;
+	uint8_t ip_masked[RTE_FIB6_IPV6_ADDR_SIZE];
+	int i, ret = 0;
+	uint64_t par_nh, node_nh;
+
+	if ((fib == NULL) || (ip == NULL) || (depth > RTE_FIB6_MAXDEPTH))
+		return -EINVAL;
+
+	dp = rte_fib6_get_dp(fib);
+	rib = rte_fib6_get_rib(fib);
+	RTE_ASSERT((dp != NULL) && (rib != NULL));
+
+	if (next_hop > get_max_nh(dp->nh_sz))
+		return -EINVAL;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
+		ip_masked[i] = ip[i] & get_msk_part(depth, i);
+
+	node = rte_rib6_lookup_exact(rib, ip_masked, depth);
+	switch (op) {
+	case RTE_FIB6_ADD:
+		if (node != NULL) {
+			rte_rib6_get_nh(node, &node_nh);
+			if (node_nh == next_hop)
+				return 0;
+			ret = modify_dp(dp, rib, ip_masked, depth, next_hop);
+			if (ret == 0)
+				rte_rib6_set_nh(node, next_hop);
+			return ret;
+		}
+
+		node = rte_rib6_insert(rib, ip_masked, depth);
+		if (node == NULL)
+			return -rte_errno;
+		rte_rib6_set_nh(node, next_hop);
+
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL) {
+			rte_rib6_get_nh(parent, &par_nh);
+			if (par_nh == next_hop)
+				return 0;
+		} else if (next_hop == dp->def_nh)
+			return 0;
+
+		ret = modify_dp(dp, rib, ip_masked, depth, next_hop);
+		if (ret != 0)
+			rte_rib6_remove(rib, ip_masked, depth);
+		return ret;
+	case RTE_FIB6_DEL:
+		if (node == NULL)
+			return -ENOENT;
+
+		rte_rib6_get_nh(node, &node_nh);
+		parent = rte_rib6_lookup_parent(node);
+		if (parent != NULL)
+			rte_rib6_get_nh(parent, &par_nh);
+		else
+			par_nh = dp->def_nh;
+		if (par_nh != node_nh)
+			ret = modify_dp(dp, rib, ip_masked, depth, par_nh);
+		if (ret == 0)
+			rte_rib6_remove(rib, ip_masked, depth);
+		return ret;
+	default:
+		break;
+	}
+	return -EINVAL;
+}
+
+void *
+trie_create(const char *name, int socket_id, struct rte_fib6_conf *conf)
+{
+	char mem_name[TRIE_NAMESIZE];
+	struct rte_trie_tbl *dp = NULL;
+	uint64_t def_nh;
+	uint32_t num_tbl8;
+	uint32_t i;
+	enum rte_fib_trie_nh_sz nh_sz;
+
+	if ((name == NULL) || (conf == NULL) ||
+			(conf->trie.nh_sz < RTE_FIB6_TRIE_2B) ||
+			(conf->trie.nh_sz > RTE_FIB6_TRIE_8B) ||
+			(conf->trie.num_tbl8 >
+			get_max_nh(conf->trie.nh_sz)) ||
+			(conf->trie.num_tbl8 == 0) ||
+			(conf->default_nh >
+			get_max_nh(conf->trie.nh_sz))) {
+
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	def_nh = conf->default_nh;
+	nh_sz = conf->trie.nh_sz;
+	num_tbl8 = conf->trie.num_tbl8;
+
+	snprintf(mem_name, sizeof(mem_name), "DP_%s", name);
+	dp = rte_zmalloc_socket(mem_name, sizeof(struct rte_trie_tbl) +
+		TRIE_TBL24_NUM_ENT * (1 << nh_sz), RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (dp == NULL) {
+		rte_errno = ENOMEM;
+		return dp;
+	}
+
+	write_to_dp(&dp->tbl24, (def_nh << 1), nh_sz, 1 << 24);
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_%p", dp);
+	dp->tbl8 = rte_zmalloc_socket(mem_name, TRIE_TBL8_GRP_NUM_ENT *
+			(1ll << nh_sz) * num_tbl8, RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (dp->tbl8 == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp);
+		return NULL;
+	}
+	dp->def_nh = def_nh;
+	dp->nh_sz = nh_sz;
+	dp->number_tbl8s = num_tbl8;
+
+	snprintf(mem_name, sizeof(mem_name), "TBL8_idxes_%p", dp);
+	dp->tbl8_pool = rte_zmalloc_socket(mem_name,
+			sizeof(uint32_t) * dp->number_tbl8s,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (dp->tbl8_pool == NULL) {
+		rte_errno = ENOMEM;
+		rte_free(dp->tbl8);
+		rte_free(dp);
+		return NULL;
+	}
+
+	for (i = 0; i < dp->number_tbl8s; i++)
+		dp->tbl8_pool[i] = i;
+
+	return dp;
+}
+
+void
+trie_free(void *p)
+{
+	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;
+
+	rte_free(dp->tbl8_pool);
+	rte_free(dp->tbl8);
+	rte_free(dp);
+}
@@ -0,0 +1,228 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _TRIE_H_
+#define _TRIE_H_
+
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+
+/**
+ * @file
+ * RTE IPv6 Longest Prefix Match (LPM)
+ *
+ * Multibit trie: the first 24 bits of the address index tbl24, every
+ * following byte indexes a 256 entry tbl8 group, so a lookup takes at
+ * most 14 memory accesses. An entry holds either a next hop or, if its
+ * least significant bit is set, the index of the next level tbl8 group.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRIE_TBL24_NUM_ENT		(1 << 24)
+#define TRIE_TBL8_GRP_NUM_ENT		256U
+#define TRIE_EXT_ENT			1
+/* address byte indexing the first tbl8 level */
+#define TRIE_TBL8_FIRST_BYTE		3
+/* number of addresses walked in lockstep by the batched lookup */
+#define TRIE_LOOKUP_BATCH		16
+
+struct rte_trie_tbl {
+	uint32_t	number_tbl8s;	/**< Total number of tbl8s */
+	uint32_t	cur_tbl8s;	/**< Current number of tbl8s */
+	uint64_t	def_nh;		/**< Default next hop */
+	enum rte_fib_trie_nh_sz	nh_sz;	/**< Size of nexthop entry */
+	uint64_t	*tbl8;		/**< tbl8 table. */
+	uint32_t	*tbl8_pool;	/**< stack of free tbl8 idxes */
+	uint32_t	tbl8_pool_pos;	/**< Number of tbl8s taken from pool */
+	/* tbl24 table. */
+	__extension__ uint64_t	tbl24[0] __rte_cache_aligned;
+};
+
+static inline uint32_t
+get_tbl24_idx(const uint8_t *ip)
+{
+	return ip[0] << 16|ip[1] << 8|ip[2];
+}
+
+static inline void *
+get_tbl_p_by_idx(uint64_t *tbl, uint64_t idx, enum rte_fib_trie_nh_sz nh_sz)
+{
+	return (uint8_t *)tbl + (idx << nh_sz);
+}
+
+static inline uint64_t
+get_tbl_val_by_idx(uint64_t *tbl, uint64_t idx,
+	enum rte_fib_trie_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		return ((uint16_t *)tbl)[idx];
+	case RTE_FIB6_TRIE_4B:
+		return ((uint32_t *)tbl)[idx];
+	case RTE_FIB6_TRIE_8B:
+	default:
+		return tbl[idx];
+	}
+}
+
+static inline void
+set_tbl_val_by_idx(uint64_t *tbl, uint64_t idx, uint64_t val,
+	enum rte_fib_trie_nh_sz nh_sz)
+{
+	switch (nh_sz) {
+	case RTE_FIB6_TRIE_2B:
+		((uint16_t *)tbl)[idx] = (uint16_t)val;
+		break;
+	case RTE_FIB6_TRIE_4B:
+		((uint32_t *)tbl)[idx] = (uint32_t)val;
+		break;
+	case RTE_FIB6_TRIE_8B:
+	default:
+		tbl[idx] = val;
+		break;
+	}
+}
+
+static inline uint64_t
+get_tbl8_idx(uint64_t ent, uint8_t byte)
+{
+	return (ent >> 1) * TRIE_TBL8_GRP_NUM_ENT + byte;
+}
+
+static inline int
+is_entry_extended(uint64_t ent)
+{
+	return (ent & TRIE_EXT_ENT) == TRIE_EXT_ENT;
+}
+
+/* Walk the trie for one address after another */
+static __rte_always_inline void
+trie_lookup_bulk(void *p, uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, const unsigned int n,
+	enum rte_fib_trie_nh_sz nh_sz)
+{
+	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;
+	uint64_t tmp;
+	uint32_t i, j;
+	uint32_t prefetch_offset = RTE_MIN(15U, n);
+
+	for (i = 0; i < prefetch_offset; i++)
+		rte_prefetch0(get_tbl_p_by_idx(dp->tbl24,
+			get_tbl24_idx(ips[i]), nh_sz));
+	for (i = 0; i < n; i++) {
+		if (i + prefetch_offset < n)
+			rte_prefetch0(get_tbl_p_by_idx(dp->tbl24,
+				get_tbl24_idx(ips[i + prefetch_offset]),
+				nh_sz));
+		tmp = get_tbl_val_by_idx(dp->tbl24, get_tbl24_idx(ips[i]),
+			nh_sz);
+		j = TRIE_TBL8_FIRST_BYTE;
+		while (is_entry_extended(tmp))
+			tmp = get_tbl_val_by_idx(dp->tbl8,
+				get_tbl8_idx(tmp, ips[i][j++]), nh_sz);
+		next_hops[i] = tmp >> 1;
+	}
+}
+
+/*
+ * Walk the trie for up to TRIE_LOOKUP_BATCH addresses in lockstep:
+ * all the unresolved addresses of the batch are at the same level, so
+ * the loads of one level are independent of each other and the next
+ * level entries are prefetched while the rest of the batch is processed.
+ */
+static __rte_always_inline void
+trie_lookup_batch(void *p, uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],
+	uint64_t *next_hops, const unsigned int n,
+	enum rte_fib_trie_nh_sz nh_sz)
+{
+	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;
+	uint64_t ent[TRIE_LOOKUP_BATCH];
+	uint64_t idx;
+	uint32_t i, j, k, nb, active, pending;
+
+	for (i = 0; i < n; i += nb) {
+		nb = RTE_MIN((unsigned int)TRIE_LOOKUP_BATCH, n - i);
+
+		for (j = 0; j < nb; j++)
+			rte_prefetch0(get_tbl_p_by_idx(dp->tbl24,
+				get_tbl24_idx(ips[i + j]), nh_sz));
+
+		active = 0;
+		for (j = 0; j < nb; j++) {
+			ent[j] = get_tbl_val_by_idx(dp->tbl24,
+				get_tbl24_idx(ips[i + j]), nh_sz);
+			if (unlikely(is_entry_extended(ent[j]))) {
+				active |= 1U << j;
+				rte_prefetch0(get_tbl_p_by_idx(dp->tbl8,
+					get_tbl8_idx(ent[j],
+					ips[i + j][TRIE_TBL8_FIRST_BYTE]),
+					nh_sz));
+			} else
+				next_hops[i + j] = ent[j] >> 1;
+		}
+
+		for (k = TRIE_TBL8_FIRST_BYTE; active != 0; k++) {
+			pending = active;
+			while (pending != 0) {
+				j = __builtin_ctz(pending);
+				pending &= pending - 1;
+				idx = get_tbl8_idx(ent[j], ips[i + j][k]);
+				ent[j] = get_tbl_val_by_idx(dp->tbl8, idx,
+					nh_sz);
+				if (is_entry_extended(ent[j]))
+					rte_prefetch0(get_tbl_p_by_idx(
+						dp->tbl8,
+						get_tbl8_idx(ent[j],
+						ips[i + j][k + 1]), nh_sz));
+				else {
+					next_hops[i + j] = ent[j] >> 1;
+					active &= ~(1U << j);
+				}
+			}
+		}
+	}
+}
+
+#define LOOKUP_FUNC(suffix, nh_sz)					\
+static inline void							\
+rte_trie_lookup_bulk_##suffix(void *p,					\
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],				\
+	uint64_t *next_hops, const unsigned int n)			\
+{									\
+	trie_lookup_bulk(p, ips, next_hops, n, nh_sz);			\
+}									\
+									\
+static inline void							\
+rte_trie_lookup_batch_##suffix(void *p,					\
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE],				\
+	uint64_t *next_hops, const unsigned int n)			\
+{									\
+	trie_lookup_batch(p, ips, next_hops, n, nh_sz);			\
+}
+
+LOOKUP_FUNC(2b, RTE_FIB6_TRIE_2B)
+LOOKUP_FUNC(4b, RTE_FIB6_TRIE_4B)
+LOOKUP_FUNC(8b, RTE_FIB6_TRIE_8B)
+
+void *
+trie_create(const char *name, int socket_id, struct rte_fib6_conf *conf);
+
+void
+trie_free(void *p);
+
+rte_fib6_lookup_fn_t
+trie_get_lookup_fn(void *p, enum rte_fib6_lookup_type type);
+
+int
+trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth, uint64_t next_hop, int op);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TRIE_H_ */
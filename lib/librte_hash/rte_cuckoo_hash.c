@@ -32,6 +32,34 @@
 #include "rte_hash.h"
 #include "rte_cuckoo_hash.h"
 
+#ifdef CC_HASH_AVX512_SUPPORT
+#include "rte_cuckoo_hash_avx512.h"
+#endif
+
+/*
+ * Table storing all different key compare functions
+ * (multi-process supported)
+ */
+#if defined(RTE_ARCH_X86) || defined(RTE_ARCH_ARM64)
+const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
+	NULL,
+	rte_hash_k16_cmp_eq,
+	rte_hash_k32_cmp_eq,
+	rte_hash_k48_cmp_eq,
+	rte_hash_k64_cmp_eq,
+	rte_hash_k80_cmp_eq,
+	rte_hash_k96_cmp_eq,
+	rte_hash_k112_cmp_eq,
+	rte_hash_k128_cmp_eq,
+	memcmp
+};
+#else
+const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
+	NULL,
+	memcmp
+};
+#endif
+
 #define FOR_EACH_BUCKET(CURRENT_BKT, START_BUCKET)                            \
 	for (CURRENT_BKT = START_BUCKET;                                      \
 		CURRENT_BKT != NULL;                                          \
@@ -121,6 +149,42 @@ get_alt_bucket_index(const struct rte_hash *h,
 	return (cur_bkt_idx ^ sig) & h->bucket_bitmask;
 }
 
+/*
+ * Return the key store entry of a key index. Each grow of a resizable table
+ * adds a key store segment as large as the table was, so key index i > E0,
+ * E0 being the size of the first segment, is found in segment
+ * log2((i - 1) / E0) + 1.
+ */
+static inline struct rte_hash_key *
+get_key_slot(const struct rte_hash *h, uint32_t key_idx)
+{
+	uint32_t seg;
+
+	if (likely(!h->resizable || key_idx <= (1U << h->key_seg_shift)))
+		return RTE_PTR_ADD(h->key_store,
+				(uintptr_t)key_idx * h->key_entry_size);
+
+	seg = 32 - __builtin_clz((key_idx - 1) >> h->key_seg_shift);
+	return RTE_PTR_ADD(h->key_segs[seg],
+			(uintptr_t)(key_idx - 1 -
+			(1U << (h->key_seg_shift + seg - 1))) *
+			h->key_entry_size);
+}
+
+/* Return the hash of the key of a key index in a resizable table */
+static inline hash_sig_t *
+get_key_sig(const struct rte_hash *h, uint32_t key_idx)
+{
+	uint32_t seg;
+
+	if (key_idx <= (1U << h->key_seg_shift))
+		return &h->sig_segs[0][key_idx];
+
+	seg = 32 - __builtin_clz((key_idx - 1) >> h->key_seg_shift);
+	return &h->sig_segs[seg][key_idx - 1 -
+			(1U << (h->key_seg_shift + seg - 1))];
+}
+
 struct rte_hash *
 rte_hash_create(const struct rte_hash_parameters *params)
 {
@@ -131,6 +195,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	struct rte_ring *r_ext = NULL;
 	char hash_name[RTE_HASH_NAMESIZE];
 	void *k = NULL;
+	hash_sig_t *sigs = NULL;
 	void *buckets = NULL;
 	void *buckets_ext = NULL;
 	char ring_name[RTE_RING_NAMESIZE];
@@ -145,6 +210,8 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	uint32_t *ext_bkt_to_free = NULL;
 	uint32_t *tbl_chng_cnt = NULL;
 	unsigned int readwrite_concur_lf_support = 0;
+	unsigned int resizable = 0;
+	uint32_t entries;
 
 	rte_hash_function default_hash_func = (rte_hash_function)rte_jhash;
 
@@ -173,6 +240,26 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		return NULL;
 	}
 
+	if ((params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE) &&
+	    (params->extra_flag & (RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD |
+				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE))) {
+		rte_errno = EINVAL;
+		RTE_LOG(ERR, HASH, "rte_hash_create: resizable table does not "
+			"support multi writer or extendable buckets\n");
+		return NULL;
+	}
+
+	/* The free slots rings of a resizable table are named HT<n>_<name> */
+	if ((params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE) &&
+	    snprintf(ring_name, sizeof(ring_name), "HT%u_%s",
+			RTE_HASH_RESIZE_MAX, params->name) >=
+			(int)sizeof(ring_name)) {
+		rte_errno = ENAMETOOLONG;
+		RTE_LOG(ERR, HASH, "rte_hash_create: name of resizable table "
+			"%s is too long\n", params->name);
+		return NULL;
+	}
+
 	/* Check extra flags field to check extra options. */
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT)
 		hw_trans_mem_support = 1;
@@ -199,6 +286,15 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		no_free_on_del = 1;
 	}
 
+	/* Resizable table grows its key store by doubling it, keep the
+	 * number of entries a power of 2 to locate key store segments.
+	 */
+	entries = params->entries;
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RESIZABLE) {
+		resizable = 1;
+		entries = rte_align32pow2(entries);
+	}
+
 	/* Store all keys and leave the first entry as a dummy entry for lookup_bulk */
 	if (use_local_cache)
 		/*
@@ -206,10 +302,10 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		 * that can be stored in the lcore caches
 		 * except for the first cache
 		 */
-		num_key_slots = params->entries + (RTE_MAX_LCORE - 1) *
+		num_key_slots = entries + (RTE_MAX_LCORE - 1) *
 					(LCORE_CACHE_SIZE - 1) + 1;
 	else
-		num_key_slots = params->entries + 1;
+		num_key_slots = entries + 1;
 
 	snprintf(ring_name, sizeof(ring_name), "HT_%s", params->name);
 	/* Create ring (Dummy slot index is not enqueued) */
@@ -220,7 +316,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err;
 	}
 
-	const uint32_t num_buckets = rte_align32pow2(params->entries) /
+	const uint32_t num_buckets = rte_align32pow2(entries) /
 						RTE_HASH_BUCKET_ENTRIES;
 
 	/* Create ring for extendable buckets. */
@@ -321,6 +417,16 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err_unlock;
 	}
 
+	if (resizable) {
+		sigs = rte_zmalloc_socket(NULL,
+				(size_t)num_key_slots * sizeof(hash_sig_t),
+				RTE_CACHE_LINE_SIZE, params->socket_id);
+		if (sigs == NULL) {
+			RTE_LOG(ERR, HASH, "memory allocation failed\n");
+			goto err_unlock;
+		}
+	}
+
 	tbl_chng_cnt = rte_zmalloc_socket(NULL, sizeof(uint32_t),
 			RTE_CACHE_LINE_SIZE, params->socket_id);
 
@@ -383,7 +489,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 #endif
 	/* Setup hash context */
 	strlcpy(h->name, params->name, sizeof(h->name));
-	h->entries = params->entries;
+	h->entries = entries;
 	h->key_len = params->key_len;
 	h->key_entry_size = key_entry_size;
 	h->hash_func_init_val = params->hash_func_init_val;
@@ -407,8 +513,29 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->writer_takes_lock = writer_takes_lock;
 	h->no_free_on_del = no_free_on_del;
 	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->resizable = resizable;
+	h->socket_id = params->socket_id;
+	if (resizable) {
+		h->key_seg_shift = rte_bsf32(entries);
+		h->key_segs[0] = k;
+		h->sig_segs[0] = sigs;
+		h->rs_tbls[0].buckets = buckets;
+		h->rs_tbls[0].bucket_bitmask = h->bucket_bitmask;
+		h->rs_tbl = &h->rs_tbls[0];
+	}
 
 #if defined(RTE_ARCH_X86)
+#if defined(CC_HASH_AVX512_SUPPORT)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) > 0 &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW) > 0)
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX512;
+	else
+#endif
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		h->sig_cmp_fn = RTE_HASH_COMPARE_AVX2;
+	else
+#endif
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
 		h->sig_cmp_fn = RTE_HASH_COMPARE_SSE;
 	else
@@ -451,16 +578,33 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	rte_free(buckets);
 	rte_free(buckets_ext);
 	rte_free(k);
+	rte_free(sigs);
 	rte_free(tbl_chng_cnt);
 	rte_free(ext_bkt_to_free);
 	return NULL;
 }
 
+/* Free the bucket arrays a resizable table has migrated or is migrating
+ * from. Readers must not be referencing the table.
+ */
+static void
+rte_hash_free_old_buckets(struct rte_hash *h)
+{
+	uint32_t i;
+
+	for (i = 0; i < h->resize_cnt; i++) {
+		rte_free(h->buckets_retired[i]);
+		h->buckets_retired[i] = NULL;
+	}
+	rte_free(h->rs_tbl->buckets_old);
+}
+
 void
 rte_hash_free(struct rte_hash *h)
 {
 	struct rte_tailq_entry *te;
 	struct rte_hash_list *hash_list;
+	uint32_t i;
 
 	if (h == NULL)
 		return;
@@ -484,6 +628,13 @@ rte_hash_free(struct rte_hash *h)
 
 	rte_mcfg_tailq_write_unlock();
 
+	if (h->resizable) {
+		for (i = 1; i <= h->resize_cnt; i++)
+			rte_free(h->key_segs[i]);
+		for (i = 0; i <= h->resize_cnt; i++)
+			rte_free(h->sig_segs[i]);
+		rte_hash_free_old_buckets(h);
+	}
 	if (h->use_local_cache)
 		rte_free(h->local_free_slots);
 	if (h->writer_takes_lock)
@@ -577,7 +728,21 @@ rte_hash_reset(struct rte_hash *h)
 
 	__hash_rw_writer_lock(h);
 	memset(h->buckets, 0, h->num_buckets * sizeof(struct rte_hash_bucket));
-	memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
+	if (h->resizable) {
+		memset(h->key_store, 0, h->key_entry_size *
+				((1U << h->key_seg_shift) + 1));
+		for (i = 1; i <= h->resize_cnt; i++)
+			memset(h->key_segs[i], 0, (size_t)h->key_entry_size <<
+					(h->key_seg_shift + i - 1));
+		/* Keep the current size, drop any ongoing migration */
+		rte_hash_free_old_buckets(h);
+		h->rs_tbls[0].buckets = h->buckets;
+		h->rs_tbls[0].buckets_old = NULL;
+		h->rs_tbls[0].bucket_bitmask = h->bucket_bitmask;
+		h->rs_tbl = &h->rs_tbls[0];
+		h->migrate_bkt = 0;
+	} else
+		memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
 	*h->tbl_chng_cnt = 0;
 
 	/* reset the free ring */
@@ -640,12 +805,11 @@ search_and_update(const struct rte_hash *h, void *data, const void *key,
 	struct rte_hash_bucket *bkt, uint16_t sig)
 {
 	int i;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		if (bkt->sig_current[i] == sig) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+			k = get_key_slot(h, bkt->key_idx[i]);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				/* The store to application data at *data
 				 * should not leak after the store to pdata
@@ -915,6 +1079,230 @@ rte_hash_cuckoo_make_space_mw(const struct rte_hash *h,
 	return -ENOSPC;
 }
 
+/*
+ * Move up to @num_bkts buckets of the old bucket array of a resizable table
+ * to the current one. Each entry is inserted in the current array before it
+ * is removed from the old one, and the readers, which search both arrays,
+ * are informed in between. The old array is released when it is empty.
+ * Only called by the writer.
+ */
+static int
+rte_hash_migrate(struct rte_hash *h, uint32_t num_bkts)
+{
+	struct rte_hash_bucket *old_bkts = h->rs_tbl->buckets_old;
+	struct rte_hash_bucket *old_bkt, *prim_bkt, *sec_bkt;
+	const uint32_t old_num_buckets = h->num_buckets >> 1;
+	struct rte_hash_rs_tbl *rs_tbl;
+	struct rte_hash_key *k;
+	uint32_t prim_bucket_idx, sec_bucket_idx, key_idx;
+	hash_sig_t sig;
+	uint16_t short_sig;
+	int32_t ret, ret_val;
+	unsigned int i;
+
+	if (old_bkts == NULL)
+		return 0;
+
+	for (; num_bkts > 0 && h->migrate_bkt < old_num_buckets;
+			num_bkts--, h->migrate_bkt++) {
+		old_bkt = &old_bkts[h->migrate_bkt];
+		for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+			key_idx = old_bkt->key_idx[i];
+			if (key_idx == EMPTY_SLOT)
+				continue;
+
+			k = get_key_slot(h, key_idx);
+			sig = *get_key_sig(h, key_idx);
+			short_sig = get_short_sig(sig);
+			prim_bucket_idx = get_prim_bucket_index(h, sig);
+			sec_bucket_idx = get_alt_bucket_index(h,
+						prim_bucket_idx, short_sig);
+			prim_bkt = &h->buckets[prim_bucket_idx];
+			sec_bkt = &h->buckets[sec_bucket_idx];
+
+			ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt,
+					(const void *)k->key, k->pdata,
+					short_sig, key_idx, &ret_val);
+			if (ret == -1)
+				ret = rte_hash_cuckoo_make_space_mw(h,
+					prim_bkt, sec_bkt,
+					(const void *)k->key, k->pdata,
+					short_sig, prim_bucket_idx, key_idx,
+					&ret_val);
+			if (ret < 0)
+				ret = rte_hash_cuckoo_make_space_mw(h,
+					sec_bkt, prim_bkt,
+					(const void *)k->key, k->pdata,
+					short_sig, sec_bucket_idx, key_idx,
+					&ret_val);
+			/* Entry stays in the old array, retry on next call */
+			if (ret < 0)
+				return -ENOSPC;
+
+			__hash_rw_writer_lock(h);
+			if (h->readwrite_concur_lf_support) {
+				/* Inform the readers that the entry is
+				 * removed from the old array. Since there
+				 * is one writer, load acquire on
+				 * tbl_chng_cnt is not required.
+				 */
+				__atomic_store_n(h->tbl_chng_cnt,
+						 *h->tbl_chng_cnt + 1,
+						 __ATOMIC_RELEASE);
+				/* The store to sig_current should not
+				 * move above the store to tbl_chng_cnt.
+				 */
+				__atomic_thread_fence(__ATOMIC_RELEASE);
+			}
+			old_bkt->sig_current[i] = NULL_SIGNATURE;
+			__atomic_store_n(&old_bkt->key_idx[i],
+					 EMPTY_SLOT,
+					 __ATOMIC_RELEASE);
+			__hash_rw_writer_unlock(h);
+		}
+	}
+
+	if (h->migrate_bkt != old_num_buckets)
+		return 0;
+
+	/* All entries are in the current array, stop searching the old one */
+	rs_tbl = &h->rs_tbls[2 * h->resize_cnt];
+	rs_tbl->buckets = h->buckets;
+	rs_tbl->buckets_old = NULL;
+	rs_tbl->bucket_bitmask = h->bucket_bitmask;
+	__hash_rw_writer_lock(h);
+	__atomic_store_n(&h->rs_tbl, rs_tbl, __ATOMIC_RELEASE);
+	__hash_rw_writer_unlock(h);
+
+	/* Lock free readers may still be walking the old array */
+	if (h->readwrite_concur_lf_support)
+		h->buckets_retired[h->resize_cnt - 1] = old_bkts;
+	else
+		rte_free(old_bkts);
+
+	return 0;
+}
+
+/*
+ * Double the number of entries of a resizable table: add a key store
+ * segment, replace the free slots ring by a larger one and start migrating
+ * to a bucket array twice as large. Only called by the writer.
+ */
+static int
+rte_hash_grow(struct rte_hash *h)
+{
+	const uint32_t new_entries = h->entries << 1;
+	struct rte_hash_bucket *buckets = NULL;
+	struct rte_hash_rs_tbl *rs_tbl;
+	char ring_name[RTE_RING_NAMESIZE];
+	struct rte_ring *r = NULL;
+	void *objs[LCORE_CACHE_SIZE];
+	hash_sig_t *sig_seg = NULL;
+	void *seg = NULL;
+	unsigned int n;
+	uint32_t i;
+	int ret;
+
+	/* Finish the previous resize first */
+	if (rte_hash_migrate(h, UINT32_MAX) != 0)
+		return -ENOSPC;
+
+	if (new_entries > RTE_HASH_ENTRIES_MAX ||
+			h->resize_cnt == RTE_HASH_RESIZE_MAX)
+		return -ENOSPC;
+
+	seg = rte_zmalloc_socket(NULL, (size_t)h->key_entry_size * h->entries,
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (seg == NULL)
+		goto err;
+
+	sig_seg = rte_zmalloc_socket(NULL, sizeof(hash_sig_t) * h->entries,
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (sig_seg == NULL)
+		goto err;
+
+	buckets = rte_zmalloc_socket(NULL,
+			(size_t)h->num_buckets * 2 *
+			sizeof(struct rte_hash_bucket),
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (buckets == NULL)
+		goto err;
+
+	/* Checked at creation, a truncated name could collide */
+	ret = snprintf(ring_name, sizeof(ring_name), "HT%u_%s",
+			h->resize_cnt + 1, h->name);
+	if (ret < 0 || ret >= (int)sizeof(ring_name)) {
+		RTE_LOG(ERR, HASH, "%s: ring name of table %s too long\n",
+				__func__, h->name);
+		goto err_free;
+	}
+	r = rte_ring_create(ring_name, rte_align32pow2(new_entries + 1),
+			h->socket_id, 0);
+	if (r == NULL)
+		goto err;
+
+	/* Move the free slots, then add the slots of the new segment */
+	while ((n = rte_ring_sc_dequeue_burst(h->free_slots, objs,
+				RTE_DIM(objs), NULL)) != 0)
+		rte_ring_sp_enqueue_bulk(r, objs, n, NULL);
+	for (i = h->entries + 1; i <= new_entries; i++)
+		rte_ring_sp_enqueue(r, (void *)((uintptr_t)i));
+	rte_ring_free(h->free_slots);
+	h->free_slots = r;
+	h->key_segs[h->resize_cnt + 1] = seg;
+	h->sig_segs[h->resize_cnt + 1] = sig_seg;
+
+	/* Readers search the new array, then the old one until migrated */
+	rs_tbl = &h->rs_tbls[2 * h->resize_cnt + 1];
+	rs_tbl->buckets = buckets;
+	rs_tbl->buckets_old = h->buckets;
+	rs_tbl->bucket_bitmask = (h->num_buckets << 1) - 1;
+
+	__hash_rw_writer_lock(h);
+	__atomic_store_n(&h->rs_tbl, rs_tbl, __ATOMIC_RELEASE);
+	h->buckets = buckets;
+	h->num_buckets <<= 1;
+	h->bucket_bitmask = h->num_buckets - 1;
+	h->entries = new_entries;
+	h->migrate_bkt = 0;
+	h->resize_cnt++;
+	__hash_rw_writer_unlock(h);
+
+	RTE_LOG(DEBUG, HASH, "%s: table %s grown to %u entries\n",
+			__func__, h->name, new_entries);
+
+	return 0;
+err:
+	RTE_LOG(ERR, HASH, "%s: memory allocation failed\n", __func__);
+err_free:
+	rte_free(seg);
+	rte_free(sig_seg);
+	rte_free(buckets);
+	return -ENOSPC;
+}
+
+/* Search a key in the bucket array a resizable table is migrating from and
+ * update its data. Writer holds the lock before calling this.
+ */
+static inline int32_t
+search_and_update_old(const struct rte_hash *h, void *data, const void *key,
+			hash_sig_t sig)
+{
+	struct rte_hash_bucket *old_bkts = h->rs_tbl->buckets_old;
+	const uint32_t old_bitmask = h->bucket_bitmask >> 1;
+	uint16_t short_sig = get_short_sig(sig);
+	uint32_t prim_bucket_idx = sig & old_bitmask;
+	uint32_t sec_bucket_idx = (prim_bucket_idx ^ short_sig) & old_bitmask;
+	int32_t ret;
+
+	ret = search_and_update(h, data, key, &old_bkts[prim_bucket_idx],
+				short_sig);
+	if (ret != -1)
+		return ret;
+	return search_and_update(h, data, key, &old_bkts[sec_bucket_idx],
+				short_sig);
+}
+
 static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig, void *data)
@@ -922,7 +1310,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	uint16_t short_sig;
 	uint32_t prim_bucket_idx, sec_bucket_idx;
 	struct rte_hash_bucket *prim_bkt, *sec_bkt, *cur_bkt;
-	struct rte_hash_key *new_k, *keys = h->key_store;
+	struct rte_hash_key *new_k;
 	void *slot_id = NULL;
 	void *ext_bkt_id = NULL;
 	uint32_t new_idx, bkt_id;
@@ -933,6 +1321,14 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	struct lcore_cache *cached_free_slots = NULL;
 	int32_t ret_val;
 	struct rte_hash_bucket *last;
+	/* Resizing only changes writer owned fields of the table */
+	struct rte_hash *rs_h = (struct rte_hash *)(uintptr_t)h;
+
+	if (h->resizable) {
+		if (rte_ring_count(h->free_slots) == 0)
+			rte_hash_grow(rs_h);
+		rte_hash_migrate(rs_h, RTE_HASH_RESIZE_MIGRATE_BKTS);
+	}
 
 	short_sig = get_short_sig(sig);
 	prim_bucket_idx = get_prim_bucket_index(h, sig);
@@ -942,8 +1338,17 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	rte_prefetch0(prim_bkt);
 	rte_prefetch0(sec_bkt);
 
-	/* Check if key is already inserted in primary location */
 	__hash_rw_writer_lock(h);
+	/* Check if key is still in the array a resize is migrating from */
+	if (h->resizable && h->rs_tbl->buckets_old != NULL) {
+		ret = search_and_update_old(h, data, key, sig);
+		if (ret != -1) {
+			__hash_rw_writer_unlock(h);
+			return ret;
+		}
+	}
+
+	/* Check if key is already inserted in primary location */
 	ret = search_and_update(h, data, key, prim_bkt, short_sig);
 	if (ret != -1) {
 		__hash_rw_writer_unlock(h);
@@ -987,8 +1392,8 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		}
 	}
 
-	new_k = RTE_PTR_ADD(keys, (uintptr_t)slot_id * h->key_entry_size);
 	new_idx = (uint32_t)((uintptr_t) slot_id);
+	new_k = get_key_slot(h, new_idx);
 	/* The store to application data (by the application) at *data should
 	 * not leak after the store of pdata in the key store. i.e. pdata is
 	 * the guard variable. Release the application data to the readers.
@@ -998,7 +1403,10 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		__ATOMIC_RELEASE);
 	/* Copy key */
 	memcpy(new_k->key, key, h->key_len);
+	if (h->resizable)
+		*get_key_sig(h, new_idx) = sig;
 
+insert:
 	/* Find an empty slot and insert */
 	ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt, key, data,
 					short_sig, new_idx, &ret_val);
@@ -1030,6 +1438,16 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		return ret_val;
 	}
 
+	/* Grow resizable table and insert in the larger bucket array */
+	if (h->resizable && rte_hash_grow(rs_h) == 0) {
+		prim_bucket_idx = get_prim_bucket_index(h, sig);
+		sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx,
+							short_sig);
+		prim_bkt = &h->buckets[prim_bucket_idx];
+		sec_bkt = &h->buckets[sec_bucket_idx];
+		goto insert;
+	}
+
 	/* if ext table not enabled, we failed the insertion */
 	if (!h->ext_table_support) {
 		enqueue_slot_back(h, cached_free_slots, slot_id);
@@ -1155,13 +1573,12 @@ search_one_bucket_l(const struct rte_hash *h, const void *key,
 		const struct rte_hash_bucket *bkt)
 {
 	int i;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		if (bkt->sig_current[i] == sig &&
 				bkt->key_idx[i] != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					bkt->key_idx[i] * h->key_entry_size);
+			k = get_key_slot(h, bkt->key_idx[i]);
 
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
@@ -1184,7 +1601,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 {
 	int i;
 	uint32_t key_idx;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		/* Signature comparison is done before the acquire-load
@@ -1198,8 +1615,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 			key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 			if (key_idx != EMPTY_SLOT) {
-				k = (struct rte_hash_key *) ((char *)keys +
-						key_idx * h->key_entry_size);
+				k = get_key_slot(h, key_idx);
 
 				if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 					if (data != NULL) {
@@ -1321,11 +1737,81 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 	return -ENOENT;
 }
 
+/* Search the primary and secondary buckets of a key in a bucket array */
+static inline int32_t
+search_bkt_array(const struct rte_hash *h, const void *key, hash_sig_t sig,
+		void **data, const struct rte_hash_bucket *buckets,
+		uint32_t bucket_bitmask)
+{
+	uint16_t short_sig = get_short_sig(sig);
+	uint32_t prim_bucket_idx = sig & bucket_bitmask;
+	uint32_t sec_bucket_idx = (prim_bucket_idx ^ short_sig) &
+							bucket_bitmask;
+	int32_t ret;
+
+	ret = search_one_bucket_lf(h, key, short_sig, data,
+				&buckets[prim_bucket_idx]);
+	if (ret != -1)
+		return ret;
+	return search_one_bucket_lf(h, key, short_sig, data,
+				&buckets[sec_bucket_idx]);
+}
+
+/* Lookup in a resizable table. The bucket arrays are taken from the reader
+ * view published by the writer, and while a resize is ongoing the key is
+ * searched in the current array first and then in the old one, which the
+ * writer only removes entries from after inserting them in the current one.
+ */
+static inline int32_t
+__rte_hash_lookup_with_hash_rs(const struct rte_hash *h, const void *key,
+					hash_sig_t sig, void **data)
+{
+	const struct rte_hash_rs_tbl *rs_tbl;
+	uint32_t cnt_b, cnt_a;
+	int32_t ret;
+
+	__hash_rw_reader_lock(h);
+	do {
+		/* Load the table change counter before the lookup
+		 * starts. Acquire semantics will make sure that
+		 * loads in search_one_bucket are not hoisted.
+		 */
+		cnt_b = __atomic_load_n(h->tbl_chng_cnt,
+				__ATOMIC_ACQUIRE);
+
+		rs_tbl = __atomic_load_n(&h->rs_tbl, __ATOMIC_ACQUIRE);
+		ret = search_bkt_array(h, key, sig, data, rs_tbl->buckets,
+					rs_tbl->bucket_bitmask);
+		if (ret == -1 && rs_tbl->buckets_old != NULL)
+			ret = search_bkt_array(h, key, sig, data,
+					rs_tbl->buckets_old,
+					rs_tbl->bucket_bitmask >> 1);
+		if (ret != -1)
+			break;
+
+		/* The loads of sig_current in search_one_bucket
+		 * should not move below the load from tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		/* Re-read the table change counter to check if the
+		 * table has changed during search. If yes, re-do
+		 * the search.
+		 */
+		cnt_a = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+	} while (cnt_b != cnt_a);
+	__hash_rw_reader_unlock(h);
+
+	return ret != -1 ? ret : -ENOENT;
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 					hash_sig_t sig, void **data)
 {
-	if (h->readwrite_concur_lf_support)
+	if (unlikely(h->resizable))
+		return __rte_hash_lookup_with_hash_rs(h, key, sig, data);
+	else if (h->readwrite_concur_lf_support)
 		return __rte_hash_lookup_with_hash_lf(h, key, sig, data);
 	else
 		return __rte_hash_lookup_with_hash_l(h, key, sig, data);
@@ -1441,7 +1927,7 @@ static inline int32_t
 search_and_remove(const struct rte_hash *h, const void *key,
 			struct rte_hash_bucket *bkt, uint16_t sig, int *pos)
 {
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k;
 	unsigned int i;
 	uint32_t key_idx;
 
@@ -1450,8 +1936,7 @@ search_and_remove(const struct rte_hash *h, const void *key,
 		key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 		if (bkt->sig_current[i] == sig && key_idx != EMPTY_SLOT) {
-			k = (struct rte_hash_key *) ((char *)keys +
-					key_idx * h->key_entry_size);
+			k = get_key_slot(h, key_idx);
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				bkt->sig_current[i] = NULL_SIGNATURE;
 				/* Free the key store index if
@@ -1487,6 +1972,10 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 	int32_t ret, i;
 	uint16_t short_sig;
 
+	if (h->resizable)
+		rte_hash_migrate((struct rte_hash *)(uintptr_t)h,
+				RTE_HASH_RESIZE_MIGRATE_BKTS);
+
 	short_sig = get_short_sig(sig);
 	prim_bucket_idx = get_prim_bucket_index(h, sig);
 	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
@@ -1515,6 +2004,26 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 		}
 	}
 
+	/* Check the array a resize is migrating from */
+	if (h->resizable && h->rs_tbl->buckets_old != NULL) {
+		const uint32_t old_bitmask = h->bucket_bitmask >> 1;
+
+		prim_bucket_idx = sig & old_bitmask;
+		sec_bucket_idx = (prim_bucket_idx ^ short_sig) & old_bitmask;
+		ret = search_and_remove(h, key,
+				&h->rs_tbl->buckets_old[prim_bucket_idx],
+				short_sig, &pos);
+		if (ret == -1)
+			ret = search_and_remove(h, key,
+				&h->rs_tbl->buckets_old[sec_bucket_idx],
+				short_sig, &pos);
+		if (ret != -1) {
+			/* No extendable buckets with resizable table */
+			__hash_rw_writer_unlock(h);
+			return ret;
+		}
+	}
+
 	__hash_rw_writer_unlock(h);
 	return -ENOENT;
 
@@ -1578,9 +2087,8 @@ rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
 
-	struct rte_hash_key *k, *keys = h->key_store;
-	k = (struct rte_hash_key *) ((char *) keys + (position + 1) *
-				     h->key_entry_size);
+	struct rte_hash_key *k;
+	k = get_key_slot(h, position + 1);
 	*key = k->key;
 
 	if (position !=
@@ -1654,6 +2162,25 @@ compare_signatures(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
 
 	/* For match mask the first bit of every two bits indicates the match */
 	switch (sig_cmp_fn) {
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+	case RTE_HASH_COMPARE_AVX2: {
+		/* Compare the signatures of both buckets at once: primary
+		 * bucket in the low lane, secondary bucket in the high lane.
+		 */
+		uint32_t hash_matches = _mm256_movemask_epi8(
+			_mm256_cmpeq_epi16(
+				_mm256_inserti128_si256(
+					_mm256_castsi128_si256(_mm_load_si128(
+					(__m128i const *)prim_bkt->sig_current)),
+					_mm_load_si128(
+					(__m128i const *)sec_bkt->sig_current),
+					1),
+				_mm256_set1_epi16(sig)));
+		*prim_hash_matches = hash_matches & 0xFFFF;
+		*sec_hash_matches = hash_matches >> 16;
+		}
+		break;
+#endif
 #if defined(RTE_MACHINE_CPUFLAG_SSE2)
 	case RTE_HASH_COMPARE_SSE:
 		/* Compare all signatures in the bucket */
@@ -1696,6 +2223,29 @@ compare_signatures(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
 	}
 }
 
+/* Compare the signatures of all keys of a bulk lookup */
+static inline void
+compare_signatures_bulk(uint32_t *prim_hash_matches,
+			uint32_t *sec_hash_matches,
+			const struct rte_hash_bucket **prim_bkt,
+			const struct rte_hash_bucket **sec_bkt,
+			uint16_t *sig, int32_t num_keys,
+			enum rte_hash_sig_compare_function sig_cmp_fn)
+{
+	int32_t i;
+
+#ifdef CC_HASH_AVX512_SUPPORT
+	if (sig_cmp_fn == RTE_HASH_COMPARE_AVX512) {
+		rte_hash_compare_signatures_avx512(prim_hash_matches,
+			sec_hash_matches, prim_bkt, sec_bkt, sig, num_keys);
+		return;
+	}
+#endif
+	for (i = 0; i < num_keys; i++)
+		compare_signatures(&prim_hash_matches[i], &sec_hash_matches[i],
+			prim_bkt[i], sec_bkt[i], sig[i], sig_cmp_fn);
+}
+
 #define PREFETCH_OFFSET 4
 static inline void
 __rte_hash_lookup_bulk_l(const struct rte_hash *h, const void **keys,
@@ -1757,11 +2307,9 @@ __rte_hash_lookup_bulk_l(const struct rte_hash *h, const void **keys,
 	__hash_rw_reader_lock(h);
 
 	/* Compare signatures and prefetch key slot of first hit */
+	compare_signatures_bulk(prim_hitmask, sec_hitmask,
+		primary_bkt, secondary_bkt, sig, num_keys, h->sig_cmp_fn);
 	for (i = 0; i < num_keys; i++) {
-		compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
-			primary_bkt[i], secondary_bkt[i],
-			sig[i], h->sig_cmp_fn);
-
 		if (prim_hitmask[i]) {
 			uint32_t first_hit =
 					__builtin_ctzl(prim_hitmask[i])
@@ -1957,11 +2505,10 @@ __rte_hash_lookup_bulk_lf(const struct rte_hash *h, const void **keys,
 					__ATOMIC_ACQUIRE);
 
 		/* Compare signatures and prefetch key slot of first hit */
+		compare_signatures_bulk(prim_hitmask, sec_hitmask,
+			primary_bkt, secondary_bkt, sig, num_keys,
+			h->sig_cmp_fn);
 		for (i = 0; i < num_keys; i++) {
-			compare_signatures(&prim_hitmask[i], &sec_hitmask[i],
-				primary_bkt[i], secondary_bkt[i],
-				sig[i], h->sig_cmp_fn);
-
 			if (prim_hitmask[i]) {
 				uint32_t first_hit =
 						__builtin_ctzl(prim_hitmask[i])
@@ -2109,12 +2656,46 @@ __rte_hash_lookup_bulk_lf(const struct rte_hash *h, const void **keys,
 		*hit_mask = hits;
 }
 
+static inline void
+__rte_hash_lookup_bulk_rs(const struct rte_hash *h, const void **keys,
+			int32_t num_keys, int32_t *positions,
+			uint64_t *hit_mask, void *data[])
+{
+	const struct rte_hash_rs_tbl *rs_tbl;
+	uint32_t prim_hash[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t hits = 0;
+	int32_t i;
+
+	/* Calculate hashes and prefetch the primary buckets of the current
+	 * array, which holds most keys.
+	 */
+	rs_tbl = __atomic_load_n(&h->rs_tbl, __ATOMIC_ACQUIRE);
+	for (i = 0; i < num_keys; i++) {
+		prim_hash[i] = rte_hash_hash(h, keys[i]);
+		rte_prefetch0(&rs_tbl->buckets[prim_hash[i] &
+					rs_tbl->bucket_bitmask]);
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		positions[i] = __rte_hash_lookup_with_hash_rs(h, keys[i],
+				prim_hash[i], data != NULL ? &data[i] : NULL);
+		if (positions[i] >= 0)
+			hits |= 1ULL << i;
+	}
+
+	if (hit_mask != NULL)
+		*hit_mask = hits;
+}
+
 static inline void
 __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 			int32_t num_keys, int32_t *positions,
 			uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (unlikely(h->resizable))
+		__rte_hash_lookup_bulk_rs(h, keys, num_keys, positions,
+					  hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_bulk_lf(h, keys, num_keys, positions,
 					  hit_mask, data);
 	else
@@ -2150,6 +2731,48 @@ rte_hash_lookup_bulk_data(const struct rte_hash *h, const void **keys,
 	return __builtin_popcountl(*hit_mask);
 }
 
+/* Iterate the bucket array a resizable table is migrating from, which
+ * holds half as many entries as the current one and follows it in the
+ * iteration order.
+ */
+static int32_t
+rte_hash_iterate_old(const struct rte_hash *h, const void **key, void **data,
+		uint32_t *next, uint32_t total_entries_main)
+{
+	const struct rte_hash_bucket *old_bkts = h->rs_tbl->buckets_old;
+	const uint32_t total_entries = total_entries_main +
+						(total_entries_main >> 1);
+	uint32_t bucket_idx, idx, position;
+	struct rte_hash_key *next_key;
+
+	if (old_bkts == NULL || *next >= total_entries)
+		return -ENOENT;
+
+	bucket_idx = (*next - total_entries_main) / RTE_HASH_BUCKET_ENTRIES;
+	idx = (*next - total_entries_main) % RTE_HASH_BUCKET_ENTRIES;
+
+	while ((position = __atomic_load_n(&old_bkts[bucket_idx].key_idx[idx],
+					__ATOMIC_ACQUIRE)) == EMPTY_SLOT) {
+		(*next)++;
+		if (*next == total_entries)
+			return -ENOENT;
+		bucket_idx = (*next - total_entries_main) /
+						RTE_HASH_BUCKET_ENTRIES;
+		idx = (*next - total_entries_main) % RTE_HASH_BUCKET_ENTRIES;
+	}
+	__hash_rw_reader_lock(h);
+	next_key = get_key_slot(h, position);
+	/* Return key and data */
+	*key = next_key->key;
+	*data = next_key->pdata;
+
+	__hash_rw_reader_unlock(h);
+
+	/* Increment iterator */
+	(*next)++;
+	return position - 1;
+}
+
 int32_t
 rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32_t *next)
 {
@@ -2182,8 +2805,7 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	}
 
 	__hash_rw_reader_lock(h);
-	next_key = (struct rte_hash_key *) ((char *)h->key_store +
-				position * h->key_entry_size);
+	next_key = get_key_slot(h, position);
 	/* Return key and data */
 	*key = next_key->key;
 	*data = next_key->pdata;
@@ -2197,6 +2819,11 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 
 /* Begin to iterate extendable buckets */
 extend_table:
+	/* A resizable table has no extendable buckets but may be migrating */
+	if (h->resizable)
+		return rte_hash_iterate_old(h, key, data, next,
+					total_entries_main);
+
 	/* Out of total bound or if ext bucket feature is not enabled */
 	if (*next >= total_entries || !h->ext_table_support)
 		return -ENOENT;
@@ -2213,8 +2840,7 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 		idx = (*next - total_entries_main) % RTE_HASH_BUCKET_ENTRIES;
 	}
 	__hash_rw_reader_lock(h);
-	next_key = (struct rte_hash_key *) ((char *)h->key_store +
-				position * h->key_entry_size);
+	next_key = get_key_slot(h, position);
 	/* Return key and data */
 	*key = next_key->key;
 	*data = next_key->pdata;
@@ -61,23 +61,6 @@ enum cmp_jump_table_case {
 	KEY_OTHER_BYTES,
 	NUM_KEY_CMP_CASES,
 };
-
-/*
- * Table storing all different key compare functions
- * (multi-process supported)
- */
-const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
-	NULL,
-	rte_hash_k16_cmp_eq,
-	rte_hash_k32_cmp_eq,
-	rte_hash_k48_cmp_eq,
-	rte_hash_k64_cmp_eq,
-	rte_hash_k80_cmp_eq,
-	rte_hash_k96_cmp_eq,
-	rte_hash_k112_cmp_eq,
-	rte_hash_k128_cmp_eq,
-	memcmp
-};
 #else
 /*
  * All different options to select a key compare function,
@@ -89,15 +72,6 @@ enum cmp_jump_table_case {
 	NUM_KEY_CMP_CASES,
 };
 
-/*
- * Table storing all different key compare functions
- * (multi-process supported)
- */
-const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
-	NULL,
-	memcmp
-};
-
 #endif
 
 
@@ -122,6 +96,12 @@ const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
 
 #define RTE_HASH_TSX_MAX_RETRY  10
 
+/** Maximum number of times a resizable table can grow */
+#define RTE_HASH_RESIZE_MAX		32
+
+/** Old buckets migrated by each add/delete while a resize is ongoing */
+#define RTE_HASH_RESIZE_MIGRATE_BKTS	2
+
 struct lcore_cache {
 	unsigned len; /**< Cache len */
 	void *objs[LCORE_CACHE_SIZE]; /**< Cache objects */
@@ -141,7 +121,9 @@ struct rte_hash_key {
 enum rte_hash_sig_compare_function {
 	RTE_HASH_COMPARE_SCALAR = 0,
 	RTE_HASH_COMPARE_SSE,
+	RTE_HASH_COMPARE_AVX2,
 	RTE_HASH_COMPARE_NEON,
+	RTE_HASH_COMPARE_AVX512,
 	RTE_HASH_COMPARE_NUM
 };
 
@@ -156,6 +138,14 @@ struct rte_hash_bucket {
 	void *next;
 } __rte_cache_aligned;
 
+/** Bucket arrays of a resizable table, as seen by the readers */
+struct rte_hash_rs_tbl {
+	struct rte_hash_bucket *buckets;     /**< Current bucket array. */
+	struct rte_hash_bucket *buckets_old;
+	/**< Bucket array being migrated from, NULL if no resize is ongoing. */
+	uint32_t bucket_bitmask;             /**< Bitmask of current array. */
+};
+
 /** A hash table structure. */
 struct rte_hash {
 	char name[RTE_HASH_NAMESIZE];   /**< Name of the hash. */
@@ -220,6 +210,30 @@ struct rte_hash {
 	uint32_t *ext_bkt_to_free;
 	uint32_t *tbl_chng_cnt;
 	/**< Indicates if the hash table changed from last read. */
+
+	/* Fields used by resizable tables */
+	uint8_t resizable;              /**< If the table grows when full. */
+	int socket_id;                  /**< Socket used for table memory. */
+	uint32_t key_seg_shift;
+	/**< Log2 of the number of entries of the first key store segment. */
+	uint32_t resize_cnt;            /**< Number of times table has grown. */
+	uint32_t migrate_bkt;           /**< Next old bucket to migrate. */
+	struct rte_hash_rs_tbl *rs_tbl; /**< Bucket arrays used by readers. */
+	struct rte_hash_rs_tbl rs_tbls[2 * RTE_HASH_RESIZE_MAX + 1];
+	/**< Reader views, one published per grow and per migration end.
+	 * A view is never modified once published.
+	 */
+	void *key_segs[RTE_HASH_RESIZE_MAX + 1];
+	/**< Key store segments, the first one is key_store. Each grow adds
+	 * a segment as large as the table was, so keys never move.
+	 */
+	hash_sig_t *sig_segs[RTE_HASH_RESIZE_MAX + 1];
+	/**< Hash of the key of each key store entry, in segments laid out
+	 * like key_segs. Migration reuses it, so keys added with a hash
+	 * computed by the application land in the right buckets.
+	 */
+	struct rte_hash_bucket *buckets_retired[RTE_HASH_RESIZE_MAX];
+	/**< Migrated bucket arrays lock free readers may still reference. */
 } __rte_cache_aligned;
 
 struct queue_node {
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_rwlock.h>
+#include <rte_ring.h>
+#include <rte_vect.h>
+
+#include "rte_hash.h"
+
+#include "rte_cuckoo_hash.h"
+#include "rte_cuckoo_hash_avx512.h"
+
+/*
+ * Compare the signatures of two keys at once: the primary and secondary
+ * buckets of both keys fill the four 128 bit lanes of one register. The
+ * 16 bit compare mask is widened back to two bits per entry, the format
+ * produced by the SSE and AVX2 compares.
+ */
+static __rte_always_inline void
+compare_signatures_x2(uint32_t *prim_hash_matches, uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **prim_bkt,
+	const struct rte_hash_bucket **sec_bkt,
+	const uint16_t *sig)
+{
+	__m512i bkts, sigs;
+	uint64_t hash_matches;
+
+	bkts = _mm512_castsi128_si512(
+		_mm_load_si128((__m128i const *)prim_bkt[0]->sig_current));
+	bkts = _mm512_inserti32x4(bkts,
+		_mm_load_si128((__m128i const *)sec_bkt[0]->sig_current), 1);
+	bkts = _mm512_inserti32x4(bkts,
+		_mm_load_si128((__m128i const *)prim_bkt[1]->sig_current), 2);
+	bkts = _mm512_inserti32x4(bkts,
+		_mm_load_si128((__m128i const *)sec_bkt[1]->sig_current), 3);
+
+	sigs = _mm512_inserti64x4(
+		_mm512_castsi256_si512(_mm256_set1_epi16(sig[0])),
+		_mm256_set1_epi16(sig[1]), 1);
+
+	hash_matches = _mm512_movepi8_mask(_mm512_movm_epi16(
+		_mm512_cmpeq_epi16_mask(bkts, sigs)));
+
+	prim_hash_matches[0] = hash_matches & 0xFFFF;
+	sec_hash_matches[0] = (hash_matches >> 16) & 0xFFFF;
+	prim_hash_matches[1] = (hash_matches >> 32) & 0xFFFF;
+	sec_hash_matches[1] = hash_matches >> 48;
+}
+
+void
+rte_hash_compare_signatures_avx512(uint32_t *prim_hash_matches,
+	uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **prim_bkt,
+	const struct rte_hash_bucket **sec_bkt,
+	uint16_t *sig, unsigned int num_keys)
+{
+	unsigned int i;
+	uint32_t hash_matches;
+
+	for (i = 0; i + 1 < num_keys; i += 2)
+		compare_signatures_x2(&prim_hash_matches[i],
+			&sec_hash_matches[i], &prim_bkt[i], &sec_bkt[i],
+			&sig[i]);
+
+	/* Odd key out: both of its buckets in one 256 bit compare */
+	if (i < num_keys) {
+		hash_matches = _mm256_movemask_epi8(_mm256_cmpeq_epi16(
+			_mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_load_si128(
+				(__m128i const *)prim_bkt[i]->sig_current)),
+				_mm_load_si128(
+				(__m128i const *)sec_bkt[i]->sig_current),
+				1),
+			_mm256_set1_epi16(sig[i])));
+		prim_hash_matches[i] = hash_matches & 0xFFFF;
+		sec_hash_matches[i] = hash_matches >> 16;
+	}
+}
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_CUCKOO_HASH_AVX512_H_
+#define _RTE_CUCKOO_HASH_AVX512_H_
+
+void
+rte_hash_compare_signatures_avx512(uint32_t *prim_hash_matches,
+	uint32_t *sec_hash_matches,
+	const struct rte_hash_bucket **prim_bkt,
+	const struct rte_hash_bucket **sec_bkt,
+	uint16_t *sig, unsigned int num_keys);
+
+#endif /* _RTE_CUCKOO_HASH_AVX512_H_ */
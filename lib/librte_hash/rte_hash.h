@@ -56,6 +56,19 @@ extern "C" {
  */
 #define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x20
 
+/** Flag to let the table grow when it is full.
+ * When no key slot is free or a key can not be placed, the number of
+ * entries is doubled. Keys are moved to the larger bucket array a few
+ * buckets at a time by the following add and delete calls, while lookups
+ * search both arrays, so there is no stall and no need to pre-allocate
+ * for the worst case. Key positions stay valid across resizes.
+ * Only a single writer is supported, rte_hash_free_key_with_position()
+ * must be called from the writer thread, and the extendable bucket table
+ * feature can not be used with this feature. The table name must leave room
+ * for the "HT32_" prefix in the names of the rings created when it grows.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RESIZABLE 0x40
+
 /**
  * The type of hash value of a key.
  * It should be a value of at least 32bit with fully random pattern.
@@ -15,6 +15,7 @@
 #include <rte_metrics.h>
 #include <rte_memzone.h>
 #include <rte_lcore.h>
+#include <rte_malloc.h>
 
 #include "rte_latencystats.h"
 
@@ -22,7 +23,7 @@
 #define NS_PER_SEC 1E9
 
 /** Clock cycles per nano second */
-static uint64_t
+static double
 latencystat_cycles_per_ns(void)
 {
 	return rte_get_timer_hz() / NS_PER_SEC;
@@ -31,21 +32,55 @@ latencystat_cycles_per_ns(void)
 /* Macros for printing using RTE_LOG */
 #define RTE_LOGTYPE_LATENCY_STATS RTE_LOGTYPE_USER1
 
+/*
+ * Latencies are recorded in log-linear histograms: values below
+ * 2^LAT_HIST_SUB_BITS cycles have a bucket each, then every power of two
+ * range is split in 2^LAT_HIST_SUB_BITS buckets, which bounds the relative
+ * error of a percentile to 1/2^LAT_HIST_SUB_BITS. Latencies of
+ * 2^LAT_HIST_MAX_BITS cycles or more are counted in the last bucket.
+ */
+#define LAT_HIST_SUB_BITS	4
+#define LAT_HIST_SUB_COUNT	(1 << LAT_HIST_SUB_BITS)
+#define LAT_HIST_MAX_BITS	48
+#define LAT_HIST_BUCKETS \
+	((LAT_HIST_MAX_BITS - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB_COUNT)
+
 static const char *MZ_RTE_LATENCY_STATS = "rte_latencystats";
 static int latency_stats_index;
 static uint64_t samp_intvl;
-static uint64_t timer_tsc;
-static uint64_t prev_tsc;
 
+/**
+ * Latency histogram of a Tx queue, only written by the lcore transmitting
+ * on the queue and merged by the readers.
+ */
+struct latency_hist {
+	uint16_t port_id;
+	uint16_t queue_id;
+	uint64_t count; /**< Number of latency samples */
+	uint64_t sum; /**< Sum of the latencies in cycles */
+	uint64_t min;
+	uint64_t max;
+	uint64_t prev_latency; /**< Latency of the previous sample */
+	uint64_t jitter16; /**< Jitter estimate in 1/16 cycles */
+	uint64_t buckets[LAT_HIST_BUCKETS];
+} __rte_cache_aligned;
+
+/** Latency stats shared with the secondary processes */
 struct rte_latency_stats {
-	float min_latency; /**< Minimum latency in nano seconds */
-	float avg_latency; /**< Average latency in nano seconds */
-	float max_latency; /**< Maximum latency in nano seconds */
-	float jitter; /** Latency variation */
+	uint32_t nb_hists;
+	struct latency_hist hists[];
 };
 
 static struct rte_latency_stats *glob_stats;
 
+/** Packet sampling state of a Rx queue */
+struct latency_sampler {
+	uint64_t prev_tsc;
+	uint64_t timer_tsc;
+} __rte_cache_aligned;
+
+static struct latency_sampler *samplers;
+
 struct rxtx_cbs {
 	const struct rte_eth_rxtx_callback *cb;
 };
@@ -53,58 +88,175 @@ struct rxtx_cbs {
 static struct rxtx_cbs rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 static struct rxtx_cbs tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
-struct latency_stats_nameoff {
-	char name[RTE_ETH_XSTATS_NAME_SIZE];
-	unsigned int offset;
+enum latency_stats_id {
+	LAT_STAT_MIN,
+	LAT_STAT_AVG,
+	LAT_STAT_MAX,
+	LAT_STAT_JITTER,
+	LAT_STAT_P50,
+	LAT_STAT_P99,
+	LAT_STAT_P999,
+	NUM_LATENCY_STATS
 };
 
-static const struct latency_stats_nameoff lat_stats_strings[] = {
-	{"min_latency_ns", offsetof(struct rte_latency_stats, min_latency)},
-	{"avg_latency_ns", offsetof(struct rte_latency_stats, avg_latency)},
-	{"max_latency_ns", offsetof(struct rte_latency_stats, max_latency)},
-	{"jitter_ns", offsetof(struct rte_latency_stats, jitter)},
+static const char * const lat_stats_strings[NUM_LATENCY_STATS] = {
+	[LAT_STAT_MIN] = "min_latency_ns",
+	[LAT_STAT_AVG] = "avg_latency_ns",
+	[LAT_STAT_MAX] = "max_latency_ns",
+	[LAT_STAT_JITTER] = "jitter_ns",
+	[LAT_STAT_P50] = "p50_latency_ns",
+	[LAT_STAT_P99] = "p99_latency_ns",
+	[LAT_STAT_P999] = "p999_latency_ns",
 };
 
-#define NUM_LATENCY_STATS (sizeof(lat_stats_strings) / \
-				sizeof(lat_stats_strings[0]))
+static inline unsigned int
+latency_hist_index(uint64_t latency)
+{
+	unsigned int msb;
 
-int32_t
-rte_latencystats_update(void)
+	if (latency < LAT_HIST_SUB_COUNT)
+		return latency;
+
+	msb = 63 - __builtin_clzll(latency);
+	if (msb >= LAT_HIST_MAX_BITS)
+		return LAT_HIST_BUCKETS - 1;
+
+	return ((msb - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS) +
+		((latency >> (msb - LAT_HIST_SUB_BITS)) &
+		 (LAT_HIST_SUB_COUNT - 1));
+}
+
+/* highest latency counted in a bucket */
+static uint64_t
+latency_hist_bucket_max(unsigned int idx)
+{
+	unsigned int shift;
+
+	if (idx < LAT_HIST_SUB_COUNT)
+		return idx;
+
+	shift = (idx >> LAT_HIST_SUB_BITS) - 1;
+	return ((uint64_t)(LAT_HIST_SUB_COUNT +
+			(idx & (LAT_HIST_SUB_COUNT - 1))) << shift) +
+		(1ULL << shift) - 1;
+}
+
+/* add a histogram to the merged one */
+static void
+latency_hist_merge(struct latency_hist *dst, const struct latency_hist *src)
 {
 	unsigned int i;
-	float *stats_ptr = NULL;
-	uint64_t values[NUM_LATENCY_STATS] = {0};
-	int ret;
 
-	for (i = 0; i < NUM_LATENCY_STATS; i++) {
-		stats_ptr = RTE_PTR_ADD(glob_stats,
-				lat_stats_strings[i].offset);
-		values[i] = (uint64_t)floor((*stats_ptr)/
-				latencystat_cycles_per_ns());
+	if (src->count == 0)
+		return;
+
+	if (dst->count == 0 || src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+	dst->count += src->count;
+	dst->sum += src->sum;
+	/* jitter of the merged queues is weighted by their sample counts */
+	dst->jitter16 += src->count * src->jitter16;
+	for (i = 0; i < LAT_HIST_BUCKETS; i++)
+		dst->buckets[i] += src->buckets[i];
+}
+
+/* latency in cycles below which per_mille of the samples fall */
+static uint64_t
+latency_hist_percentile(const struct latency_hist *hist, unsigned int per_mille)
+{
+	uint64_t target, seen = 0;
+	unsigned int i;
+
+	if (hist->count == 0)
+		return 0;
+
+	target = (hist->count * per_mille + 999) / 1000;
+	for (i = 0; i < LAT_HIST_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if (seen >= target)
+			return RTE_MIN(latency_hist_bucket_max(i), hist->max);
 	}
+	return hist->max;
+}
 
-	ret = rte_metrics_update_values(RTE_METRICS_GLOBAL,
-					latency_stats_index,
-					values, NUM_LATENCY_STATS);
-	if (ret < 0)
-		RTE_LOG(INFO, LATENCY_STATS, "Failed to push the stats\n");
+/*
+ * Merge the histograms of a port and queue, RTE_MAX_ETHPORTS and
+ * RTE_MAX_QUEUES_PER_PORT standing for all of them, and fill the
+ * latency stats values in nano seconds.
+ * Return the number of merged histograms.
+ */
+static unsigned int
+rte_latencystats_fill_values(uint32_t port_id, uint32_t queue_id,
+			     uint64_t *values)
+{
+	struct latency_hist merged;
+	const struct latency_hist *hist;
+	double cycles_per_ns = latencystat_cycles_per_ns();
+	uint64_t cycles[NUM_LATENCY_STATS];
+	unsigned int i, nb_merged = 0;
+
+	memset(&merged, 0, sizeof(merged));
+	for (i = 0; i < glob_stats->nb_hists; i++) {
+		hist = &glob_stats->hists[i];
+		if ((port_id != RTE_MAX_ETHPORTS && hist->port_id != port_id) ||
+		    (queue_id != RTE_MAX_QUEUES_PER_PORT &&
+		     hist->queue_id != queue_id))
+			continue;
+		latency_hist_merge(&merged, hist);
+		nb_merged++;
+	}
 
-	return ret;
+	memset(cycles, 0, sizeof(cycles));
+	if (merged.count != 0) {
+		cycles[LAT_STAT_MIN] = merged.min;
+		cycles[LAT_STAT_AVG] = merged.sum / merged.count;
+		cycles[LAT_STAT_MAX] = merged.max;
+		cycles[LAT_STAT_JITTER] = merged.jitter16 / 16 / merged.count;
+		cycles[LAT_STAT_P50] = latency_hist_percentile(&merged, 500);
+		cycles[LAT_STAT_P99] = latency_hist_percentile(&merged, 990);
+		cycles[LAT_STAT_P999] = latency_hist_percentile(&merged, 999);
+	}
+
+	for (i = 0; i < NUM_LATENCY_STATS; i++)
+		values[i] = (uint64_t)floor(cycles[i] / cycles_per_ns);
+
+	return nb_merged;
 }
 
-static void
-rte_latencystats_fill_values(struct rte_metric_value *values)
+int32_t
+rte_latencystats_update(void)
 {
-	unsigned int i;
-	float *stats_ptr = NULL;
+	uint64_t values[NUM_LATENCY_STATS];
+	uint16_t pid;
+	int ret;
 
-	for (i = 0; i < NUM_LATENCY_STATS; i++) {
-		stats_ptr = RTE_PTR_ADD(glob_stats,
-				lat_stats_strings[i].offset);
-		values[i].key = i;
-		values[i].value = (uint64_t)floor((*stats_ptr)/
-						latencystat_cycles_per_ns());
+	rte_latencystats_fill_values(RTE_MAX_ETHPORTS,
+			RTE_MAX_QUEUES_PER_PORT, values);
+	ret = rte_metrics_update_values(RTE_METRICS_GLOBAL,
+					latency_stats_index,
+					values, NUM_LATENCY_STATS);
+	if (ret < 0) {
+		RTE_LOG(INFO, LATENCY_STATS, "Failed to push the stats\n");
+		return ret;
 	}
+
+	/* per port stats */
+	RTE_ETH_FOREACH_DEV(pid) {
+		if (rte_latencystats_fill_values(pid, RTE_MAX_QUEUES_PER_PORT,
+				values) == 0)
+			continue;
+		ret = rte_metrics_update_values(pid, latency_stats_index,
+						values, NUM_LATENCY_STATS);
+		if (ret < 0) {
+			RTE_LOG(INFO, LATENCY_STATS,
+				"Failed to push the stats of port %u\n", pid);
+			return ret;
+		}
+	}
+
+	return ret;
 }
 
 static uint16_t
@@ -113,29 +265,28 @@ add_time_stamps(uint16_t pid __rte_unused,
 		struct rte_mbuf **pkts,
 		uint16_t nb_pkts,
 		uint16_t max_pkts __rte_unused,
-		void *user_cb __rte_unused)
+		void *user_cb)
 {
+	struct latency_sampler *sampler = user_cb;
+	uint64_t timer_tsc = sampler->timer_tsc;
+	uint64_t now;
 	unsigned int i;
-	uint64_t diff_tsc, now;
 
 	/*
 	 * For every sample interval,
 	 * time stamp is marked on one received packet.
 	 */
 	now = rte_rdtsc();
-	for (i = 0; i < nb_pkts; i++) {
-		diff_tsc = now - prev_tsc;
-		timer_tsc += diff_tsc;
-
-		if ((pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0
-				&& (timer_tsc >= samp_intvl)) {
+	timer_tsc += now - sampler->prev_tsc;
+	for (i = 0; i < nb_pkts && timer_tsc >= samp_intvl; i++) {
+		if ((pkts[i]->ol_flags & PKT_RX_TIMESTAMP) == 0) {
 			pkts[i]->timestamp = now;
 			pkts[i]->ol_flags |= PKT_RX_TIMESTAMP;
 			timer_tsc = 0;
 		}
-		prev_tsc = now;
-		now = rte_rdtsc();
 	}
+	sampler->timer_tsc = timer_tsc;
+	sampler->prev_tsc = now;
 
 	return nb_pkts;
 }
@@ -145,26 +296,18 @@ calc_latency(uint16_t pid __rte_unused,
 		uint16_t qid __rte_unused,
 		struct rte_mbuf **pkts,
 		uint16_t nb_pkts,
-		void *_ __rte_unused)
+		void *user_cb)
 {
-	unsigned int i, cnt = 0;
-	uint64_t now;
-	float latency[nb_pkts];
-	static float prev_latency;
-	/*
-	 * Alpha represents degree of weighting decrease in EWMA,
-	 * a constant smoothing factor between 0 and 1. The value
-	 * is used below for measuring average latency.
-	 */
-	const float alpha = 0.2;
+	struct latency_hist *hist = user_cb;
+	uint64_t now, latency, diff;
+	unsigned int i;
 
 	now = rte_rdtsc();
 	for (i = 0; i < nb_pkts; i++) {
-		if (pkts[i]->ol_flags & PKT_RX_TIMESTAMP)
-			latency[cnt++] = now - pkts[i]->timestamp;
-	}
+		if (!(pkts[i]->ol_flags & PKT_RX_TIMESTAMP))
+			continue;
 
-	for (i = 0; i < cnt; i++) {
+		latency = now - pkts[i]->timestamp;
 		/*
 		 * The jitter is calculated as statistical mean of interpacket
 		 * delay variation. The "jitter estimate" is computed by taking
@@ -172,26 +315,23 @@ calc_latency(uint16_t pid __rte_unused,
 		 * exponential filter with parameter 1/16 to generate the
 		 * estimate. i.e J=J+(|D(i-1,i)|-J)/16. Where J is jitter,
 		 * D(i-1,i) is difference in latency of two consecutive packets
-		 * i-1 and i.
+		 * i-1 and i. The estimate is kept multiplied by 16.
 		 * Reference: Calculated as per RFC 5481, sec 4.1,
 		 * RFC 3393 sec 4.5, RFC 1889 sec.
 		 */
-		glob_stats->jitter +=  (fabsf(prev_latency - latency[i])
-					- glob_stats->jitter)/16;
-		if (glob_stats->min_latency == 0)
-			glob_stats->min_latency = latency[i];
-		else if (latency[i] < glob_stats->min_latency)
-			glob_stats->min_latency = latency[i];
-		else if (latency[i] > glob_stats->max_latency)
-			glob_stats->max_latency = latency[i];
-		/*
-		 * The average latency is measured using exponential moving
-		 * average, i.e. using EWMA
-		 * https://en.wikipedia.org/wiki/Moving_average
-		 */
-		glob_stats->avg_latency +=
-			alpha * (latency[i] - glob_stats->avg_latency);
-		prev_latency = latency[i];
+		diff = (latency > hist->prev_latency) ?
+			latency - hist->prev_latency :
+			hist->prev_latency - latency;
+		hist->jitter16 += diff - hist->jitter16 / 16;
+		hist->prev_latency = latency;
+
+		if (hist->count == 0 || latency < hist->min)
+			hist->min = latency;
+		if (latency > hist->max)
+			hist->max = latency;
+		hist->count++;
+		hist->sum += latency;
+		hist->buckets[latency_hist_index(latency)]++;
 	}
 
 	return nb_pkts;
@@ -199,13 +339,14 @@ calc_latency(uint16_t pid __rte_unused,
 
 int
 rte_latencystats_init(uint64_t app_samp_intvl,
-		rte_latency_stats_flow_type_fn user_cb)
+		rte_latency_stats_flow_type_fn user_cb __rte_unused)
 {
-	unsigned int i;
+	struct rte_eth_dev_info dev_info;
+	unsigned int nb_rxq = 0, nb_txq = 0, nb_samplers = 0;
+	struct latency_hist *hist;
 	uint16_t pid;
 	uint16_t qid;
 	struct rxtx_cbs *cbs = NULL;
-	const char *ptr_strings[NUM_LATENCY_STATS] = {0};
 	const struct rte_memzone *mz = NULL;
 	const unsigned int flags = 0;
 	int ret;
@@ -213,23 +354,41 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 	if (rte_memzone_lookup(MZ_RTE_LATENCY_STATS))
 		return -EEXIST;
 
+	/* one sampler per Rx queue and one histogram per Tx queue */
+	RTE_ETH_FOREACH_DEV(pid) {
+		if (rte_eth_dev_info_get(pid, &dev_info) != 0)
+			continue;
+		nb_rxq += dev_info.nb_rx_queues;
+		nb_txq += dev_info.nb_tx_queues;
+	}
+
+	samplers = rte_zmalloc("latency_samplers",
+			RTE_MAX(nb_rxq, 1U) * sizeof(*samplers),
+			RTE_CACHE_LINE_SIZE);
+	if (samplers == NULL) {
+		RTE_LOG(ERR, LATENCY_STATS, "Cannot allocate samplers: %s:%d\n",
+			__func__, __LINE__);
+		return -ENOMEM;
+	}
+
 	/** Allocate stats in shared memory fo multi process support */
-	mz = rte_memzone_reserve(MZ_RTE_LATENCY_STATS, sizeof(*glob_stats),
-					rte_socket_id(), flags);
+	mz = rte_memzone_reserve_aligned(MZ_RTE_LATENCY_STATS,
+			sizeof(*glob_stats) + nb_txq * sizeof(*hist),
+			rte_socket_id(), flags, RTE_CACHE_LINE_SIZE);
 	if (mz == NULL) {
 		RTE_LOG(ERR, LATENCY_STATS, "Cannot reserve memory: %s:%d\n",
 			__func__, __LINE__);
+		rte_free(samplers);
+		samplers = NULL;
 		return -ENOMEM;
 	}
 
 	glob_stats = mz->addr;
+	memset(glob_stats, 0, mz->len);
 	samp_intvl = app_samp_intvl * latencystat_cycles_per_ns();
 
 	/** Register latency stats with stats library */
-	for (i = 0; i < NUM_LATENCY_STATS; i++)
-		ptr_strings[i] = lat_stats_strings[i].name;
-
-	latency_stats_index = rte_metrics_reg_names(ptr_strings,
+	latency_stats_index = rte_metrics_reg_names(lat_stats_strings,
 							NUM_LATENCY_STATS);
 	if (latency_stats_index < 0) {
 		RTE_LOG(DEBUG, LATENCY_STATS,
@@ -239,8 +398,6 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 
 	/** Register Rx/Tx callbacks */
 	RTE_ETH_FOREACH_DEV(pid) {
-		struct rte_eth_dev_info dev_info;
-
 		ret = rte_eth_dev_info_get(pid, &dev_info);
 		if (ret != 0) {
 			RTE_LOG(INFO, LATENCY_STATS,
@@ -251,18 +408,28 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 		}
 
 		for (qid = 0; qid < dev_info.nb_rx_queues; qid++) {
+			/* ports may have been added since the first walk */
+			if (nb_samplers == nb_rxq)
+				break;
 			cbs = &rx_cbs[pid][qid];
 			cbs->cb = rte_eth_add_first_rx_callback(pid, qid,
-					add_time_stamps, user_cb);
+					add_time_stamps,
+					&samplers[nb_samplers++]);
 			if (!cbs->cb)
 				RTE_LOG(INFO, LATENCY_STATS, "Failed to "
 					"register Rx callback for pid=%d, "
 					"qid=%d\n", pid, qid);
 		}
 		for (qid = 0; qid < dev_info.nb_tx_queues; qid++) {
+			/* ports may have been added since the first walk */
+			if (glob_stats->nb_hists == nb_txq)
+				break;
+			hist = &glob_stats->hists[glob_stats->nb_hists++];
+			hist->port_id = pid;
+			hist->queue_id = qid;
 			cbs = &tx_cbs[pid][qid];
 			cbs->cb =  rte_eth_add_tx_callback(pid, qid,
-					calc_latency, user_cb);
+					calc_latency, hist);
 			if (!cbs->cb)
 				RTE_LOG(INFO, LATENCY_STATS, "Failed to "
 					"register Tx callback for pid=%d, "
@@ -316,6 +483,10 @@ rte_latencystats_uninit(void)
 	mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
 	if (mz)
 		rte_memzone_free(mz);
+	glob_stats = NULL;
+
+	rte_free(samplers);
+	samplers = NULL;
 
 	return 0;
 }
@@ -329,20 +500,18 @@ rte_latencystats_get_names(struct rte_metric_name *names, uint16_t size)
 		return NUM_LATENCY_STATS;
 
 	for (i = 0; i < NUM_LATENCY_STATS; i++)
-		strlcpy(names[i].name, lat_stats_strings[i].name,
+		strlcpy(names[i].name, lat_stats_strings[i],
 			sizeof(names[i].name));
 
 	return NUM_LATENCY_STATS;
 }
 
-int
-rte_latencystats_get(struct rte_metric_value *values, uint16_t size)
+static int
+latency_stats_lookup(void)
 {
-	if (size < NUM_LATENCY_STATS || values == NULL)
-		return NUM_LATENCY_STATS;
+	const struct rte_memzone *mz;
 
 	if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
-		const struct rte_memzone *mz;
 		mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
 		if (mz == NULL) {
 			RTE_LOG(ERR, LATENCY_STATS,
@@ -352,8 +521,53 @@ rte_latencystats_get(struct rte_metric_value *values, uint16_t size)
 		glob_stats =  mz->addr;
 	}
 
+	if (glob_stats == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static int
+latency_stats_get(uint32_t port_id, uint32_t queue_id,
+		  struct rte_metric_value *values, uint16_t size)
+{
+	uint64_t stats[NUM_LATENCY_STATS];
+	unsigned int i;
+	int ret;
+
+	if (size < NUM_LATENCY_STATS || values == NULL)
+		return NUM_LATENCY_STATS;
+
+	ret = latency_stats_lookup();
+	if (ret < 0)
+		return ret;
+
 	/* Retrieve latency stats */
-	rte_latencystats_fill_values(values);
+	if (rte_latencystats_fill_values(port_id, queue_id, stats) == 0 &&
+	    queue_id != RTE_MAX_QUEUES_PER_PORT)
+		return -ENOENT;
+
+	for (i = 0; i < NUM_LATENCY_STATS; i++) {
+		values[i].key = i;
+		values[i].value = stats[i];
+	}
 
 	return NUM_LATENCY_STATS;
 }
+
+int
+rte_latencystats_get(struct rte_metric_value *values, uint16_t size)
+{
+	return latency_stats_get(RTE_MAX_ETHPORTS, RTE_MAX_QUEUES_PER_PORT,
+				 values, size);
+}
+
+int
+rte_latencystats_get_queue(uint16_t port_id, uint16_t queue_id,
+			   struct rte_metric_value *values, uint16_t size)
+{
+	if (port_id >= RTE_MAX_ETHPORTS || queue_id >= RTE_MAX_QUEUES_PER_PORT)
+		return -EINVAL;
+
+	return latency_stats_get(port_id, queue_id, values, size);
+}
@@ -10,9 +10,17 @@
  * RTE latency stats
  *
  * library to provide application and flow based latency stats.
+ *
+ * The latency of the sampled packets is recorded, by the lcore transmitting
+ * them, in a log-linear histogram of each Tx queue, so that no state is
+ * shared between the queues. The histograms are merged when the stats are
+ * read: minimum, average, maximum, jitter and the 50th, 99th and 99.9th
+ * percentiles of the latency are reported, in nano seconds. Percentiles
+ * have a relative error below 1/16.
  */
 
 #include <stdint.h>
+#include <rte_compat.h>
 #include <rte_metrics.h>
 #include <rte_mbuf.h>
 
@@ -64,7 +72,8 @@ int rte_latencystats_init(uint64_t samp_intvl,
 
 /**
  * Calculates the latency and jitter values internally, exposing the updated
- * values via *rte_latencystats_get* or the rte_metrics API.
+ * values via *rte_latencystats_get* or the rte_metrics API, as global
+ * metrics for all the ports and as metrics of each port.
  * @return:
  *  0      : on Success
  *  < 0    : Error in updating values.
@@ -121,6 +130,41 @@ int rte_latencystats_get_names(struct rte_metric_name *names,
 int rte_latencystats_get(struct rte_metric_value *values,
 			uint16_t size);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve latency statistics of a Tx queue.
+ *
+ * The statistics are the ones of *rte_latencystats_get*, restricted to the
+ * packets transmitted on one queue.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The index of the transmit queue.
+ * @param values
+ *   A pointer to a table of structure of type *rte_metric_value*
+ *   to be filled with latency statistics ids and values.
+ *   This parameter can be set to NULL if size is 0.
+ * @param size
+ *   The size of the stats table, which should be large enough to store
+ *   all the latency stats.
+ * @return
+ *   - positive value lower or equal to size: success. The return value
+ *     is the number of entries filled in the stats table.
+ *   - positive value higher than size: error, the given statistics table
+ *     is too small. The return value corresponds to the size that should
+ *     be given to succeed. The entries in the table are not valid and
+ *     shall not be used by the caller.
+ *   -EINVAL: invalid port or queue identifier.
+ *   -ENOENT: the queue latency is not measured.
+ *   -ENOMEM: On failure.
+ */
+__rte_experimental
+int rte_latencystats_get_queue(uint16_t port_id, uint16_t queue_id,
+			struct rte_metric_value *values, uint16_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,7 +49,7 @@ rte_pktmbuf_pool_init(struct rte_mempool *mp, void *opaque_arg)
 	/* if no structure is provided, assume no mbuf private area */
 	user_mbp_priv = opaque_arg;
 	if (user_mbp_priv == NULL) {
-		default_mbp_priv.mbuf_priv_size = 0;
+		memset(&default_mbp_priv, 0, sizeof(default_mbp_priv));
 		if (mp->elt_size > sizeof(struct rte_mbuf))
 			roomsz = mp->elt_size - sizeof(struct rte_mbuf);
 		else
@@ -59,7 +59,9 @@ rte_pktmbuf_pool_init(struct rte_mempool *mp, void *opaque_arg)
 	}
 
 	RTE_ASSERT(mp->elt_size >= sizeof(struct rte_mbuf) +
-		user_mbp_priv->mbuf_data_room_size +
+		((user_mbp_priv->flags & RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF) ?
+			sizeof(struct rte_mbuf_ext_shared_info) :
+			user_mbp_priv->mbuf_data_room_size) +
 		user_mbp_priv->mbuf_priv_size);
 
 	mbp_priv = rte_mempool_get_priv(mp);
@@ -126,6 +128,7 @@ rte_pktmbuf_pool_create_by_ops(const char *name, unsigned int n,
 	}
 	elt_size = sizeof(struct rte_mbuf) + (unsigned)priv_size +
 		(unsigned)data_room_size;
+	memset(&mbp_priv, 0, sizeof(mbp_priv));
 	mbp_priv.mbuf_data_room_size = data_room_size;
 	mbp_priv.mbuf_priv_size = priv_size;
 
@@ -157,6 +160,171 @@ rte_pktmbuf_pool_create_by_ops(const char *name, unsigned int n,
 	return mp;
 }
 
+/*
+ * Free callback of the pinned external buffers, called once the mbufs of
+ * other pools attached to the buffer of a freed mbuf are all freed.
+ */
+static void
+rte_pktmbuf_free_pinned_extmem(void *addr, void *opaque)
+{
+	struct rte_mbuf *m = opaque;
+
+	RTE_SET_USED(addr);
+	RTE_ASSERT(RTE_MBUF_HAS_EXTBUF(m));
+	RTE_ASSERT(RTE_MBUF_HAS_PINNED_EXTBUF(m));
+	RTE_ASSERT(m->shinfo->fcb_opaque == m);
+
+	rte_mbuf_ext_refcnt_set(m->shinfo, 1);
+	m->ol_flags = EXT_ATTACHED_MBUF;
+	if (m->next != NULL) {
+		m->next = NULL;
+		m->nb_segs = 1;
+	}
+	rte_mbuf_raw_free(m);
+}
+
+/* state of the pinned external buffer mbuf constructor */
+struct rte_pktmbuf_extmem_init_ctx {
+	const struct rte_pktmbuf_extmem *ext_mem; /* zones array */
+	unsigned int ext_num; /* number of zones */
+	unsigned int ext; /* zone of the next buffer */
+	size_t off; /* offset of the next buffer in the zone */
+};
+
+/*
+ * pktmbuf constructor for the pools with pinned external buffers, given
+ * as a callback function to rte_mempool_obj_iter().
+ */
+static void
+__rte_pktmbuf_init_extmem(struct rte_mempool *mp, void *opaque_arg,
+	void *_m, __attribute__((unused)) unsigned int i)
+{
+	struct rte_pktmbuf_extmem_init_ctx *ctx = opaque_arg;
+	const struct rte_pktmbuf_extmem *ext_mem;
+	struct rte_mbuf_ext_shared_info *shinfo;
+	struct rte_mbuf *m = _m;
+	uint32_t mbuf_size, priv_size;
+
+	priv_size = rte_pktmbuf_priv_size(mp);
+	mbuf_size = sizeof(struct rte_mbuf) + priv_size;
+	memset(m, 0, mbuf_size);
+	m->priv_size = priv_size;
+
+	/* the zones were checked to fit all the buffers */
+	ext_mem = &ctx->ext_mem[ctx->ext];
+	while (ctx->off + ext_mem->elt_size > ext_mem->buf_len) {
+		ctx->off = 0;
+		ext_mem = &ctx->ext_mem[++ctx->ext];
+	}
+	RTE_ASSERT(ctx->ext < ctx->ext_num);
+
+	m->buf_addr = RTE_PTR_ADD(ext_mem->buf_ptr, ctx->off);
+	m->buf_iova = ext_mem->buf_iova == RTE_BAD_IOVA ?
+		RTE_BAD_IOVA : ext_mem->buf_iova + ctx->off;
+	m->buf_len = rte_pktmbuf_data_room_size(mp);
+	ctx->off += ext_mem->elt_size;
+
+	/* keep some headroom between start of buffer and data */
+	m->data_off = RTE_MIN(RTE_PKTMBUF_HEADROOM, (uint16_t)m->buf_len);
+
+	/* init some constant fields */
+	m->pool = mp;
+	m->nb_segs = 1;
+	m->port = MBUF_INVALID_PORT;
+	m->ol_flags = EXT_ATTACHED_MBUF;
+	rte_mbuf_refcnt_set(m, 1);
+	m->next = NULL;
+
+	/* the shared info follows the mbuf and its private area */
+	shinfo = RTE_PTR_ADD(m, mbuf_size);
+	m->shinfo = shinfo;
+	shinfo->free_cb = rte_pktmbuf_free_pinned_extmem;
+	shinfo->fcb_opaque = m;
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+}
+
+/* Helper to create a mbuf pool with pinned external data buffers. */
+struct rte_mempool *
+rte_pktmbuf_pool_create_extbuf(const char *name, unsigned int n,
+	unsigned int cache_size, uint16_t priv_size, uint16_t data_room_size,
+	int socket_id, const struct rte_pktmbuf_extmem *ext_mem,
+	unsigned int ext_num)
+{
+	struct rte_pktmbuf_extmem_init_ctx init_ctx;
+	struct rte_pktmbuf_pool_private mbp_priv;
+	struct rte_mempool *mp;
+	uint64_t nb_bufs = 0;
+	unsigned int elt_size, i;
+	int ret;
+
+	if (RTE_ALIGN(priv_size, RTE_MBUF_PRIV_ALIGN) != priv_size) {
+		RTE_LOG(ERR, MBUF, "mbuf priv_size=%u is not aligned\n",
+			priv_size);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (ext_mem == NULL || ext_num == 0) {
+		RTE_LOG(ERR, MBUF, "no external memory for the mbufs\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	for (i = 0; i < ext_num; i++) {
+		if (ext_mem[i].buf_ptr == NULL ||
+				ext_mem[i].elt_size < data_room_size ||
+				ext_mem[i].elt_size == 0) {
+			RTE_LOG(ERR, MBUF, "bad external memory zone %u\n", i);
+			rte_errno = EINVAL;
+			return NULL;
+		}
+		nb_bufs += ext_mem[i].buf_len / ext_mem[i].elt_size;
+	}
+	if (nb_bufs < n) {
+		RTE_LOG(ERR, MBUF, "external memory too small for %u mbufs\n",
+			n);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	elt_size = sizeof(struct rte_mbuf) + (unsigned int)priv_size +
+		sizeof(struct rte_mbuf_ext_shared_info);
+	memset(&mbp_priv, 0, sizeof(mbp_priv));
+	mbp_priv.mbuf_data_room_size = data_room_size;
+	mbp_priv.mbuf_priv_size = priv_size;
+	mbp_priv.flags = RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF;
+
+	mp = rte_mempool_create_empty(name, n, elt_size, cache_size,
+		 sizeof(struct rte_pktmbuf_pool_private), socket_id, 0);
+	if (mp == NULL)
+		return NULL;
+
+	ret = rte_mempool_set_ops_byname(mp, rte_mbuf_best_mempool_ops(),
+		NULL);
+	if (ret != 0) {
+		RTE_LOG(ERR, MBUF, "error setting mempool handler\n");
+		rte_mempool_free(mp);
+		rte_errno = -ret;
+		return NULL;
+	}
+	rte_pktmbuf_pool_init(mp, &mbp_priv);
+
+	ret = rte_mempool_populate_default(mp);
+	if (ret < 0) {
+		rte_mempool_free(mp);
+		rte_errno = -ret;
+		return NULL;
+	}
+
+	init_ctx = (struct rte_pktmbuf_extmem_init_ctx){
+		.ext_mem = ext_mem,
+		.ext_num = ext_num,
+		.ext = 0,
+		.off = 0,
+	};
+	rte_mempool_obj_iter(mp, __rte_pktmbuf_init_extmem, &init_ctx);
+
+	return mp;
+}
+
 /* helper to create a mbuf pool */
 struct rte_mempool *
 rte_pktmbuf_pool_create(const char *name, unsigned int n,
@@ -245,52 +413,89 @@ int rte_mbuf_check(const struct rte_mbuf *m, int is_header,
 	return 0;
 }
 
+/**
+ * Size of the arrays holding mbufs from the same mempool pending to be freed
+ * in bulk.
+ */
+#define RTE_PKTMBUF_FREE_PENDING_SZ 64
+
+/**
+ * Number of mempools whose mbufs are gathered at the same time when freeing
+ * in bulk, so that mbufs of interleaved pools are still freed in bulk.
+ */
+#define RTE_PKTMBUF_FREE_POOLS 4
+
+/* Packet mbuf segments of a mempool pending to be freed. */
+struct rte_pktmbuf_free_pending {
+	struct rte_mempool *pool;
+	unsigned int nb;
+	struct rte_mbuf *mbufs[RTE_PKTMBUF_FREE_PENDING_SZ];
+};
+
 /**
  * @internal helper function for freeing a bulk of packet mbuf segments
- * via an array holding the packet mbuf segments from the same mempool
- * pending to be freed.
+ * via arrays holding the packet mbuf segments pending to be freed, one per
+ * mempool.
  *
  * @param m
  *  The packet mbuf segment to be freed.
  * @param pending
- *  Pointer to the array of packet mbuf segments pending to be freed.
- * @param nb_pending
- *  Pointer to the number of elements held in the array.
- * @param pending_sz
- *  Number of elements the array can hold.
- *  Note: The compiler should optimize this parameter away when using a
- *  constant value, such as RTE_PKTMBUF_FREE_PENDING_SZ.
+ *  Arrays of packet mbuf segments pending to be freed.
+ * @param nb_pools
+ *  Pointer to the number of arrays in use.
+ * @param last
+ *  Pointer to the index of the array used for the previous segment, which
+ *  is most likely the one of this segment.
  */
-static void
+static inline void
 __rte_pktmbuf_free_seg_via_array(struct rte_mbuf *m,
-	struct rte_mbuf ** const pending, unsigned int * const nb_pending,
-	const unsigned int pending_sz)
+	struct rte_pktmbuf_free_pending * const pending,
+	unsigned int * const nb_pools, unsigned int * const last)
 {
+	struct rte_pktmbuf_free_pending *p;
+	unsigned int i;
+
 	m = rte_pktmbuf_prefree_seg(m);
-	if (likely(m != NULL)) {
-		if (*nb_pending == pending_sz ||
-		    (*nb_pending > 0 && m->pool != pending[0]->pool)) {
-			rte_mempool_put_bulk(pending[0]->pool,
-					(void **)pending, *nb_pending);
-			*nb_pending = 0;
+	if (unlikely(m == NULL))
+		return;
+
+	p = &pending[*last];
+	if (unlikely(p->pool != m->pool)) {
+		for (i = 0; i < *nb_pools; i++)
+			if (pending[i].pool == m->pool)
+				break;
+		if (i == *nb_pools) {
+			if (*nb_pools < RTE_PKTMBUF_FREE_POOLS) {
+				(*nb_pools)++;
+			} else {
+				/* evict the array following the last used */
+				i = (*last + 1) % RTE_PKTMBUF_FREE_POOLS;
+				rte_mempool_put_bulk(pending[i].pool,
+					(void **)pending[i].mbufs,
+					pending[i].nb);
+			}
+			pending[i].pool = m->pool;
+			pending[i].nb = 0;
 		}
+		*last = i;
+		p = &pending[i];
+	}
 
-		pending[(*nb_pending)++] = m;
+	if (p->nb == RTE_PKTMBUF_FREE_PENDING_SZ) {
+		rte_mempool_put_bulk(p->pool, (void **)p->mbufs, p->nb);
+		p->nb = 0;
 	}
+	p->mbufs[p->nb++] = m;
 }
 
-/**
- * Size of the array holding mbufs from the same mempool pending to be freed
- * in bulk.
- */
-#define RTE_PKTMBUF_FREE_PENDING_SZ 64
-
 /* Free a bulk of packet mbufs back into their original mempools. */
 void rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count)
 {
-	struct rte_mbuf *m, *m_next, *pending[RTE_PKTMBUF_FREE_PENDING_SZ];
-	unsigned int idx, nb_pending = 0;
+	struct rte_pktmbuf_free_pending pending[RTE_PKTMBUF_FREE_POOLS];
+	unsigned int idx, i, nb_pools = 0, last = 0;
+	struct rte_mbuf *m, *m_next;
 
+	pending[0].pool = NULL;
 	for (idx = 0; idx < count; idx++) {
 		m = mbufs[idx];
 		if (unlikely(m == NULL))
@@ -300,15 +505,16 @@ void rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count)
 
 		do {
 			m_next = m->next;
-			__rte_pktmbuf_free_seg_via_array(m,
-					pending, &nb_pending,
-					RTE_PKTMBUF_FREE_PENDING_SZ);
+			__rte_pktmbuf_free_seg_via_array(m, pending,
+					&nb_pools, &last);
 			m = m_next;
 		} while (m != NULL);
 	}
 
-	if (nb_pending > 0)
-		rte_mempool_put_bulk(pending[0]->pool, (void **)pending, nb_pending);
+	for (i = 0; i < nb_pools; i++)
+		if (pending[i].nb > 0)
+			rte_mempool_put_bulk(pending[i].pool,
+				(void **)pending[i].mbufs, pending[i].nb);
 }
 
 /* Creates a shallow copy of mbuf */
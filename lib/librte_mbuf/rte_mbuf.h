@@ -43,6 +43,9 @@
 #include <rte_byteorder.h>
 #include <rte_mbuf_ptype.h>
 #include <rte_mbuf_core.h>
+#ifdef RTE_MACHINE_CPUFLAG_AVX2
+#include <rte_vect.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -303,8 +306,43 @@ rte_mbuf_to_priv(struct rte_mbuf *m)
 struct rte_pktmbuf_pool_private {
 	uint16_t mbuf_data_room_size; /**< Size of data space in each mbuf. */
 	uint16_t mbuf_priv_size;      /**< Size of private area in each mbuf. */
+	uint32_t flags; /**< RTE_PKTMBUF_POOL_F_* flags. */
 };
 
+/**
+ * The mbufs of the pool have a pinned external buffer: they are created
+ * attached to an external buffer, which stays attached when they are freed.
+ * See rte_pktmbuf_pool_create_extbuf().
+ */
+#define RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF (1 << 0)
+
+/**
+ * Get the flags of a pktmbuf pool.
+ *
+ * @param mp
+ *   The packet mbuf pool.
+ * @return
+ *   The RTE_PKTMBUF_POOL_F_* flags of the pool.
+ */
+static inline uint32_t
+rte_pktmbuf_priv_flags(struct rte_mempool *mp)
+{
+	struct rte_pktmbuf_pool_private *mbp_priv;
+
+	mbp_priv = (struct rte_pktmbuf_pool_private *)rte_mempool_get_priv(mp);
+	return mbp_priv->flags;
+}
+
+/**
+ * Returns TRUE if given mbuf has a pinned external buffer, or FALSE
+ * otherwise. The pinned external buffer is allocated at pool creation
+ * time and should not be freed on mbuf freeing.
+ *
+ * External buffer is a user-provided anonymous buffer.
+ */
+#define RTE_MBUF_HAS_PINNED_EXTBUF(mb) \
+	(rte_pktmbuf_priv_flags((mb)->pool) & RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF)
+
 #ifdef RTE_LIBRTE_MBUF_DEBUG
 
 /**  check mbuf type in debug mode */
@@ -556,9 +594,9 @@ static inline struct rte_mbuf *rte_mbuf_raw_alloc(struct rte_mempool *mp)
 /**
  * Put mbuf back into its original mempool.
  *
- * The caller must ensure that the mbuf is direct and properly
- * reinitialized (refcnt=1, next=NULL, nb_segs=1), as done by
- * rte_pktmbuf_prefree_seg().
+ * The caller must ensure that the mbuf is direct, or has a pinned external
+ * buffer, and is properly reinitialized (refcnt=1, next=NULL, nb_segs=1),
+ * as done by rte_pktmbuf_prefree_seg().
  *
  * This function should be used with care, when optimization is
  * required. For standard needs, prefer rte_pktmbuf_free() or
@@ -570,7 +608,8 @@ static inline struct rte_mbuf *rte_mbuf_raw_alloc(struct rte_mempool *mp)
 static __rte_always_inline void
 rte_mbuf_raw_free(struct rte_mbuf *m)
 {
-	RTE_ASSERT(RTE_MBUF_DIRECT(m));
+	RTE_ASSERT(!RTE_MBUF_CLONED(m) &&
+		(!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_HAS_PINNED_EXTBUF(m)));
 	RTE_ASSERT(rte_mbuf_refcnt_read(m) == 1);
 	RTE_ASSERT(m->next == NULL);
 	RTE_ASSERT(m->nb_segs == 1);
@@ -616,7 +655,9 @@ void rte_pktmbuf_init(struct rte_mempool *mp, void *opaque_arg,
  * @param opaque_arg
  *   A pointer that can be used by the user to retrieve useful information
  *   for mbuf initialization. This pointer is the opaque argument passed to
- *   rte_mempool_create().
+ *   rte_mempool_create(). If not NULL, it points to a
+ *   struct rte_pktmbuf_pool_private, which must be zeroed before its fields
+ *   are set, so that no unexpected flag is set.
  */
 void rte_pktmbuf_pool_init(struct rte_mempool *mp, void *opaque_arg);
 
@@ -701,6 +742,80 @@ rte_pktmbuf_pool_create_by_ops(const char *name, unsigned int n,
 	unsigned int cache_size, uint16_t priv_size, uint16_t data_room_size,
 	int socket_id, const char *ops_name);
 
+/** A structure that describes a zone of external memory for mbuf buffers. */
+struct rte_pktmbuf_extmem {
+	void *buf_ptr;		/**< Start address of the zone. */
+	rte_iova_t buf_iova;	/**< IO address of the zone, or RTE_BAD_IOVA. */
+	size_t buf_len;		/**< Length of the zone. */
+	uint16_t elt_size;	/**< Distance between two mbuf buffers. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a mbuf pool with external pinned data buffers.
+ *
+ * This function creates and initializes a packet mbuf pool whose mbufs
+ * have their data buffers in the given zones of external memory, such as
+ * application memory or memory registered with rte_extmem_register().
+ * The mempool only holds the mbuf headers, their private area and a
+ * struct rte_mbuf_ext_shared_info, so that large buffers do not use
+ * memory of the DPDK heap, and devices can receive directly into
+ * application memory.
+ *
+ * The mbufs are attached to their external buffer at creation and stay
+ * attached, with the EXT_ATTACHED_MBUF flag set, for the whole pool
+ * lifetime. Cloning a mbuf of this pool into a regular pool attaches the
+ * clone to the external buffer, which is only returned to this pool once
+ * all the clones are freed.
+ * The mbufs of this pool cannot be attached to another buffer, so they
+ * cannot be used as clones. Cloning received mbufs requires a driver which
+ * keeps the EXT_ATTACHED_MBUF flag when setting the offload flags.
+ *
+ * The zones must be registered for DMA by the application if required,
+ * and must not be freed before the pool.
+ *
+ * @param name
+ *   The name of the mbuf pool.
+ * @param n
+ *   The number of elements in the mbuf pool. It must not exceed the number
+ *   of buffers fitting in the zones.
+ * @param cache_size
+ *   Size of the per-core object cache. See rte_mempool_create() for
+ *   details.
+ * @param priv_size
+ *   Size of application private are between the rte_mbuf structure
+ *   and the data buffer. This value must be aligned to RTE_MBUF_PRIV_ALIGN.
+ * @param data_room_size
+ *   Size of data buffer in each mbuf, including RTE_PKTMBUF_HEADROOM.
+ *   It must not exceed the elt_size of any zone.
+ * @param socket_id
+ *   The socket identifier where the memory should be allocated. The
+ *   value can be *SOCKET_ID_ANY* if there is no NUMA constraint for the
+ *   reserved zone.
+ * @param ext_mem
+ *   Array of zones of external memory.
+ * @param ext_num
+ *   Number of zones in the array.
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. Possible rte_errno values include:
+ *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
+ *    - E_RTE_SECONDARY - function was called from a secondary process instance
+ *    - EINVAL - cache size provided is too large, priv_size is not aligned,
+ *      or the zones are too small.
+ *    - ENOSPC - the maximum number of memzones has already been allocated
+ *    - EEXIST - a memzone with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+__rte_experimental
+struct rte_mempool *
+rte_pktmbuf_pool_create_extbuf(const char *name, unsigned int n,
+	unsigned int cache_size, uint16_t priv_size, uint16_t data_room_size,
+	int socket_id, const struct rte_pktmbuf_extmem *ext_mem,
+	unsigned int ext_num);
+
 /**
  * Get the data room size of mbufs stored in a pktmbuf_pool
  *
@@ -776,7 +891,8 @@ static inline void rte_pktmbuf_reset(struct rte_mbuf *m)
 	m->nb_segs = 1;
 	m->port = MBUF_INVALID_PORT;
 
-	m->ol_flags = 0;
+	/* a pinned external buffer stays attached */
+	m->ol_flags &= EXT_ATTACHED_MBUF;
 	m->packet_type = 0;
 	rte_pktmbuf_reset_headroom(m);
 
@@ -784,6 +900,76 @@ static inline void rte_pktmbuf_reset(struct rte_mbuf *m)
 	__rte_mbuf_sanity_check(m, 1);
 }
 
+/**
+ * @internal
+ * Reset the fields of a bulk of mbufs just allocated from a mempool, like
+ * rte_pktmbuf_reset() does for each of them.
+ *
+ * The mbufs of a pool all have a buffer of the data room size of the pool,
+ * and the same attachment to a pinned external buffer, so that the rearm
+ * data and offload flags are the same for all of them and can be written
+ * with a single vector store, along with the fields following them.
+ *
+ * @param pool
+ *   The mempool from which the mbufs were allocated.
+ * @param mbufs
+ *   Array of pointers to mbufs.
+ * @param count
+ *   Array size.
+ */
+static inline void
+__rte_pktmbuf_reset_bulk(struct rte_mempool *pool, struct rte_mbuf **mbufs,
+	unsigned int count)
+{
+	unsigned int i;
+#ifdef RTE_MACHINE_CPUFLAG_AVX2
+	const uint64_t data_off = RTE_MIN((uint16_t)RTE_PKTMBUF_HEADROOM,
+		rte_pktmbuf_data_room_size(pool));
+	const uint64_t ol_flags = (rte_pktmbuf_priv_flags(pool) &
+		RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF) ? EXT_ATTACHED_MBUF : 0;
+	/*
+	 * data_off, refcnt = 1, nb_segs = 1 and port, ol_flags, followed by
+	 * zeroed packet_type, pkt_len, data_len, vlan_tci and hash.rss.
+	 */
+	const __m256i rearm = _mm256_set_epi64x(0, 0, (int64_t)ol_flags,
+		(int64_t)(data_off | (uint64_t)1 << 16 | (uint64_t)1 << 32 |
+			(uint64_t)MBUF_INVALID_PORT << 48));
+	const __m128i zero = _mm_setzero_si128();
+
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, data_off) !=
+		offsetof(struct rte_mbuf, rearm_data));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, refcnt) !=
+		offsetof(struct rte_mbuf, rearm_data) + 2);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, nb_segs) !=
+		offsetof(struct rte_mbuf, rearm_data) + 4);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, port) !=
+		offsetof(struct rte_mbuf, rearm_data) + 6);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+		offsetof(struct rte_mbuf, rearm_data) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, vlan_tci) + 2 >
+		offsetof(struct rte_mbuf, rearm_data) + 32);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, tx_offload) !=
+		offsetof(struct rte_mbuf, next) + 8);
+
+	for (i = 0; i < count; i++) {
+		struct rte_mbuf *m = mbufs[i];
+
+		MBUF_RAW_ALLOC_CHECK(m);
+		_mm256_storeu_si256((__m256i *)&m->rearm_data, rearm);
+		/* next and tx_offload */
+		_mm_storeu_si128((__m128i *)&m->next, zero);
+		m->vlan_tci_outer = 0;
+		__rte_mbuf_sanity_check(m, 1);
+	}
+#else
+	RTE_SET_USED(pool);
+	for (i = 0; i < count; i++) {
+		MBUF_RAW_ALLOC_CHECK(mbufs[i]);
+		rte_pktmbuf_reset(mbufs[i]);
+	}
+#endif
+}
+
 /**
  * Allocate a new mbuf from a mempool.
  *
@@ -822,42 +1008,13 @@ static inline struct rte_mbuf *rte_pktmbuf_alloc(struct rte_mempool *mp)
 static inline int rte_pktmbuf_alloc_bulk(struct rte_mempool *pool,
 	 struct rte_mbuf **mbufs, unsigned count)
 {
-	unsigned idx = 0;
 	int rc;
 
 	rc = rte_mempool_get_bulk(pool, (void **)mbufs, count);
 	if (unlikely(rc))
 		return rc;
 
-	/* To understand duff's device on loop unwinding optimization, see
-	 * https://en.wikipedia.org/wiki/Duff's_device.
-	 * Here while() loop is used rather than do() while{} to avoid extra
-	 * check if count is zero.
-	 */
-	switch (count % 4) {
-	case 0:
-		while (idx != count) {
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-	case 3:
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-	case 2:
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-	case 1:
-			MBUF_RAW_ALLOC_CHECK(mbufs[idx]);
-			rte_pktmbuf_reset(mbufs[idx]);
-			idx++;
-			/* fall-through */
-		}
-	}
+	__rte_pktmbuf_reset_bulk(pool, mbufs, count);
 	return 0;
 }
 
@@ -1131,6 +1288,8 @@ __rte_pktmbuf_free_direct(struct rte_mbuf *m)
  *
  * All other fields of the given packet mbuf will be left intact.
  *
+ * A mbuf with a pinned external buffer is left attached to it.
+ *
  * @param m
  *   The indirect attached packet mbuf.
  */
@@ -1140,9 +1299,13 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	uint32_t mbuf_size, buf_len;
 	uint16_t priv_size;
 
-	if (RTE_MBUF_HAS_EXTBUF(m))
+	if (RTE_MBUF_HAS_EXTBUF(m)) {
+		/* a pinned external buffer is never detached */
+		if (rte_pktmbuf_priv_flags(mp) &
+				RTE_PKTMBUF_POOL_F_PINNED_EXT_BUF)
+			return;
 		__rte_pktmbuf_free_extbuf(m);
-	else
+	} else
 		__rte_pktmbuf_free_direct(m);
 
 	priv_size = rte_pktmbuf_priv_size(mp);
@@ -1158,6 +1321,39 @@ static inline void rte_pktmbuf_detach(struct rte_mbuf *m)
 	m->ol_flags = 0;
 }
 
+/**
+ * @internal used by rte_pktmbuf_prefree_seg().
+ *
+ * Release the pinned external buffer of a mbuf being freed, still
+ * attached to it after rte_pktmbuf_detach().
+ *
+ * @return
+ *   - 0 if the mbuf can be returned to its pool.
+ *   - 1 if mbufs of another pool are still attached to the buffer, in which
+ *     case the mbuf is returned to its pool by the free callback of the
+ *     buffer, once they are all freed.
+ */
+static inline int
+__rte_pktmbuf_pinned_extbuf_decref(struct rte_mbuf *m)
+{
+	struct rte_mbuf_ext_shared_info *shinfo;
+
+	/* clear the flags, the mbuf is being freed */
+	m->ol_flags = EXT_ATTACHED_MBUF;
+	shinfo = m->shinfo;
+
+	/* do not touch the refcnt when the buffer is not shared */
+	if (likely(rte_mbuf_ext_refcnt_read(shinfo) == 1))
+		return 0;
+
+	if (likely(rte_mbuf_ext_refcnt_update(shinfo, -1) != 0))
+		return 1;
+
+	/* the attached mbufs were freed meanwhile */
+	rte_mbuf_ext_refcnt_set(shinfo, 1);
+	return 0;
+}
+
 /**
  * Decrease reference counter and unlink a mbuf segment
  *
@@ -1179,8 +1375,12 @@ rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 
 	if (likely(rte_mbuf_refcnt_read(m) == 1)) {
 
-		if (!RTE_MBUF_DIRECT(m))
+		if (!RTE_MBUF_DIRECT(m)) {
 			rte_pktmbuf_detach(m);
+			if (RTE_MBUF_HAS_EXTBUF(m) &&
+			    __rte_pktmbuf_pinned_extbuf_decref(m))
+				return NULL;
+		}
 
 		if (m->next != NULL) {
 			m->next = NULL;
@@ -1191,14 +1391,19 @@ rte_pktmbuf_prefree_seg(struct rte_mbuf *m)
 
 	} else if (__rte_mbuf_refcnt_update(m, -1) == 0) {
 
-		if (!RTE_MBUF_DIRECT(m))
+		rte_mbuf_refcnt_set(m, 1);
+
+		if (!RTE_MBUF_DIRECT(m)) {
 			rte_pktmbuf_detach(m);
+			if (RTE_MBUF_HAS_EXTBUF(m) &&
+			    __rte_pktmbuf_pinned_extbuf_decref(m))
+				return NULL;
+		}
 
 		if (m->next != NULL) {
 			m->next = NULL;
 			m->nb_segs = 1;
 		}
-		rte_mbuf_refcnt_set(m, 1);
 
 		return m;
 	}
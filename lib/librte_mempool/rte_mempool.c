@@ -41,6 +41,14 @@ static struct rte_tailq_elem rte_mempool_tailq = {
 };
 EAL_REGISTER_TAILQ(rte_mempool_tailq)
 
+RTE_TRACE_POINT_DEFINE(rte_mempool_trace_generic_put);
+RTE_TRACE_POINT_DEFINE(rte_mempool_trace_generic_get);
+
+RTE_TRACE_POINT_REGISTER(rte_mempool_trace_generic_put,
+	"lib.mempool.generic.put", "mempool,cache,nb_objs");
+RTE_TRACE_POINT_REGISTER(rte_mempool_trace_generic_get,
+	"lib.mempool.generic.get", "mempool,cache,nb_objs,ret");
+
 #define CACHE_FLUSHTHRESH_MULTIPLIER 1.5
 #define CALC_CACHE_FLUSHTHRESH(c)	\
 	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
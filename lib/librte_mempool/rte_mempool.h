@@ -50,6 +50,7 @@
 #include <rte_ring.h>
 #include <rte_memcpy.h>
 #include <rte_common.h>
+#include <rte_trace.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -1205,6 +1206,10 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 	cache->len = 0;
 }
 
+/* fast path tracepoints, compiled in with RTE_ENABLE_TRACE_FP */
+RTE_TRACE_POINT_DECLARE(rte_mempool_trace_generic_put);
+RTE_TRACE_POINT_DECLARE(rte_mempool_trace_generic_get);
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1280,6 +1285,7 @@ static __rte_always_inline void
 rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 			unsigned int n, struct rte_mempool_cache *cache)
 {
+	rte_trace_point_emit_fp(rte_mempool_trace_generic_put, mp, cache, n);
 	__mempool_check_cookies(mp, obj_table, n, 0);
 	__mempool_generic_put(mp, obj_table, n, cache);
 }
@@ -1425,6 +1431,8 @@ rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 	ret = __mempool_generic_get(mp, obj_table, n, cache);
 	if (ret == 0)
 		__mempool_check_cookies(mp, obj_table, n, 1);
+	rte_trace_point_emit_fp(rte_mempool_trace_generic_get, mp, cache, n,
+			ret);
 	return ret;
 }
 
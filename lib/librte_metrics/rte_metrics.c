@@ -2,10 +2,14 @@
  * Copyright(c) 2017 Intel Corporation
  */
 
+#include <stdbool.h>
+#include <stdio.h>
 #include <string.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
 #include <rte_string_fns.h>
 #include <rte_malloc.h>
 #include <rte_metrics.h>
@@ -15,6 +19,15 @@
 
 #define RTE_METRICS_MAX_METRICS 256
 #define RTE_METRICS_MEMZONE_NAME "RTE_METRICS"
+#define RTE_METRICS_SHARD_MEMZONE_NAME "RTE_METRICS_SHARD_%u"
+
+/* shard of the writers which are not EAL threads, updated under the lock */
+#define RTE_METRICS_SHARD_UNOWNED RTE_MAX_LCORE
+#define RTE_METRICS_NB_SHARDS (RTE_MAX_LCORE + 1)
+/* values of a set in a shard: global values then the ones of each port */
+#define RTE_METRICS_SHARD_VALUES(cnt) \
+	RTE_ALIGN((cnt) * (RTE_MAX_ETHPORTS + 1), \
+		RTE_CACHE_LINE_SIZE / sizeof(uint64_t))
 
 /**
  * Internal stats metadata and value entry.
@@ -32,6 +45,10 @@ struct rte_metrics_meta_s {
 	uint16_t idx_next_set;
 	/** Index of next metric in set (zero for none) */
 	uint16_t idx_next_stat;
+	/** Index of the first metric of a sharded set */
+	uint16_t idx_shard_set;
+	/** Number of metrics of a sharded set (zero if not sharded) */
+	uint16_t cnt_shard_set;
 };
 
 /**
@@ -55,6 +72,56 @@ struct rte_metrics_data_s {
 	rte_spinlock_t lock;
 };
 
+/*
+ * Values of the sharded sets, indexed by the key of their first metric.
+ * Cached per process since the shard memzones are looked up by name.
+ */
+static uint64_t *shard_values[RTE_METRICS_MAX_METRICS];
+/* Metrics memzone cached for the shard writers */
+static struct rte_metrics_data_s *shard_stats;
+
+static uint64_t *
+metrics_shard_lookup(uint16_t idx_set)
+{
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+	const struct rte_memzone *memzone;
+
+	if (likely(shard_values[idx_set] != NULL))
+		return shard_values[idx_set];
+
+	snprintf(mz_name, sizeof(mz_name), RTE_METRICS_SHARD_MEMZONE_NAME,
+		 idx_set);
+	memzone = rte_memzone_lookup(mz_name);
+	if (memzone == NULL)
+		return NULL;
+	shard_values[idx_set] = memzone->addr;
+
+	return shard_values[idx_set];
+}
+
+/* sum of the shards of a metric */
+static uint64_t
+metrics_shard_sum(const struct rte_metrics_meta_s *entry, uint16_t idx_metric,
+		  int port_id)
+{
+	uint32_t stride = RTE_METRICS_SHARD_VALUES(entry->cnt_shard_set);
+	const uint64_t *values;
+	uint64_t sum = 0;
+	uint32_t offset;
+	unsigned int shard;
+
+	values = metrics_shard_lookup(entry->idx_shard_set);
+	if (values == NULL)
+		return 0;
+
+	offset = (port_id == RTE_METRICS_GLOBAL ? 0 : port_id + 1) *
+		entry->cnt_shard_set + idx_metric - entry->idx_shard_set;
+	for (shard = 0; shard < RTE_METRICS_NB_SHARDS; shard++)
+		sum += values[shard * stride + offset];
+
+	return sum;
+}
+
 void
 rte_metrics_init(int socket_id)
 {
@@ -79,8 +146,10 @@ rte_metrics_init(int socket_id)
 int
 rte_metrics_deinit(void)
 {
+	char mz_name[RTE_MEMZONE_NAMESIZE];
 	struct rte_metrics_data_s *stats;
 	const struct rte_memzone *memzone;
+	uint16_t idx;
 
 	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
 		return -EINVAL;
@@ -90,6 +159,16 @@ rte_metrics_deinit(void)
 		return -EIO;
 
 	stats = memzone->addr;
+	for (idx = 0; idx < stats->cnt_stats; idx++) {
+		if (stats->metadata[idx].cnt_shard_set == 0 ||
+		    stats->metadata[idx].idx_shard_set != idx)
+			continue;
+		snprintf(mz_name, sizeof(mz_name),
+			 RTE_METRICS_SHARD_MEMZONE_NAME, idx);
+		rte_memzone_free(rte_memzone_lookup(mz_name));
+	}
+	memset(shard_values, 0, sizeof(shard_values));
+	shard_stats = NULL;
 	memset(stats, 0, sizeof(struct rte_metrics_data_s));
 
 	return rte_memzone_free(memzone);
@@ -104,9 +183,11 @@ rte_metrics_reg_name(const char *name)
 	return rte_metrics_reg_names(list_names, 1);
 }
 
-int
-rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
+static int
+metrics_reg_names(const char * const *names, uint16_t cnt_names,
+		  bool sharded)
 {
+	char mz_name[RTE_MEMZONE_NAMESIZE];
 	struct rte_metrics_meta_s *entry = NULL;
 	struct rte_metrics_data_s *stats;
 	const struct rte_memzone *memzone;
@@ -130,6 +211,21 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 
 	rte_spinlock_lock(&stats->lock);
 
+	if (sharded) {
+		snprintf(mz_name, sizeof(mz_name),
+			 RTE_METRICS_SHARD_MEMZONE_NAME, stats->cnt_stats);
+		memzone = rte_memzone_reserve_aligned(mz_name,
+			RTE_METRICS_NB_SHARDS *
+			RTE_METRICS_SHARD_VALUES(cnt_names) * sizeof(uint64_t),
+			rte_socket_id(), 0, RTE_CACHE_LINE_SIZE);
+		if (memzone == NULL) {
+			rte_spinlock_unlock(&stats->lock);
+			return -ENOMEM;
+		}
+		memset(memzone->addr, 0, memzone->len);
+		shard_values[stats->cnt_stats] = memzone->addr;
+	}
+
 	/* Overwritten later if this is actually first set.. */
 	stats->metadata[stats->idx_last_set].idx_next_set = stats->cnt_stats;
 
@@ -139,10 +235,15 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 		entry = &stats->metadata[idx_name + stats->cnt_stats];
 		strlcpy(entry->name, names[idx_name], RTE_METRICS_MAX_NAME_LEN);
 		memset(entry->value, 0, sizeof(entry->value));
+		entry->global_value = 0;
 		entry->idx_next_stat = idx_name + stats->cnt_stats + 1;
+		entry->idx_shard_set = idx_base;
+		entry->cnt_shard_set = sharded ? cnt_names : 0;
 	}
 	entry->idx_next_stat = 0;
 	entry->idx_next_set = 0;
+	/* publish the set to the lock-free shard writers */
+	rte_smp_wmb();
 	stats->cnt_stats += cnt_names;
 
 	rte_spinlock_unlock(&stats->lock);
@@ -150,6 +251,18 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 	return idx_base;
 }
 
+int
+rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
+{
+	return metrics_reg_names(names, cnt_names, false);
+}
+
+int
+rte_metrics_reg_names_sharded(const char * const *names, uint16_t cnt_names)
+{
+	return metrics_reg_names(names, cnt_names, true);
+}
+
 int
 rte_metrics_update_value(int port_id, uint16_t key, const uint64_t value)
 {
@@ -218,6 +331,70 @@ rte_metrics_update_values(int port_id,
 	return 0;
 }
 
+int
+rte_metrics_update_shard_values(int port_id,
+	uint16_t key,
+	const uint64_t *values,
+	uint32_t count)
+{
+	struct rte_metrics_data_s *stats = shard_stats;
+	const struct rte_metrics_meta_s *entry;
+	const struct rte_memzone *memzone;
+	unsigned int shard = rte_lcore_id();
+	uint64_t *shard_set;
+	uint32_t idx_value;
+	uint32_t offset;
+
+	if (port_id != RTE_METRICS_GLOBAL &&
+			(port_id < 0 || port_id >= RTE_MAX_ETHPORTS))
+		return -EINVAL;
+
+	if (values == NULL)
+		return -EINVAL;
+
+	if (unlikely(stats == NULL || stats->cnt_stats == 0)) {
+		memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
+		if (memzone == NULL)
+			return -EIO;
+		stats = shard_stats = memzone->addr;
+	}
+
+	if (key >= stats->cnt_stats)
+		return -EINVAL;
+	rte_smp_rmb();
+	entry = &stats->metadata[key];
+	if (entry->cnt_shard_set == 0)
+		return -EINVAL;
+	/* Check update does not cross set border */
+	if (key + count > entry->idx_shard_set + entry->cnt_shard_set)
+		return -ERANGE;
+
+	shard_set = metrics_shard_lookup(entry->idx_shard_set);
+	if (shard_set == NULL)
+		return -EIO;
+
+	offset = (port_id == RTE_METRICS_GLOBAL ? 0 : port_id + 1) *
+		entry->cnt_shard_set + key - entry->idx_shard_set;
+
+	if (unlikely(shard >= RTE_MAX_LCORE)) {
+		/* writers which are not EAL threads share a locked shard */
+		shard_set += RTE_METRICS_SHARD_UNOWNED *
+			RTE_METRICS_SHARD_VALUES(entry->cnt_shard_set);
+		rte_spinlock_lock(&stats->lock);
+		for (idx_value = 0; idx_value < count; idx_value++)
+			shard_set[offset + idx_value] = values[idx_value];
+		rte_spinlock_unlock(&stats->lock);
+		return 0;
+	}
+
+	/* the shard of an lcore is only written by this lcore */
+	shard_set += shard * RTE_METRICS_SHARD_VALUES(entry->cnt_shard_set);
+	for (idx_value = 0; idx_value < count; idx_value++)
+		shard_set[offset + idx_value] = values[idx_value];
+
+	return 0;
+}
+
 int
 rte_metrics_get_names(struct rte_metric_name *names,
 	uint16_t capacity)
@@ -284,6 +461,10 @@ rte_metrics_get_values(int port_id,
 				entry = &stats->metadata[idx_name];
 				values[idx_name].key = idx_name;
 				values[idx_name].value = entry->global_value;
+				if (entry->cnt_shard_set != 0)
+					values[idx_name].value +=
+						metrics_shard_sum(entry,
+							idx_name, port_id);
 			}
 		else
 			for (idx_name = 0;
@@ -292,6 +473,10 @@ rte_metrics_get_values(int port_id,
 				entry = &stats->metadata[idx_name];
 				values[idx_name].key = idx_name;
 				values[idx_name].value = entry->value[port_id];
+				if (entry->cnt_shard_set != 0)
+					values[idx_name].value +=
+						metrics_shard_sum(entry,
+							idx_name, port_id);
 			}
 	}
 	return_value = stats->cnt_stats;
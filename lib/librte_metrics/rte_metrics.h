@@ -140,6 +140,36 @@ int rte_metrics_reg_name(const char *name);
  */
 int rte_metrics_reg_names(const char * const *names, uint16_t cnt_names);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Register a set of sharded metrics.
+ *
+ * The values of a sharded set are written by rte_metrics_update_shard_values()
+ * into a shard owned by the calling lcore, without any lock or atomic
+ * operation. rte_metrics_get_values() reports the sum of the shards of
+ * each metric, added to the value set by rte_metrics_update_values() if any,
+ * so each writer should publish its own share of a counter.
+ *
+ * @param names
+ *   List of metric names
+ *
+ * @param cnt_names
+ *   Number of metrics in set
+ *
+ * @return
+ *  - Zero or positive: Success (index key of start of set)
+ *  - -EIO: Error, unable to access metrics shared memory
+ *    (rte_metrics_init() not called)
+ *  - -EINVAL: Error, invalid parameters
+ *  - -ENOMEM: Error, maximum metrics reached or not enough memory for
+ *    the shards
+ */
+__rte_experimental
+int rte_metrics_reg_names_sharded(const char * const *names,
+	uint16_t cnt_names);
+
 /**
  * Get metric name-key lookup table.
  *
@@ -233,6 +263,40 @@ int rte_metrics_update_values(
 	const uint64_t *values,
 	uint32_t count);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Updates the calling lcore shard of a sharded metric set. Note that it
+ * is an error to try to update across a set boundary.
+ *
+ * The shard of an EAL thread is written with plain stores, so no two
+ * threads may share an lcore id while updating the same set. Threads
+ * which are not EAL threads share a shard updated under a lock.
+ *
+ * @param port_id
+ *   Port to update metrics for
+ * @param key
+ *   Id of the first metric to update, in a set registered by
+ *   rte_metrics_reg_names_sharded()
+ * @param values
+ *   Set of new values of the calling lcore shard
+ * @param count
+ *   Number of new values
+ *
+ * @return
+ *   - -ERANGE if count exceeds metric set size
+ *   - -EINVAL if the key is not part of a sharded set
+ *   - -EIO if unable to access shared metrics memory
+ *   - Zero on success
+ */
+__rte_experimental
+int rte_metrics_update_shard_values(
+	int port_id,
+	uint16_t key,
+	const uint64_t *values,
+	uint32_t count);
+
 #ifdef __cplusplus
 }
 #endif
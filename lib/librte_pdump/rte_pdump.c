@@ -2,17 +2,26 @@
  * Copyright(c) 2016-2018 Intel Corporation
  */
 
+#include <stdlib.h>
+#include <unistd.h>
+
 #include <rte_memcpy.h>
+#include <rte_memzone.h>
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
 #include <rte_lcore.h>
 #include <rte_log.h>
 #include <rte_errno.h>
+#include <rte_atomic.h>
 #include <rte_string_fns.h>
+#ifdef RTE_LIBRTE_BPF
+#include <rte_bpf.h>
+#endif
 
 #include "rte_pdump.h"
 
 #define DEVICE_ID_SIZE 64
+#define PDUMP_BPF_NAME_SIZE 64
 /* Macros for printing using RTE_LOG */
 #define RTE_LOGTYPE_PDUMP RTE_LOGTYPE_USER1
 
@@ -25,7 +34,8 @@ enum pdump_operation {
 };
 
 enum pdump_version {
-	V1 = 1
+	V1 = 1,
+	V2 = 2
 };
 
 struct pdump_request {
@@ -47,9 +57,60 @@ struct pdump_request {
 			struct rte_mempool *mp;
 			void *filter;
 		} dis_v1;
+		struct enable_v2 {
+			char device[DEVICE_ID_SIZE];
+			uint16_t queue;
+			struct rte_ring *ring;
+			struct rte_mempool *mp;
+			void *filter;
+			uint32_t snaplen;
+			uint32_t sample_rate;
+			/* memzone holding the BPF program, empty for none */
+			char bpf_mz[RTE_MEMZONE_NAMESIZE];
+		} en_v2;
 	} data;
 };
 
+#define PDUMP_REQ_V1_LEN \
+	(offsetof(struct pdump_request, data) + sizeof(struct enable_v1))
+#define PDUMP_REQ_V2_LEN \
+	(offsetof(struct pdump_request, data) + sizeof(struct enable_v2))
+
+/*
+ * BPF program serialized by the requester into a memzone, as process
+ * local pointers cannot be passed to the primary and the program does not
+ * fit in an IPC message:
+ * header, instructions, variable symbols, then the variable values.
+ */
+struct pdump_bpf_hdr {
+	uint32_t nb_ins;
+	uint32_t nb_var;
+	uint32_t var_sz;  /* total size of the variable values */
+	uint32_t arg_type;
+	uint64_t arg_size;
+	uint64_t arg_buf_size;
+};
+
+struct pdump_bpf_var {
+	char name[PDUMP_BPF_NAME_SIZE];
+	uint32_t type;
+	uint32_t ofs;	   /* offset of the value after the symbols */
+	uint64_t size;
+	uint64_t buf_size;
+	uint64_t addr;	   /* address in the requester, to relocate */
+};
+
+/*
+ * BPF filter loaded for a queue, with the primary copies of the variables
+ * it references.
+ */
+struct pdump_bpf {
+	struct pdump_bpf *next; /* in the list of retired filters */
+	struct rte_bpf *bpf;
+	uint64_t (*jit)(void *);
+	uint8_t vars[];
+};
+
 struct pdump_response {
 	uint16_t ver;
 	uint16_t res_op;
@@ -61,13 +122,24 @@ static struct pdump_rxtx_cbs {
 	struct rte_mempool *mp;
 	const struct rte_eth_rxtx_callback *cb;
 	void *filter;
+	struct pdump_bpf *bpf;
+	uint32_t snaplen;
+	uint32_t sample_rate;
+	uint32_t sample_cnt;
 } rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT],
 tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
+/*
+ * Filters of removed callbacks: the data path may still be running them,
+ * so they are only destroyed on uninit.
+ */
+static struct pdump_bpf *retired_bpf;
+
 static inline int
-pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
+pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m,
+			uint16_t len)
 {
-	if (rte_pktmbuf_tailroom(seg) < m->data_len) {
+	if (rte_pktmbuf_tailroom(seg) < len) {
 		RTE_LOG(ERR, PDUMP,
 			"User mempool: insufficient data_len of mbuf\n");
 		return -EINVAL;
@@ -80,7 +152,7 @@ pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
 	seg->ol_flags = m->ol_flags;
 	seg->packet_type = m->packet_type;
 	seg->vlan_tci_outer = m->vlan_tci_outer;
-	seg->data_len = m->data_len;
+	seg->data_len = len;
 	seg->pkt_len = seg->data_len;
 	rte_memcpy(rte_pktmbuf_mtod(seg, void *),
 			rte_pktmbuf_mtod(m, void *),
@@ -89,12 +161,17 @@ pdump_pktmbuf_copy_data(struct rte_mbuf *seg, const struct rte_mbuf *m)
 	return 0;
 }
 
+/*
+ * Copy at most snaplen bytes of the packet (whole packet if snaplen is 0),
+ * segments past the snap length are neither allocated nor copied.
+ */
 static inline struct rte_mbuf *
-pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
+pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t snaplen)
 {
 	struct rte_mbuf *m_dup, *seg, **prev;
-	uint32_t pktlen;
-	uint16_t nseg;
+	uint32_t pktlen, remain;
+	uint16_t nseg, len;
 
 	m_dup = rte_pktmbuf_alloc(mp);
 	if (unlikely(m_dup == NULL))
@@ -103,11 +180,15 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 	seg = m_dup;
 	prev = &seg->next;
 	pktlen = m->pkt_len;
+	if (snaplen != 0 && snaplen < pktlen)
+		pktlen = snaplen;
+	remain = pktlen;
 	nseg = 0;
 
 	do {
 		nseg++;
-		if (pdump_pktmbuf_copy_data(seg, m) < 0) {
+		len = RTE_MIN(remain, (uint32_t)m->data_len);
+		if (pdump_pktmbuf_copy_data(seg, m, len) < 0) {
 			if (seg != m_dup)
 				rte_pktmbuf_free_seg(seg);
 			rte_pktmbuf_free(m_dup);
@@ -115,7 +196,8 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 		}
 		*prev = seg;
 		prev = &seg->next;
-	} while ((m = m->next) != NULL &&
+		remain -= len;
+	} while (remain != 0 && (m = m->next) != NULL &&
 			(seg = rte_pktmbuf_alloc(mp)) != NULL);
 
 	*prev = NULL;
@@ -132,6 +214,23 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 	return m_dup;
 }
 
+/* run the BPF filter over the burst, rc of 0 means the packet is skipped */
+static inline void
+pdump_filter(const struct pdump_bpf *bpf, struct rte_mbuf **pkts,
+		uint64_t *rcs, uint16_t nb_pkts)
+{
+	unsigned int i;
+
+#ifdef RTE_LIBRTE_BPF
+	if (bpf->jit == NULL) {
+		rte_bpf_exec_burst(bpf->bpf, (void **)pkts, rcs, nb_pkts);
+		return;
+	}
+#endif
+	for (i = 0; i < nb_pkts; i++)
+		rcs[i] = bpf->jit(pkts[i]);
+}
+
 static inline void
 pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 {
@@ -139,7 +238,9 @@ pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 	int ring_enq;
 	uint16_t d_pkts = 0;
 	struct rte_mbuf *dup_bufs[nb_pkts];
+	uint64_t rcs[nb_pkts];
 	struct pdump_rxtx_cbs *cbs;
+	const struct pdump_bpf *bpf;
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
 	struct rte_mbuf *p;
@@ -147,12 +248,28 @@ pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 	cbs  = user_params;
 	ring = cbs->ring;
 	mp = cbs->mp;
+	bpf = cbs->bpf;
+
+	if (bpf != NULL)
+		pdump_filter(bpf, pkts, rcs, nb_pkts);
+
 	for (i = 0; i < nb_pkts; i++) {
-		p = pdump_pktmbuf_copy(pkts[i], mp);
+		if (bpf != NULL && rcs[i] == 0)
+			continue;
+		/* callbacks of a queue run on one lcore, no atomics needed */
+		if (cbs->sample_rate > 1) {
+			if (++cbs->sample_cnt < cbs->sample_rate)
+				continue;
+			cbs->sample_cnt = 0;
+		}
+		p = pdump_pktmbuf_copy(pkts[i], mp, cbs->snaplen);
 		if (p)
 			dup_bufs[d_pkts++] = p;
 	}
 
+	if (d_pkts == 0)
+		return;
+
 	ring_enq = rte_ring_enqueue_burst(ring, (void *)dup_bufs, d_pkts, NULL);
 	if (unlikely(ring_enq < d_pkts)) {
 		RTE_LOG(DEBUG, PDUMP,
@@ -181,10 +298,176 @@ pdump_tx(uint16_t port __rte_unused, uint16_t qidx __rte_unused,
 	return nb_pkts;
 }
 
+static void
+pdump_destroy_filter(struct pdump_bpf *bpf)
+{
+#ifdef RTE_LIBRTE_BPF
+	rte_bpf_destroy(bpf->bpf);
+#endif
+	free(bpf);
+}
+
+/*
+ * Retire the filter of a queue whose callback has been removed. The data
+ * path may still be running the removed callback, the filter is destroyed
+ * on uninit only.
+ */
+static void
+pdump_retire_filter(struct pdump_rxtx_cbs *cbs)
+{
+	if (cbs->bpf == NULL)
+		return;
+	cbs->bpf->next = retired_bpf;
+	retired_bpf = cbs->bpf;
+	cbs->bpf = NULL;
+}
+
+#ifdef RTE_LIBRTE_BPF
+/* rewrite the 64-bit immediate loads of a requester variable address */
+static void
+pdump_relocate_var(struct ebpf_insn *ins, uint32_t nb_ins, uint64_t addr,
+		const void *val)
+{
+	uint64_t imm;
+	uint32_t i;
+
+	for (i = 0; i + 1 < nb_ins; i++) {
+		if (ins[i].code != (BPF_LD | BPF_IMM | EBPF_DW))
+			continue;
+		imm = (uint32_t)ins[i].imm |
+			(uint64_t)(uint32_t)ins[i + 1].imm << 32;
+		if (imm == addr) {
+			ins[i].imm = (uint32_t)(uintptr_t)val;
+			ins[i + 1].imm = (uint32_t)((uint64_t)(uintptr_t)val >> 32);
+		}
+		i++;
+	}
+}
+#endif
+
+/*
+ * Every queue gets its own instance of the filter, with its own copy of
+ * the variables, so that its lifetime follows the callback of that queue.
+ */
+static int
+pdump_load_filter(struct pdump_rxtx_cbs *cbs, const struct rte_memzone *mz)
+{
+#ifdef RTE_LIBRTE_BPF
+	const struct pdump_bpf_hdr *hdr = mz->addr;
+	const struct pdump_bpf_var *var;
+	struct rte_bpf_xsym *xsym = NULL;
+	struct ebpf_insn *ins = NULL;
+	struct rte_bpf_prm prm;
+	struct rte_bpf_jit jit;
+	struct pdump_bpf *bpf;
+	const uint8_t *vals;
+	size_t sz;
+	uint32_t i;
+	int ret;
+
+	sz = sizeof(*hdr) + hdr->nb_ins * sizeof(*ins) +
+		hdr->nb_var * sizeof(*var) + hdr->var_sz;
+	if (hdr->nb_ins == 0 || sz > mz->len) {
+		RTE_LOG(ERR, PDUMP, "invalid BPF filter in %s\n", mz->name);
+		return -EINVAL;
+	}
+	if (hdr->arg_type != RTE_BPF_ARG_PTR_MBUF) {
+		RTE_LOG(ERR, PDUMP,
+			"BPF filter argument must be RTE_BPF_ARG_PTR_MBUF\n");
+		return -EINVAL;
+	}
+
+	var = (const struct pdump_bpf_var *)((const struct ebpf_insn *)
+			(hdr + 1) + hdr->nb_ins);
+	vals = (const uint8_t *)(var + hdr->nb_var);
+
+	bpf = calloc(1, sizeof(*bpf) + hdr->var_sz);
+	ins = malloc(hdr->nb_ins * sizeof(*ins));
+	if (hdr->nb_var != 0)
+		xsym = calloc(hdr->nb_var, sizeof(*xsym));
+	if (bpf == NULL || ins == NULL ||
+			(hdr->nb_var != 0 && xsym == NULL)) {
+		ret = -ENOMEM;
+		goto error;
+	}
+	memcpy(ins, hdr + 1, hdr->nb_ins * sizeof(*ins));
+	memcpy(bpf->vars, vals, hdr->var_sz);
+
+	for (i = 0; i != hdr->nb_var; i++) {
+		if (var[i].ofs + var[i].size > hdr->var_sz ||
+				var[i].name[sizeof(var[i].name) - 1] != '\0') {
+			RTE_LOG(ERR, PDUMP, "invalid BPF filter in %s\n",
+				mz->name);
+			ret = -EINVAL;
+			goto error;
+		}
+		xsym[i].name = var[i].name;
+		xsym[i].type = RTE_BPF_XTYPE_VAR;
+		xsym[i].var.val = bpf->vars + var[i].ofs;
+		xsym[i].var.desc.type = var[i].type;
+		xsym[i].var.desc.size = var[i].size;
+		xsym[i].var.desc.buf_size = var[i].buf_size;
+		pdump_relocate_var(ins, hdr->nb_ins, var[i].addr,
+				xsym[i].var.val);
+	}
+
+	memset(&prm, 0, sizeof(prm));
+	prm.ins = ins;
+	prm.nb_ins = hdr->nb_ins;
+	prm.xsym = xsym;
+	prm.nb_xsym = hdr->nb_var;
+	prm.prog_arg.type = hdr->arg_type;
+	prm.prog_arg.size = hdr->arg_size;
+	prm.prog_arg.buf_size = hdr->arg_buf_size;
+
+	bpf->bpf = rte_bpf_load(&prm);
+	if (bpf->bpf == NULL) {
+		RTE_LOG(ERR, PDUMP,
+			"failed to load BPF filter, errno=%d\n", rte_errno);
+		ret = -rte_errno;
+		goto error;
+	}
+	if (rte_bpf_get_jit(bpf->bpf, &jit) == 0)
+		bpf->jit = jit.func;
+
+	free(xsym);
+	free(ins);
+	cbs->bpf = bpf;
+	return 0;
+
+error:
+	free(xsym);
+	free(ins);
+	free(bpf);
+	return ret;
+#else
+	RTE_SET_USED(cbs);
+	RTE_SET_USED(mz);
+	RTE_LOG(ERR, PDUMP, "BPF filter requested, but librte_bpf is disabled\n");
+	return -ENOTSUP;
+#endif
+}
+
+static int
+pdump_setup_cbs(struct pdump_rxtx_cbs *cbs, const struct enable_v2 *en,
+		const struct rte_memzone *mz)
+{
+	cbs->ring = en->ring;
+	cbs->mp = en->mp;
+	cbs->snaplen = en->snaplen;
+	cbs->sample_rate = en->sample_rate;
+	cbs->sample_cnt = 0;
+
+	if (mz == NULL)
+		return 0;
+
+	return pdump_load_filter(cbs, mz);
+}
+
 static int
 pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
-				struct rte_ring *ring, struct rte_mempool *mp,
-				uint16_t operation)
+				const struct enable_v2 *en,
+				const struct rte_memzone *mz, uint16_t operation)
 {
 	uint16_t qid;
 	struct pdump_rxtx_cbs *cbs = NULL;
@@ -193,6 +476,8 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 	for (; qid < end_q; qid++) {
 		cbs = &rx_cbs[port][qid];
 		if (cbs && operation == ENABLE) {
+			int ret;
+
 			if (cbs->cb) {
 				RTE_LOG(ERR, PDUMP,
 					"failed to add rx callback for port=%d "
@@ -200,14 +485,19 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 					port, qid);
 				return -EEXIST;
 			}
-			cbs->ring = ring;
-			cbs->mp = mp;
+			ret = pdump_setup_cbs(cbs, en, mz);
+			if (ret < 0)
+				return ret;
 			cbs->cb = rte_eth_add_first_rx_callback(port, qid,
 								pdump_rx, cbs);
 			if (cbs->cb == NULL) {
 				RTE_LOG(ERR, PDUMP,
 					"failed to add rx callback, errno=%d\n",
 					rte_errno);
+				if (cbs->bpf != NULL) {
+					pdump_destroy_filter(cbs->bpf);
+					cbs->bpf = NULL;
+				}
 				return rte_errno;
 			}
 		}
@@ -229,6 +519,7 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 				return ret;
 			}
 			cbs->cb = NULL;
+			pdump_retire_filter(cbs);
 		}
 	}
 
@@ -237,8 +528,8 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 
 static int
 pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
-				struct rte_ring *ring, struct rte_mempool *mp,
-				uint16_t operation)
+				const struct enable_v2 *en,
+				const struct rte_memzone *mz, uint16_t operation)
 {
 
 	uint16_t qid;
@@ -248,6 +539,8 @@ pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 	for (; qid < end_q; qid++) {
 		cbs = &tx_cbs[port][qid];
 		if (cbs && operation == ENABLE) {
+			int ret;
+
 			if (cbs->cb) {
 				RTE_LOG(ERR, PDUMP,
 					"failed to add tx callback for port=%d "
@@ -255,14 +548,19 @@ pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 					port, qid);
 				return -EEXIST;
 			}
-			cbs->ring = ring;
-			cbs->mp = mp;
+			ret = pdump_setup_cbs(cbs, en, mz);
+			if (ret < 0)
+				return ret;
 			cbs->cb = rte_eth_add_tx_callback(port, qid, pdump_tx,
 								cbs);
 			if (cbs->cb == NULL) {
 				RTE_LOG(ERR, PDUMP,
 					"failed to add tx callback, errno=%d\n",
 					rte_errno);
+				if (cbs->bpf != NULL) {
+					pdump_destroy_filter(cbs->bpf);
+					cbs->bpf = NULL;
+				}
 				return rte_errno;
 			}
 		}
@@ -284,6 +582,7 @@ pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 				return ret;
 			}
 			cbs->cb = NULL;
+			pdump_retire_filter(cbs);
 		}
 	}
 
@@ -298,23 +597,42 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	int ret = 0;
 	uint32_t flags;
 	uint16_t operation;
-	struct rte_ring *ring;
-	struct rte_mempool *mp;
+	struct enable_v2 en;
+	const struct rte_memzone *mz = NULL;
 
 	flags = p->flags;
 	operation = p->op;
 	if (operation == ENABLE) {
-		ret = rte_eth_dev_get_port_by_name(p->data.en_v1.device,
-				&port);
+		if (p->ver == V1) {
+			/* V1 requests have no capture parameters */
+			memset(&en, 0, sizeof(en));
+			strlcpy(en.device, p->data.en_v1.device,
+				sizeof(en.device));
+			en.queue = p->data.en_v1.queue;
+			en.ring = p->data.en_v1.ring;
+			en.mp = p->data.en_v1.mp;
+			en.filter = p->data.en_v1.filter;
+		} else {
+			en = p->data.en_v2;
+			en.bpf_mz[sizeof(en.bpf_mz) - 1] = '\0';
+		}
+		ret = rte_eth_dev_get_port_by_name(en.device, &port);
 		if (ret < 0) {
 			RTE_LOG(ERR, PDUMP,
 				"failed to get port id for device id=%s\n",
-				p->data.en_v1.device);
+				en.device);
 			return -EINVAL;
 		}
-		queue = p->data.en_v1.queue;
-		ring = p->data.en_v1.ring;
-		mp = p->data.en_v1.mp;
+		queue = en.queue;
+		if (en.bpf_mz[0] != '\0') {
+			mz = rte_memzone_lookup(en.bpf_mz);
+			if (mz == NULL) {
+				RTE_LOG(ERR, PDUMP,
+					"failed to find BPF filter %s\n",
+					en.bpf_mz);
+				return -EINVAL;
+			}
+		}
 	} else {
 		ret = rte_eth_dev_get_port_by_name(p->data.dis_v1.device,
 				&port);
@@ -325,8 +643,6 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 			return -EINVAL;
 		}
 		queue = p->data.dis_v1.queue;
-		ring = p->data.dis_v1.ring;
-		mp = p->data.dis_v1.mp;
 	}
 
 	/* validation if packet capture is for all queues */
@@ -364,8 +680,8 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	/* register RX callback */
 	if (flags & RTE_PDUMP_FLAG_RX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_rx_q : queue + 1;
-		ret = pdump_register_rx_callbacks(end_q, port, queue, ring, mp,
-							operation);
+		ret = pdump_register_rx_callbacks(end_q, port, queue, &en,
+							mz, operation);
 		if (ret < 0)
 			return ret;
 	}
@@ -373,8 +689,8 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	/* register TX callback */
 	if (flags & RTE_PDUMP_FLAG_TX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_tx_q : queue + 1;
-		ret = pdump_register_tx_callbacks(end_q, port, queue, ring, mp,
-							operation);
+		ret = pdump_register_tx_callbacks(end_q, port, queue, &en,
+							mz, operation);
 		if (ret < 0)
 			return ret;
 	}
@@ -382,19 +698,38 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	return ret;
 }
 
+/* expected length of a request, 0 for an unknown version */
+static size_t
+pdump_request_len(const struct rte_mp_msg *mp_msg)
+{
+	const struct pdump_request *req =
+		(const struct pdump_request *)mp_msg->param;
+
+	if (mp_msg->len_param < (int)offsetof(struct pdump_request, data))
+		return 0;
+	if (req->ver == V1)
+		return PDUMP_REQ_V1_LEN;
+	/* capture parameters only come with enable */
+	if (req->ver == V2 && req->op == ENABLE)
+		return PDUMP_REQ_V2_LEN;
+	return 0;
+}
+
 static int
 pdump_server(const struct rte_mp_msg *mp_msg, const void *peer)
 {
 	struct rte_mp_msg mp_resp;
 	const struct pdump_request *cli_req;
 	struct pdump_response *resp = (struct pdump_response *)&mp_resp.param;
+	size_t len;
 
 	/* recv client requests */
-	if (mp_msg->len_param != sizeof(*cli_req)) {
+	cli_req = (const struct pdump_request *)mp_msg->param;
+	len = pdump_request_len(mp_msg);
+	if (len == 0 || (size_t)mp_msg->len_param != len) {
 		RTE_LOG(ERR, PDUMP, "failed to recv from client\n");
 		resp->err_value = -EINVAL;
 	} else {
-		cli_req = (const struct pdump_request *)mp_msg->param;
 		resp->ver = cli_req->ver;
 		resp->res_op = cli_req->op;
 		resp->err_value = set_pdump_rxtx_cbs(cli_req);
@@ -424,8 +759,18 @@ rte_pdump_init(void)
 int
 rte_pdump_uninit(void)
 {
+
+	struct pdump_bpf *bpf;
+
 	rte_mp_action_unregister(PDUMP_MP);
 
+	/* filters of removed callbacks are no longer referenced */
+	while (retired_bpf != NULL) {
+		bpf = retired_bpf;
+		retired_bpf = bpf->next;
+		pdump_destroy_filter(bpf);
+	}
+
 	return 0;
 }
 
@@ -492,13 +837,91 @@ pdump_validate_port(uint16_t port, char *name)
 	return 0;
 }
 
+#ifdef RTE_LIBRTE_BPF
+/* serialize the BPF program in a memzone read by the primary */
+static const struct rte_memzone *
+pdump_serialize_filter(const struct rte_bpf_prm *prm)
+{
+	static rte_atomic32_t mz_id;
+	char name[RTE_MEMZONE_NAMESIZE];
+	const struct rte_memzone *mz;
+	const struct rte_bpf_xsym *xsym;
+	struct pdump_bpf_hdr *hdr;
+	struct pdump_bpf_var *var;
+	uint8_t *vals;
+	uint32_t i, var_sz = 0;
+	size_t sz;
+
+	if (prm->ins == NULL || prm->nb_ins == 0 ||
+			(prm->nb_xsym != 0 && prm->xsym == NULL)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	for (i = 0; i != prm->nb_xsym; i++) {
+		xsym = &prm->xsym[i];
+		/* functions are only known to the requester process */
+		if (xsym->type != RTE_BPF_XTYPE_VAR) {
+			RTE_LOG(ERR, PDUMP,
+				"BPF filter function symbols are not supported\n");
+			rte_errno = ENOTSUP;
+			return NULL;
+		}
+		if (xsym->name == NULL || xsym->var.val == NULL ||
+				strlen(xsym->name) >= sizeof(var->name)) {
+			rte_errno = EINVAL;
+			return NULL;
+		}
+		var_sz += RTE_ALIGN_CEIL(xsym->var.desc.size, sizeof(uint64_t));
+	}
+
+	sz = sizeof(*hdr) + prm->nb_ins * sizeof(prm->ins[0]) +
+		prm->nb_xsym * sizeof(*var) + var_sz;
+	snprintf(name, sizeof(name), "pdump_bpf_%d_%d", getpid(),
+		rte_atomic32_add_return(&mz_id, 1));
+	mz = rte_memzone_reserve(name, sz, SOCKET_ID_ANY, 0);
+	if (mz == NULL) {
+		RTE_LOG(ERR, PDUMP, "failed to reserve BPF filter memzone\n");
+		return NULL;
+	}
+
+	hdr = mz->addr;
+	hdr->nb_ins = prm->nb_ins;
+	hdr->nb_var = prm->nb_xsym;
+	hdr->var_sz = var_sz;
+	hdr->arg_type = prm->prog_arg.type;
+	hdr->arg_size = prm->prog_arg.size;
+	hdr->arg_buf_size = prm->prog_arg.buf_size;
+	memcpy(hdr + 1, prm->ins, prm->nb_ins * sizeof(prm->ins[0]));
+
+	var = (struct pdump_bpf_var *)((struct ebpf_insn *)(hdr + 1) +
+			prm->nb_ins);
+	vals = (uint8_t *)(var + prm->nb_xsym);
+	var_sz = 0;
+	for (i = 0; i != prm->nb_xsym; i++) {
+		xsym = &prm->xsym[i];
+		memset(&var[i], 0, sizeof(var[i]));
+		strlcpy(var[i].name, xsym->name, sizeof(var[i].name));
+		var[i].type = xsym->var.desc.type;
+		var[i].ofs = var_sz;
+		var[i].size = xsym->var.desc.size;
+		var[i].buf_size = xsym->var.desc.buf_size;
+		var[i].addr = (uintptr_t)xsym->var.val;
+		memcpy(vals + var_sz, xsym->var.val, xsym->var.desc.size);
+		var_sz += RTE_ALIGN_CEIL(xsym->var.desc.size, sizeof(uint64_t));
+	}
+
+	return mz;
+}
+#endif
+
 static int
 pdump_prepare_client_request(char *device, uint16_t queue,
 				uint32_t flags,
 				uint16_t operation,
 				struct rte_ring *ring,
 				struct rte_mempool *mp,
-				void *filter)
+				void *filter,
+				const struct rte_pdump_params *params)
 {
 	int ret = -1;
 	struct rte_mp_msg mp_req, *mp_rep;
@@ -506,11 +929,43 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 	struct timespec ts = {.tv_sec = 5, .tv_nsec = 0};
 	struct pdump_request *req = (struct pdump_request *)mp_req.param;
 	struct pdump_response *resp;
+	const struct rte_memzone *mz = NULL;
 
-	req->ver = 1;
+	memset(req, 0, sizeof(*req));
+	req->ver = V1;
 	req->flags = flags;
 	req->op = operation;
-	if ((operation & ENABLE) != 0) {
+	mp_req.len_param = PDUMP_REQ_V1_LEN;
+	if ((operation & ENABLE) != 0 && params != NULL) {
+		req->ver = V2;
+		strlcpy(req->data.en_v2.device, device,
+			sizeof(req->data.en_v2.device));
+		req->data.en_v2.queue = queue;
+		req->data.en_v2.ring = ring;
+		req->data.en_v2.mp = mp;
+		req->data.en_v2.filter = filter;
+		req->data.en_v2.snaplen = params->snaplen;
+		req->data.en_v2.sample_rate = params->sample_rate;
+		if (params->prm != NULL) {
+#ifdef RTE_LIBRTE_BPF
+			mz = pdump_serialize_filter(params->prm);
+			if (mz == NULL) {
+				RTE_LOG(ERR, PDUMP,
+					"failed to pass BPF filter, errno=%d\n",
+					rte_errno);
+				return -1;
+			}
+			strlcpy(req->data.en_v2.bpf_mz, mz->name,
+				sizeof(req->data.en_v2.bpf_mz));
+#else
+			RTE_LOG(ERR, PDUMP,
+				"BPF filter requested, but librte_bpf is disabled\n");
+			rte_errno = ENOTSUP;
+			return -1;
+#endif
+		}
+		mp_req.len_param = PDUMP_REQ_V2_LEN;
+	} else if ((operation & ENABLE) != 0) {
 		strlcpy(req->data.en_v1.device, device,
 			sizeof(req->data.en_v1.device));
 		req->data.en_v1.queue = queue;
@@ -527,7 +982,6 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 	}
 
 	strlcpy(mp_req.name, PDUMP_MP, RTE_MP_MAX_NAME_LEN);
-	mp_req.len_param = sizeof(*req);
 	mp_req.num_fds = 0;
 	if (rte_mp_request_sync(&mp_req, &mp_reply, &ts) == 0) {
 		mp_rep = &mp_reply.msgs[0];
@@ -536,6 +990,9 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 		if (!resp->err_value)
 			ret = 0;
 		free(mp_reply.msgs);
+		/* the primary has loaded its own copy of the filter */
+		if (mz != NULL)
+			rte_memzone_free(mz);
 	}
 
 	if (ret < 0)
@@ -544,13 +1001,11 @@ pdump_prepare_client_request(char *device, uint16_t queue,
 	return ret;
 }
 
-int
-rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
-			struct rte_ring *ring,
-			struct rte_mempool *mp,
-			void *filter)
+static int
+pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
+		struct rte_ring *ring, struct rte_mempool *mp, void *filter,
+		const struct rte_pdump_params *params)
 {
-
 	int ret = 0;
 	char name[DEVICE_ID_SIZE];
 
@@ -565,17 +1020,15 @@ rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
 		return ret;
 
 	ret = pdump_prepare_client_request(name, queue, flags,
-						ENABLE, ring, mp, filter);
+					ENABLE, ring, mp, filter, params);
 
 	return ret;
 }
 
-int
-rte_pdump_enable_by_deviceid(char *device_id, uint16_t queue,
-				uint32_t flags,
-				struct rte_ring *ring,
-				struct rte_mempool *mp,
-				void *filter)
+static int
+pdump_enable_by_deviceid(char *device_id, uint16_t queue, uint32_t flags,
+		struct rte_ring *ring, struct rte_mempool *mp, void *filter,
+		const struct rte_pdump_params *params)
 {
 	int ret = 0;
 
@@ -587,11 +1040,51 @@ rte_pdump_enable_by_deviceid(char *device_id, uint16_t queue,
 		return ret;
 
 	ret = pdump_prepare_client_request(device_id, queue, flags,
-						ENABLE, ring, mp, filter);
+					ENABLE, ring, mp, filter, params);
 
 	return ret;
 }
 
+int
+rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
+			struct rte_ring *ring,
+			struct rte_mempool *mp,
+			void *filter)
+{
+	return pdump_enable(port, queue, flags, ring, mp, filter, NULL);
+}
+
+int
+rte_pdump_enable_params(uint16_t port, uint16_t queue, uint32_t flags,
+			struct rte_ring *ring,
+			struct rte_mempool *mp,
+			const struct rte_pdump_params *params)
+{
+	return pdump_enable(port, queue, flags, ring, mp, NULL, params);
+}
+
+int
+rte_pdump_enable_by_deviceid(char *device_id, uint16_t queue,
+				uint32_t flags,
+				struct rte_ring *ring,
+				struct rte_mempool *mp,
+				void *filter)
+{
+	return pdump_enable_by_deviceid(device_id, queue, flags, ring, mp,
+					filter, NULL);
+}
+
+int
+rte_pdump_enable_by_deviceid_params(char *device_id, uint16_t queue,
+				uint32_t flags,
+				struct rte_ring *ring,
+				struct rte_mempool *mp,
+				const struct rte_pdump_params *params)
+{
+	return pdump_enable_by_deviceid(device_id, queue, flags, ring, mp,
+					NULL, params);
+}
+
 int
 rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags)
 {
@@ -606,7 +1099,7 @@ rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags)
 		return ret;
 
 	ret = pdump_prepare_client_request(name, queue, flags,
-						DISABLE, NULL, NULL, NULL);
+						DISABLE, NULL, NULL, NULL, NULL);
 
 	return ret;
 }
@@ -622,7 +1115,7 @@ rte_pdump_disable_by_deviceid(char *device_id, uint16_t queue,
 		return ret;
 
 	ret = pdump_prepare_client_request(device_id, queue, flags,
-						DISABLE, NULL, NULL, NULL);
+						DISABLE, NULL, NULL, NULL, NULL);
 
 	return ret;
 }
@@ -13,6 +13,7 @@
  */
 
 #include <stdint.h>
+#include <rte_compat.h>
 #include <rte_mempool.h>
 #include <rte_ring.h>
 
@@ -29,6 +30,38 @@ enum {
 	RTE_PDUMP_FLAG_RXTX = (RTE_PDUMP_FLAG_RX|RTE_PDUMP_FLAG_TX)
 };
 
+struct rte_bpf_prm;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice
+ *
+ * Capture parameters, applied in the data path of the primary process
+ * before packets are copied to the ring.
+ */
+struct rte_pdump_params {
+	/**
+	 * Maximum number of bytes copied from each packet, 0 copies the
+	 * whole packet. pkt_len of the copy is the truncated length.
+	 */
+	uint32_t snaplen;
+	/**
+	 * Capture one packet out of every sample_rate packets that pass the
+	 * filter, 0 or 1 captures every packet.
+	 */
+	uint32_t sample_rate;
+	/**
+	 * BPF program run on each packet with the mbuf as argument
+	 * (RTE_BPF_ARG_PTR_MBUF), packets for which it returns 0 are not
+	 * captured. NULL disables filtering. The program is copied to the
+	 * primary process, which loads one instance per queue. Only
+	 * variable symbols (RTE_BPF_XTYPE_VAR) are supported, the primary
+	 * gets its own copy of their values at enable time.
+	 * Requires librte_bpf, rte_errno is set to ENOTSUP otherwise.
+	 */
+	const struct rte_bpf_prm *prm;
+};
+
 /**
  * Initialize packet capturing handling
  *
@@ -44,6 +77,8 @@ rte_pdump_init(void);
  * Un initialize packet capturing handling
  *
  * Unregister the IPC action for communication with target (primary) process.
+ * BPF filters of disabled captures are destroyed, so the data path must no
+ * longer be running the capture callbacks.
  *
  * @return
  *    0 on success, -1 on error
@@ -100,6 +135,39 @@ rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
 int
 rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enables packet capturing on given port and queue with filtering,
+ * sampling and snap length truncation.
+ *
+ * @param port
+ *  port on which packet capturing should be enabled.
+ * @param queue
+ *  queue of a given port on which packet capturing should be enabled.
+ *  users should pass on value UINT16_MAX to enable packet capturing on all
+ *  queues of a given port.
+ * @param flags
+ *  flags specifies RTE_PDUMP_FLAG_RX/RTE_PDUMP_FLAG_TX/RTE_PDUMP_FLAG_RXTX
+ *  on which packet capturing should be enabled for a given port and queue.
+ * @param ring
+ *  ring on which captured packets will be enqueued for user.
+ * @param mp
+ *  mempool on to which original packets will be mirrored or duplicated.
+ * @param params
+ *  capture parameters, NULL behaves as rte_pdump_enable().
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+__rte_experimental
+int
+rte_pdump_enable_params(uint16_t port, uint16_t queue, uint32_t flags,
+		struct rte_ring *ring,
+		struct rte_mempool *mp,
+		const struct rte_pdump_params *params);
+
 /**
  * Enables packet capturing on given device id and queue.
  * device_id can be name or pci address of device.
@@ -153,6 +221,41 @@ int
 rte_pdump_disable_by_deviceid(char *device_id, uint16_t queue,
 				uint32_t flags);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enables packet capturing on given device id and queue with filtering,
+ * sampling and snap length truncation.
+ * device_id can be name or pci address of device.
+ *
+ * @param device_id
+ *  device id on which packet capturing should be enabled.
+ * @param queue
+ *  queue of a given device id on which packet capturing should be enabled.
+ *  users should pass on value UINT16_MAX to enable packet capturing on all
+ *  queues of a given device id.
+ * @param flags
+ *  flags specifies RTE_PDUMP_FLAG_RX/RTE_PDUMP_FLAG_TX/RTE_PDUMP_FLAG_RXTX
+ *  on which packet capturing should be enabled for a given port and queue.
+ * @param ring
+ *  ring on which captured packets will be enqueued for user.
+ * @param mp
+ *  mempool on to which original packets will be mirrored or duplicated.
+ * @param params
+ *  capture parameters, NULL behaves as rte_pdump_enable_by_deviceid().
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+__rte_experimental
+int
+rte_pdump_enable_by_deviceid_params(char *device_id, uint16_t queue,
+				uint32_t flags,
+				struct rte_ring *ring,
+				struct rte_mempool *mp,
+				const struct rte_pdump_params *params);
+
 #ifdef __cplusplus
 }
 #endif
@@ -6,6 +6,7 @@
 #include <string.h>
 
 #include <rte_string_fns.h>
+#include <rte_cycles.h>
 #include <rte_log.h>
 #include <rte_mbuf.h>
 #include <rte_eal_memconfig.h>
@@ -29,6 +30,18 @@ EAL_REGISTER_TAILQ(rte_reorder_tailq)
 /* Macros for printing using RTE_LOG */
 #define RTE_LOGTYPE_REORDER	RTE_LOGTYPE_USER1
 
+/*
+ * Multi-producer slots hold either a mbuf pointer, or, once the drain went
+ * past them, the odd value below recording the last sequence number which
+ * went through the slot. 0 is a slot which was never used.
+ */
+#define MP_SLOT_DONE(seqn) (((uint64_t)(seqn) << 1) | 1)
+#define MP_SLOT_IS_MBUF(v) ((v) != 0 && ((v) & 1) == 0)
+#define MP_SLOT_SEQN(v) ((uint32_t)((v) >> 1))
+
+/* Number of slots a drain call looks at to find the end of a gap */
+#define MP_GAP_SCAN 64
+
 /* A generic circular buffer */
 struct cir_buffer {
 	unsigned int size;   /**< Number of entries that can be stored */
@@ -46,6 +59,15 @@ struct rte_reorder_buffer {
 	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
 	struct cir_buffer order_buf; /**< buffer used to reorder entries */
 	int is_initialized;
+	/* Multi-producer mode, see rte_reorder_mp_create() */
+	int is_mp;
+	uint32_t first_seqn;  /**< min_seqn after a reset */
+	uint64_t *slots;      /**< One slot per sequence number of the window */
+	/* Drain state, away from what the producers read */
+	uint32_t gap_seqn __rte_cache_aligned; /**< Seq. number waited for */
+	unsigned int gap_scan; /**< Next slot to look at behind the gap */
+	uint64_t gap_tsc;     /**< When the drain started waiting, 0 if not */
+	uint64_t gap_timeout; /**< Cycles to wait before skipping a gap */
 } __rte_cache_aligned;
 
 static void
@@ -157,12 +179,113 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 	return b;
 }
 
+static void
+rte_reorder_mp_init(struct rte_reorder_buffer *b, unsigned int bufsize,
+		const char *name, const struct rte_reorder_mp_params *params)
+{
+	const uint64_t hz = rte_get_timer_hz();
+	const uint64_t ns = params->gap_timeout_ns;
+
+	memset(b, 0, bufsize);
+	strlcpy(b->name, name, sizeof(b->name));
+	b->memsize = bufsize;
+	b->order_buf.size = params->size;
+	b->order_buf.mask = params->size - 1;
+	b->is_initialized = 1;
+	b->is_mp = 1;
+	b->first_seqn = params->first_seqn;
+	b->min_seqn = params->first_seqn;
+	if (ns == RTE_REORDER_MP_NO_TIMEOUT)
+		b->gap_timeout = UINT64_MAX;
+	else
+		b->gap_timeout = ns / NS_PER_S * hz +
+				ns % NS_PER_S * hz / NS_PER_S;
+	b->slots = (void *)&b[1];
+}
+
+struct rte_reorder_buffer *
+rte_reorder_mp_create(const char *name, unsigned int socket_id,
+		const struct rte_reorder_mp_params *params)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_tailq_entry *te;
+	struct rte_reorder_list *reorder_list;
+	unsigned int bufsize;
+
+	reorder_list = RTE_TAILQ_CAST(rte_reorder_tailq.head, rte_reorder_list);
+
+	/* Check user arguments. */
+	if (params == NULL || !rte_is_power_of_2(params->size) ||
+			params->size > RTE_REORDER_MP_MAX_SIZE) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer size"
+				" - Not a power of 2 up to %u\n",
+				RTE_REORDER_MP_MAX_SIZE);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (name == NULL) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer name ptr:"
+					" NULL\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	bufsize = sizeof(*b) + params->size * sizeof(b->slots[0]);
+
+	rte_mcfg_tailq_write_lock();
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, reorder_list, next) {
+		b = (struct rte_reorder_buffer *) te->data;
+		if (strncmp(name, b->name, RTE_REORDER_NAMESIZE) == 0)
+			break;
+	}
+	if (te != NULL) {
+		b = NULL;
+		rte_errno = EEXIST;
+		goto exit;
+	}
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("REORDER_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, REORDER, "Failed to allocate tailq entry\n");
+		rte_errno = ENOMEM;
+		b = NULL;
+		goto exit;
+	}
+
+	/* Allocate memory to store the reorder buffer structure. */
+	b = rte_zmalloc_socket("REORDER_BUFFER", bufsize, 0, socket_id);
+	if (b == NULL) {
+		RTE_LOG(ERR, REORDER, "Memzone allocation failed\n");
+		rte_errno = ENOMEM;
+		rte_free(te);
+	} else {
+		rte_reorder_mp_init(b, bufsize, name, params);
+		te->data = (void *)b;
+		TAILQ_INSERT_TAIL(reorder_list, te, next);
+	}
+
+exit:
+	rte_mcfg_tailq_write_unlock();
+	return b;
+}
+
 void
 rte_reorder_reset(struct rte_reorder_buffer *b)
 {
 	char name[RTE_REORDER_NAMESIZE];
 
 	rte_reorder_free_mbufs(b);
+	if (b->is_mp) {
+		unsigned int i;
+
+		for (i = 0; i < b->order_buf.size; i++)
+			b->slots[i] = 0;
+		b->min_seqn = b->first_seqn;
+		b->gap_tsc = 0;
+		return;
+	}
 	strlcpy(name, b->name, sizeof(name));
 	/* No error checking as current values should be valid */
 	rte_reorder_init(b, b->memsize, name, b->order_buf.size);
@@ -173,6 +296,14 @@ rte_reorder_free_mbufs(struct rte_reorder_buffer *b)
 {
 	unsigned i;
 
+	if (b->is_mp) {
+		for (i = 0; i < b->order_buf.size; i++)
+			if (MP_SLOT_IS_MBUF(b->slots[i]))
+				rte_pktmbuf_free((struct rte_mbuf *)
+					(uintptr_t)b->slots[i]);
+		return;
+	}
+
 	/* Free up the mbufs of order buffer & ready buffer */
 	for (i = 0; i < b->order_buf.size; i++) {
 		if (b->order_buf.entries[i])
@@ -303,7 +434,7 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	uint32_t offset, position;
 	struct cir_buffer *order_buf;
 
-	if (b == NULL || mbuf == NULL) {
+	if (b == NULL || mbuf == NULL || b->is_mp) {
 		rte_errno = EINVAL;
 		return -1;
 	}
@@ -372,6 +503,9 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 	struct cir_buffer *order_buf = &b->order_buf,
 			*ready_buf = &b->ready_buf;
 
+	if (unlikely(b->is_mp))
+		return 0;
+
 	/* Try to fetch requested number of mbufs from ready buffer */
 	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
 		mbufs[drain_cnt++] = ready_buf->entries[ready_buf->tail];
@@ -392,3 +526,143 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 
 	return drain_cnt;
 }
+
+int
+rte_reorder_mp_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf,
+		uint32_t seqn)
+{
+	uint64_t *slot;
+	uint64_t v;
+	uint32_t offset;
+
+	if (b == NULL || mbuf == NULL || !b->is_mp) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	/*
+	 * The drain publishes min_seqn after having released the slots below
+	 * it, so that a sequence number within the window owns its slot,
+	 * unless the drain already went past it since min_seqn was read.
+	 */
+	offset = seqn - __atomic_load_n(&b->min_seqn, __ATOMIC_ACQUIRE);
+	if (offset >= b->order_buf.size) {
+		rte_errno = (int32_t)offset < 0 ? ERANGE : ENOSPC;
+		return -1;
+	}
+
+	slot = &b->slots[seqn & b->order_buf.mask];
+	v = __atomic_load_n(slot, __ATOMIC_RELAXED);
+	do {
+		if (MP_SLOT_IS_MBUF(v)) {
+			/* the drain went past seqn, or it is a duplicate */
+			offset = seqn - __atomic_load_n(&b->min_seqn,
+					__ATOMIC_ACQUIRE);
+			rte_errno = (int32_t)offset < 0 ? ERANGE : EEXIST;
+			return -1;
+		}
+		/* the drain skipped or took seqn, or a later one */
+		if (v != 0 && (int32_t)(MP_SLOT_SEQN(v) - seqn) >= 0) {
+			rte_errno = ERANGE;
+			return -1;
+		}
+	} while (!__atomic_compare_exchange_n(slot, &v, (uintptr_t)mbuf, 0,
+			__ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	return 0;
+}
+
+/*
+ * Called by the drain when the packet with sequence number seqn is missing.
+ * Returns the sequence number the drain can continue from, past the gap if
+ * it waited long enough and packets are waiting behind it.
+ */
+static uint32_t
+rte_reorder_mp_skip_gap(struct rte_reorder_buffer *b, uint32_t seqn)
+{
+	unsigned int i, gap, end;
+	uint64_t *slot;
+	uint64_t now;
+	uint64_t v;
+
+	if (b->gap_timeout == UINT64_MAX)
+		return seqn;
+
+	now = rte_get_timer_cycles();
+	if (b->gap_tsc == 0 || b->gap_seqn != seqn) {
+		b->gap_seqn = seqn;
+		b->gap_tsc = now;
+		b->gap_scan = 1;
+	}
+	if (now - b->gap_tsc < b->gap_timeout)
+		return seqn;
+
+	/*
+	 * Look for the first packet behind the gap, a few slots per call so
+	 * that an idle buffer is cheap to drain: skipping a gap with nothing
+	 * behind it would only refuse the packets which are still to come.
+	 */
+	end = RTE_MIN(b->gap_scan + MP_GAP_SCAN, b->order_buf.size);
+	for (gap = b->gap_scan; gap < end; gap++) {
+		v = __atomic_load_n(&b->slots[(seqn + gap) & b->order_buf.mask],
+				__ATOMIC_RELAXED);
+		if (MP_SLOT_IS_MBUF(v))
+			break;
+	}
+	if (gap == end) {
+		b->gap_scan = end == b->order_buf.size ? 1 : end;
+		return seqn;
+	}
+
+	/*
+	 * Mark the missing sequence numbers as done, so that they are refused
+	 * if they are inserted later, unless they are inserted meanwhile.
+	 */
+	for (i = 0; i < gap; i++, seqn++) {
+		slot = &b->slots[seqn & b->order_buf.mask];
+		v = __atomic_load_n(slot, __ATOMIC_RELAXED);
+		if (MP_SLOT_IS_MBUF(v) || !__atomic_compare_exchange_n(slot,
+				&v, MP_SLOT_DONE(seqn), 0, __ATOMIC_RELAXED,
+				__ATOMIC_RELAXED))
+			break;
+	}
+	b->gap_tsc = 0;
+
+	return seqn;
+}
+
+unsigned int
+rte_reorder_mp_drain_burst(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned int max_mbufs)
+{
+	const uint32_t mask = b->order_buf.mask;
+	uint32_t seqn = b->min_seqn;
+	unsigned int drain_cnt = 0;
+	uint32_t next;
+	uint64_t *slot;
+	uint64_t v;
+
+	if (unlikely(!b->is_mp))
+		return 0;
+
+	while (drain_cnt < max_mbufs) {
+		slot = &b->slots[seqn & mask];
+		v = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+		if (unlikely(!MP_SLOT_IS_MBUF(v))) {
+			next = rte_reorder_mp_skip_gap(b, seqn);
+			if (next == seqn)
+				break;
+			seqn = next;
+			continue;
+		}
+		mbufs[drain_cnt++] = (struct rte_mbuf *)(uintptr_t)v;
+		/* only the drain writes a slot holding a mbuf */
+		__atomic_store_n(slot, MP_SLOT_DONE(seqn), __ATOMIC_RELAXED);
+		seqn++;
+	}
+
+	if (seqn != b->min_seqn)
+		__atomic_store_n(&b->min_seqn, seqn, __ATOMIC_RELEASE);
+
+	return drain_cnt;
+}
@@ -13,8 +13,14 @@
  * provide ordering of out of ordered packets based on
  * sequence number present in mbuf.
  *
+ * A reorder buffer created with rte_reorder_mp_create() accepts packets
+ * inserted concurrently by several threads with rte_reorder_mp_insert(),
+ * and drained in order by a single thread with
+ * rte_reorder_mp_drain_burst().
+ *
  */
 
+#include <rte_compat.h>
 #include <rte_mbuf.h>
 
 #ifdef __cplusplus
@@ -146,6 +152,117 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+/** Maximum size of a multi-producer reorder buffer. */
+#define RTE_REORDER_MP_MAX_SIZE (1U << 24)
+
+/** Gap timeout of a multi-producer reorder buffer which never skips gaps. */
+#define RTE_REORDER_MP_NO_TIMEOUT UINT64_MAX
+
+/** Parameters of a multi-producer reorder buffer. */
+struct rte_reorder_mp_params {
+	/**
+	 * Number of consecutive sequence numbers which can be waiting to be
+	 * drained, must be a power of 2.
+	 */
+	unsigned int size;
+	/** Sequence number of the first packet. */
+	uint32_t first_seqn;
+	/**
+	 * Time the drain waits for a missing packet before skipping it,
+	 * provided that packets are waiting behind it, or
+	 * RTE_REORDER_MP_NO_TIMEOUT. The skipped packets are refused if they
+	 * are inserted later.
+	 */
+	uint64_t gap_timeout_ns;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new multi-producer reorder buffer instance.
+ *
+ * Packets are inserted with rte_reorder_mp_insert(), which can be called
+ * concurrently by several threads, and drained with
+ * rte_reorder_mp_drain_burst(), which must be called by a single thread at
+ * a time. rte_reorder_insert() and rte_reorder_drain() cannot be used with
+ * this instance. It is reset and freed with rte_reorder_reset() and
+ * rte_reorder_free().
+ *
+ * @param name
+ *   The name to be given to the reorder buffer instance.
+ * @param socket_id
+ *   The NUMA node on which the memory for the reorder buffer
+ *   instance is to be reserved.
+ * @param params
+ *   Parameters of the reorder buffer.
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found
+ *    - EINVAL - invalid parameters
+ *    - EEXIST - a reorder buffer with the same name already exists
+ */
+__rte_experimental
+struct rte_reorder_buffer *
+rte_reorder_mp_create(const char *name, unsigned int socket_id,
+		const struct rte_reorder_mp_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Insert a mbuf in a multi-producer reorder buffer.
+ *
+ * Can be called concurrently by several threads, and with
+ * rte_reorder_mp_drain_burst(). The mbuf is not modified, its sequence
+ * number is passed as a parameter.
+ *
+ * @param b
+ *   Reorder buffer created with rte_reorder_mp_create().
+ * @param mbuf
+ *   mbuf of packet that needs to be inserted in reorder buffer.
+ * @param seqn
+ *   Sequence number of the packet.
+ * @return
+ *   0 on success
+ *   -1 on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOSPC - The sequence number is too far ahead of the packets
+ *      waiting to be drained, the insertion can be retried after a drain.
+ *    - ERANGE - The sequence number was already drained or skipped.
+ *    - EEXIST - A packet with the same sequence number is already waiting.
+ *    - EINVAL - Invalid parameters.
+ */
+__rte_experimental
+int
+rte_reorder_mp_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf,
+		uint32_t seqn);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Fetch reordered buffers from a multi-producer reorder buffer.
+ *
+ * Returns the consecutive packets following the last drained one. A
+ * missing packet stops the drain, until it is inserted or its gap timeout
+ * expires.
+ *
+ * @param b
+ *   Reorder buffer created with rte_reorder_mp_create().
+ * @param mbufs
+ *   array of mbufs where reordered packets will be inserted from reorder buffer
+ * @param max_mbufs
+ *   the number of elements in the mbufs array.
+ * @return
+ *   number of mbuf pointers written to mbufs.
+ */
+__rte_experimental
+unsigned int
+rte_reorder_mp_drain_burst(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned int max_mbufs);
+
 #ifdef __cplusplus
 }
 #endif
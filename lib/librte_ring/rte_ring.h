@@ -48,6 +48,7 @@ extern "C" {
 #include <rte_branch_prediction.h>
 #include <rte_memzone.h>
 #include <rte_pause.h>
+#include <rte_trace.h>
 
 #define RTE_TAILQ_RING_NAME "RTE_RING"
 
@@ -311,6 +312,10 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
 #include "rte_ring_generic.h"
 #endif
 
+/* fast path tracepoints, compiled in with RTE_ENABLE_TRACE_FP */
+RTE_TRACE_POINT_DECLARE(rte_ring_trace_enqueue);
+RTE_TRACE_POINT_DECLARE(rte_ring_trace_dequeue);
+
 /**
  * @internal Enqueue several objects on the ring
  *
@@ -350,6 +355,7 @@ __rte_ring_do_enqueue(struct rte_ring *r, void * const *obj_table,
 end:
 	if (free_space != NULL)
 		*free_space = free_entries - n;
+	rte_trace_point_emit_fp(rte_ring_trace_enqueue, r, obj_table, n);
 	return n;
 }
 
@@ -393,6 +399,7 @@ __rte_ring_do_dequeue(struct rte_ring *r, void **obj_table,
 end:
 	if (available != NULL)
 		*available = entries - n;
+	rte_trace_point_emit_fp(rte_ring_trace_dequeue, r, obj_table, n);
 	return n;
 }
 
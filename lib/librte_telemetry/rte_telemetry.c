@@ -9,20 +9,26 @@
 #include <sys/un.h>
 #include <jansson.h>
 
+#include <rte_cycles.h>
 #include <rte_eal.h>
 #include <rte_ethdev.h>
+#include <rte_lcore_poll.h>
 #include <rte_metrics.h>
 #include <rte_option.h>
 #include <rte_string_fns.h>
 
 #include "rte_telemetry.h"
+#include "rte_telemetry_shm.h"
 #include "rte_telemetry_internal.h"
 #include "rte_telemetry_parser.h"
 #include "rte_telemetry_socket_tests.h"
 
 #define BUF_SIZE 1024
-#define ACTION_POST 1
 #define SLEEP_TIME 10
+#define MS_PER_S 1000
+/* maximum number of statistics in a stats_delta message */
+#define DELTA_MAX_STATS 1024
+#define DELTA_READ_RETRIES 16
 
 #define SELFTEST_VALID_CLIENT "/var/run/dpdk/valid_client"
 #define SELFTEST_INVALID_CLIENT "/var/run/dpdk/invalid_client"
@@ -646,6 +652,405 @@ rte_telemetry_send_ports_stats_values(struct telemetry_encode_param *ep,
 	return -1;
 }
 
+static int32_t
+rte_telemetry_json_format_hist(struct telemetry_impl *telemetry,
+	json_t *stats, const char *prefix, const uint64_t *hist)
+{
+	char name[RTE_METRICS_MAX_NAME_LEN];
+	int i;
+
+	for (i = 0; i < RTE_LCORE_POLL_HIST_SIZE; i++) {
+		snprintf(name, sizeof(name), "%s_ge_%u", prefix, 1u << i);
+		if (rte_telemetry_json_format_stat(telemetry, stats, name,
+				hist[i]) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static int32_t
+rte_telemetry_json_format_lcore(struct telemetry_impl *telemetry,
+	uint32_t lcore_id, const struct rte_lcore_poll_stats *ps,
+	json_t *lcores)
+{
+	json_t *lcore, *stats;
+	int ret;
+
+	lcore = json_object();
+	stats = json_array();
+	if (lcore == NULL || stats == NULL) {
+		TELEMETRY_LOG_ERR("Could not create lcore/stats JSON objects");
+		goto eperm_fail;
+	}
+
+	ret = json_object_set_new(lcore, "lcore", json_integer(lcore_id));
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Lcore field cannot be set");
+		goto eperm_fail;
+	}
+
+	if (rte_telemetry_json_format_stat(telemetry, stats, "busy_polls",
+			ps->busy_polls) < 0 ||
+	    rte_telemetry_json_format_stat(telemetry, stats, "idle_polls",
+			ps->idle_polls) < 0 ||
+	    rte_telemetry_json_format_stat(telemetry, stats, "busy_cycles",
+			ps->busy_cycles) < 0 ||
+	    rte_telemetry_json_format_stat(telemetry, stats, "idle_cycles",
+			ps->idle_cycles) < 0 ||
+	    rte_telemetry_json_format_stat(telemetry, stats, "pkts",
+			ps->pkts) < 0 ||
+	    rte_telemetry_json_format_hist(telemetry, stats, "burst",
+			ps->burst_hist) < 0 ||
+	    rte_telemetry_json_format_hist(telemetry, stats, "cycles_per_pkt",
+			ps->cpp_hist) < 0) {
+		TELEMETRY_LOG_ERR("Format stats of lcore %u failed", lcore_id);
+		json_decref(lcore);
+		json_decref(stats);
+		return -1;
+	}
+
+	ret = json_object_set_new(lcore, "stats", stats);
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Stats object cannot be set");
+		stats = NULL;
+		goto eperm_fail;
+	}
+
+	ret = json_array_append_new(lcores, lcore);
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Lcore object cannot be added to lcores array");
+		return -1;
+	}
+
+	return 0;
+
+eperm_fail:
+	json_decref(lcore);
+	json_decref(stats);
+	ret = rte_telemetry_send_error_response(telemetry, -EPERM);
+	if (ret < 0)
+		TELEMETRY_LOG_ERR("Could not send error");
+	return -1;
+}
+
+int32_t
+rte_telemetry_send_lcores_poll_stats(struct telemetry_impl *telemetry)
+{
+	struct rte_lcore_poll_stats ps;
+	char *json_buffer;
+	json_t *root, *lcores;
+	uint32_t lcore_id;
+	int ret;
+
+	if (telemetry == NULL) {
+		TELEMETRY_LOG_ERR("Invalid telemetry argument");
+		return -1;
+	}
+
+	lcores = json_array();
+	if (lcores == NULL) {
+		TELEMETRY_LOG_ERR("Could not create lcores JSON array");
+		goto eperm_fail;
+	}
+
+	/* only the lcores which account their polls */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (rte_lcore_poll_stats_get(lcore_id, &ps) < 0 ||
+				ps.busy_polls + ps.idle_polls == 0)
+			continue;
+		ret = rte_telemetry_json_format_lcore(telemetry, lcore_id,
+				&ps, lcores);
+		if (ret < 0) {
+			json_decref(lcores);
+			return -1;
+		}
+	}
+
+	root = json_object();
+	if (root == NULL) {
+		TELEMETRY_LOG_ERR("Could not create root JSON object");
+		json_decref(lcores);
+		goto eperm_fail;
+	}
+
+	ret = json_object_set_new(root, "status_code",
+		json_string("Status OK: 200"));
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Status code field cannot be set");
+		json_decref(lcores);
+		json_decref(root);
+		goto eperm_fail;
+	}
+
+	ret = json_object_set_new(root, "data", lcores);
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Data field cannot be set");
+		json_decref(root);
+		goto eperm_fail;
+	}
+
+	json_buffer = json_dumps(root, JSON_INDENT(2));
+	json_decref(root);
+
+	ret = rte_telemetry_write_to_socket(telemetry, json_buffer);
+	free(json_buffer);
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Could not write to socket");
+		return -1;
+	}
+
+	return 0;
+
+eperm_fail:
+	ret = rte_telemetry_send_error_response(telemetry, -EPERM);
+	if (ret < 0)
+		TELEMETRY_LOG_ERR("Could not send error");
+	return -1;
+}
+
+static int32_t
+rte_telemetry_send_delta_message(struct telemetry_impl *telemetry,
+	const struct rte_telemetry_shm_buf *buf, int full, int last,
+	json_t *ports)
+{
+	json_t *root, *data;
+	char *json_buffer;
+	int ret;
+
+	root = json_object();
+	data = json_object();
+	if (root == NULL || data == NULL) {
+		TELEMETRY_LOG_ERR("Could not create root/data JSON objects");
+		json_decref(root);
+		json_decref(data);
+		json_decref(ports);
+		return -1;
+	}
+
+	/* from here, root owns the data object which owns the ports array */
+	if (json_object_set_new(data, "ports", ports) < 0) {
+		json_decref(root);
+		json_decref(data);
+		TELEMETRY_LOG_ERR("Ports array cannot be set");
+		return -1;
+	}
+	if (json_object_set_new(root, "data", data) < 0 ||
+	    json_object_set_new(root, "status_code",
+			json_string("Status OK: 200")) < 0 ||
+	    json_object_set_new(data, "generation",
+			json_integer(buf->generation)) < 0 ||
+	    json_object_set_new(data, "timestamp",
+			json_integer(buf->timestamp)) < 0 ||
+	    json_object_set_new(data, "full", json_boolean(full)) < 0 ||
+	    json_object_set_new(data, "last", json_boolean(last)) < 0 ||
+	    json_object_set_new(data, "truncated", json_boolean(buf->flags &
+			RTE_TELEMETRY_SHM_F_TRUNCATED)) < 0) {
+		TELEMETRY_LOG_ERR("Delta fields cannot be set");
+		json_decref(root);
+		return -1;
+	}
+
+	json_buffer = json_dumps(root, JSON_COMPACT);
+	json_decref(root);
+
+	ret = rte_telemetry_write_to_socket(telemetry, json_buffer);
+	free(json_buffer);
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Could not write to socket");
+		return -1;
+	}
+
+	return 0;
+}
+
+static json_t *
+rte_telemetry_json_delta_port(const struct rte_telemetry_shm_record *rec)
+{
+	json_t *port;
+
+	port = json_object();
+	if (port == NULL)
+		return NULL;
+
+	if (json_object_set_new(port, "type", json_string(
+			rec->type == RTE_TELEMETRY_SHM_ETHDEV ?
+			"ethdev" : "metrics")) < 0 ||
+	    json_object_set_new(port, "port", json_integer(
+			rec->port_id == RTE_TELEMETRY_SHM_GLOBAL ?
+			-1 : (json_int_t)rec->port_id)) < 0 ||
+	    json_object_set_new(port, "stats", json_array()) < 0) {
+		json_decref(port);
+		return NULL;
+	}
+
+	return port;
+}
+
+int32_t
+rte_telemetry_send_stats_delta(struct telemetry_impl *telemetry)
+{
+	const struct rte_telemetry_shm_record *recs;
+	const struct rte_telemetry_shm_name *names;
+	const struct rte_telemetry_shm_buf *buf;
+	struct rte_telemetry_shm_hdr hdr;
+	struct telemetry_client *client;
+	json_t *ports, *port = NULL;
+	const uint64_t *values;
+	uint32_t r, i, nb_stats = 0;
+	int ret, full;
+
+	if (telemetry == NULL) {
+		TELEMETRY_LOG_ERR("Invalid telemetry argument");
+		return -1;
+	}
+	client = telemetry->request_client;
+
+	/* the region may be disabled meanwhile, so work on a copy */
+	if (rte_telemetry_shm_copy(&hdr, &telemetry->shm_snapshot,
+			&telemetry->shm_snapshot_size,
+			DELTA_READ_RETRIES) == 0) {
+		TELEMETRY_LOG_ERR("Could not read a consistent snapshot");
+		goto eperm_fail;
+	}
+	buf = telemetry->shm_snapshot;
+	recs = rte_telemetry_shm_records(&hdr, buf);
+	names = rte_telemetry_shm_names(&hdr, buf);
+	values = rte_telemetry_shm_values(&hdr, buf);
+
+	/* values are compared index by index while the layout is the same */
+	full = client->last_values == NULL ||
+		client->last_layout != buf->layout ||
+		client->nb_last_values != buf->nb_values;
+	if (full) {
+		free(client->last_values);
+		client->nb_last_values = 0;
+		client->last_values = malloc(RTE_MAX(buf->nb_values, 1u) *
+			sizeof(*client->last_values));
+		if (client->last_values == NULL) {
+			TELEMETRY_LOG_ERR("Cannot allocate client values");
+			goto eperm_fail;
+		}
+	}
+
+	ports = json_array();
+	if (ports == NULL) {
+		TELEMETRY_LOG_ERR("Could not create ports JSON array");
+		goto eperm_fail;
+	}
+
+	for (r = 0; r < buf->nb_records; r++) {
+		const struct rte_telemetry_shm_record *rec = &recs[r];
+
+		for (i = 0; i < rec->nb_values; i++) {
+			const uint64_t v = values[rec->first_value + i];
+
+			if (!full &&
+			    v == client->last_values[rec->first_value + i])
+				continue;
+
+			if (port == NULL) {
+				port = rte_telemetry_json_delta_port(rec);
+				if (port == NULL ||
+				    json_array_append_new(ports, port) < 0) {
+					TELEMETRY_LOG_ERR("Port object cannot be added to ports array");
+					json_decref(ports);
+					goto fail;
+				}
+			}
+			ret = rte_telemetry_json_format_stat(telemetry,
+				json_object_get(port, "stats"),
+				names[rec->first_name + i].name, v);
+			if (ret < 0) {
+				json_decref(ports);
+				goto fail;
+			}
+
+			/* keep the messages within the client buffer */
+			if (++nb_stats == DELTA_MAX_STATS) {
+				ret = rte_telemetry_send_delta_message(
+					telemetry, buf, full, 0, ports);
+				if (ret < 0)
+					goto fail;
+				ports = json_array();
+				if (ports == NULL)
+					goto fail;
+				port = NULL;
+				nb_stats = 0;
+			}
+		}
+		port = NULL;
+	}
+
+	ret = rte_telemetry_send_delta_message(telemetry, buf, full, 1, ports);
+	if (ret < 0)
+		goto fail;
+
+	memcpy(client->last_values, values,
+		buf->nb_values * sizeof(*client->last_values));
+	client->nb_last_values = buf->nb_values;
+	client->last_layout = buf->layout;
+	client->last_generation = buf->generation;
+
+	return 0;
+
+fail:
+	/* the client missed some changes, send everything next time */
+	free(client->last_values);
+	client->last_values = NULL;
+	return -1;
+
+eperm_fail:
+	ret = rte_telemetry_send_error_response(telemetry, -EPERM);
+	if (ret < 0)
+		TELEMETRY_LOG_ERR("Could not send error");
+	return -1;
+}
+
+int32_t
+rte_telemetry_stream_stats_delta(struct telemetry_impl *telemetry,
+	uint32_t interval_ms)
+{
+	struct telemetry_client *client;
+
+	if (telemetry == NULL || telemetry->request_client == NULL) {
+		TELEMETRY_LOG_ERR("Invalid telemetry argument");
+		return -1;
+	}
+	client = telemetry->request_client;
+
+	/* 0 stops the streaming, the first delta is sent at the next run */
+	client->stream_period = (uint64_t)interval_ms *
+		rte_get_timer_hz() / MS_PER_S;
+	client->stream_next = rte_get_timer_cycles();
+
+	return 0;
+}
+
+static void
+rte_telemetry_stream_clients(struct telemetry_impl *telemetry)
+{
+	const uint64_t gen = rte_telemetry_shm_generation();
+	const uint64_t now = rte_get_timer_cycles();
+	struct telemetry_client *client;
+
+	TAILQ_FOREACH(client, &telemetry->client_list_head, client_list) {
+		if (client->stream_period == 0 ||
+				(int64_t)(now - client->stream_next) < 0)
+			continue;
+		client->stream_next = now + client->stream_period;
+
+		/* nothing changed if no snapshot was published meanwhile */
+		if (gen != 0 && client->last_values != NULL &&
+				gen == client->last_generation)
+			continue;
+
+		telemetry->request_client = client;
+		if (rte_telemetry_send_stats_delta(telemetry) < 0)
+			TELEMETRY_LOG_WARN("Streaming to %s failed",
+				client->file_path);
+	}
+}
 
 static int32_t
 rte_telemetry_reg_ethdev_to_metrics(uint16_t port_id)
@@ -885,6 +1290,8 @@ rte_telemetry_run(void *userdata)
 		return -1;
 	}
 
+	rte_telemetry_stream_clients(telemetry);
+
 	return 0;
 }
 
@@ -1027,6 +1434,7 @@ rte_telemetry_client_cleanup(struct telemetry_client *client)
 
 	ret = close(client->fd);
 	free(client->file_path);
+	free(client->last_values);
 	free(client);
 
 	if (ret < 0) {
@@ -1063,6 +1471,8 @@ rte_telemetry_cleanup(void)
 
 	telemetry->thread_status = 0;
 	pthread_join(telemetry->thread_id, NULL);
+	rte_telemetry_shm_disable();
+	free(telemetry->shm_snapshot);
 	free(telemetry);
 	static_telemetry = NULL;
 
@@ -1157,7 +1567,7 @@ rte_telemetry_register_client(struct telemetry_impl *telemetry,
 
 	addrs.sun_family = AF_UNIX;
 	strlcpy(addrs.sun_path, client_path, sizeof(addrs.sun_path));
-	telemetry_client *new_client = malloc(sizeof(telemetry_client));
+	telemetry_client *new_client = calloc(1, sizeof(telemetry_client));
 	new_client->file_path = strdup(client_path);
 	new_client->fd = fd;
 
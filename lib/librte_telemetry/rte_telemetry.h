@@ -66,4 +66,60 @@ __rte_experimental
 int32_t
 rte_telemetry_selftest(void);
 
+/**
+ * Parameters of the shared memory snapshots, 0 selects the default value.
+ */
+struct rte_telemetry_shm_params {
+	uint32_t period_ms;   /**< Publication period, default 1000 ms. */
+	/** Maximum number of records, default two per port plus one. */
+	uint32_t max_records;
+	uint32_t max_names;   /**< Maximum number of names, default 4096. */
+	uint32_t max_values;  /**< Maximum number of values, default 65536. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Start publishing snapshots of the ethdev extended statistics and of the
+ * metrics in the file "telemetry_shm" of the runtime directory, see
+ * rte_telemetry_shm.h for its layout.
+ *
+ * A low priority control thread takes the snapshots periodically, so that
+ * collectors reading the file do not interact with the datapath nor with
+ * the DPDK process. A first snapshot is published before returning.
+ *
+ * Can be used without rte_telemetry_init().
+ *
+ * @param params
+ *  Parameters of the snapshots, NULL for the default ones.
+ * @return
+ *  0 on success
+ * @return
+ *  -EALREADY if the snapshots are already enabled
+ * @return
+ *  -ENOMEM on memory allocation error, other negative errno on file error
+ */
+__rte_experimental
+int32_t
+rte_telemetry_shm_enable(const struct rte_telemetry_shm_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Stop publishing snapshots and remove the shared memory file.
+ *
+ * Waits for the telemetry thread to finish reading the latest snapshot,
+ * if it is sending statistics deltas to its clients.
+ *
+ * @return
+ *  0 on success
+ * @return
+ *  -ENOENT if the snapshots are not enabled
+ */
+__rte_experimental
+int32_t
+rte_telemetry_shm_disable(void);
+
 #endif
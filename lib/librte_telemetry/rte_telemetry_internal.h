@@ -29,6 +29,14 @@ extern int telemetry_log_level;
 typedef struct telemetry_client {
 	char *file_path;
 	int fd;
+	/* values of the last stats_delta sent, and their layout */
+	uint64_t *last_values;
+	uint32_t nb_last_values;
+	uint64_t last_layout;
+	uint64_t last_generation;
+	/* stats_delta streaming period and deadline in timer cycles */
+	uint64_t stream_period;
+	uint64_t stream_next;
 	TAILQ_ENTRY(telemetry_client) client_list;
 } telemetry_client;
 
@@ -43,10 +51,14 @@ typedef struct telemetry_impl {
 	TAILQ_HEAD(, telemetry_client) client_list_head;
 	struct telemetry_client *request_client;
 	int register_fail_count;
+	/* copy of the latest shared memory snapshot */
+	void *shm_snapshot;
+	size_t shm_snapshot_size;
 } telemetry_impl;
 
 enum rte_telemetry_parser_actions {
 	ACTION_GET = 0,
+	ACTION_POST = 1,
 	ACTION_DELETE = 2
 };
 
@@ -106,6 +118,31 @@ int32_t
 rte_telemetry_send_global_stats_values(struct telemetry_encode_param *ep,
 	struct telemetry_impl *telemetry);
 
+int32_t
+rte_telemetry_send_lcores_poll_stats(struct telemetry_impl *telemetry);
+
+int32_t
+rte_telemetry_send_stats_delta(struct telemetry_impl *telemetry);
+
+int32_t
+rte_telemetry_stream_stats_delta(struct telemetry_impl *telemetry,
+	uint32_t interval_ms);
+
+struct rte_telemetry_shm_hdr;
+
+/*
+ * Copy the latest shared memory snapshot in *copy, reallocated as needed,
+ * and the header in *hdr, enabling the snapshots if they are not.
+ * Returns the number of the snapshot, 0 if none could be read.
+ */
+uint64_t
+rte_telemetry_shm_copy(struct rte_telemetry_shm_hdr *hdr, void **copy,
+	size_t *copy_size, unsigned int max_retries);
+
+/* Number of the latest snapshot, 0 if the snapshots are not enabled. */
+uint64_t
+rte_telemetry_shm_generation(void);
+
 int32_t
 rte_telemetry_parser_test(struct telemetry_impl *telemetry);
 
@@ -540,6 +540,95 @@ rte_telemetry_command_ports_stats_values_by_name(struct telemetry_impl
 	return 0;
 }
 
+static int32_t
+rte_telemetry_command_lcores_poll_stats(struct telemetry_impl *telemetry,
+	int action, json_t *data)
+{
+	int ret;
+
+	if (telemetry == NULL) {
+		TELEMETRY_LOG_ERR("Invalid telemetry argument");
+		return -1;
+	}
+
+	if (action != ACTION_GET) {
+		TELEMETRY_LOG_WARN("Invalid action for this command");
+		ret = rte_telemetry_send_error_response(telemetry, -EINVAL);
+		if (ret < 0)
+			TELEMETRY_LOG_ERR("Could not send error");
+		return -1;
+	}
+
+	if (json_is_object(data)) {
+		TELEMETRY_LOG_WARN("Invalid data provided for this command");
+		ret = rte_telemetry_send_error_response(telemetry, -EINVAL);
+		if (ret < 0)
+			TELEMETRY_LOG_ERR("Could not send error");
+		return -1;
+	}
+
+	ret = rte_telemetry_send_lcores_poll_stats(telemetry);
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Sending lcores poll stats failed");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int32_t
+rte_telemetry_command_stats_delta(struct telemetry_impl *telemetry,
+	int action, json_t *data)
+{
+	json_t *interval;
+	int ret;
+
+	if (telemetry == NULL) {
+		TELEMETRY_LOG_ERR("Invalid telemetry argument");
+		return -1;
+	}
+
+	switch (action) {
+	case ACTION_GET:
+		if (json_is_object(data)) {
+			TELEMETRY_LOG_WARN("Invalid data provided for this command");
+			goto einval_fail;
+		}
+		ret = rte_telemetry_send_stats_delta(telemetry);
+		break;
+	case ACTION_POST:
+		interval = json_object_get(data, "interval_ms");
+		if (!json_is_integer(interval) ||
+				json_integer_value(interval) <= 0 ||
+				json_integer_value(interval) > UINT32_MAX) {
+			TELEMETRY_LOG_WARN("Invalid interval_ms provided");
+			goto einval_fail;
+		}
+		ret = rte_telemetry_stream_stats_delta(telemetry,
+			json_integer_value(interval));
+		break;
+	case ACTION_DELETE:
+		ret = rte_telemetry_stream_stats_delta(telemetry, 0);
+		break;
+	default:
+		TELEMETRY_LOG_WARN("Invalid action for this command");
+		goto einval_fail;
+	}
+
+	if (ret < 0) {
+		TELEMETRY_LOG_ERR("Sending stats delta failed");
+		return -1;
+	}
+
+	return 0;
+
+einval_fail:
+	ret = rte_telemetry_send_error_response(telemetry, -EINVAL);
+	if (ret < 0)
+		TELEMETRY_LOG_ERR("Could not send error");
+	return -1;
+}
+
 static int32_t
 rte_telemetry_parse_command(struct telemetry_impl *telemetry, int action,
 	const char *command, json_t *data)
@@ -580,6 +669,14 @@ rte_telemetry_parse_command(struct telemetry_impl *telemetry, int action,
 		{
 			.text = "global_stat_values",
 			.fn = &rte_telemetry_command_global_stat_values
+		},
+		{
+			.text = "lcores_poll_stats",
+			.fn = &rte_telemetry_command_lcores_poll_stats
+		},
+		{
+			.text = "stats_delta",
+			.fn = &rte_telemetry_command_stats_delta
 		}
 	};
 
@@ -651,7 +748,8 @@ rte_telemetry_parse(struct telemetry_impl *telemetry, char *socket_rx_data)
 	}
 
 	action_int = json_integer_value(action);
-	if (action_int != ACTION_GET && action_int != ACTION_DELETE) {
+	if (action_int != ACTION_GET && action_int != ACTION_POST &&
+			action_int != ACTION_DELETE) {
 		TELEMETRY_LOG_WARN("Invalid action code");
 		goto einval_fail;
 	}
@@ -0,0 +1,514 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_metrics.h>
+#include <rte_string_fns.h>
+
+#include "rte_telemetry.h"
+#include "rte_telemetry_shm.h"
+#include "rte_telemetry_internal.h"
+
+#define SHM_DEFAULT_PERIOD_MS 1000
+#define SHM_DEFAULT_MAX_NAMES 4096
+#define SHM_DEFAULT_MAX_VALUES 65536
+/* longest sleep of the publisher, to notice quickly when it is stopped */
+#define SHM_MAX_SLEEP_MS 100
+
+struct telemetry_shm {
+	struct rte_telemetry_shm_hdr *hdr;
+	size_t size;
+	char path[PATH_MAX];
+	pthread_t thread;
+	volatile int running;
+	/* serializes the publications of the thread and of enable() */
+	pthread_mutex_t lock;
+	uint64_t layout;
+	/* scratch space for the statistics of a port */
+	struct rte_eth_xstat *xstats;
+	struct rte_eth_xstat_name *xstats_names;
+	struct rte_metric_value *metrics;
+	struct rte_metric_name *metrics_names;
+	unsigned int xstats_size;
+	unsigned int xstats_names_size;
+	unsigned int metrics_size;
+	unsigned int metrics_names_size;
+};
+
+/*
+ * The telemetry thread reads the snapshots while the application may
+ * enable or disable them: the lock keeps the region mapped while it is
+ * used, and makes checking and enabling the snapshots a single step.
+ * The publisher thread does not take it, so that disable() can join it.
+ */
+static pthread_mutex_t telemetry_shm_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct telemetry_shm *telemetry_shm;
+
+static int
+shm_scratch_reserve(void **p, unsigned int *size, unsigned int n,
+		size_t elt_size)
+{
+	void *np;
+
+	if (n <= *size)
+		return 0;
+	np = realloc(*p, n * elt_size);
+	if (np == NULL)
+		return -ENOMEM;
+	*p = np;
+	*size = n;
+	return 0;
+}
+
+/* reserve a record and its values, and names unless shared, in a buffer */
+static struct rte_telemetry_shm_record *
+shm_record_add(const struct rte_telemetry_shm_hdr *hdr,
+		struct rte_telemetry_shm_buf *buf, uint32_t type,
+		uint32_t port_id, uint32_t nb_values)
+{
+	struct rte_telemetry_shm_record *rec;
+
+	if (buf->nb_records == hdr->max_records ||
+			hdr->max_values - buf->nb_values < nb_values) {
+		buf->flags |= RTE_TELEMETRY_SHM_F_TRUNCATED;
+		return NULL;
+	}
+
+	rec = &rte_telemetry_shm_records(hdr, buf)[buf->nb_records++];
+	rec->type = type;
+	rec->port_id = port_id;
+	rec->nb_values = nb_values;
+	rec->first_value = buf->nb_values;
+	rec->first_name = 0;
+	rec->reserved = 0;
+	buf->nb_values += nb_values;
+	return rec;
+}
+
+/*
+ * Find names already written in the buffer, or write them, and return the
+ * index of the first one. Ports of the same driver have the same names, so
+ * they are only compared with the names of the previous records.
+ */
+static int
+shm_names_add(const struct rte_telemetry_shm_hdr *hdr,
+		struct rte_telemetry_shm_buf *buf,
+		const struct rte_telemetry_shm_record *rec,
+		const char *names, size_t name_size)
+{
+	struct rte_telemetry_shm_name *shm_names =
+		rte_telemetry_shm_names(hdr, buf);
+	const struct rte_telemetry_shm_record *prev;
+	uint32_t i;
+
+	for (prev = rte_telemetry_shm_records(hdr, buf); prev != rec; prev++) {
+		if (prev->nb_values != rec->nb_values)
+			continue;
+		for (i = 0; i < rec->nb_values; i++)
+			if (strncmp(shm_names[prev->first_name + i].name,
+					&names[i * name_size],
+					RTE_TELEMETRY_SHM_NAME_SIZE) != 0)
+				break;
+		if (i == rec->nb_values)
+			return prev->first_name;
+	}
+
+	if (hdr->max_names - buf->nb_names < rec->nb_values)
+		return -ENOSPC;
+	for (i = 0; i < rec->nb_values; i++)
+		strlcpy(shm_names[buf->nb_names + i].name,
+			&names[i * name_size], RTE_TELEMETRY_SHM_NAME_SIZE);
+	buf->nb_names += rec->nb_values;
+	return buf->nb_names - rec->nb_values;
+}
+
+static void
+shm_add_ethdev(struct telemetry_shm *shm, struct rte_telemetry_shm_buf *buf,
+		uint16_t port_id)
+{
+	const struct rte_telemetry_shm_hdr *hdr = shm->hdr;
+	struct rte_telemetry_shm_record *rec;
+	uint64_t *values;
+	int n, i, first;
+
+	n = rte_eth_xstats_get_names(port_id, NULL, 0);
+	if (n <= 0)
+		return;
+	if (shm_scratch_reserve((void **)&shm->xstats, &shm->xstats_size, n,
+			sizeof(*shm->xstats)) < 0 ||
+	    shm_scratch_reserve((void **)&shm->xstats_names,
+			&shm->xstats_names_size, n,
+			sizeof(*shm->xstats_names)) < 0)
+		return;
+	if (rte_eth_xstats_get_names(port_id, shm->xstats_names, n) != n ||
+			rte_eth_xstats_get(port_id, shm->xstats, n) != n)
+		return;
+
+	rec = shm_record_add(hdr, buf, RTE_TELEMETRY_SHM_ETHDEV, port_id, n);
+	if (rec == NULL)
+		return;
+	first = shm_names_add(hdr, buf, rec, shm->xstats_names[0].name,
+			sizeof(*shm->xstats_names));
+	if (first < 0) {
+		buf->flags |= RTE_TELEMETRY_SHM_F_TRUNCATED;
+		buf->nb_records--;
+		buf->nb_values -= n;
+		return;
+	}
+	rec->first_name = first;
+
+	values = rte_telemetry_shm_values(hdr, buf) + rec->first_value;
+	for (i = 0; i < n; i++)
+		if (shm->xstats[i].id < (uint64_t)n)
+			values[shm->xstats[i].id] = shm->xstats[i].value;
+}
+
+static void
+shm_add_metrics(struct telemetry_shm *shm, struct rte_telemetry_shm_buf *buf,
+		int port_id, int nb_names)
+{
+	const struct rte_telemetry_shm_hdr *hdr = shm->hdr;
+	struct rte_telemetry_shm_record *rec;
+	uint64_t *values;
+	int n, i, first;
+
+	n = rte_metrics_get_values(port_id, shm->metrics, nb_names);
+	if (n <= 0 || n > nb_names)
+		return;
+
+	rec = shm_record_add(hdr, buf, RTE_TELEMETRY_SHM_METRICS,
+			(uint32_t)port_id, nb_names);
+	if (rec == NULL)
+		return;
+	/* all the metrics share the same names, indexed by key */
+	first = shm_names_add(hdr, buf, rec, shm->metrics_names[0].name,
+			sizeof(*shm->metrics_names));
+	if (first < 0) {
+		buf->flags |= RTE_TELEMETRY_SHM_F_TRUNCATED;
+		buf->nb_records--;
+		buf->nb_values -= nb_names;
+		return;
+	}
+	rec->first_name = first;
+
+	values = rte_telemetry_shm_values(hdr, buf) + rec->first_value;
+	memset(values, 0, nb_names * sizeof(*values));
+	for (i = 0; i < n; i++)
+		if (shm->metrics[i].key < nb_names)
+			values[shm->metrics[i].key] = shm->metrics[i].value;
+}
+
+/* check if the records and names differ from the previous snapshot */
+static int
+shm_layout_changed(const struct rte_telemetry_shm_hdr *hdr,
+		const struct rte_telemetry_shm_buf *buf,
+		const struct rte_telemetry_shm_buf *prev)
+{
+	const struct rte_telemetry_shm_record *r = rte_telemetry_shm_records(
+		hdr, buf), *pr = rte_telemetry_shm_records(hdr, prev);
+	uint32_t i;
+
+	if (prev->generation == 0 || buf->nb_records != prev->nb_records ||
+			buf->nb_names != prev->nb_names ||
+			buf->nb_values != prev->nb_values)
+		return 1;
+	for (i = 0; i < buf->nb_records; i++)
+		if (r[i].type != pr[i].type || r[i].port_id != pr[i].port_id ||
+				r[i].first_name != pr[i].first_name ||
+				r[i].nb_values != pr[i].nb_values)
+			return 1;
+	return memcmp(rte_telemetry_shm_names(hdr, buf),
+		rte_telemetry_shm_names(hdr, prev),
+		buf->nb_names * sizeof(struct rte_telemetry_shm_name)) != 0;
+}
+
+/* write a snapshot in the buffer not holding the latest one */
+static void
+shm_publish(struct telemetry_shm *shm)
+{
+	struct rte_telemetry_shm_hdr *hdr = shm->hdr;
+	struct rte_telemetry_shm_buf *buf;
+	const uint64_t gen = hdr->generation + 1;
+	struct timespec ts;
+	int nb_metrics;
+	uint16_t pid;
+
+	buf = rte_telemetry_shm_buf(hdr, gen & 1);
+	__atomic_store_n(&buf->seq, buf->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	buf->generation = gen;
+	buf->timestamp = (uint64_t)ts.tv_sec * NS_PER_S + ts.tv_nsec;
+	buf->nb_records = 0;
+	buf->nb_names = 0;
+	buf->nb_values = 0;
+	buf->flags = 0;
+
+	RTE_ETH_FOREACH_DEV(pid)
+		shm_add_ethdev(shm, buf, pid);
+
+	nb_metrics = rte_metrics_get_names(NULL, 0);
+	if (nb_metrics > 0 &&
+	    shm_scratch_reserve((void **)&shm->metrics, &shm->metrics_size,
+			nb_metrics, sizeof(*shm->metrics)) == 0 &&
+	    shm_scratch_reserve((void **)&shm->metrics_names,
+			&shm->metrics_names_size, nb_metrics,
+			sizeof(*shm->metrics_names)) == 0 &&
+	    rte_metrics_get_names(shm->metrics_names, nb_metrics) ==
+			nb_metrics) {
+		shm_add_metrics(shm, buf, RTE_METRICS_GLOBAL, nb_metrics);
+		RTE_ETH_FOREACH_DEV(pid)
+			shm_add_metrics(shm, buf, pid, nb_metrics);
+	}
+
+	if (shm_layout_changed(hdr, buf,
+			rte_telemetry_shm_buf(hdr, (gen - 1) & 1)))
+		shm->layout++;
+	buf->layout = shm->layout;
+
+	__atomic_store_n(&buf->seq, buf->seq + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&hdr->generation, gen, __ATOMIC_RELEASE);
+}
+
+static void *
+shm_thread_func(void *arg)
+{
+	struct telemetry_shm *shm = arg;
+	struct sched_param param = { .sched_priority = 0 };
+	uint32_t slept;
+	struct timespec ts;
+
+	/* never compete with the application threads sharing the cpus */
+	if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+		TELEMETRY_LOG_INFO("Cannot lower the snapshot thread priority");
+
+	while (shm->running) {
+		for (slept = 0; shm->running &&
+				slept < shm->hdr->period_ms;
+				slept += SHM_MAX_SLEEP_MS) {
+			uint32_t ms = RTE_MIN(shm->hdr->period_ms - slept,
+				(uint32_t)SHM_MAX_SLEEP_MS);
+
+			ts.tv_sec = ms / 1000;
+			ts.tv_nsec = (ms % 1000) * 1000000;
+			nanosleep(&ts, NULL);
+		}
+		if (!shm->running)
+			break;
+		pthread_mutex_lock(&shm->lock);
+		shm_publish(shm);
+		pthread_mutex_unlock(&shm->lock);
+	}
+
+	return NULL;
+}
+
+static void
+shm_free(struct telemetry_shm *shm)
+{
+	if (shm->hdr != NULL) {
+		munmap(shm->hdr, shm->size);
+		unlink(shm->path);
+	}
+	pthread_mutex_destroy(&shm->lock);
+	free(shm->xstats);
+	free(shm->xstats_names);
+	free(shm->metrics);
+	free(shm->metrics_names);
+	free(shm);
+}
+
+static int32_t
+shm_enable(const struct rte_telemetry_shm_params *params)
+{
+	struct rte_telemetry_shm_params p = {
+		.period_ms = SHM_DEFAULT_PERIOD_MS,
+		/* ethdev and metrics records of every port, global metrics */
+		.max_records = 2 * RTE_MAX_ETHPORTS + 1,
+		.max_names = SHM_DEFAULT_MAX_NAMES,
+		.max_values = SHM_DEFAULT_MAX_VALUES,
+	};
+	struct rte_telemetry_shm_hdr *hdr;
+	struct telemetry_shm *shm;
+	size_t buf_size;
+	int fd, ret;
+
+	if (telemetry_shm != NULL)
+		return -EALREADY;
+
+	if (params != NULL) {
+		if (params->period_ms != 0)
+			p.period_ms = params->period_ms;
+		if (params->max_records != 0)
+			p.max_records = params->max_records;
+		if (params->max_names != 0)
+			p.max_names = params->max_names;
+		if (params->max_values != 0)
+			p.max_values = params->max_values;
+	}
+
+	shm = calloc(1, sizeof(*shm));
+	if (shm == NULL)
+		return -ENOMEM;
+	pthread_mutex_init(&shm->lock, NULL);
+
+	buf_size = sizeof(struct rte_telemetry_shm_buf) +
+		p.max_records * sizeof(struct rte_telemetry_shm_record) +
+		p.max_names * sizeof(struct rte_telemetry_shm_name) +
+		p.max_values * sizeof(uint64_t);
+	buf_size = RTE_ALIGN_CEIL(buf_size, RTE_CACHE_LINE_SIZE);
+	shm->size = RTE_CACHE_LINE_ROUNDUP(sizeof(*hdr)) + 2 * buf_size;
+
+	snprintf(shm->path, sizeof(shm->path), "%s/telemetry_shm",
+		rte_eal_get_runtime_dir());
+	fd = open(shm->path, O_CREAT | O_RDWR | O_TRUNC, 0600);
+	if (fd < 0) {
+		TELEMETRY_LOG_ERR("Cannot create %s: %s", shm->path,
+			strerror(errno));
+		ret = -errno;
+		goto fail;
+	}
+	if (ftruncate(fd, shm->size) < 0) {
+		TELEMETRY_LOG_ERR("Cannot resize %s: %s", shm->path,
+			strerror(errno));
+		ret = -errno;
+		close(fd);
+		unlink(shm->path);
+		goto fail;
+	}
+	hdr = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (hdr == MAP_FAILED) {
+		TELEMETRY_LOG_ERR("Cannot map %s: %s", shm->path,
+			strerror(errno));
+		ret = -errno;
+		unlink(shm->path);
+		goto fail;
+	}
+	shm->hdr = hdr;
+
+	hdr->version = RTE_TELEMETRY_SHM_VERSION;
+	hdr->buf_offset = RTE_CACHE_LINE_ROUNDUP(sizeof(*hdr));
+	hdr->buf_size = buf_size;
+	hdr->max_records = p.max_records;
+	hdr->max_names = p.max_names;
+	hdr->max_values = p.max_values;
+	hdr->period_ms = p.period_ms;
+	/* readers check the magic last */
+	__atomic_store_n(&hdr->magic, RTE_TELEMETRY_SHM_MAGIC,
+		__ATOMIC_RELEASE);
+
+	/* a first snapshot is available on return */
+	shm_publish(shm);
+
+	shm->running = 1;
+	ret = rte_ctrl_thread_create(&shm->thread, "telemetry-shm", NULL,
+		shm_thread_func, shm);
+	if (ret != 0) {
+		TELEMETRY_LOG_ERR("Cannot create snapshot thread");
+		ret = -ret;
+		goto fail;
+	}
+
+	telemetry_shm = shm;
+	return 0;
+
+fail:
+	shm_free(shm);
+	return ret;
+}
+
+int32_t
+rte_telemetry_shm_enable(const struct rte_telemetry_shm_params *params)
+{
+	int32_t ret;
+
+	pthread_mutex_lock(&telemetry_shm_lock);
+	ret = shm_enable(params);
+	pthread_mutex_unlock(&telemetry_shm_lock);
+
+	return ret;
+}
+
+int32_t
+rte_telemetry_shm_disable(void)
+{
+	struct telemetry_shm *shm;
+
+	pthread_mutex_lock(&telemetry_shm_lock);
+	shm = telemetry_shm;
+	if (shm == NULL) {
+		pthread_mutex_unlock(&telemetry_shm_lock);
+		return -ENOENT;
+	}
+
+	shm->running = 0;
+	pthread_join(shm->thread, NULL);
+	telemetry_shm = NULL;
+	shm_free(shm);
+	pthread_mutex_unlock(&telemetry_shm_lock);
+
+	return 0;
+}
+
+uint64_t
+rte_telemetry_shm_copy(struct rte_telemetry_shm_hdr *hdr, void **copy,
+		size_t *copy_size, unsigned int max_retries)
+{
+	struct telemetry_shm *shm;
+	uint64_t gen = 0;
+	void *p;
+
+	pthread_mutex_lock(&telemetry_shm_lock);
+	/* the snapshots are taken on demand of the first client */
+	if (telemetry_shm == NULL && shm_enable(NULL) < 0)
+		goto out;
+	shm = telemetry_shm;
+
+	if (*copy_size < shm->hdr->buf_size) {
+		p = realloc(*copy, shm->hdr->buf_size);
+		if (p == NULL) {
+			TELEMETRY_LOG_ERR("Cannot allocate snapshot copy");
+			goto out;
+		}
+		*copy = p;
+		*copy_size = shm->hdr->buf_size;
+	}
+	gen = rte_telemetry_shm_read(shm->hdr, *copy, max_retries);
+	*hdr = *shm->hdr;
+
+out:
+	pthread_mutex_unlock(&telemetry_shm_lock);
+	return gen;
+}
+
+uint64_t
+rte_telemetry_shm_generation(void)
+{
+	uint64_t gen = 0;
+
+	pthread_mutex_lock(&telemetry_shm_lock);
+	if (telemetry_shm != NULL)
+		gen = __atomic_load_n(&telemetry_shm->hdr->generation,
+			__ATOMIC_ACQUIRE);
+	pthread_mutex_unlock(&telemetry_shm_lock);
+
+	return gen;
+}
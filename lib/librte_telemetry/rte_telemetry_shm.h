@@ -0,0 +1,184 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_TELEMETRY_SHM_H_
+#define _RTE_TELEMETRY_SHM_H_
+
+/**
+ * @file
+ * RTE Telemetry shared memory snapshots
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Layout of the statistics snapshots published by
+ * rte_telemetry_shm_enable() in the file "telemetry_shm" of the DPDK
+ * runtime directory. A collector maps this file read-only and calls
+ * rte_telemetry_shm_read() to copy the latest snapshot, without any system
+ * call nor interaction with the DPDK process.
+ *
+ * This header has no dependency on the DPDK libraries, so that external
+ * collectors can use it.
+ *
+ * The file starts with struct rte_telemetry_shm_hdr, followed by two
+ * buffers. Snapshot number g is written in buffer g & 1, so that the
+ * latest snapshot can be read while the next one is written. Each buffer
+ * is made of struct rte_telemetry_shm_buf, followed by arrays of
+ * max_records records, max_names names and max_values values.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Magic number at the start of the file. */
+#define RTE_TELEMETRY_SHM_MAGIC 0x54454c45 /* "TELE" */
+/** Version of the layout. */
+#define RTE_TELEMETRY_SHM_VERSION 1
+/** Size of a statistic name, including the terminating NUL. */
+#define RTE_TELEMETRY_SHM_NAME_SIZE 64
+/** Port id of the records of the global metrics. */
+#define RTE_TELEMETRY_SHM_GLOBAL UINT32_MAX
+
+/** Flag set in a snapshot which did not fit in the buffer. */
+#define RTE_TELEMETRY_SHM_F_TRUNCATED (1u << 0)
+
+/** Source of the statistics of a record. */
+enum rte_telemetry_shm_type {
+	RTE_TELEMETRY_SHM_ETHDEV,  /**< Extended statistics of a port. */
+	RTE_TELEMETRY_SHM_METRICS, /**< Metrics library values. */
+};
+
+/** Header of the shared memory file. */
+struct rte_telemetry_shm_hdr {
+	uint32_t magic;       /**< RTE_TELEMETRY_SHM_MAGIC. */
+	uint32_t version;     /**< RTE_TELEMETRY_SHM_VERSION. */
+	uint64_t buf_offset;  /**< Offset of the first buffer in the file. */
+	uint64_t buf_size;    /**< Size of a buffer. */
+	uint32_t max_records; /**< Size of the records array of a buffer. */
+	uint32_t max_names;   /**< Size of the names array of a buffer. */
+	uint32_t max_values;  /**< Size of the values array of a buffer. */
+	uint32_t period_ms;   /**< Publication period. */
+	/** Number of the latest snapshot, 0 if none was published yet. */
+	uint64_t generation;
+};
+
+/** Header of a snapshot buffer. */
+struct rte_telemetry_shm_buf {
+	uint64_t seq;        /**< Odd while the buffer is written. */
+	uint64_t generation; /**< Number of the snapshot. */
+	uint64_t timestamp;  /**< Wall clock time of the snapshot, in ns. */
+	/**
+	 * Changed whenever the records or names differ from the previous
+	 * snapshot; values of two snapshots with the same layout can be
+	 * compared index by index.
+	 */
+	uint64_t layout;
+	uint32_t nb_records; /**< Number of valid records. */
+	uint32_t nb_names;   /**< Number of valid names. */
+	uint32_t nb_values;  /**< Number of valid values. */
+	uint32_t flags;      /**< RTE_TELEMETRY_SHM_F_* flags. */
+};
+
+/** Statistics of one source for one port. */
+struct rte_telemetry_shm_record {
+	uint32_t type;        /**< enum rte_telemetry_shm_type. */
+	uint32_t port_id;     /**< Port id, or RTE_TELEMETRY_SHM_GLOBAL. */
+	uint32_t nb_values;   /**< Number of statistics. */
+	uint32_t first_value; /**< Index of the first value. */
+	/**
+	 * Index of the name of the first value, the names of the values
+	 * follow. Records with the same names share them.
+	 */
+	uint32_t first_name;
+	uint32_t reserved;
+};
+
+/** Name of a statistic. */
+struct rte_telemetry_shm_name {
+	char name[RTE_TELEMETRY_SHM_NAME_SIZE];
+};
+
+/** Get a buffer of the shared memory. */
+static inline struct rte_telemetry_shm_buf *
+rte_telemetry_shm_buf(const struct rte_telemetry_shm_hdr *hdr,
+		unsigned int idx)
+{
+	return (struct rte_telemetry_shm_buf *)((uintptr_t)hdr +
+		hdr->buf_offset + idx * hdr->buf_size);
+}
+
+/** Get the records of a buffer, or of a copy of a buffer. */
+static inline struct rte_telemetry_shm_record *
+rte_telemetry_shm_records(const struct rte_telemetry_shm_hdr *hdr,
+		const struct rte_telemetry_shm_buf *buf)
+{
+	(void)hdr;
+	return (struct rte_telemetry_shm_record *)((uintptr_t)buf +
+		sizeof(*buf));
+}
+
+/** Get the names of a buffer, or of a copy of a buffer. */
+static inline struct rte_telemetry_shm_name *
+rte_telemetry_shm_names(const struct rte_telemetry_shm_hdr *hdr,
+		const struct rte_telemetry_shm_buf *buf)
+{
+	return (struct rte_telemetry_shm_name *)
+		(rte_telemetry_shm_records(hdr, buf) + hdr->max_records);
+}
+
+/** Get the values of a buffer, or of a copy of a buffer. */
+static inline uint64_t *
+rte_telemetry_shm_values(const struct rte_telemetry_shm_hdr *hdr,
+		const struct rte_telemetry_shm_buf *buf)
+{
+	return (uint64_t *)(rte_telemetry_shm_names(hdr, buf) +
+		hdr->max_names);
+}
+
+/**
+ * Copy the latest snapshot.
+ *
+ * @param hdr
+ *   Shared memory, as mapped by the collector.
+ * @param dst
+ *   Destination buffer of hdr->buf_size bytes, which can then be accessed
+ *   with the rte_telemetry_shm_records/names/values() helpers.
+ * @param max_retries
+ *   Number of attempts when the snapshot is overwritten while copied.
+ * @return
+ *   Number of the snapshot copied, 0 if none is available.
+ */
+static inline uint64_t
+rte_telemetry_shm_read(const struct rte_telemetry_shm_hdr *hdr, void *dst,
+		unsigned int max_retries)
+{
+	const struct rte_telemetry_shm_buf *buf;
+	uint64_t gen, seq;
+
+	do {
+		gen = __atomic_load_n(&hdr->generation, __ATOMIC_ACQUIRE);
+		if (gen == 0)
+			return 0;
+		buf = rte_telemetry_shm_buf(hdr, gen & 1);
+		seq = __atomic_load_n(&buf->seq, __ATOMIC_ACQUIRE);
+		if (seq & 1)
+			continue;
+		memcpy(dst, buf, hdr->buf_size);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&buf->seq, __ATOMIC_RELAXED) == seq)
+			return ((struct rte_telemetry_shm_buf *)dst)->generation;
+	} while (max_retries-- != 0);
+
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TELEMETRY_SHM_H_ */
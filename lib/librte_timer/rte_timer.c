@@ -30,6 +30,36 @@
 
 #include "rte_timer.h"
 
+/*
+ * Hierarchical timing wheel: level n has WHEEL_SLOTS slots spanning
+ * 1 << (n * WHEEL_BITS) ticks each. A timer is kept in the lowest level
+ * whose range covers its distance to the current tick, and is moved one or
+ * more levels down when the wheel reaches the start of its slot. Timers
+ * beyond the last level are kept in an overflow list, rescanned at the start
+ * of every last level slot.
+ */
+#define WHEEL_LEVELS		4
+#define WHEEL_BITS		8
+#define WHEEL_SLOTS		(1 << WHEEL_BITS)
+#define WHEEL_MASK		(WHEEL_SLOTS - 1)
+#define WHEEL_BMAP_WORDS	(WHEEL_SLOTS / 64)
+/* default number of wheel ticks per second */
+#define WHEEL_DEFAULT_HZ	100000
+
+/**
+ * Per-lcore timing wheel.
+ */
+struct timer_wheel {
+	uint64_t cur;		/**< Next tick to process. */
+	uint64_t next_tick;	/**< No timer to process before this tick. */
+	uint32_t tick_shift;	/**< log2 of the timer cycles per tick. */
+	uint32_t nb_pending;	/**< Number of timers in the wheel. */
+	/** Non empty level 0 slots, cleared when the slot is processed. */
+	uint64_t bmap[WHEEL_BMAP_WORDS];
+	struct rte_timer *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+	struct rte_timer *overflow; /**< Timers beyond the last level. */
+} __rte_cache_aligned;
+
 /**
  * Per-lcore info for timers.
  */
@@ -49,6 +79,13 @@ struct priv_timer {
 	/** running timer on this lcore now */
 	struct rte_timer *running_tim;
 
+	/** timers passed to the running rte_timer_alt_manage_burst() callback */
+	struct rte_timer **burst_tims;
+	unsigned int nb_burst_tims;
+
+	/** timing wheel of this lcore, NULL for the skiplist backend */
+	struct timer_wheel *wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
@@ -59,6 +96,7 @@ struct priv_timer {
 struct rte_timer_data {
 	struct priv_timer priv_timer[RTE_MAX_LCORE];
 	uint8_t internal_flags;
+	struct timer_wheel *wheels; /**< Per-lcore timing wheels, if any. */
 };
 
 #define RTE_MAX_DATA_ELS 64
@@ -120,12 +158,78 @@ rte_timer_data_alloc(uint32_t *id_ptr)
 	return -ENOSPC;
 }
 
+int
+rte_timer_data_alloc_params(uint32_t *id_ptr,
+			    const struct rte_timer_data_params *params)
+{
+	struct rte_timer_data *data;
+	struct timer_wheel *wheels;
+	uint64_t tick, now;
+	uint32_t id, shift;
+	int lcore_id, ret;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	switch (params->backend) {
+	case RTE_TIMER_BACKEND_SKIPLIST:
+		return rte_timer_data_alloc(id_ptr);
+	case RTE_TIMER_BACKEND_WHEEL:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (!rte_timer_subsystem_initialized)
+		return -ENOMEM;
+
+	tick = params->wheel_tick;
+	if (tick == 0)
+		tick = rte_get_timer_hz() / WHEEL_DEFAULT_HZ;
+	shift = (tick <= 1) ? 0 : rte_bsf64(rte_align64prevpow2(tick));
+
+	wheels = rte_zmalloc("rte_timer_wheel",
+			RTE_MAX_LCORE * sizeof(*wheels), RTE_CACHE_LINE_SIZE);
+	if (wheels == NULL)
+		return -ENOMEM;
+
+	ret = rte_timer_data_alloc(&id);
+	if (ret < 0) {
+		rte_free(wheels);
+		return ret;
+	}
+
+	now = rte_get_timer_cycles() >> shift;
+	data = &rte_timer_data_arr[id];
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		wheels[lcore_id].cur = now;
+		wheels[lcore_id].next_tick = UINT64_MAX;
+		wheels[lcore_id].tick_shift = shift;
+		data->priv_timer[lcore_id].wheel = &wheels[lcore_id];
+	}
+	data->wheels = wheels;
+
+	if (id_ptr)
+		*id_ptr = id;
+
+	return 0;
+}
+
 int
 rte_timer_data_dealloc(uint32_t id)
 {
 	struct rte_timer_data *timer_data;
+	int lcore_id;
+
 	TIMER_DATA_VALID_GET_OR_ERR_RET(id, timer_data, -EINVAL);
 
+	if (timer_data->wheels != NULL) {
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+			timer_data->priv_timer[lcore_id].wheel = NULL;
+		rte_free(timer_data->wheels);
+		timer_data->wheels = NULL;
+	}
+
 	timer_data->internal_flags &= ~(FL_ALLOCATED);
 
 	return 0;
@@ -240,6 +344,18 @@ rte_timer_init(struct rte_timer *tim)
 	tim->status.u32 = status.u32;
 }
 
+/* check whether a timer is part of the running expired timers burst */
+static inline int
+timer_in_burst(const struct rte_timer *tim, const struct priv_timer *privp)
+{
+	unsigned int i;
+
+	for (i = 0; i < privp->nb_burst_tims; i++)
+		if (privp->burst_tims[i] == tim)
+			return 1;
+	return 0;
+}
+
 /*
  * if timer is pending or stopped (or running on the same core than
  * us), mark timer as configuring, and on success return the previous
@@ -266,7 +382,8 @@ timer_set_config_state(struct rte_timer *tim,
 		 */
 		if (prev_status.state == RTE_TIMER_RUNNING &&
 		    (prev_status.owner != (uint16_t)lcore_id ||
-		     tim != priv_timer[lcore_id].running_tim))
+		     (tim != priv_timer[lcore_id].running_tim &&
+		      !timer_in_burst(tim, &priv_timer[lcore_id]))))
 			return -1;
 
 		/* timer is being configured on another core */
@@ -396,6 +513,197 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 	}
 }
 
+/*
+ * Timers in a wheel are linked through the skiplist pointers: sl_next[0]
+ * is the next timer of the slot and sl_next[1] holds the address of the
+ * pointer to the timer, so a timer is unlinked without looking up its slot.
+ * A NULL sl_next[1] means that the timer has been taken out of the wheel to
+ * be run.
+ */
+static inline struct rte_timer **
+wheel_get_pprev(const struct rte_timer *tim)
+{
+	return (struct rte_timer **)(uintptr_t)tim->sl_next[1];
+}
+
+static inline void
+wheel_set_pprev(struct rte_timer *tim, struct rte_timer **pprev)
+{
+	tim->sl_next[1] = (struct rte_timer *)(uintptr_t)pprev;
+}
+
+static inline void
+wheel_link(struct rte_timer **head, struct rte_timer *tim)
+{
+	tim->sl_next[0] = *head;
+	if (*head != NULL)
+		wheel_set_pprev(*head, &tim->sl_next[0]);
+	*head = tim;
+	wheel_set_pprev(tim, head);
+}
+
+static inline void
+wheel_unlink(struct rte_timer *tim)
+{
+	struct rte_timer **pprev = wheel_get_pprev(tim);
+	struct rte_timer *next = tim->sl_next[0];
+
+	*pprev = next;
+	if (next != NULL)
+		wheel_set_pprev(next, pprev);
+	wheel_set_pprev(tim, NULL);
+}
+
+/* insert a timer in the slot matching its expiry tick */
+static void
+wheel_insert(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint64_t mask = (1ULL << w->tick_shift) - 1;
+	uint64_t t, delta, next;
+	unsigned int lvl, idx;
+
+	/* round up so that the timer never expires early */
+	t = (tim->expire >> w->tick_shift) + ((tim->expire & mask) != 0);
+	if (t < w->cur)
+		t = w->cur;
+	delta = t - w->cur;
+	lvl = (delta == 0) ? 0 : (63 - __builtin_clzll(delta)) / WHEEL_BITS;
+
+	if (lvl >= WHEEL_LEVELS) {
+		wheel_link(&w->overflow, tim);
+		next = (w->cur | WHEEL_MASK) + 1;
+	} else {
+		idx = (t >> (lvl * WHEEL_BITS)) & WHEEL_MASK;
+		wheel_link(&w->slots[lvl][idx], tim);
+		/* upper levels are only looked at on level 0 wrap around */
+		if (lvl == 0) {
+			w->bmap[idx / 64] |= 1ULL << (idx % 64);
+			next = t;
+		} else {
+			next = (w->cur | WHEEL_MASK) + 1;
+		}
+	}
+
+	if (next < w->next_tick)
+		w->next_tick = next;
+}
+
+static void
+wheel_add(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint64_t now;
+
+	/* skip the idle period rather than walking it on the next manage */
+	if (w->nb_pending == 0) {
+		now = rte_get_timer_cycles() >> w->tick_shift;
+		if (now > w->cur)
+			w->cur = now;
+	}
+
+	wheel_insert(w, tim);
+	w->nb_pending++;
+}
+
+static void
+wheel_del(struct timer_wheel *w, struct rte_timer *tim)
+{
+	/* already taken out to be run */
+	if (wheel_get_pprev(tim) == NULL)
+		return;
+
+	wheel_unlink(tim);
+	w->nb_pending--;
+}
+
+/* first tick after k, in the same level 0 round, with a non empty slot */
+static uint64_t
+wheel_next_slot(const struct timer_wheel *w, uint64_t k)
+{
+	unsigned int idx = (k & WHEEL_MASK) + 1;
+	uint64_t bits;
+
+	while (idx < WHEEL_SLOTS) {
+		bits = w->bmap[idx / 64] >> (idx % 64);
+		if (bits != 0)
+			return (k & ~(uint64_t)WHEEL_MASK) + idx +
+				__builtin_ctzll(bits);
+		idx = (idx | 63) + 1;
+	}
+	return (k | WHEEL_MASK) + 1;
+}
+
+/* move all the timers of a slot to the levels matching their distance */
+static void
+wheel_cascade(struct timer_wheel *w, struct rte_timer **head)
+{
+	struct rte_timer *tim, *next_tim;
+
+	for (tim = *head; tim != NULL; tim = next_tim) {
+		next_tim = tim->sl_next[0];
+		wheel_unlink(tim);
+		wheel_insert(w, tim);
+	}
+}
+
+/*
+ * Process the wheel up to the current tick, lock held. Expired timers are
+ * marked as running and returned as a list linked through sl_next[0].
+ */
+static struct rte_timer *
+wheel_get_expired(struct timer_wheel *w, uint64_t cur_time)
+{
+	uint64_t now = cur_time >> w->tick_shift;
+	struct rte_timer *run_first_tim = NULL, **pprev = &run_first_tim;
+	struct rte_timer *tim, *next_tim;
+	unsigned int lvl, idx;
+	uint64_t k;
+
+	while (w->cur <= now) {
+		k = w->cur;
+
+		if ((k & WHEEL_MASK) == 0) {
+			if ((k & ((1ULL << ((WHEEL_LEVELS - 1) *
+					WHEEL_BITS)) - 1)) == 0)
+				wheel_cascade(w, &w->overflow);
+			for (lvl = WHEEL_LEVELS - 1; lvl > 0; lvl--) {
+				if ((k & ((1ULL << (lvl * WHEEL_BITS)) - 1))
+						!= 0)
+					continue;
+				idx = (k >> (lvl * WHEEL_BITS)) & WHEEL_MASK;
+				wheel_cascade(w, &w->slots[lvl][idx]);
+			}
+		}
+
+		idx = k & WHEEL_MASK;
+		for (tim = w->slots[0][idx]; tim != NULL; tim = next_tim) {
+			next_tim = tim->sl_next[0];
+			/* another core is trying to re-config this one,
+			 * it will remove it from the wheel
+			 */
+			if (timer_set_running_state(tim) < 0)
+				continue;
+			wheel_unlink(tim);
+			w->nb_pending--;
+			tim->sl_next[0] = NULL;
+			*pprev = tim;
+			pprev = &tim->sl_next[0];
+		}
+		if (w->slots[0][idx] == NULL)
+			w->bmap[idx / 64] &= ~(1ULL << (idx % 64));
+
+		w->cur = RTE_MIN(wheel_next_slot(w, k), now + 1);
+	}
+
+	if (w->nb_pending == 0)
+		w->next_tick = UINT64_MAX;
+	else if ((w->cur & WHEEL_MASK) == 0)
+		w->next_tick = w->cur;
+	else
+		w->next_tick = wheel_next_slot(w, w->cur - 1);
+
+	return run_first_tim;
+}
+
 /* call with lock held as necessary
  * add in list
  * timer must be in config state
@@ -408,6 +716,11 @@ timer_add(struct rte_timer *tim, unsigned int tim_lcore,
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
+	if (priv_timer[tim_lcore].wheel != NULL) {
+		wheel_add(priv_timer[tim_lcore].wheel, tim);
+		return;
+	}
+
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
 	timer_get_prev_entries(tim->expire, tim_lcore, prev, priv_timer);
@@ -453,6 +766,11 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
 
+	if (priv_timer[prev_owner].wheel != NULL) {
+		wheel_del(priv_timer[prev_owner].wheel, tim);
+		goto unlock;
+	}
+
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -473,6 +791,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 		else
 			break;
 
+unlock:
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
 }
@@ -698,59 +1017,72 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
-/* must be called periodically, run all timer that expired */
-static void
-__rte_timer_manage(struct rte_timer_data *timer_data)
+/*
+ * Take the timers of a lcore which expired at cur_time out of its list,
+ * mark them as running and return them linked through sl_next[0].
+ */
+static struct rte_timer *
+timer_get_expired(unsigned int poll_lcore, struct priv_timer *priv_timer,
+		  uint64_t cur_time)
 {
-	union rte_timer_status status;
+	struct priv_timer *privp = &priv_timer[poll_lcore];
 	struct rte_timer *tim, *next_tim;
 	struct rte_timer *run_first_tim, **pprev;
-	unsigned lcore_id = rte_lcore_id();
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
-	uint64_t cur_time;
 	int i, ret;
-	struct priv_timer *priv_timer = timer_data->priv_timer;
 
-	/* timer manager only runs on EAL thread with valid lcore_id */
-	assert(lcore_id < RTE_MAX_LCORE);
+	if (privp->wheel != NULL) {
+		/* optimize for the case where the wheel is empty */
+		if (privp->wheel->nb_pending == 0)
+			return NULL;
+#ifdef RTE_ARCH_64
+		/* next_tick is updated atomically on 64-bit, check it
+		 * outside the lock
+		 */
+		if (likely(privp->wheel->next_tick >
+				cur_time >> privp->wheel->tick_shift))
+			return NULL;
+#endif
+		rte_spinlock_lock(&privp->list_lock);
+		run_first_tim = wheel_get_expired(privp->wheel, cur_time);
+		rte_spinlock_unlock(&privp->list_lock);
+		return run_first_tim;
+	}
 
-	__TIMER_STAT_ADD(priv_timer, manage, 1);
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
-		return;
-	cur_time = rte_get_timer_cycles();
+	if (privp->pending_head.sl_next[0] == NULL)
+		return NULL;
 
 #ifdef RTE_ARCH_64
 	/* on 64-bit the value cached in the pending_head.expired will be
 	 * updated atomically, so we can consult that for a quick check here
 	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
-		return;
+	if (likely(privp->pending_head.expire > cur_time))
+		return NULL;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
-	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_lock(&privp->list_lock);
 
 	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
-		return;
+	if (privp->pending_head.sl_next[0] == NULL ||
+	    privp->pending_head.sl_next[0]->expire > cur_time) {
+		rte_spinlock_unlock(&privp->list_lock);
+		return NULL;
 	}
 
 	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+	tim = privp->pending_head.sl_next[0];
 
 	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev, priv_timer);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		if (prev[i] == &priv_timer[lcore_id].pending_head)
+	timer_get_prev_entries(cur_time, poll_lcore, prev, priv_timer);
+	for (i = privp->curr_skiplist_depth - 1; i >= 0; i--) {
+		if (prev[i] == &privp->pending_head)
 			continue;
-		priv_timer[lcore_id].pending_head.sl_next[i] =
-		    prev[i]->sl_next[i];
+		privp->pending_head.sl_next[i] = prev[i]->sl_next[i];
 		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
-		prev[i] ->sl_next[i] = NULL;
+			privp->curr_skiplist_depth--;
+		prev[i]->sl_next[i] = NULL;
 	}
 
 	/* transition run-list from PENDING to RUNNING */
@@ -772,11 +1104,33 @@ __rte_timer_manage(struct rte_timer_data *timer_data)
 	}
 
 	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
+	privp->pending_head.expire =
+	    (privp->pending_head.sl_next[0] == NULL) ? 0 :
+		privp->pending_head.sl_next[0]->expire;
+
+	rte_spinlock_unlock(&privp->list_lock);
+
+	return run_first_tim;
+}
+
+/* must be called periodically, run all timer that expired */
+static void
+__rte_timer_manage(struct rte_timer_data *timer_data)
+{
+	union rte_timer_status status;
+	struct rte_timer *tim, *next_tim;
+	struct rte_timer *run_first_tim;
+	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_timer = timer_data->priv_timer;
+
+	/* timer manager only runs on EAL thread with valid lcore_id */
+	assert(lcore_id < RTE_MAX_LCORE);
 
-	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	__TIMER_STAT_ADD(priv_timer, manage, 1);
+	run_first_tim = timer_get_expired(lcore_id, priv_timer,
+					  rte_get_timer_cycles());
+	if (run_first_tim == NULL)
+		return;
 
 	/* now scan expired list and call callbacks */
 	for (tim = run_first_tim; tim != NULL; tim = next_tim) {
@@ -846,15 +1200,12 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 {
 	unsigned int default_poll_lcores[] = {rte_lcore_id()};
 	union rte_timer_status status;
-	struct rte_timer *tim, *next_tim, **pprev;
+	struct rte_timer *tim;
 	struct rte_timer *run_first_tims[RTE_MAX_LCORE];
 	unsigned int this_lcore = rte_lcore_id();
-	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
-	uint64_t cur_time;
-	int i, j, ret;
+	int i;
 	int nb_runlists = 0;
 	struct rte_timer_data *data;
-	struct priv_timer *privp;
 	uint32_t poll_lcore;
 
 	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, data, -EINVAL);
@@ -871,74 +1222,11 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 
 	for (i = 0; i < nb_poll_lcores; i++) {
 		poll_lcore = poll_lcores[i];
-		privp = &data->priv_timer[poll_lcore];
-
-		/* optimize for the case where per-cpu list is empty */
-		if (privp->pending_head.sl_next[0] == NULL)
-			continue;
-		cur_time = rte_get_timer_cycles();
-
-#ifdef RTE_ARCH_64
-		/* on 64-bit the value cached in the pending_head.expired will
-		 * be updated atomically, so we can consult that for a quick
-		 * check here outside the lock
-		 */
-		if (likely(privp->pending_head.expire > cur_time))
-			continue;
-#endif
-
-		/* browse ordered list, add expired timers in 'expired' list */
-		rte_spinlock_lock(&privp->list_lock);
-
-		/* if nothing to do just unlock and return */
-		if (privp->pending_head.sl_next[0] == NULL ||
-		    privp->pending_head.sl_next[0]->expire > cur_time) {
-			rte_spinlock_unlock(&privp->list_lock);
-			continue;
-		}
-
-		/* save start of list of expired timers */
-		tim = privp->pending_head.sl_next[0];
-
-		/* break the existing list at current time point */
-		timer_get_prev_entries(cur_time, poll_lcore, prev,
-				       data->priv_timer);
-		for (j = privp->curr_skiplist_depth - 1; j >= 0; j--) {
-			if (prev[j] == &privp->pending_head)
-				continue;
-			privp->pending_head.sl_next[j] =
-				prev[j]->sl_next[j];
-			if (prev[j]->sl_next[j] == NULL)
-				privp->curr_skiplist_depth--;
-
-			prev[j]->sl_next[j] = NULL;
-		}
-
-		/* transition run-list from PENDING to RUNNING */
-		run_first_tims[nb_runlists] = tim;
-		pprev = &run_first_tims[nb_runlists];
-		nb_runlists++;
-
-		for ( ; tim != NULL; tim = next_tim) {
-			next_tim = tim->sl_next[0];
-
-			ret = timer_set_running_state(tim);
-			if (likely(ret == 0)) {
-				pprev = &tim->sl_next[0];
-			} else {
-				/* another core is trying to re-config this one,
-				 * remove it from local expired list
-				 */
-				*pprev = next_tim;
-			}
-		}
-
-		/* update the next to expire timer value */
-		privp->pending_head.expire =
-		    (privp->pending_head.sl_next[0] == NULL) ? 0 :
-			privp->pending_head.sl_next[0]->expire;
 
-		rte_spinlock_unlock(&privp->list_lock);
+		tim = timer_get_expired(poll_lcore, data->priv_timer,
+					rte_get_timer_cycles());
+		if (tim != NULL)
+			run_first_tims[nb_runlists++] = tim;
 	}
 
 	/* Now process the run lists */
@@ -1010,6 +1298,117 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 	return 0;
 }
 
+int
+rte_timer_alt_manage_burst(uint32_t timer_data_id,
+			   rte_timer_alt_manage_burst_cb_t f, void *arg)
+{
+	struct rte_timer *burst[RTE_TIMER_MANAGE_BURST_SIZE];
+	unsigned int this_lcore = rte_lcore_id();
+	union rte_timer_status status;
+	struct rte_timer *tim, *next_tim;
+	struct rte_timer_data *data;
+	struct priv_timer *privp;
+	unsigned int i, nb;
+	int nb_expired = 0;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, data, -EINVAL);
+	if (f == NULL)
+		return -EINVAL;
+
+	/* timer manager only runs on EAL thread with valid lcore_id */
+	assert(this_lcore < RTE_MAX_LCORE);
+
+	__TIMER_STAT_ADD(data->priv_timer, manage, 1);
+	privp = &data->priv_timer[this_lcore];
+
+	tim = timer_get_expired(this_lcore, data->priv_timer,
+				rte_get_timer_cycles());
+
+	while (tim != NULL) {
+		for (nb = 0; nb < RTE_DIM(burst) && tim != NULL; nb++) {
+			burst[nb] = tim;
+			tim = tim->sl_next[0];
+		}
+		next_tim = tim;
+
+		/* let the callback stop or reset the timers of the burst */
+		privp->burst_tims = burst;
+		privp->nb_burst_tims = nb;
+		f(burst, nb, arg);
+		privp->burst_tims = NULL;
+		privp->nb_burst_tims = 0;
+
+		__TIMER_STAT_ADD(data->priv_timer, pending, -(int)nb);
+		nb_expired += nb;
+
+		for (i = 0; i < nb; i++) {
+			tim = burst[i];
+
+			/* the timer was stopped or reloaded by the callback
+			 * function, we have nothing to do here
+			 */
+			if (tim->status.state != RTE_TIMER_RUNNING ||
+			    tim->status.owner != (int16_t)this_lcore)
+				continue;
+
+			if (tim->period == 0) {
+				/* mark timer as stopped */
+				status.state = RTE_TIMER_STOP;
+				status.owner = RTE_TIMER_NO_OWNER;
+				rte_wmb();
+				tim->status.u32 = status.u32;
+			} else {
+				/* keep it in list and mark timer as pending */
+				rte_spinlock_lock(&privp->list_lock);
+				status.state = RTE_TIMER_PENDING;
+				__TIMER_STAT_ADD(data->priv_timer, pending, 1);
+				status.owner = (int16_t)this_lcore;
+				rte_wmb();
+				tim->status.u32 = status.u32;
+				__rte_timer_reset(tim,
+					tim->expire + tim->period,
+					tim->period, this_lcore, tim->f,
+					tim->arg, 1, data);
+				rte_spinlock_unlock(&privp->list_lock);
+			}
+		}
+
+		tim = next_tim;
+	}
+
+	return nb_expired;
+}
+
+/* stop all the timers of a wheel, lock held */
+static void
+wheel_stop_all(struct timer_wheel *w, struct rte_timer_data *timer_data,
+	       rte_timer_stop_all_cb_t f, void *f_arg)
+{
+	struct rte_timer *tim, *next_tim;
+	unsigned int lvl, idx;
+
+	for (lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+		for (idx = 0; idx < WHEEL_SLOTS; idx++) {
+			for (tim = w->slots[lvl][idx]; tim != NULL;
+			     tim = next_tim) {
+				next_tim = tim->sl_next[0];
+				__rte_timer_stop(tim, 1, timer_data);
+				if (f)
+					f(tim, f_arg);
+			}
+		}
+	}
+	memset(w->bmap, 0, sizeof(w->bmap));
+
+	for (tim = w->overflow; tim != NULL; tim = next_tim) {
+		next_tim = tim->sl_next[0];
+		__rte_timer_stop(tim, 1, timer_data);
+		if (f)
+			f(tim, f_arg);
+	}
+	w->next_tick = UINT64_MAX;
+}
+
 /* Walk pending lists, stopping timers and calling user-specified function */
 int
 rte_timer_stop_all(uint32_t timer_data_id, unsigned int *walk_lcores,
@@ -1030,6 +1429,13 @@ rte_timer_stop_all(uint32_t timer_data_id, unsigned int *walk_lcores,
 
 		rte_spinlock_lock(&priv_timer->list_lock);
 
+		if (priv_timer->wheel != NULL) {
+			wheel_stop_all(priv_timer->wheel, timer_data, f,
+				       f_arg);
+			rte_spinlock_unlock(&priv_timer->list_lock);
+			continue;
+		}
+
 		for (tim = priv_timer->pending_head.sl_next[0];
 		     tim != NULL;
 		     tim = next_tim) {
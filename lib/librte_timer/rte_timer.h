@@ -150,6 +150,63 @@ struct rte_timer
 __rte_experimental
 int rte_timer_data_alloc(uint32_t *id_ptr);
 
+/**
+ * Data structure used to keep track of the pending timers of a timer data
+ * instance.
+ */
+enum rte_timer_backend {
+	/**
+	 * Per-lcore skiplist ordered by expiry time: O(log n) reset and
+	 * exact expiry. This is the backend of rte_timer_data_alloc().
+	 */
+	RTE_TIMER_BACKEND_SKIPLIST,
+	/**
+	 * Per-lcore hierarchical timing wheel: O(1) reset and stop, timers
+	 * expire with the resolution of the wheel tick, never early.
+	 */
+	RTE_TIMER_BACKEND_WHEEL,
+};
+
+/**
+ * Parameters of a timer data instance.
+ */
+struct rte_timer_data_params {
+	enum rte_timer_backend backend; /**< Pending timers data structure. */
+	/**
+	 * Resolution of the timing wheel in timer cycles, rounded down to a
+	 * power of two. 0 selects about 10 microseconds. Ignored by the
+	 * skiplist backend.
+	 */
+	uint64_t wheel_tick;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Allocate a timer data instance in shared memory, using the pending timer
+ * data structure described by *params*.
+ *
+ * The timing wheel backend is suited to a large number of timers which are
+ * frequently reset or stopped before they expire, e.g. connection tracking
+ * timeouts.
+ *
+ * @param id_ptr
+ *   Pointer to variable into which to write the identifier of the allocated
+ *   timer data instance.
+ * @param params
+ *   Parameters of the timer data instance.
+ *
+ * @return
+ *   - 0: Success
+ *   - -EINVAL: invalid parameters
+ *   - -ENOMEM: not enough memory for the timing wheels
+ *   - -ENOSPC: maximum number of timer data instances already allocated
+ */
+__rte_experimental
+int rte_timer_data_alloc_params(uint32_t *id_ptr,
+		const struct rte_timer_data_params *params);
+
 /**
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
@@ -480,6 +537,44 @@ int
 rte_timer_alt_manage(uint32_t timer_data_id, unsigned int *poll_lcores,
 		     int n_poll_lcores, rte_timer_alt_manage_cb_t f);
 
+/** Maximum number of timers passed to a rte_timer_alt_manage_burst() callback */
+#define RTE_TIMER_MANAGE_BURST_SIZE 32
+
+/**
+ * Callback function type for rte_timer_alt_manage_burst().
+ */
+typedef void (*rte_timer_alt_manage_burst_cb_t)(struct rte_timer **tims,
+		unsigned int nb_tims, void *arg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Process the expired timers of the calling lcore in the specified timer
+ * data instance, passing them to the callback function in bursts of up to
+ * RTE_TIMER_MANAGE_BURST_SIZE timers. Callback functions of individual
+ * timers are ignored.
+ *
+ * While the callback function runs, any timer of the burst may be reset or
+ * stopped from the calling lcore. Once it returns, the timers which have not
+ * been reset or stopped are reloaded if periodic and stopped otherwise.
+ *
+ * @param timer_data_id
+ *   An identifier indicating which instance of timer data should be used for
+ *   this operation.
+ * @param f
+ *   The callback function which should be called for the expired timers.
+ * @param arg
+ *   An arbitrary argument that will be passed to f.
+ * @return
+ *   - number of expired timers on success
+ *   - -EINVAL: invalid timer_data_id or callback function
+ */
+__rte_experimental
+int
+rte_timer_alt_manage_burst(uint32_t timer_data_id,
+			   rte_timer_alt_manage_burst_cb_t f, void *arg);
+
 /**
  * Callback function type for rte_timer_stop_all().
  */
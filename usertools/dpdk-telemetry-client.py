@@ -15,6 +15,9 @@
 API_REG = "{\"action\":1,\"command\":\"clients\",\"data\":{\"client_path\":\""
 API_UNREG = "{\"action\":2,\"command\":\"clients\",\"data\":{\"client_path\":\""
 GLOBAL_METRICS_REQ = "{\"action\":0,\"command\":\"global_stat_values\",\"data\":null}"
+LCORES_POLL_REQ = "{\"action\":0,\"command\":\"lcores_poll_stats\",\"data\":null}"
+DELTA_START_REQ = "{\"action\":1,\"command\":\"stats_delta\",\"data\":{\"interval_ms\":"
+DELTA_STOP_REQ = "{\"action\":2,\"command\":\"stats_delta\",\"data\":null}"
 DEFAULT_FP = "/var/run/dpdk/default_client"
 
 try:
@@ -92,13 +95,33 @@ def requestGlobalMetrics(self): #Requests global metrics for given client
         data = self.socket.client_fd.recv(BUFFER_SIZE)
         print("\nResponse: \n", str(data))
 
+    def requestLcoresPollStats(self): #Requests lcores poll stats for given client
+        self.socket.client_fd.send(LCORES_POLL_REQ)
+        data = self.socket.client_fd.recv(BUFFER_SIZE)
+        print("\nResponse: \n", str(data))
+
+    def streamStatsDelta(self, sleep_time): # Streams the changed statistics for given client
+        print("\nPlease enter the number of deltas you'd like to receive:")
+        n_deltas = int(raw_input("\n:"))
+        print("\033[F") #Removes the user input from screen, cleans it up
+        print("\033[K")
+        self.socket.client_fd.send(DELTA_START_REQ + str(int(sleep_time * 1000)) + "}}")
+        while n_deltas > 0:
+            data = self.socket.client_fd.recv(BUFFER_SIZE)
+            print("\nResponse: \n", str(data))
+            if "\"last\":true" in str(data) or "Status Error" in str(data):
+                n_deltas -= 1
+        self.socket.client_fd.send(DELTA_STOP_REQ)
+
     def interactiveMenu(self, sleep_time): # Creates Interactive menu within the script
-        while self.choice != 4:
+        while self.choice != 6:
             print("\nOptions Menu")
             print("[1] Send for Metrics for all ports")
             print("[2] Send for Metrics for all ports recursively")
             print("[3] Send for global Metrics")
-            print("[4] Unregister client")
+            print("[4] Send for lcores poll statistics")
+            print("[5] Stream statistics deltas")
+            print("[6] Unregister client")
 
             try:
                 self.choice = int(raw_input("\n:"))
@@ -111,6 +134,10 @@ def interactiveMenu(self, sleep_time): # Creates Interactive menu within the scr
                 elif self.choice == 3:
                     self.requestGlobalMetrics()
                 elif self.choice == 4:
+                    self.requestLcoresPollStats()
+                elif self.choice == 5:
+                    self.streamStatsDelta(sleep_time)
+                elif self.choice == 6:
                     self.unregister()
                     self.unregistered = 1
                 else: